@@ -28,6 +28,8 @@
 #include "py/smallint.h"
 #include "py/pairheap.h"
 #include "py/mphal.h"
+#include "py/stream.h"
+#include "shared/runtime/interrupt_char.h"
 
 #if MICROPY_PY_ASYNCIO
 
@@ -353,6 +355,520 @@ static MP_DEFINE_CONST_OBJ_TYPE(
     iter, &task_getiter_iternext
     );
 
+#if MICROPY_PY_ASYNCIO_NATIVE_LOOP
+
+#if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+#include <errno.h>
+#include <poll.h>
+
+// While a waited-on stream has no file descriptor, the system poll() that
+// waits for the others is cut to this many ms, so the stream is asked again.
+#define IO_QUEUE_IOCTL_CALL_PERIOD_MS (1)
+#endif
+
+/******************************************************************************/
+// IOQueue class
+
+// A stream that tasks wait on.  Entries stay in the IOQueue map after their
+// waiters are woken, so a task that loops on the same stream re-queues without
+// allocating.  They are only dropped when the loop goes idle (see
+// io_queue_drop_idle), by which point every woken task has had a chance to run.
+typedef struct _io_queue_entry_t {
+    mp_obj_t stream;
+    mp_uint_t (*ioctl)(mp_obj_t obj, mp_uint_t request, uintptr_t arg, int *errcode);
+    // Tasks waiting to read and to write, or MP_OBJ_NULL.
+    mp_obj_t waiting[2];
+} io_queue_entry_t;
+
+typedef struct _mp_obj_io_queue_t {
+    mp_obj_base_t base;
+    // Map with key=id(stream), value=its io_queue_entry_t.
+    mp_map_t map;
+    // Total number of tasks waiting on all entries.
+    size_t n_waiting;
+    #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+    // Scratch space for io_queue_poll_once, kept between polls: the
+    // descriptors passed to poll() and the entry each one belongs to.
+    struct pollfd *pollfds;
+    io_queue_entry_t **poll_entries;
+    size_t pollfds_alloc;
+    #endif
+} mp_obj_io_queue_t;
+
+static const mp_obj_type_t io_queue_type;
+
+static mp_obj_t io_queue_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    (void)args;
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+    mp_obj_io_queue_t *self = mp_obj_malloc(mp_obj_io_queue_t, type);
+    mp_map_init(&self->map, 0);
+    self->n_waiting = 0;
+    #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+    self->pollfds = NULL;
+    self->poll_entries = NULL;
+    self->pollfds_alloc = 0;
+    #endif
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static void io_queue_enqueue(mp_obj_t self_in, mp_obj_t stream, size_t idx) {
+    mp_obj_io_queue_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t key = mp_obj_id(stream);
+    mp_map_elem_t *elem = mp_map_lookup(&self->map, key, MP_MAP_LOOKUP);
+    io_queue_entry_t *entry;
+    if (elem == NULL) {
+        // Look up the ioctl before adding to the map, so a non-stream leaves no entry behind.
+        const mp_stream_p_t *stream_p = mp_get_stream_raise(stream, MP_STREAM_OP_IOCTL);
+        entry = m_new_obj(io_queue_entry_t);
+        entry->stream = stream;
+        entry->ioctl = stream_p->ioctl;
+        entry->waiting[0] = MP_OBJ_NULL;
+        entry->waiting[1] = MP_OBJ_NULL;
+        mp_map_lookup(&self->map, key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND)->value = MP_OBJ_FROM_PTR(entry);
+    } else {
+        entry = MP_OBJ_TO_PTR(elem->value);
+    }
+    if (entry->waiting[idx] != MP_OBJ_NULL) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("can't wait"));
+    }
+    mp_obj_t cur_task = mp_obj_dict_get(mp_asyncio_context, MP_OBJ_NEW_QSTR(MP_QSTR_cur_task));
+    entry->waiting[idx] = cur_task;
+    self->n_waiting += 1;
+    // Set the task's data to this queue so Task.cancel() can remove it.
+    ((mp_obj_task_t *)MP_OBJ_TO_PTR(cur_task))->data = self_in;
+}
+
+static mp_obj_t io_queue_queue_read(mp_obj_t self_in, mp_obj_t stream) {
+    io_queue_enqueue(self_in, stream, 0);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(io_queue_queue_read_obj, io_queue_queue_read);
+
+static mp_obj_t io_queue_queue_write(mp_obj_t self_in, mp_obj_t stream) {
+    io_queue_enqueue(self_in, stream, 1);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(io_queue_queue_write_obj, io_queue_queue_write);
+
+static mp_obj_t io_queue_remove(mp_obj_t self_in, mp_obj_t task_in) {
+    mp_obj_io_queue_t *self = MP_OBJ_TO_PTR(self_in);
+    for (size_t i = 0; i < self->map.alloc; ++i) {
+        if (!mp_map_slot_is_filled(&self->map, i)) {
+            continue;
+        }
+        io_queue_entry_t *entry = MP_OBJ_TO_PTR(self->map.table[i].value);
+        for (size_t idx = 0; idx < 2; ++idx) {
+            if (entry->waiting[idx] == task_in) {
+                entry->waiting[idx] = MP_OBJ_NULL;
+                self->n_waiting -= 1;
+            }
+        }
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(io_queue_remove_obj, io_queue_remove);
+
+// Forget streams that no task is waiting on.
+static void io_queue_drop_idle(mp_obj_io_queue_t *self) {
+    for (size_t i = 0; i < self->map.alloc; ++i) {
+        if (!mp_map_slot_is_filled(&self->map, i)) {
+            continue;
+        }
+        io_queue_entry_t *entry = MP_OBJ_TO_PTR(self->map.table[i].value);
+        if (entry->waiting[0] == MP_OBJ_NULL && entry->waiting[1] == MP_OBJ_NULL) {
+            // Removal only marks the slot as deleted, so the scan can continue.
+            mp_map_lookup(&self->map, self->map.table[i].key, MP_MAP_LOOKUP_REMOVE_IF_FOUND);
+            m_del_obj(io_queue_entry_t, entry);
+        }
+    }
+}
+
+// Move the tasks waiting on entry for the events in ret (MP_STREAM_POLL_xxx)
+// onto the main task queue.  Returns the number of tasks woken.
+static size_t io_queue_wake(mp_obj_io_queue_t *self, io_queue_entry_t *entry, mp_uint_t ret, mp_obj_t task_queue) {
+    size_t n_woken = 0;
+    // Errors and hang-ups wake both readers and writers, as with select.poll.
+    for (size_t idx = 0; idx < 2; ++idx) {
+        mp_uint_t other = idx == 0 ? MP_STREAM_POLL_WR : MP_STREAM_POLL_RD;
+        if ((ret & ~other) && entry->waiting[idx] != MP_OBJ_NULL) {
+            mp_obj_t args[2] = { task_queue, entry->waiting[idx] };
+            entry->waiting[idx] = MP_OBJ_NULL;
+            self->n_waiting -= 1;
+            task_queue_push(2, args);
+            n_woken += 1;
+        }
+    }
+    return n_woken;
+}
+
+// Ask a stream without a file descriptor which of the events it is ready for.
+static mp_uint_t io_queue_poll_entry(io_queue_entry_t *entry, mp_uint_t events) {
+    int errcode;
+    mp_uint_t ret = entry->ioctl(entry->stream, MP_STREAM_POLL, events, &errcode);
+    if (ret == MP_STREAM_ERROR) {
+        mp_raise_OSError(errcode);
+    }
+    return ret;
+}
+
+static mp_uint_t io_queue_entry_events(io_queue_entry_t *entry) {
+    mp_uint_t events = 0;
+    if (entry->waiting[0] != MP_OBJ_NULL) {
+        events |= MP_STREAM_POLL_RD;
+    }
+    if (entry->waiting[1] != MP_OBJ_NULL) {
+        events |= MP_STREAM_POLL_WR;
+    }
+    return events;
+}
+
+#if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+
+// Poll each stream that has a waiter, blocking in the system poll() for up to
+// timeout_ms (forever if negative) until one is ready or a signal arrives, and
+// move tasks whose stream is ready onto the main task queue.  Streams with a
+// file descriptor don't implement MP_STREAM_POLL on this port, so they are
+// polled through it; any other stream is asked directly, and cuts the wait
+// short so it is asked again soon.  Returns the number of tasks woken.
+static size_t io_queue_poll_once(mp_obj_io_queue_t *self, mp_int_t timeout_ms) {
+    mp_obj_t task_queue = mp_obj_dict_get(mp_asyncio_context, MP_OBJ_NEW_QSTR(MP_QSTR__task_queue));
+    if (self->pollfds_alloc < self->map.used) {
+        self->pollfds = m_renew(struct pollfd, self->pollfds, self->pollfds_alloc, self->map.used);
+        self->poll_entries = m_renew(io_queue_entry_t *, self->poll_entries, self->pollfds_alloc, self->map.used);
+        self->pollfds_alloc = self->map.used;
+    }
+    size_t n_woken = 0;
+    nfds_t nfds = 0;
+    for (size_t i = 0; i < self->map.alloc; ++i) {
+        if (!mp_map_slot_is_filled(&self->map, i)) {
+            continue;
+        }
+        io_queue_entry_t *entry = MP_OBJ_TO_PTR(self->map.table[i].value);
+        mp_uint_t events = io_queue_entry_events(entry);
+        if (events == 0) {
+            continue;
+        }
+        // Looked up each time, as the stream may have been closed and its
+        // descriptor reused since it was queued.
+        int errcode;
+        mp_uint_t fd = entry->ioctl(entry->stream, MP_STREAM_GET_FILENO, 0, &errcode);
+        if (fd == MP_STREAM_ERROR) {
+            n_woken += io_queue_wake(self, entry, io_queue_poll_entry(entry, events), task_queue);
+            if (timeout_ms < 0 || timeout_ms > IO_QUEUE_IOCTL_CALL_PERIOD_MS) {
+                timeout_ms = IO_QUEUE_IOCTL_CALL_PERIOD_MS;
+            }
+            continue;
+        }
+        self->pollfds[nfds].fd = fd;
+        self->pollfds[nfds].events = (events & MP_STREAM_POLL_RD ? POLLIN : 0) | (events & MP_STREAM_POLL_WR ? POLLOUT : 0);
+        self->pollfds[nfds].revents = 0;
+        self->poll_entries[nfds] = entry;
+        ++nfds;
+    }
+    if (n_woken > 0) {
+        timeout_ms = 0;
+    }
+
+    MP_THREAD_GIL_EXIT();
+    int n_ready = poll(self->pollfds, nfds, timeout_ms);
+    MP_THREAD_GIL_ENTER();
+
+    if (n_ready == -1) {
+        // EINTR is how a signal such as Ctrl-C gets here; the caller handles it.
+        if (errno != EINTR) {
+            mp_raise_OSError(errno);
+        }
+        n_ready = 0;
+    }
+    for (nfds_t i = 0; n_ready > 0 && i < nfds; ++i) {
+        short revents = self->pollfds[i].revents;
+        if (revents == 0) {
+            continue;
+        }
+        --n_ready;
+        mp_uint_t ret = 0;
+        if (revents & POLLIN) {
+            ret |= MP_STREAM_POLL_RD;
+        }
+        if (revents & POLLOUT) {
+            ret |= MP_STREAM_POLL_WR;
+        }
+        if (revents & POLLERR) {
+            ret |= MP_STREAM_POLL_ERR;
+        }
+        if (revents & POLLHUP) {
+            ret |= MP_STREAM_POLL_HUP;
+        }
+        if (revents & POLLNVAL) {
+            ret |= MP_STREAM_POLL_NVAL;
+        }
+        n_woken += io_queue_wake(self, self->poll_entries[i], ret, task_queue);
+    }
+    return n_woken;
+}
+
+#else
+
+// Poll each stream that has a waiter and move tasks whose stream is ready onto
+// the main task queue.  Returns the number of tasks woken.
+static size_t io_queue_poll_once(mp_obj_io_queue_t *self) {
+    if (self->n_waiting == 0) {
+        return 0;
+    }
+    mp_obj_t task_queue = mp_obj_dict_get(mp_asyncio_context, MP_OBJ_NEW_QSTR(MP_QSTR__task_queue));
+    size_t n_woken = 0;
+    for (size_t i = 0; i < self->map.alloc; ++i) {
+        if (!mp_map_slot_is_filled(&self->map, i)) {
+            continue;
+        }
+        io_queue_entry_t *entry = MP_OBJ_TO_PTR(self->map.table[i].value);
+        mp_uint_t events = io_queue_entry_events(entry);
+        if (events != 0) {
+            n_woken += io_queue_wake(self, entry, io_queue_poll_entry(entry, events), task_queue);
+        }
+    }
+    return n_woken;
+}
+
+#endif
+
+// Wait for up to dt ms (forever if dt < 0) for a stream to become ready.  With
+// dt == 0 this only polls.  Without any waiters it just sleeps for dt ms.
+static void io_queue_wait_io_event_helper(mp_obj_io_queue_t *self, mp_int_t dt) {
+    if (dt != 0) {
+        // No task is ready to run, so any task woken by an earlier poll has
+        // already had its chance to wait again on its stream.
+        io_queue_drop_idle(self);
+    }
+    mp_uint_t start_ticks = mp_hal_ticks_ms();
+    for (;;) {
+        mp_int_t remaining = -1;
+        if (dt >= 0) {
+            mp_uint_t elapsed = mp_hal_ticks_ms() - start_ticks;
+            remaining = elapsed >= (mp_uint_t)dt ? 0 : dt - elapsed;
+        } else if (self->n_waiting == 0) {
+            return;
+        }
+        #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+        size_t n_woken = io_queue_poll_once(self, remaining);
+        // Raise any pending exception, such as KeyboardInterrupt from a signal
+        // that cut the wait short.
+        mp_event_handle_nowait();
+        if (n_woken > 0 || remaining == 0) {
+            return;
+        }
+        #else
+        if (io_queue_poll_once(self) > 0 || remaining == 0) {
+            return;
+        }
+        // CIRCUITPY-CHANGE: check for ctrl-C interrupt
+        if (mp_hal_is_interrupted()) {
+            return;
+        }
+        // These run background tasks and raise any pending exception.
+        if (remaining < 0) {
+            mp_event_wait_indefinite();
+        } else {
+            mp_event_wait_ms(remaining);
+        }
+        #endif
+    }
+}
+
+static mp_obj_t io_queue_wait_io_event(mp_obj_t self_in, mp_obj_t dt_in) {
+    io_queue_wait_io_event_helper(MP_OBJ_TO_PTR(self_in), mp_obj_get_int(dt_in));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(io_queue_wait_io_event_obj, io_queue_wait_io_event);
+
+static mp_obj_t io_queue_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    mp_obj_io_queue_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL:
+            return mp_obj_new_bool(self->n_waiting != 0);
+        case MP_UNARY_OP_LEN:
+            return MP_OBJ_NEW_SMALL_INT(self->n_waiting);
+        default:
+            return MP_OBJ_NULL; // op not supported
+    }
+}
+
+static const mp_rom_map_elem_t io_queue_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_queue_read), MP_ROM_PTR(&io_queue_queue_read_obj) },
+    { MP_ROM_QSTR(MP_QSTR_queue_write), MP_ROM_PTR(&io_queue_queue_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_remove), MP_ROM_PTR(&io_queue_remove_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_io_event), MP_ROM_PTR(&io_queue_wait_io_event_obj) },
+};
+static MP_DEFINE_CONST_DICT(io_queue_locals_dict, io_queue_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(
+    io_queue_type,
+    MP_QSTR_IOQueue,
+    MP_TYPE_FLAG_NONE,
+    make_new, io_queue_make_new,
+    unary_op, io_queue_unary_op,
+    locals_dict, &io_queue_locals_dict
+    );
+
+/******************************************************************************/
+// Core run loop
+
+static mp_obj_t asyncio_context_get(qstr name) {
+    return mp_obj_dict_get(mp_asyncio_context, MP_OBJ_NEW_QSTR(name));
+}
+
+// Equivalent of `not _io_queue.map` (or `not _io_queue` for a native IOQueue).
+static bool io_queue_is_empty(mp_obj_t io_queue) {
+    if (mp_obj_is_exact_type(io_queue, &io_queue_type)) {
+        return ((mp_obj_io_queue_t *)MP_OBJ_TO_PTR(io_queue))->n_waiting == 0;
+    }
+    return !mp_obj_is_true(mp_load_attr(io_queue, MP_QSTR_map));
+}
+
+static void io_queue_wait(mp_obj_t io_queue, mp_int_t dt) {
+    if (mp_obj_is_exact_type(io_queue, &io_queue_type)) {
+        io_queue_wait_io_event_helper(MP_OBJ_TO_PTR(io_queue), dt);
+    } else {
+        mp_obj_t dest[3];
+        mp_load_method(io_queue, MP_QSTR_wait_io_event, dest);
+        dest[2] = MP_OBJ_NEW_SMALL_INT(dt);
+        mp_call_method_n_kw(1, 0, dest);
+    }
+}
+
+// A task's coroutine finished, with er being the StopIteration or exception
+// that ended it and exc the exception (if any) that was thrown into it.
+static void run_loop_task_finished(mp_obj_task_t *t, mp_obj_t er, mp_obj_t exc, mp_obj_t task_queue) {
+    mp_obj_t cancelled_error = asyncio_context_get(MP_QSTR_CancelledError);
+    if (mp_obj_is_true(t->state)) {
+        // Task was running but is now finished.
+        bool waiting = false;
+        if (t->state == TASK_STATE_RUNNING_NOT_WAITED_ON) {
+            // "None" indicates that the task is complete and not await'ed on (yet).
+            t->state = TASK_STATE_DONE_NOT_WAITED_ON;
+        } else if (mp_obj_is_callable(t->state)) {
+            // The task has a callback registered to be called on completion.
+            mp_call_function_2(t->state, MP_OBJ_FROM_PTR(t), er);
+            t->state = TASK_STATE_DONE_WAS_WAITED_ON;
+            waiting = true;
+        } else {
+            // Schedule any other tasks waiting on the completion of this task.
+            mp_obj_task_queue_t *waiters = MP_OBJ_TO_PTR(t->state);
+            while (waiters->heap != NULL) {
+                mp_obj_t args[2] = { task_queue, task_queue_pop(t->state) };
+                task_queue_push(2, args);
+                waiting = true;
+            }
+            // "False" indicates that the task is complete and has been await'ed on.
+            t->state = TASK_STATE_DONE_WAS_WAITED_ON;
+        }
+        const mp_obj_type_t *er_type = mp_obj_get_type(er);
+        if (!waiting
+            && !mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(er_type), MP_OBJ_FROM_PTR(&mp_type_StopIteration))
+            && !mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(er_type), cancelled_error)) {
+            // An exception ended this detached task, so queue it for later
+            // execution to handle the uncaught exception if no other task retrieves
+            // the exception in the meantime (this is handled by Task.throw).
+            mp_obj_t args[2] = { task_queue, MP_OBJ_FROM_PTR(t) };
+            task_queue_push(2, args);
+        }
+        // Save return value of coro to pass up to caller.
+        t->data = er;
+    } else if (t->state == TASK_STATE_DONE_NOT_WAITED_ON) {
+        // Task is already finished and nothing await'ed on the task,
+        // so call the exception handler.
+        t->data = exc;
+        mp_obj_t exc_context = asyncio_context_get(MP_QSTR__exc_context);
+        mp_obj_dict_store(exc_context, MP_OBJ_NEW_QSTR(MP_QSTR_exception), exc);
+        mp_obj_dict_store(exc_context, MP_OBJ_NEW_QSTR(MP_QSTR_future), MP_OBJ_FROM_PTR(t));
+        mp_obj_t dest[3];
+        mp_load_method(asyncio_context_get(MP_QSTR_Loop), MP_QSTR_call_exception_handler, dest);
+        dest[2] = exc_context;
+        mp_call_method_n_kw(1, 0, dest);
+    }
+}
+
+// Native version of asyncio.core.run_until_complete: run tasks from _task_queue
+// until main_task finishes (returning its result or raising its exception), or
+// until there is nothing left to run.  The asyncio context must have been set
+// by creating a Task with the core module's globals.
+static mp_obj_t asyncio_run_until_complete(size_t n_args, const mp_obj_t *args) {
+    mp_obj_t main_task = n_args > 0 ? args[0] : mp_const_none;
+    if (mp_asyncio_context == MP_OBJ_NULL) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("no running event loop"));
+    }
+    mp_obj_t cur_task_key = MP_OBJ_NEW_QSTR(MP_QSTR_cur_task);
+    mp_obj_t task_queue_in = asyncio_context_get(MP_QSTR__task_queue);
+    mp_obj_task_queue_t *task_queue = MP_OBJ_TO_PTR(task_queue_in);
+    mp_obj_t io_queue = asyncio_context_get(MP_QSTR__io_queue);
+    mp_obj_t cancelled_error = asyncio_context_get(MP_QSTR_CancelledError);
+
+    for (;;) {
+        // Wait until the head of _task_queue is ready to run, polling for IO
+        // once per step (without allocating) so streams are serviced fairly.
+        mp_int_t dt;
+        do {
+            dt = -1;
+            mp_obj_task_t *head = task_queue->heap;
+            if (head != NULL) {
+                // A task waiting on _task_queue; "ph_key" is time to schedule task at.
+                dt = MAX(0, ticks_diff(head->ph_key, ticks()));
+            } else if (io_queue_is_empty(io_queue)) {
+                // No tasks can be woken so finished running.
+                mp_obj_dict_store(mp_asyncio_context, cur_task_key, mp_const_none);
+                return mp_const_none;
+            }
+            io_queue_wait(io_queue, dt);
+        } while (dt != 0 || task_queue->heap == NULL);
+
+        // Get next task to run and continue it.
+        mp_obj_task_t *t = MP_OBJ_TO_PTR(task_queue_pop(task_queue_in));
+        mp_obj_dict_store(mp_asyncio_context, cur_task_key, MP_OBJ_FROM_PTR(t));
+        mp_obj_t exc = t->data;
+        mp_obj_t ret;
+        mp_vm_return_kind_t kind;
+        if (!mp_obj_is_true(exc)) {
+            kind = mp_resume(t->coro, mp_const_none, MP_OBJ_NULL, &ret);
+        } else {
+            // If the task is finished and on the run queue and gets here, then it
+            // had an exception and was not await'ed on.  Throwing into it now will
+            // end it and the code below will run the call_exception_handler function.
+            t->data = mp_const_none;
+            kind = mp_resume(t->coro, MP_OBJ_NULL, exc, &ret);
+        }
+        if (kind == MP_VM_RETURN_YIELD) {
+            // The coroutine is responsible for rescheduling itself.
+            continue;
+        }
+
+        mp_obj_t er;
+        if (kind == MP_VM_RETURN_NORMAL) {
+            er = mp_obj_new_exception_arg1(&mp_type_StopIteration, ret);
+        } else {
+            er = ret;
+            const mp_obj_type_t *er_type = mp_obj_get_type(er);
+            if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(er_type), MP_OBJ_FROM_PTR(&mp_type_Exception))
+                && !mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(er_type), cancelled_error)) {
+                // Eg KeyboardInterrupt or SystemExit, which stop the loop.
+                nlr_raise(er);
+            }
+        }
+
+        // This task is done, check if it's the main task and then loop should stop.
+        if (MP_OBJ_FROM_PTR(t) == main_task) {
+            mp_obj_dict_store(mp_asyncio_context, cur_task_key, mp_const_none);
+            if (kind == MP_VM_RETURN_NORMAL) {
+                return ret;
+            }
+            nlr_raise(er);
+        }
+        run_loop_task_finished(t, er, exc, task_queue_in);
+    }
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(asyncio_run_until_complete_obj, 0, 1, asyncio_run_until_complete);
+
+#endif // MICROPY_PY_ASYNCIO_NATIVE_LOOP
+
 /******************************************************************************/
 // C-level asyncio module
 
@@ -360,6 +876,10 @@ static const mp_rom_map_elem_t mp_module_asyncio_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR__asyncio) },
     { MP_ROM_QSTR(MP_QSTR_TaskQueue), MP_ROM_PTR(&task_queue_type) },
     { MP_ROM_QSTR(MP_QSTR_Task), MP_ROM_PTR(&task_type) },
+    #if MICROPY_PY_ASYNCIO_NATIVE_LOOP
+    { MP_ROM_QSTR(MP_QSTR_IOQueue), MP_ROM_PTR(&io_queue_type) },
+    { MP_ROM_QSTR(MP_QSTR_run_until_complete), MP_ROM_PTR(&asyncio_run_until_complete_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(mp_module_asyncio_globals, mp_module_asyncio_globals_table);
 
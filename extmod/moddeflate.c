@@ -58,6 +58,10 @@ typedef enum {
 // to the smallest window size (faster compression, less RAM usage, etc).
 const int DEFLATEIO_DEFAULT_WBITS = 8;
 
+// Compressed output is collected here and written to the underlying stream in
+// chunks, rather than making a stream write call for every output byte.
+#define DEFLATEIO_OUT_BUF_SIZE (64)
+
 typedef struct {
     void *window;
     uzlib_uncomp_t decomp;
@@ -67,9 +71,13 @@ typedef struct {
 #if MICROPY_PY_DEFLATE_COMPRESS
 typedef struct {
     void *window;
+    uint16_t *hash_head;
+    uint16_t *hash_prev;
     size_t input_len;
     uint32_t input_checksum;
     uzlib_lz77_state_t lz77;
+    size_t out_len;
+    uint8_t out_buf[DEFLATEIO_OUT_BUF_SIZE];
 } mp_obj_deflateio_write_t;
 #endif
 
@@ -78,6 +86,7 @@ typedef struct {
     mp_obj_t stream;
     uint8_t format : 2;
     uint8_t window_bits : 4;
+    uint8_t level : 4;
     bool close : 1;
     mp_obj_deflateio_read_t *read;
     #if MICROPY_PY_DEFLATE_COMPRESS
@@ -151,16 +160,27 @@ static bool deflateio_init_read(mp_obj_deflateio_t *self) {
 }
 
 #if MICROPY_PY_DEFLATE_COMPRESS
-static void deflateio_out_byte(void *data, uint8_t b) {
-    mp_obj_deflateio_t *self = data;
+static void deflateio_flush_out(mp_obj_deflateio_t *self) {
+    if (self->write->out_len == 0) {
+        return;
+    }
     const mp_stream_p_t *stream = mp_get_stream(self->stream);
     int err;
-    mp_uint_t ret = stream->write(self->stream, &b, 1, &err);
+    mp_uint_t ret = stream->write(self->stream, self->write->out_buf, self->write->out_len, &err);
+    self->write->out_len = 0;
     if (ret == MP_STREAM_ERROR) {
         mp_raise_OSError(err);
     }
 }
 
+static void deflateio_out_byte(void *data, uint8_t b) {
+    mp_obj_deflateio_t *self = data;
+    self->write->out_buf[self->write->out_len++] = b;
+    if (self->write->out_len == DEFLATEIO_OUT_BUF_SIZE) {
+        deflateio_flush_out(self);
+    }
+}
+
 static bool deflateio_init_write(mp_obj_deflateio_t *self) {
     if (self->write) {
         return true;
@@ -179,13 +199,29 @@ static bool deflateio_init_write(mp_obj_deflateio_t *self) {
     size_t window_len = 1 << wbits;
     uint8_t *window = m_new(uint8_t, window_len);
 
+    // Level 0 uses a brute force search of the window and needs no hash chains.
+    unsigned int hash_bits = 0;
+    uint16_t *hash_head = NULL;
+    uint16_t *hash_prev = NULL;
+    if (self->level != 0) {
+        hash_bits = uzlib_lz77_hash_bits(self->level, window_len);
+        hash_head = m_new(uint16_t, 1 << hash_bits);
+        hash_prev = m_new(uint16_t, window_len);
+    }
+
     self->write = m_new_obj(mp_obj_deflateio_write_t);
     self->write->window = window;
+    self->write->hash_head = hash_head;
+    self->write->hash_prev = hash_prev;
     self->write->input_len = 0;
+    self->write->out_len = 0;
 
     uzlib_lz77_init(&self->write->lz77, self->write->window, window_len);
-    self->write->lz77.dest_write_data = self;
-    self->write->lz77.dest_write_cb = deflateio_out_byte;
+    if (self->level != 0) {
+        uzlib_lz77_init_level(&self->write->lz77, self->level, hash_head, hash_bits, hash_prev);
+    }
+    self->write->lz77.outbuf.dest_write_data = self;
+    self->write->lz77.outbuf.dest_write_cb = deflateio_out_byte;
 
     // Write header if needed.
     mp_uint_t ret = 0;
@@ -219,11 +255,12 @@ static bool deflateio_init_write(mp_obj_deflateio_t *self) {
 #endif
 
 static mp_obj_t deflateio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args_in) {
-    // args: stream, format=NONE, wbits=0, close=False
-    mp_arg_check_num(n_args, n_kw, 1, 4, false);
+    // args: stream, format=NONE, wbits=0, close=False, level=0
+    mp_arg_check_num(n_args, n_kw, 1, 5, false);
 
     mp_int_t format = n_args > 1 ? mp_obj_get_int(args_in[1]) : DEFLATEIO_FORMAT_AUTO;
     mp_int_t wbits = n_args > 2 ? mp_obj_get_int(args_in[2]) : 0;
+    mp_int_t level = n_args > 4 ? mp_obj_get_int(args_in[4]) : 0;
 
     if (format < DEFLATEIO_FORMAT_MIN || format > DEFLATEIO_FORMAT_MAX) {
         mp_raise_ValueError(MP_ERROR_TEXT("format"));
@@ -231,11 +268,15 @@ static mp_obj_t deflateio_make_new(const mp_obj_type_t *type, size_t n_args, siz
     if (wbits != 0 && (wbits < 5 || wbits > 15)) {
         mp_raise_ValueError(MP_ERROR_TEXT("wbits"));
     }
+    if (level < 0 || level > UZLIB_LZ77_LEVEL_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("level"));
+    }
 
     mp_obj_deflateio_t *self = mp_obj_malloc(mp_obj_deflateio_t, type);
     self->stream = args_in[0];
     self->format = format;
     self->window_bits = wbits;
+    self->level = level;
     self->read = NULL;
     #if MICROPY_PY_DEFLATE_COMPRESS
     self->write = NULL;
@@ -288,6 +329,7 @@ static mp_uint_t deflateio_write(mp_obj_t self_in, const void *buf, mp_uint_t si
     }
 
     uzlib_lz77_compress(&self->write->lz77, buf, size);
+    deflateio_flush_out(self);
     return size;
 }
 
@@ -316,6 +358,7 @@ static mp_uint_t deflateio_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t
             #if MICROPY_PY_DEFLATE_COMPRESS
             if (self->write) {
                 uzlib_finish_block(&self->write->lz77);
+                deflateio_flush_out(self);
 
                 const mp_stream_p_t *stream = mp_get_stream(self->stream);
 
@@ -45,8 +45,19 @@
 
 #define FLAG_DEBUG 0x1000
 
+// Maximum number of literal bytes recorded from the start of a pattern.
+#define RE_PREFIX_MAX (8)
+
+#define RE_CACHE (MICROPY_PY_RE_CACHE_SIZE && !MICROPY_ENABLE_DYNRUNTIME)
+
 typedef struct _mp_obj_re_t {
     mp_obj_base_t base;
+    #if RE_CACHE
+    mp_obj_t pattern;
+    #endif
+    // Literal bytes that every match must start with.
+    uint8_t prefix_len;
+    char prefix[RE_PREFIX_MAX];
     ByteProg re;
 } mp_obj_re_t;
 
@@ -194,6 +205,36 @@ static void re_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t
     mp_printf(print, "<re %p>", self);
 }
 
+// Unanchored search of subj.  This gives the same result as running the
+// program's own search loop, but when the pattern starts with literal bytes,
+// start positions that can't match are skipped with memchr and only the
+// candidates are run through the (anchored) program.
+static int re_exec_search(mp_obj_re_t *self, Subject *subj, const char **caps, int caps_num) {
+    size_t prefix_len = self->prefix_len;
+    if (prefix_len == 0) {
+        return re1_5_recursiveloopprog(&self->re, subj, caps, caps_num, false);
+    }
+    Subject candidate = *subj;
+    const char *p = subj->begin;
+    for (;;) {
+        size_t remain = subj->end - p;
+        if (remain < prefix_len) {
+            return 0;
+        }
+        p = memchr(p, self->prefix[0], remain - prefix_len + 1);
+        if (p == NULL) {
+            return 0;
+        }
+        if (memcmp(p + 1, self->prefix + 1, prefix_len - 1) == 0) {
+            candidate.begin = p;
+            if (re1_5_recursiveloopprog(&self->re, &candidate, caps, caps_num, true)) {
+                return 1;
+            }
+        }
+        ++p;
+    }
+}
+
 // Note: this function can't be named re_exec because it may clash with system headers, eg on FreeBSD
 static mp_obj_t re_exec_helper(bool is_anchored, uint n_args, const mp_obj_t *args) {
     (void)n_args;
@@ -242,7 +283,12 @@ static mp_obj_t re_exec_helper(bool is_anchored, uint n_args, const mp_obj_t *ar
     mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, caps, char *, caps_num);
     // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
     memset((char *)match->caps, 0, caps_num * sizeof(char *));
-    int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, is_anchored);
+    int res;
+    if (is_anchored) {
+        res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, true);
+    } else {
+        res = re_exec_search(self, &subj, match->caps, caps_num);
+    }
     if (res == 0) {
         m_del_var(mp_obj_match_t, caps, char *, caps_num, match);
         return mp_const_none;
@@ -283,7 +329,7 @@ static mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     while (true) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char **)caps, 0, caps_num * sizeof(char *));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, caps, caps_num, false);
+        int res = re_exec_search(self, &subj, caps, caps_num);
 
         // if we didn't have a match, or had an empty match, it's time to stop
         if (!res || caps[0] == caps[1]) {
@@ -343,7 +389,7 @@ static mp_obj_t re_sub_helper(size_t n_args, const mp_obj_t *args) {
     for (;;) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char *)match->caps, 0, caps_num * sizeof(char *));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, false);
+        int res = re_exec_search(self, &subj, match->caps, caps_num);
 
         // If we didn't have a match, or had an empty match, it's time to stop
         if (!res || match->caps[0] == match->caps[1]) {
@@ -453,30 +499,97 @@ static MP_DEFINE_CONST_OBJ_TYPE(
     );
 #endif
 
+#if RE_CACHE
+// The cache holds the most recently used compiled patterns, most recent first.
+static mp_obj_t re_cache_lookup(mp_obj_t pattern) {
+    const mp_obj_type_t *type = mp_obj_get_type(pattern);
+    size_t len;
+    const char *str = mp_obj_str_get_data(pattern, &len);
+    mp_obj_t *cache = MP_STATE_VM(re_cache);
+    for (size_t i = 0; i < MICROPY_PY_RE_CACHE_SIZE && cache[i] != MP_OBJ_NULL; ++i) {
+        mp_obj_re_t *o = MP_OBJ_TO_PTR(cache[i]);
+        if (o->pattern != pattern) {
+            if (mp_obj_get_type(o->pattern) != type) {
+                continue;
+            }
+            size_t o_len;
+            const char *o_str = mp_obj_str_get_data(o->pattern, &o_len);
+            if (o_len != len || memcmp(o_str, str, len) != 0) {
+                continue;
+            }
+        }
+        memmove(&cache[1], &cache[0], i * sizeof(mp_obj_t));
+        cache[0] = MP_OBJ_FROM_PTR(o);
+        return cache[0];
+    }
+    return MP_OBJ_NULL;
+}
+
+static void re_cache_insert(mp_obj_t re) {
+    // Evicts the least recently used entry when full.
+    mp_obj_t *cache = MP_STATE_VM(re_cache);
+    memmove(&cache[1], &cache[0], (MICROPY_PY_RE_CACHE_SIZE - 1) * sizeof(mp_obj_t));
+    cache[0] = re;
+}
+
+MP_REGISTER_ROOT_POINTER(mp_obj_t re_cache[MICROPY_PY_RE_CACHE_SIZE]);
+#endif
+
+// Record the literal bytes at the start of the compiled program.  Only Save
+// instructions may be skipped over: anything else (a split, class, assertion,
+// etc) means the following bytes are not required at every match start.
+static void re_find_prefix(mp_obj_re_t *o) {
+    const char *pc = o->re.insts + NON_ANCHORED_PREFIX;
+    const char *end = o->re.insts + o->re.bytelen;
+    size_t n = 0;
+    while (pc < end && n < RE_PREFIX_MAX) {
+        if (*pc == Char) {
+            o->prefix[n++] = pc[1];
+        } else if (*pc != Save) {
+            break;
+        }
+        pc += 2;
+    }
+    o->prefix_len = n;
+}
+
 static mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
-    (void)n_args;
+    int flags = 0;
+    if (n_args > 1) {
+        flags = mp_obj_get_int(args[1]);
+    }
+    (void)flags;
+    #if RE_CACHE
+    if (flags == 0) {
+        mp_obj_t cached = re_cache_lookup(args[0]);
+        if (cached != MP_OBJ_NULL) {
+            return cached;
+        }
+    }
+    #endif
     const char *re_str = mp_obj_str_get_str(args[0]);
     int size = re1_5_sizecode(re_str);
     if (size == -1) {
         goto error;
     }
     mp_obj_re_t *o = mp_obj_malloc_var(mp_obj_re_t, re.insts, char, size, (mp_obj_type_t *)&re_type);
-    #if MICROPY_PY_RE_DEBUG
-    int flags = 0;
-    if (n_args > 1) {
-        flags = mp_obj_get_int(args[1]);
-    }
-    #endif
     int error = re1_5_compilecode(&o->re, re_str);
     if (error != 0) {
     error:
         mp_raise_ValueError(MP_ERROR_TEXT("Error in regex"));
     }
+    re_find_prefix(o);
     #if MICROPY_PY_RE_DEBUG
     if (flags & FLAG_DEBUG) {
         re1_5_dumpcode(&o->re);
     }
     #endif
+    #if RE_CACHE
+    o->pattern = args[0];
+    if (flags == 0) {
+        re_cache_insert(MP_OBJ_FROM_PTR(o));
+    }
+    #endif
     return MP_OBJ_FROM_PTR(o);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_compile_obj, 1, 2, mod_re_compile);
@@ -61,6 +61,20 @@
 
 #endif
 
+#if MICROPY_PY_SELECT_EPOLL
+
+#if !MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+#error "MICROPY_PY_SELECT_EPOLL requires MICROPY_PY_SELECT_POSIX_OPTIMISATIONS"
+#endif
+
+#include <unistd.h>
+#include <sys/epoll.h>
+
+// Number of epoll events fetched per epoll_wait() call.
+#define POLL_SET_EPOLL_EVENTS (16)
+
+#endif
+
 // Flags for ipoll()
 #define FLAG_ONESHOT (1)
 
@@ -78,6 +92,16 @@ typedef struct _poll_obj_t {
     struct pollfd *pollfd;
     uint16_t nonfd_events;
     uint16_t nonfd_revents;
+    #if MICROPY_PY_SELECT_EPOLL
+    // If the file descriptor could be registered with poll_set_t::epfd then it
+    // is stored here and pollfd==NULL, with events/revents in the nonfd_* members.
+    // Otherwise this is -1.
+    int epoll_fd;
+    // Where this object is in poll_set_t::epoll_objs, and the id it was given
+    // there; see poll_set_epoll_key().
+    uint32_t epoll_slot;
+    uint32_t epoll_id;
+    #endif
     #else
     mp_uint_t events;
     mp_uint_t revents;
@@ -96,9 +120,34 @@ typedef struct _poll_set_t {
     unsigned short used; // actual number of used entries in pollfds
     struct pollfd *pollfds;
     #endif
+
+    #if MICROPY_PY_SELECT_EPOLL
+    // Objects with a file descriptor stay registered with the kernel between
+    // polls, so waiting on them costs nothing per registered object.  The epoll
+    // fd itself sits in pollfds (at epfd_slot) so it is waited on with the rest.
+    int epfd; // -1 until the first object with a file descriptor is added
+    unsigned short epfd_slot;
+    size_t n_epoll; // number of objects in map that are registered with epfd
+    // Objects registered with epfd, indexed by epoll_slot (NULL when free).
+    // Events carry a slot and id rather than a pointer: a registration can
+    // outlive unregister() when its fd was closed while a dup of it stays
+    // open, and the kernel may then still report it.
+    poll_obj_t **epoll_objs;
+    uint32_t epoll_objs_alloc;
+    uint32_t epoll_next_id;
+    // False for the one-off set made by select.select(), where setting up
+    // epoll would cost more system calls than the single poll() it saves.
+    bool use_epoll;
+    #endif
+
+    // The objects found ready by the last poll, so results can be returned
+    // without walking the whole map again.
+    poll_obj_t **ready;
+    size_t ready_alloc;
+    size_t ready_len;
 } poll_set_t;
 
-static void poll_set_init(poll_set_t *poll_set, size_t n) {
+static void poll_set_init(poll_set_t *poll_set, size_t n, bool persistent) {
     mp_map_init(&poll_set->map, n);
     #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
     poll_set->alloc = 0;
@@ -106,10 +155,39 @@ static void poll_set_init(poll_set_t *poll_set, size_t n) {
     poll_set->used = 0;
     poll_set->pollfds = NULL;
     #endif
+    #if MICROPY_PY_SELECT_EPOLL
+    poll_set->epfd = -1;
+    poll_set->n_epoll = 0;
+    poll_set->epoll_objs = NULL;
+    poll_set->epoll_objs_alloc = 0;
+    poll_set->epoll_next_id = 0;
+    poll_set->use_epoll = persistent;
+    #else
+    (void)persistent;
+    #endif
+    poll_set->ready = NULL;
+    poll_set->ready_alloc = 0;
+    poll_set->ready_len = 0;
 }
 
+#if MICROPY_PY_SELECT_EPOLL
+static void poll_set_close_epoll(poll_set_t *poll_set) {
+    if (poll_set->epfd >= 0) {
+        close(poll_set->epfd);
+        poll_set->epfd = -1;
+    }
+}
+#endif
+
 #if MICROPY_PY_SELECT_SELECT
 static void poll_set_deinit(poll_set_t *poll_set) {
+    #if MICROPY_PY_SELECT_EPOLL
+    poll_set_close_epoll(poll_set);
+    #endif
+    m_del(poll_obj_t *, poll_set->ready, poll_set->ready_alloc);
+    poll_set->ready = NULL;
+    poll_set->ready_alloc = 0;
+    poll_set->ready_len = 0;
     mp_map_deinit(&poll_set->map);
 }
 #endif
@@ -121,11 +199,48 @@ static mp_uint_t poll_obj_get_events(poll_obj_t *poll_obj) {
     return poll_obj->nonfd_events;
 }
 
-static void poll_obj_set_events(poll_obj_t *poll_obj, mp_uint_t events) {
+#if MICROPY_PY_SELECT_EPOLL
+// Return the fd that poll_obj is registered with epoll under, or -1 if its
+// registration is gone.  Closing the fd makes the kernel drop the registration,
+// and the fd number may then be reused by another registered object, so for
+// stream objects the fd is looked up again rather than trusting epoll_fd.
+static int poll_obj_get_epoll_fd(poll_obj_t *poll_obj) {
+    if (poll_obj->epoll_fd < 0 || poll_obj->ioctl == NULL) {
+        // Not registered, or the object is the fd number itself.
+        return poll_obj->epoll_fd;
+    }
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        int err;
+        mp_uint_t res = poll_obj->ioctl(poll_obj->obj, MP_STREAM_GET_FILENO, 0, &err);
+        nlr_pop();
+        if (res != MP_STREAM_ERROR && (int)res == poll_obj->epoll_fd) {
+            return poll_obj->epoll_fd;
+        }
+    }
+    // The stream is closed (its ioctl may raise to say so) or has another fd.
+    return -1;
+}
+
+static uint64_t poll_set_epoll_key(poll_obj_t *poll_obj) {
+    return (uint64_t)poll_obj->epoll_id << 32 | poll_obj->epoll_slot;
+}
+#endif
+
+static void poll_obj_set_events(poll_set_t *poll_set, poll_obj_t *poll_obj, mp_uint_t events) {
     if (poll_obj->pollfd != NULL) {
         poll_obj->pollfd->events = events;
     } else {
         poll_obj->nonfd_events = events;
+        #if MICROPY_PY_SELECT_EPOLL
+        int fd = poll_obj_get_epoll_fd(poll_obj);
+        if (fd >= 0) {
+            struct epoll_event ev = { .events = events, .data.u64 = poll_set_epoll_key(poll_obj) };
+            epoll_ctl(poll_set->epfd, EPOLL_CTL_MOD, fd, &ev);
+        }
+        #else
+        (void)poll_set;
+        #endif
     }
 }
 
@@ -176,6 +291,10 @@ static struct pollfd *poll_set_add_fd(poll_set_t *poll_set, int fd) {
                         // afterwards.
                         continue;
                     }
+                    if (poll_obj->pollfd == NULL) {
+                        // Not polled via pollfds.
+                        continue;
+                    }
 
                     poll_obj->pollfd = new_fds + (poll_obj->pollfd - poll_set->pollfds);
                 }
@@ -207,7 +326,12 @@ static struct pollfd *poll_set_add_fd(poll_set_t *poll_set, int fd) {
 }
 
 static inline bool poll_set_all_are_fds(poll_set_t *poll_set) {
+    #if MICROPY_PY_SELECT_EPOLL
+    // Objects registered with epoll are waited on through the epfd entry in pollfds.
+    return poll_set->map.used - poll_set->n_epoll == poll_set->used - (size_t)(poll_set->epfd >= 0);
+    #else
     return poll_set->map.used == poll_set->used;
+    #endif
 }
 
 #else
@@ -216,7 +340,8 @@ static inline mp_uint_t poll_obj_get_events(poll_obj_t *poll_obj) {
     return poll_obj->events;
 }
 
-static inline void poll_obj_set_events(poll_obj_t *poll_obj, mp_uint_t events) {
+static inline void poll_obj_set_events(poll_set_t *poll_set, poll_obj_t *poll_obj, mp_uint_t events) {
+    (void)poll_set;
     poll_obj->events = events;
 }
 
@@ -230,6 +355,50 @@ static inline void poll_obj_set_revents(poll_obj_t *poll_obj, mp_uint_t revents)
 
 #endif
 
+#if MICROPY_PY_SELECT_EPOLL
+// Register fd with epoll on behalf of poll_obj.  Returns false if that's not
+// possible, in which case the fd should be added to pollfds instead.
+static bool poll_set_epoll_add(poll_set_t *poll_set, poll_obj_t *poll_obj, int fd, mp_uint_t events) {
+    if (!poll_set->use_epoll) {
+        return false;
+    }
+    if (poll_set->epfd < 0) {
+        int epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epfd < 0) {
+            return false;
+        }
+        // Offsets into pollfds survive reallocation, pointers don't.
+        struct pollfd *slot = poll_set_add_fd(poll_set, epfd);
+        slot->events = POLLIN;
+        poll_set->epfd_slot = slot - poll_set->pollfds;
+        poll_set->epfd = epfd;
+    }
+    // Find a free slot, growing the table if they're all in use.
+    uint32_t slot = 0;
+    if (poll_set->n_epoll == poll_set->epoll_objs_alloc) {
+        slot = poll_set->epoll_objs_alloc;
+        uint32_t new_alloc = slot ? slot * 2 : 4;
+        poll_set->epoll_objs = m_renew(poll_obj_t *, poll_set->epoll_objs, slot, new_alloc);
+        memset(poll_set->epoll_objs + slot, 0, (new_alloc - slot) * sizeof(poll_obj_t *));
+        poll_set->epoll_objs_alloc = new_alloc;
+    } else {
+        while (poll_set->epoll_objs[slot] != NULL) {
+            ++slot;
+        }
+    }
+    poll_obj->epoll_slot = slot;
+    poll_obj->epoll_id = ++poll_set->epoll_next_id;
+    struct epoll_event ev = { .events = events, .data.u64 = poll_set_epoll_key(poll_obj) };
+    if (epoll_ctl(poll_set->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        // Eg a regular file, or an fd already registered via another object.
+        return false;
+    }
+    poll_set->epoll_objs[slot] = poll_obj;
+    poll_set->n_epoll += 1;
+    return true;
+}
+#endif
+
 static void poll_set_add_obj(poll_set_t *poll_set, const mp_obj_t *obj, mp_uint_t obj_len, mp_uint_t events, bool or_events) {
     for (mp_uint_t i = 0; i < obj_len; i++) {
         mp_map_elem_t *elem = mp_map_lookup(&poll_set->map, mp_obj_id(obj[i]), MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
@@ -261,6 +430,14 @@ static void poll_set_add_obj(poll_set_t *poll_set, const mp_obj_t *obj, mp_uint_
                     fd = res;
                 }
             }
+            #if MICROPY_PY_SELECT_EPOLL
+            poll_obj->epoll_fd = -1;
+            if (fd >= 0 && poll_set_epoll_add(poll_set, poll_obj, fd, events)) {
+                // Object has a file descriptor that's now registered with epoll.
+                poll_obj->epoll_fd = fd;
+                poll_obj->pollfd = NULL;
+            } else
+            #endif
             if (fd >= 0) {
                 // Object has a file descriptor so add it to pollfds.
                 poll_obj->pollfd = poll_set_add_fd(poll_set, fd);
@@ -273,7 +450,7 @@ static void poll_set_add_obj(poll_set_t *poll_set, const mp_obj_t *obj, mp_uint_
             poll_obj->ioctl = stream_p->ioctl;
             #endif
 
-            poll_obj_set_events(poll_obj, events);
+            poll_obj_set_events(poll_set, poll_obj, events);
             poll_obj_set_revents(poll_obj, 0);
             elem->value = MP_OBJ_FROM_PTR(poll_obj);
         } else {
@@ -286,11 +463,45 @@ static void poll_set_add_obj(poll_set_t *poll_set, const mp_obj_t *obj, mp_uint_
             #else
             (void)or_events;
             #endif
-            poll_obj_set_events(poll_obj, events);
+            poll_obj_set_events(poll_set, poll_obj, events);
         }
     }
 }
 
+// Forget the results of the previous poll, and make sure the ready list can
+// hold every object in the set.
+static void poll_set_clear_ready(poll_set_t *poll_set) {
+    for (size_t i = 0; i < poll_set->ready_len; ++i) {
+        poll_obj_set_revents(poll_set->ready[i], 0);
+    }
+    poll_set->ready_len = 0;
+    if (poll_set->ready_alloc < poll_set->map.used) {
+        poll_set->ready = m_renew(poll_obj_t *, poll_set->ready, poll_set->ready_alloc, poll_set->map.used);
+        poll_set->ready_alloc = poll_set->map.used;
+    }
+}
+
+static void poll_set_add_ready(poll_set_t *poll_set, poll_obj_t *poll_obj, mp_uint_t revents, size_t *rwx_num) {
+    assert(poll_set->ready_len < poll_set->ready_alloc);
+    poll_obj_set_revents(poll_obj, revents);
+    poll_set->ready[poll_set->ready_len++] = poll_obj;
+    #if MICROPY_PY_SELECT_SELECT
+    if (rwx_num != NULL) {
+        if (revents & MP_STREAM_POLL_RD) {
+            rwx_num[0] += 1;
+        }
+        if (revents & MP_STREAM_POLL_WR) {
+            rwx_num[1] += 1;
+        }
+        if ((revents & ~(MP_STREAM_POLL_RD | MP_STREAM_POLL_WR)) != 0) {
+            rwx_num[2] += 1;
+        }
+    }
+    #else
+    (void)rwx_num;
+    #endif
+}
+
 // For each object in the poll set, poll it once.
 static mp_uint_t poll_set_poll_once(poll_set_t *poll_set, size_t *rwx_num) {
     mp_uint_t n_ready = 0;
@@ -308,9 +519,15 @@ static mp_uint_t poll_set_poll_once(poll_set_t *poll_set, size_t *rwx_num) {
         }
         #endif
 
+        #if MICROPY_PY_SELECT_EPOLL
+        if (poll_obj->epoll_fd >= 0) {
+            // Object is registered with epoll so is polled by epoll_wait().
+            continue;
+        }
+        #endif
+
         int errcode;
         mp_int_t ret = poll_obj->ioctl(poll_obj->obj, MP_STREAM_POLL, poll_obj_get_events(poll_obj), &errcode);
-        poll_obj_set_revents(poll_obj, ret);
 
         if (ret == -1) {
             // error doing ioctl
@@ -319,31 +536,89 @@ static mp_uint_t poll_set_poll_once(poll_set_t *poll_set, size_t *rwx_num) {
 
         if (ret != 0) {
             // object is ready
+            poll_set_add_ready(poll_set, poll_obj, ret, rwx_num);
             n_ready += 1;
-            #if MICROPY_PY_SELECT_SELECT
-            if (rwx_num != NULL) {
-                if (ret & MP_STREAM_POLL_RD) {
-                    rwx_num[0] += 1;
-                }
-                if (ret & MP_STREAM_POLL_WR) {
-                    rwx_num[1] += 1;
-                }
-                if ((ret & ~(MP_STREAM_POLL_RD | MP_STREAM_POLL_WR)) != 0) {
-                    rwx_num[2] += 1;
-                }
-            }
-            #else
-            (void)rwx_num;
-            #endif
         }
     }
     return n_ready;
 }
 
+#if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
+// Add the objects whose file descriptors were reported ready by poll().
+static void poll_set_add_ready_fds(poll_set_t *poll_set) {
+    #if MICROPY_PY_SELECT_EPOLL
+    if (poll_set->used == (poll_set->epfd >= 0)) {
+        // Every fd is registered with epoll, so they're already on the ready list.
+        return;
+    }
+    #endif
+    for (mp_uint_t i = 0; i < poll_set->map.alloc; ++i) {
+        if (!mp_map_slot_is_filled(&poll_set->map, i)) {
+            continue;
+        }
+        poll_obj_t *poll_obj = MP_OBJ_TO_PTR(poll_set->map.table[i].value);
+        if (poll_obj->pollfd != NULL && poll_obj->pollfd->revents != 0) {
+            poll_set_add_ready(poll_set, poll_obj, poll_obj->pollfd->revents, NULL);
+        }
+    }
+}
+#endif
+
+#if MICROPY_PY_SELECT_EPOLL
+// Wait up to timeout_ms (forever if negative) for epoll-registered objects and
+// add the ready ones to the ready list.  Only ready objects are visited.
+static mp_uint_t poll_set_epoll_wait(poll_set_t *poll_set, int timeout_ms, size_t *rwx_num) {
+    struct epoll_event events[POLL_SET_EPOLL_EVENTS];
+    mp_uint_t n_ready = 0;
+    for (;;) {
+        MP_THREAD_GIL_EXIT();
+        int n = epoll_wait(poll_set->epfd, events, POLL_SET_EPOLL_EVENTS, timeout_ms);
+        MP_THREAD_GIL_ENTER();
+
+        if (n == -1) {
+            // As with poll(), EINTR is not an error and the caller retries.
+            int err = errno;
+            if (err != EINTR) {
+                mp_raise_OSError(err);
+            }
+            return n_ready;
+        }
+
+        mp_uint_t n_new = 0;
+        for (int i = 0; i < n; ++i) {
+            uint32_t slot = (uint32_t)events[i].data.u64;
+            uint32_t id = events[i].data.u64 >> 32;
+            poll_obj_t *poll_obj = slot < poll_set->epoll_objs_alloc ? poll_set->epoll_objs[slot] : NULL;
+            if (poll_obj == NULL || poll_obj->epoll_id != id) {
+                // A registration left behind by an unregistered object.
+                continue;
+            }
+            mp_uint_t revents = events[i].events & (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP);
+            // Objects can be reported again by a later call in this loop.
+            if (revents != 0 && poll_obj_get_revents(poll_obj) == 0) {
+                poll_set_add_ready(poll_set, poll_obj, revents, rwx_num);
+                n_new += 1;
+            }
+        }
+        n_ready += n_new;
+
+        if (n < POLL_SET_EPOLL_EVENTS || n_new == 0) {
+            return n_ready;
+        }
+        // The event buffer was filled, so collect any remaining ready objects without blocking.
+        timeout_ms = 0;
+    }
+}
+#endif
+
+// Poll until at least one object is ready or the timeout expires.  The ready
+// objects are left in poll_set->ready, and the number of them is returned.
 static mp_uint_t poll_set_poll_until_ready_or_timeout(poll_set_t *poll_set, size_t *rwx_num, mp_uint_t timeout) {
     mp_uint_t start_ticks = mp_hal_ticks_ms();
     bool has_timeout = timeout != (mp_uint_t)-1;
 
+    poll_set_clear_ready(poll_set);
+
     #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
 
     for (;;) {
@@ -381,6 +656,13 @@ static mp_uint_t poll_set_poll_until_ready_or_timeout(poll_set_t *poll_set, size
             n_ready = 0;
         }
 
+        #if MICROPY_PY_SELECT_EPOLL
+        if (n_ready > 0 && poll_set->epfd >= 0 && poll_set->pollfds[poll_set->epfd_slot].revents != 0) {
+            // The epoll fd isn't itself in the set; count the objects it has ready instead.
+            n_ready = n_ready - 1 + poll_set_epoll_wait(poll_set, 0, rwx_num);
+        }
+        #endif
+
         // Explicitly poll any objects that do not have a file descriptor.
         if (!poll_set_all_are_fds(poll_set)) {
             n_ready += poll_set_poll_once(poll_set, rwx_num);
@@ -388,7 +670,8 @@ static mp_uint_t poll_set_poll_until_ready_or_timeout(poll_set_t *poll_set, size
 
         // Return if an object is ready, or if the timeout expired.
         if (n_ready > 0 || (has_timeout && mp_hal_ticks_ms() - start_ticks >= timeout)) {
-            return n_ready;
+            poll_set_add_ready_fds(poll_set);
+            return poll_set->ready_len;
         }
 
         // This would be mp_event_wait_ms() but the call to poll() above already includes a delay.
@@ -446,7 +729,7 @@ static mp_obj_t select_select(size_t n_args, const mp_obj_t *args) {
 
     // merge separate lists and get the ioctl function for each object
     poll_set_t poll_set;
-    poll_set_init(&poll_set, rwx_len[0] + rwx_len[1] + rwx_len[2]);
+    poll_set_init(&poll_set, rwx_len[0] + rwx_len[1] + rwx_len[2], false);
     poll_set_add_obj(&poll_set, r_array, rwx_len[0], MP_STREAM_POLL_RD, true);
     poll_set_add_obj(&poll_set, w_array, rwx_len[1], MP_STREAM_POLL_WR, true);
     poll_set_add_obj(&poll_set, x_array, rwx_len[2], MP_STREAM_POLL_ERR | MP_STREAM_POLL_HUP, true);
@@ -488,8 +771,7 @@ MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_select_select_obj, 3, 4, select_select);
 typedef struct _mp_obj_poll_t {
     mp_obj_base_t base;
     poll_set_t poll_set;
-    short iter_cnt;
-    short iter_idx;
+    size_t iter_idx;
     int flags;
     // callee-owned tuple
     mp_obj_t ret_tuple;
@@ -514,18 +796,35 @@ static mp_obj_t poll_unregister(mp_obj_t self_in, mp_obj_t obj_in) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
     mp_map_elem_t *elem = mp_map_lookup(&self->poll_set.map, mp_obj_id(obj_in), MP_MAP_LOOKUP_REMOVE_IF_FOUND);
 
-    #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
     if (elem != NULL) {
         poll_obj_t *poll_obj = (poll_obj_t *)MP_OBJ_TO_PTR(elem->value);
+        #if MICROPY_PY_SELECT_POSIX_OPTIMISATIONS
         if (poll_obj->pollfd != NULL) {
             poll_obj->pollfd->fd = -1;
             --self->poll_set.used;
+            // The pollfd slot may be reused, so detach it from this object.
+            poll_obj->pollfd = NULL;
         }
         elem->value = MP_OBJ_NULL;
+        #endif
+        #if MICROPY_PY_SELECT_EPOLL
+        if (poll_obj->epoll_fd >= 0) {
+            int fd = poll_obj_get_epoll_fd(poll_obj);
+            if (fd >= 0) {
+                epoll_ctl(self->poll_set.epfd, EPOLL_CTL_DEL, fd, NULL);
+            }
+            // If the fd was closed but is still open through a dup, the kernel
+            // keeps the registration and it can't be removed by fd any more.
+            // Freeing the slot makes any events it reports be ignored.
+            self->poll_set.epoll_objs[poll_obj->epoll_slot] = NULL;
+            --self->poll_set.n_epoll;
+            poll_obj->epoll_fd = -1;
+        }
+        #endif
+        // The object may still be on the ready list, eg during ipoll(), and
+        // is skipped there if it has no events.
+        poll_obj_set_revents(poll_obj, 0);
     }
-    #else
-    (void)elem;
-    #endif
 
     // TODO raise KeyError if obj didn't exist in map
     return mp_const_none;
@@ -539,7 +838,7 @@ static mp_obj_t poll_modify(mp_obj_t self_in, mp_obj_t obj_in, mp_obj_t eventmas
     if (elem == NULL) {
         mp_raise_OSError(MP_ENOENT);
     }
-    poll_obj_set_events((poll_obj_t *)MP_OBJ_TO_PTR(elem->value), mp_obj_get_int(eventmask_in));
+    poll_obj_set_events(&self->poll_set, (poll_obj_t *)MP_OBJ_TO_PTR(elem->value), mp_obj_get_int(eventmask_in));
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_3(poll_modify_obj, poll_modify);
@@ -573,16 +872,10 @@ static mp_obj_t poll_poll(size_t n_args, const mp_obj_t *args) {
 
     // one or more objects are ready, or we had a timeout
     mp_obj_list_t *ret_list = MP_OBJ_TO_PTR(mp_obj_new_list(n_ready, NULL));
-    n_ready = 0;
-    for (mp_uint_t i = 0; i < self->poll_set.map.alloc; ++i) {
-        if (!mp_map_slot_is_filled(&self->poll_set.map, i)) {
-            continue;
-        }
-        poll_obj_t *poll_obj = MP_OBJ_TO_PTR(self->poll_set.map.table[i].value);
-        if (poll_obj_get_revents(poll_obj) != 0) {
-            mp_obj_t tuple[2] = {poll_obj->obj, MP_OBJ_NEW_SMALL_INT(poll_obj_get_revents(poll_obj))};
-            ret_list->items[n_ready++] = mp_obj_new_tuple(2, tuple);
-        }
+    for (mp_uint_t i = 0; i < n_ready; ++i) {
+        poll_obj_t *poll_obj = self->poll_set.ready[i];
+        mp_obj_t tuple[2] = {poll_obj->obj, MP_OBJ_NEW_SMALL_INT(poll_obj_get_revents(poll_obj))};
+        ret_list->items[i] = mp_obj_new_tuple(2, tuple);
     }
     return MP_OBJ_FROM_PTR(ret_list);
 }
@@ -595,8 +888,7 @@ static mp_obj_t poll_ipoll(size_t n_args, const mp_obj_t *args) {
         self->ret_tuple = mp_obj_new_tuple(2, NULL);
     }
 
-    int n_ready = poll_poll_internal(n_args, args);
-    self->iter_cnt = n_ready;
+    poll_poll_internal(n_args, args);
     self->iter_idx = 0;
 
     return args[0];
@@ -606,41 +898,44 @@ MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_ipoll_obj, 1, 3, poll_ipoll);
 static mp_obj_t poll_iternext(mp_obj_t self_in) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
 
-    if (self->iter_cnt == 0) {
-        return MP_OBJ_STOP_ITERATION;
-    }
-
-    self->iter_cnt--;
-
-    for (mp_uint_t i = self->iter_idx; i < self->poll_set.map.alloc; ++i) {
-        self->iter_idx++;
-        if (!mp_map_slot_is_filled(&self->poll_set.map, i)) {
+    while (self->iter_idx < self->poll_set.ready_len) {
+        poll_obj_t *poll_obj = self->poll_set.ready[self->iter_idx++];
+        mp_uint_t revents = poll_obj_get_revents(poll_obj);
+        if (revents == 0) {
+            // Unregistered since it was polled.
             continue;
         }
-        poll_obj_t *poll_obj = MP_OBJ_TO_PTR(self->poll_set.map.table[i].value);
-        if (poll_obj_get_revents(poll_obj) != 0) {
-            mp_obj_tuple_t *t = MP_OBJ_TO_PTR(self->ret_tuple);
-            t->items[0] = poll_obj->obj;
-            t->items[1] = MP_OBJ_NEW_SMALL_INT(poll_obj_get_revents(poll_obj));
-            if (self->flags & FLAG_ONESHOT) {
-                // Don't poll next time, until new event mask will be set explicitly
-                poll_obj_set_events(poll_obj, 0);
-            }
-            return MP_OBJ_FROM_PTR(t);
+        mp_obj_tuple_t *t = MP_OBJ_TO_PTR(self->ret_tuple);
+        t->items[0] = poll_obj->obj;
+        t->items[1] = MP_OBJ_NEW_SMALL_INT(revents);
+        if (self->flags & FLAG_ONESHOT) {
+            // Don't poll next time, until new event mask will be set explicitly
+            poll_obj_set_events(&self->poll_set, poll_obj, 0);
         }
+        return MP_OBJ_FROM_PTR(t);
     }
 
-    assert(!"inconsistent number of poll active entries");
-    self->iter_cnt = 0;
     return MP_OBJ_STOP_ITERATION;
 }
 
+#if MICROPY_PY_SELECT_EPOLL
+static mp_obj_t poll_del(mp_obj_t self_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    poll_set_close_epoll(&self->poll_set);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(poll_del_obj, poll_del);
+#endif
+
 static const mp_rom_map_elem_t poll_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_register), MP_ROM_PTR(&poll_register_obj) },
     { MP_ROM_QSTR(MP_QSTR_unregister), MP_ROM_PTR(&poll_unregister_obj) },
     { MP_ROM_QSTR(MP_QSTR_modify), MP_ROM_PTR(&poll_modify_obj) },
     { MP_ROM_QSTR(MP_QSTR_poll), MP_ROM_PTR(&poll_poll_obj) },
     { MP_ROM_QSTR(MP_QSTR_ipoll), MP_ROM_PTR(&poll_ipoll_obj) },
+    #if MICROPY_PY_SELECT_EPOLL
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&poll_del_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(poll_locals_dict, poll_locals_dict_table);
 
@@ -654,9 +949,14 @@ static MP_DEFINE_CONST_OBJ_TYPE(
 
 // poll()
 static mp_obj_t select_poll(void) {
+    #if MICROPY_PY_SELECT_EPOLL
+    // The finaliser closes the epoll file descriptor.
+    mp_obj_poll_t *poll = mp_obj_malloc_with_finaliser(mp_obj_poll_t, &mp_type_poll);
+    #else
     mp_obj_poll_t *poll = mp_obj_malloc(mp_obj_poll_t, &mp_type_poll);
-    poll_set_init(&poll->poll_set, 0);
-    poll->iter_cnt = 0;
+    #endif
+    poll_set_init(&poll->poll_set, 0, true);
+    poll->iter_idx = 0;
     poll->ret_tuple = MP_OBJ_NULL;
     return MP_OBJ_FROM_PTR(poll);
 }
@@ -48,12 +48,6 @@
 #include "shared/timeutils/timeutils.h"
 #include "supervisor/filesystem.h"
 
-#if FF_MAX_SS == FF_MIN_SS
-#define SECSIZE(fs) (FF_MIN_SS)
-#else
-#define SECSIZE(fs) ((fs)->ssize)
-#endif
-
 #define mp_obj_fat_vfs_t fs_user_mount_t
 
 // CIRCUITPY-CHANGE
@@ -62,11 +56,72 @@ static NORETURN void mp_raise_OSError_fresult(FRESULT res) {
     mp_raise_OSError(fresult_to_errno_table[res]);
 }
 
+// CIRCUITPY-CHANGE: stat cache
+#if MICROPY_FATFS_STAT_CACHE
+// 64-bit FNV-1a, which can be carried on from a directory to its entries.
+#define FAT_VFS_PATH_HASH_INIT (0xcbf29ce484222325ULL)
+
+static uint64_t fat_vfs_path_hash(uint64_t hash, const char *path) {
+    while (*path) {
+        hash = (hash ^ (uint8_t)*path++) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Zero is left for entries that were never filled in.
+static uint64_t fat_vfs_path_key(uint64_t hash) {
+    return hash | 1;
+}
+
+static void fat_vfs_stat_cache_store(fs_user_mount_t *vfs, uint64_t key, FRESULT res, const FILINFO *fno) {
+    fat_stat_cache_entry_t *entry = &vfs->stat_cache[vfs->stat_cache_next];
+    vfs->stat_cache_next = (vfs->stat_cache_next + 1) % MICROPY_FATFS_STAT_CACHE;
+    entry->path_hash = key;
+    entry->generation = vfs->stat_cache_generation;
+    entry->res = res;
+    if (res == FR_OK) {
+        entry->fsize = fno->fsize;
+        entry->fdate = fno->fdate;
+        entry->ftime = fno->ftime;
+        entry->fattrib = fno->fattrib;
+    }
+}
+#endif
+
+// f_stat, answered from the stat cache when possible. Only the size, date,
+// time and attributes of fno are filled in from the cache.
+static FRESULT fat_vfs_stat_cached(fs_user_mount_t *vfs, const char *path, FILINFO *fno) {
+    #if MICROPY_FATFS_STAT_CACHE
+    uint64_t key = fat_vfs_path_key(fat_vfs_path_hash(FAT_VFS_PATH_HASH_INIT, path));
+    for (size_t i = 0; i < MICROPY_FATFS_STAT_CACHE; i++) {
+        fat_stat_cache_entry_t *entry = &vfs->stat_cache[i];
+        if (entry->path_hash == key && entry->generation == vfs->stat_cache_generation) {
+            if (entry->res == FR_OK) {
+                fno->fsize = entry->fsize;
+                fno->fdate = entry->fdate;
+                fno->ftime = entry->ftime;
+                fno->fattrib = entry->fattrib;
+            }
+            return entry->res;
+        }
+    }
+    FRESULT res = f_stat(&vfs->fatfs, path, fno);
+    // Errors other than a missing file or directory may be transient.
+    if (res == FR_OK || res == FR_NO_FILE || res == FR_NO_PATH) {
+        fat_vfs_stat_cache_store(vfs, key, res, fno);
+    }
+    return res;
+    #else
+    return f_stat(&vfs->fatfs, path, fno);
+    #endif
+}
+
 static mp_import_stat_t fat_vfs_import_stat(void *vfs_in, const char *path) {
     fs_user_mount_t *vfs = vfs_in;
     FILINFO fno;
     assert(vfs != NULL);
-    FRESULT res = f_stat(&vfs->fatfs, path, &fno);
+    // CIRCUITPY-CHANGE: use the stat cache
+    FRESULT res = fat_vfs_stat_cached(vfs, path, &fno);
     if (res == FR_OK) {
         if ((fno.fattrib & AM_DIR) != 0) {
             return MP_IMPORT_STAT_DIR;
@@ -150,6 +205,12 @@ typedef struct _mp_vfs_fat_ilistdir_it_t {
     mp_fun_1_t finaliser;
     bool is_str;
     FF_DIR dir;
+    // CIRCUITPY-CHANGE: entries listed are added to the stat cache
+    #if MICROPY_FATFS_STAT_CACHE
+    fs_user_mount_t *vfs;
+    uint64_t path_hash;
+    uint32_t generation;
+    #endif
 } mp_vfs_fat_ilistdir_it_t;
 
 static mp_obj_t mp_vfs_fat_ilistdir_it_iternext(mp_obj_t self_in) {
@@ -166,6 +227,14 @@ static mp_obj_t mp_vfs_fat_ilistdir_it_iternext(mp_obj_t self_in) {
 
         // Note that FatFS already filters . and .., so we don't need to
 
+        // CIRCUITPY-CHANGE: a listing is usually followed by a stat of each
+        // entry, so remember what we've just read.
+        #if MICROPY_FATFS_STAT_CACHE
+        if (self->vfs->stat_cache_generation == self->generation) {
+            fat_vfs_stat_cache_store(self->vfs, fat_vfs_path_key(fat_vfs_path_hash(self->path_hash, fn)), FR_OK, &fno);
+        }
+        #endif
+
         // make 4-tuple with info about this entry
         mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(4, NULL));
         if (self->is_str) {
@@ -217,6 +286,16 @@ static mp_obj_t fat_vfs_ilistdir_func(size_t n_args, const mp_obj_t *args) {
     iter->iternext = mp_vfs_fat_ilistdir_it_iternext;
     iter->finaliser = mp_vfs_fat_ilistdir_it_del;
     iter->is_str = is_str_type;
+    #if MICROPY_FATFS_STAT_CACHE
+    // Hash the directory's path followed by a separator, ready for each name.
+    iter->vfs = self;
+    iter->generation = self->stat_cache_generation;
+    iter->path_hash = fat_vfs_path_hash(FAT_VFS_PATH_HASH_INIT, path);
+    size_t path_len = strlen(path);
+    if (path_len > 0 && path[path_len - 1] != '/') {
+        iter->path_hash = fat_vfs_path_hash(iter->path_hash, "/");
+    }
+    #endif
     FRESULT res = f_opendir(&self->fatfs, &iter->dir, path);
     if (res != FR_OK) {
         // CIRCUITPY-CHANGE
@@ -244,6 +323,8 @@ static mp_obj_t fat_vfs_remove_internal(mp_obj_t vfs_in, mp_obj_t path_in, mp_in
     // check if path is a file or directory
     if ((fno.fattrib & AM_DIR) == attr) {
         res = f_unlink(&self->fatfs, path);
+        // CIRCUITPY-CHANGE
+        fat_vfs_invalidate_stat_cache(self);
 
         if (res != FR_OK) {
             // CIRCUITPY-CHANGE
@@ -278,6 +359,8 @@ static mp_obj_t fat_vfs_rename(mp_obj_t vfs_in, mp_obj_t path_in, mp_obj_t path_
         // try to rename again
         res = f_rename(&self->fatfs, old_path, new_path);
     }
+    // CIRCUITPY-CHANGE
+    fat_vfs_invalidate_stat_cache(self);
     if (res == FR_OK) {
         return mp_const_none;
     } else {
@@ -293,6 +376,8 @@ static mp_obj_t fat_vfs_mkdir(mp_obj_t vfs_in, mp_obj_t path_o) {
     verify_fs_writable(self);
     const char *path = mp_obj_str_get_str(path_o);
     FRESULT res = f_mkdir(&self->fatfs, path);
+    // CIRCUITPY-CHANGE
+    fat_vfs_invalidate_stat_cache(self);
     if (res == FR_OK) {
         return mp_const_none;
     } else {
@@ -309,6 +394,8 @@ static mp_obj_t fat_vfs_chdir(mp_obj_t vfs_in, mp_obj_t path_in) {
     path = mp_obj_str_get_str(path_in);
 
     FRESULT res = f_chdir(&self->fatfs, path);
+    // CIRCUITPY-CHANGE: relative paths in the stat cache now mean something else.
+    fat_vfs_invalidate_stat_cache(self);
 
     if (res != FR_OK) {
         // CIRCUITPY-CHANGE
@@ -345,7 +432,8 @@ static mp_obj_t fat_vfs_stat(mp_obj_t vfs_in, mp_obj_t path_in) {
         fno.ftime = 0;
         fno.fattrib = AM_DIR;
     } else {
-        FRESULT res = f_stat(&self->fatfs, path, &fno);
+        // CIRCUITPY-CHANGE: use the stat cache
+        FRESULT res = fat_vfs_stat_cached(self, path, &fno);
         if (res != FR_OK) {
             // CIRCUITPY-CHANGE
             if (gc_alloc_possible()) {
@@ -446,14 +534,17 @@ static mp_obj_t vfs_fat_mount(mp_obj_t self_in, mp_obj_t readonly, mp_obj_t mkfs
         mp_raise_OSError_fresult(res);
     }
     self->blockdev.flags &= ~MP_BLOCKDEV_FLAG_NO_FILESYSTEM;
+    // CIRCUITPY-CHANGE
+    fat_vfs_invalidate_stat_cache(self);
 
     return mp_const_none;
 }
 static MP_DEFINE_CONST_FUN_OBJ_3(vfs_fat_mount_obj, vfs_fat_mount);
 
 static mp_obj_t vfs_fat_umount(mp_obj_t self_in) {
-    (void)self_in;
     // keep the FAT filesystem mounted internally so the VFS methods can still be used
+    // CIRCUITPY-CHANGE: but the volume may change before it is mounted again.
+    fat_vfs_invalidate_stat_cache(MP_OBJ_TO_PTR(self_in));
     return mp_const_none;
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(fat_vfs_umount_obj, vfs_fat_umount);
@@ -480,6 +571,7 @@ static mp_obj_t vfs_fat_utime(mp_obj_t vfs_in, mp_obj_t path_in, mp_obj_t times_
     fno.fdate = (WORD)(((tm.tm_year - 1980) * 512U) | tm.tm_mon * 32U | tm.tm_mday);
     fno.ftime = (WORD)(tm.tm_hour * 2048U | tm.tm_min * 32U | tm.tm_sec / 2U);
     FRESULT res = f_utime(&self->fatfs, path, &fno);
+    fat_vfs_invalidate_stat_cache(self);
     if (res != FR_OK) {
         mp_raise_OSError_fresult(res);
     }
@@ -529,6 +621,29 @@ static MP_PROPERTY_GETSET(fat_vfs_label_obj,
     (mp_obj_t)&fat_vfs_setlabel_obj);
 #endif
 
+#if FF_FS_TINY && FF_FS_FILE_BUF
+static mp_obj_t vfs_fat_getfile_buffers(mp_obj_t self_in) {
+    fs_user_mount_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_bool(self->blockdev.flags & MP_BLOCKDEV_FLAG_FILE_BUFFERS);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(fat_vfs_getfile_buffers_obj, vfs_fat_getfile_buffers);
+
+static mp_obj_t vfs_fat_setfile_buffers(mp_obj_t self_in, mp_obj_t value_in) {
+    fs_user_mount_t *self = MP_OBJ_TO_PTR(self_in);
+    if (mp_obj_is_true(value_in)) {
+        self->blockdev.flags |= MP_BLOCKDEV_FLAG_FILE_BUFFERS;
+    } else {
+        self->blockdev.flags &= ~MP_BLOCKDEV_FLAG_FILE_BUFFERS;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(fat_vfs_setfile_buffers_obj, vfs_fat_setfile_buffers);
+
+static MP_PROPERTY_GETSET(fat_vfs_file_buffers_obj,
+    (mp_obj_t)&fat_vfs_getfile_buffers_obj,
+    (mp_obj_t)&fat_vfs_setfile_buffers_obj);
+#endif
+
 static const mp_rom_map_elem_t fat_vfs_locals_dict_table[] = {
     // CIRCUITPY-CHANGE: correct name
     #if FF_FS_REENTRANT
@@ -553,6 +668,9 @@ static const mp_rom_map_elem_t fat_vfs_locals_dict_table[] = {
     #if MICROPY_FATFS_USE_LABEL
     { MP_ROM_QSTR(MP_QSTR_label), MP_ROM_PTR(&fat_vfs_label_obj) },
     #endif
+    #if FF_FS_TINY && FF_FS_FILE_BUF
+    { MP_ROM_QSTR(MP_QSTR_file_buffers), MP_ROM_PTR(&fat_vfs_file_buffers_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(fat_vfs_locals_dict, fat_vfs_locals_dict_table);
 
@@ -29,6 +29,26 @@
 #include "py/obj.h"
 #include "lib/oofatfs/ff.h"
 #include "extmod/vfs.h"
+// CIRCUITPY-CHANGE
+#if MICROPY_FATFS_READAHEAD_BACKGROUND
+#include "supervisor/background_callback.h"
+#endif
+
+// CIRCUITPY-CHANGE
+#if MICROPY_FATFS_STAT_CACHE
+// The result of an f_stat call, keyed by a hash of the path it was given.
+// Failed lookups are kept too, since imports mostly probe for files that
+// don't exist.
+typedef struct _fat_stat_cache_entry_t {
+    uint64_t path_hash;
+    uint32_t generation;
+    FSIZE_t fsize;
+    WORD fdate;
+    WORD ftime;
+    BYTE fattrib;
+    BYTE res;
+} fat_stat_cache_entry_t;
+#endif
 
 typedef struct _fs_user_mount_t {
     mp_obj_base_t base;
@@ -38,8 +58,37 @@ typedef struct _fs_user_mount_t {
     // CIRCUITPY-CHANGE: Count the users that are manipulating the blockdev via
     // native fatfs so we can lock and unlock the blockdev.
     int8_t lock_count;
+
+    // CIRCUITPY-CHANGE: Set while a FatFs call is using the volume.
+    #if FF_FS_REENTRANT
+    bool busy;
+    #endif
+
+    // CIRCUITPY-CHANGE: Recent stat results. Entries are only valid while
+    // their generation matches, so bumping it empties the cache.
+    #if MICROPY_FATFS_STAT_CACHE
+    uint32_t stat_cache_generation;
+    uint8_t stat_cache_next;
+    fat_stat_cache_entry_t stat_cache[MICROPY_FATFS_STAT_CACHE];
+    #endif
 } fs_user_mount_t;
 
+// CIRCUITPY-CHANGE
+// Forget cached stat results; called whenever the volume may have changed.
+static inline void fat_vfs_invalidate_stat_cache(fs_user_mount_t *vfs) {
+    #if MICROPY_FATFS_STAT_CACHE
+    vfs->stat_cache_generation++;
+    #else
+    (void)vfs;
+    #endif
+}
+
+#if FF_MAX_SS == FF_MIN_SS
+#define SECSIZE(fs) (FF_MIN_SS)
+#else
+#define SECSIZE(fs) ((fs)->ssize)
+#endif
+
 extern const byte fresult_to_errno_table[20];
 extern const mp_obj_type_t mp_fat_vfs_type;
 extern const mp_obj_type_t mp_type_vfs_fat_fileio;
@@ -51,6 +100,30 @@ MP_DECLARE_CONST_FUN_OBJ_3(fat_vfs_open_obj);
 typedef struct _pyb_file_obj_t {
     mp_obj_base_t base;
     FIL fp;
+    #if MICROPY_FATFS_READAHEAD
+    // Data read from fp ahead of the reader, who has consumed the first
+    // readahead_pos of readahead_len bytes. fp is positioned after the lot.
+    uint8_t *readahead_buf;
+    uint32_t readahead_size;
+    uint32_t readahead_len;
+    uint32_t readahead_pos;
+    // Set while fp is in use, so the background fill leaves it alone.
+    bool readahead_busy;
+    #if MICROPY_FATFS_READAHEAD_BACKGROUND
+    background_callback_t readahead_callback;
+    #endif
+    #endif
+    #if FF_USE_EXPAND
+    // Bytes reserved by preallocate() and not yet released, or 0.
+    FSIZE_t preallocated;
+    #endif
 } pyb_file_obj_t;
 
+// CIRCUITPY-CHANGE
+// Native code that reads an open file should go through these rather than
+// calling f_read and f_lseek on fp, so that any read-ahead buffer is used.
+FRESULT fat_file_read(pyb_file_obj_t *file, void *buf, UINT len, UINT *len_out);
+FRESULT fat_file_seek(pyb_file_obj_t *file, FSIZE_t offset);
+FSIZE_t fat_file_tell(pyb_file_obj_t *file);
+
 #endif  // MICROPY_INCLUDED_EXTMOD_VFS_FAT_H
@@ -84,6 +84,9 @@ DRESULT disk_write(
     }
 
     int ret = mp_vfs_blockdev_write(&vfs->blockdev, sector, count, buff);
+    // CIRCUITPY-CHANGE: every change to the volume, from FatFs or from USB,
+    // comes through here.
+    fat_vfs_invalidate_stat_cache(vfs);
 
     if (ret == -MP_EROFS) {
         // read-only block device
@@ -167,4 +170,34 @@ DRESULT disk_ioctl(
     }
 }
 
+// CIRCUITPY-CHANGE: Volume locking. A background callback, such as a
+// read-ahead refill, can call into FatFs while a transfer in the foreground is
+// running background tasks. Nothing can release the volume until that call
+// returns, so refuse straight away rather than wait; FatFs then reports
+// FR_LOCKED, which is raised as EBUSY.
+#if FF_FS_REENTRANT
+int ff_cre_syncobj(FATFS *fatfs, FF_SYNC_t *sobj) {
+    *sobj = disk_get_device(fatfs->drv);
+    (*sobj)->busy = false;
+    return 1;
+}
+
+int ff_req_grant(FF_SYNC_t sobj) {
+    if (sobj->busy) {
+        return 0;
+    }
+    sobj->busy = true;
+    return 1;
+}
+
+void ff_rel_grant(FF_SYNC_t sobj) {
+    sobj->busy = false;
+}
+
+int ff_del_syncobj(FF_SYNC_t sobj) {
+    (void)sobj;
+    return 1;
+}
+#endif
+
 #endif // MICROPY_VFS && MICROPY_VFS_FAT
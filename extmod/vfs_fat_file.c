@@ -56,12 +56,222 @@ const byte fresult_to_errno_table[20] = {
     [FR_NO_FILESYSTEM] = MP_ENODEV,
     [FR_MKFS_ABORTED] = MP_EIO,
     [FR_TIMEOUT] = MP_EIO,
-    [FR_LOCKED] = MP_EIO,
+    // CIRCUITPY-CHANGE: the volume is in use by a transfer that is running
+    // background tasks. See ff_req_grant().
+    [FR_LOCKED] = MP_EBUSY,
     [FR_NOT_ENOUGH_CORE] = MP_ENOMEM,
     [FR_TOO_MANY_OPEN_FILES] = MP_EMFILE,
     [FR_INVALID_PARAMETER] = MP_EINVAL,
 };
 
+// CIRCUITPY-CHANGE: read-ahead buffering
+#if MICROPY_FATFS_READAHEAD
+static uint32_t readahead_unread(pyb_file_obj_t *self) {
+    return self->readahead_len - self->readahead_pos;
+}
+
+// Forget what was read ahead, and put fp back where the reader is.
+static FRESULT readahead_drop(pyb_file_obj_t *self) {
+    uint32_t unread = readahead_unread(self);
+    self->readahead_len = 0;
+    self->readahead_pos = 0;
+    if (unread == 0) {
+        return FR_OK;
+    }
+    return f_lseek(&self->fp, f_tell(&self->fp) - unread);
+}
+
+// Top up the buffer, keeping what hasn't been read yet.
+static FRESULT readahead_fill(pyb_file_obj_t *self) {
+    uint32_t unread = readahead_unread(self);
+    memmove(self->readahead_buf, self->readahead_buf + self->readahead_pos, unread);
+    self->readahead_pos = 0;
+    self->readahead_len = unread;
+    UINT sz_out;
+    FRESULT res = f_read(&self->fp, self->readahead_buf + unread, self->readahead_size - unread, &sz_out);
+    self->readahead_len += sz_out;
+    return res;
+}
+
+#if MICROPY_FATFS_READAHEAD_BACKGROUND
+static void readahead_background(void *data) {
+    pyb_file_obj_t *self = data;
+    // The file may have been closed, or be in the middle of an operation.
+    // FatFs refuses with FR_LOCKED if a transfer on the volume is running
+    // background tasks. Any error turns up again when the reader needs the
+    // data.
+    if (self->fp.obj.fs != NULL && self->readahead_buf != NULL && !self->readahead_busy) {
+        readahead_fill(self);
+    }
+}
+#endif
+
+// Once half the buffer has been read, refill it off the reader's critical path.
+static void readahead_consumed(pyb_file_obj_t *self) {
+    #if MICROPY_FATFS_READAHEAD_BACKGROUND
+    if (readahead_unread(self) <= self->readahead_size / 2 && !f_eof(&self->fp)) {
+        background_callback_add(&self->readahead_callback, readahead_background, self);
+    }
+    #else
+    (void)self;
+    #endif
+}
+
+static void readahead_set_size(pyb_file_obj_t *self, size_t size) {
+    readahead_drop(self);
+    // Leave the old buffer to the GC; this may be called from a finaliser.
+    self->readahead_buf = NULL;
+    self->readahead_size = 0;
+    if (size > 0) {
+        self->readahead_buf = m_malloc(size);
+        self->readahead_size = size;
+    }
+}
+#endif
+
+FRESULT fat_file_read(pyb_file_obj_t *self, void *buf, UINT len, UINT *len_out) {
+    #if MICROPY_FATFS_READAHEAD
+    if (self->readahead_buf != NULL) {
+        uint8_t *dest = buf;
+        FRESULT res = FR_OK;
+        *len_out = 0;
+        self->readahead_busy = true;
+        while (len > 0) {
+            uint32_t unread = readahead_unread(self);
+            if (unread == 0) {
+                if (len >= self->readahead_size) {
+                    // Too big to be worth buffering.
+                    UINT sz_out;
+                    res = f_read(&self->fp, dest, len, &sz_out);
+                    *len_out += sz_out;
+                    break;
+                }
+                res = readahead_fill(self);
+                if (res != FR_OK || readahead_unread(self) == 0) {
+                    break;
+                }
+                continue;
+            }
+            uint32_t n = MIN(unread, len);
+            memcpy(dest, self->readahead_buf + self->readahead_pos, n);
+            self->readahead_pos += n;
+            dest += n;
+            len -= n;
+            *len_out += n;
+        }
+        self->readahead_busy = false;
+        readahead_consumed(self);
+        return res;
+    }
+    #endif
+    return f_read(&self->fp, buf, len, len_out);
+}
+
+#if FF_USE_EXPAND
+static void preallocate_finish(pyb_file_obj_t *self);
+#endif
+
+FRESULT fat_file_seek(pyb_file_obj_t *self, FSIZE_t offset) {
+    #if MICROPY_FATFS_READAHEAD
+    if (self->readahead_buf != NULL) {
+        // Stay inside the buffer if we can.
+        FSIZE_t end = f_tell(&self->fp);
+        FSIZE_t start = end - self->readahead_len;
+        if (offset >= start && offset <= end) {
+            self->readahead_pos = offset - start;
+            return FR_OK;
+        }
+        self->readahead_len = 0;
+        self->readahead_pos = 0;
+    }
+    #endif
+    #if FF_USE_EXPAND
+    if (self->preallocated != 0 && offset > f_size(&self->fp)) {
+        if (offset > self->preallocated) {
+            preallocate_finish(self);
+        } else {
+            // With a cluster map f_lseek stops at the end of what has been
+            // written, so seek into the reservation by following the chain.
+            DWORD *cltbl = self->fp.cltbl;
+            self->fp.cltbl = NULL;
+            FRESULT res = f_lseek(&self->fp, offset);
+            self->fp.cltbl = cltbl;
+            return res;
+        }
+    }
+    #endif
+    return f_lseek(&self->fp, offset);
+}
+
+FSIZE_t fat_file_tell(pyb_file_obj_t *self) {
+    #if MICROPY_FATFS_READAHEAD
+    return f_tell(&self->fp) - readahead_unread(self);
+    #else
+    return f_tell(&self->fp);
+    #endif
+}
+
+// CIRCUITPY-CHANGE: contiguous preallocation
+#if FF_USE_EXPAND
+// While space is reserved, the file's size only covers what has been written
+// and the cluster map points writes into the reserved clusters. This makes
+// the file an ordinary one again, with the reserved size, ready to grow.
+static void preallocate_finish(pyb_file_obj_t *self) {
+    if (self->fp.obj.objsize < self->preallocated) {
+        self->fp.obj.objsize = self->preallocated;
+    }
+    self->fp.cltbl = NULL;
+    self->preallocated = 0;
+}
+
+// Give back the reserved clusters that weren't written.
+static FRESULT preallocate_release(pyb_file_obj_t *self) {
+    FSIZE_t written = f_size(&self->fp);
+    FSIZE_t pos = f_tell(&self->fp);
+    self->fp.obj.objsize = self->preallocated;
+    FRESULT res = f_lseek(&self->fp, written);
+    if (res == FR_OK) {
+        res = f_truncate(&self->fp);
+    }
+    if (res == FR_OK) {
+        res = f_lseek(&self->fp, pos);
+    }
+    self->fp.cltbl = NULL;
+    self->preallocated = 0;
+    return res;
+}
+
+// preallocate(size): reserve size bytes of contiguous clusters for an empty
+// file, so that writing it never has to search the FAT for free clusters.
+// The file's size still grows only as it is written, and reserved space that
+// isn't used is released when the file is closed.
+static mp_obj_t file_obj_preallocate(mp_obj_t self_in, mp_obj_t size_in) {
+    pyb_file_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t size = mp_arg_validate_int_min(mp_obj_get_int(size_in), 1, MP_QSTR_size);
+    if (self->fp.obj.fs == NULL || !(self->fp.flag & FA_WRITE) || f_size(&self->fp) != 0) {
+        mp_raise_OSError(MP_EINVAL);
+    }
+    FRESULT res = f_expand(&self->fp, size, 1);
+    if (res != FR_OK) {
+        // f_expand reports a lack of contiguous space as FR_DENIED.
+        mp_raise_OSError(res == FR_DENIED ? MP_ENOSPC : fresult_to_errno_table[res]);
+    }
+    // The clusters are contiguous, so the cluster map is a single fragment.
+    FATFS *fs = self->fp.obj.fs;
+    DWORD cluster_size = fs->csize * SECSIZE(fs);
+    DWORD *table = m_new(DWORD, 4);
+    table[0] = 4;
+    table[1] = (size + cluster_size - 1) / cluster_size;
+    table[2] = self->fp.obj.sclust;
+    table[3] = 0;
+    self->fp.cltbl = table;
+    self->fp.obj.objsize = 0;
+    self->preallocated = size;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(file_obj_preallocate_obj, file_obj_preallocate);
+#endif
+
 static void file_obj_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     (void)kind;
     // CIRCUITPY-CHANGE
@@ -71,7 +281,8 @@ static void file_obj_print(const mp_print_t *print, mp_obj_t self_in, mp_print_k
 static mp_uint_t file_obj_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     pyb_file_obj_t *self = MP_OBJ_TO_PTR(self_in);
     UINT sz_out;
-    FRESULT res = f_read(&self->fp, buf, size, &sz_out);
+    // CIRCUITPY-CHANGE: read through any read-ahead buffer
+    FRESULT res = fat_file_read(self, buf, size, &sz_out);
     if (res != FR_OK) {
         *errcode = fresult_to_errno_table[res];
         return MP_STREAM_ERROR;
@@ -82,7 +293,21 @@ static mp_uint_t file_obj_read(mp_obj_t self_in, void *buf, mp_uint_t size, int
 static mp_uint_t file_obj_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
     pyb_file_obj_t *self = MP_OBJ_TO_PTR(self_in);
     UINT sz_out;
+    // CIRCUITPY-CHANGE: a write past the reserved space carries on as normal.
+    #if FF_USE_EXPAND
+    if (self->preallocated != 0 && fat_file_tell(self) + size > self->preallocated) {
+        preallocate_finish(self);
+    }
+    #endif
+    // CIRCUITPY-CHANGE: write where the reader is, not where read-ahead got to.
+    #if MICROPY_FATFS_READAHEAD
+    FRESULT res = readahead_drop(self);
+    if (res == FR_OK) {
+        res = f_write(&self->fp, buf, size, &sz_out);
+    }
+    #else
     FRESULT res = f_write(&self->fp, buf, size, &sz_out);
+    #endif
     if (res != FR_OK) {
         *errcode = fresult_to_errno_table[res];
         return MP_STREAM_ERROR;
@@ -101,21 +326,22 @@ static mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
     if (request == MP_STREAM_SEEK) {
         struct mp_stream_seek_t *s = (struct mp_stream_seek_t *)(uintptr_t)arg;
 
+        // CIRCUITPY-CHANGE: seek within any read-ahead buffer
         switch (s->whence) {
             case 0: // SEEK_SET
-                f_lseek(&self->fp, s->offset);
+                fat_file_seek(self, s->offset);
                 break;
 
             case 1: // SEEK_CUR
-                f_lseek(&self->fp, f_tell(&self->fp) + s->offset);
+                fat_file_seek(self, fat_file_tell(self) + s->offset);
                 break;
 
             case 2: // SEEK_END
-                f_lseek(&self->fp, f_size(&self->fp) + s->offset);
+                fat_file_seek(self, f_size(&self->fp) + s->offset);
                 break;
         }
 
-        s->offset = f_tell(&self->fp);
+        s->offset = fat_file_tell(self);
         return 0;
 
     } else if (request == MP_STREAM_FLUSH) {
@@ -129,6 +355,20 @@ static mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
     } else if (request == MP_STREAM_CLOSE) {
         // if fs==NULL then the file is closed and in that case this method is a no-op
         if (self->fp.obj.fs != NULL) {
+            // CIRCUITPY-CHANGE
+            #if MICROPY_FATFS_READAHEAD
+            self->readahead_buf = NULL;
+            #endif
+            #if FF_USE_EXPAND
+            if (self->preallocated != 0) {
+                FRESULT res = preallocate_release(self);
+                if (res != FR_OK) {
+                    f_close(&self->fp);
+                    *errcode = fresult_to_errno_table[res];
+                    return MP_STREAM_ERROR;
+                }
+            }
+            #endif
             FRESULT res = f_close(&self->fp);
             if (res != FR_OK) {
                 *errcode = fresult_to_errno_table[res];
@@ -137,6 +377,17 @@ static mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
         }
         return 0;
 
+    // CIRCUITPY-CHANGE
+    #if MICROPY_FATFS_READAHEAD
+    } else if (request == MP_STREAM_SET_READAHEAD) {
+        if (self->fp.obj.fs == NULL || !(self->fp.flag & FA_READ)) {
+            *errcode = MP_EINVAL;
+            return MP_STREAM_ERROR;
+        }
+        readahead_set_size(self, arg);
+        return 0;
+    #endif
+
     } else {
         *errcode = MP_EINVAL;
         return MP_STREAM_ERROR;
@@ -155,6 +406,10 @@ static const mp_rom_map_elem_t vfs_fat_rawfile_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
     { MP_ROM_QSTR(MP_QSTR_seek), MP_ROM_PTR(&mp_stream_seek_obj) },
     { MP_ROM_QSTR(MP_QSTR_tell), MP_ROM_PTR(&mp_stream_tell_obj) },
+    // CIRCUITPY-CHANGE
+    #if FF_USE_EXPAND
+    { MP_ROM_QSTR(MP_QSTR_preallocate), MP_ROM_PTR(&file_obj_preallocate_obj) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mp_stream_close_obj) },
     { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
     { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&mp_stream___exit___obj) },
@@ -259,9 +514,15 @@ static mp_obj_t fat_vfs_open(mp_obj_t self_in, mp_obj_t path_in, mp_obj_t mode_i
         m_del_obj(pyb_file_obj_t, o);
         mp_raise_OSError_errno_str(fresult_to_errno_table[res], path_in);
     }
+    // CIRCUITPY-CHANGE: creating or truncating a file changes its directory
+    // entry before anything reaches the disk.
+    if (mode & FA_WRITE) {
+        fat_vfs_invalidate_stat_cache(self);
+    }
     // CIRCUITPY-CHANGE: does fast seek.
-    // If we're reading, turn on fast seek.
-    if (mode == FA_READ) {
+    // If we're reading, turn on fast seek. A file that fits in one cluster
+    // has no chain to walk, so it doesn't need the map.
+    if (mode == FA_READ && f_size(&o->fp) > (FSIZE_t)self->fatfs.csize * SECSIZE(&self->fatfs)) {
         // One call to determine how much space we need.
         DWORD temp_table[2];
         temp_table[0] = 2;
@@ -280,6 +541,17 @@ static mp_obj_t fat_vfs_open(mp_obj_t self_in, mp_obj_t path_in, mp_obj_t mode_i
         }
     }
 
+    // CIRCUITPY-CHANGE: give the file its own sector buffer, so it doesn't
+    // have to share the filesystem's window with other open files.
+    #if FF_FS_TINY && FF_FS_FILE_BUF
+    if (self->blockdev.flags & MP_BLOCKDEV_FLAG_FILE_BUFFERS) {
+        BYTE *buf = m_malloc_maybe(SECSIZE(&self->fatfs));
+        if (buf != NULL) {
+            f_setbuf(&o->fp, buf);
+        }
+    }
+    #endif
+
     // for 'a' mode, we must begin at the end of the file
     if ((mode & FA_OPEN_ALWAYS) != 0) {
         f_lseek(&o->fp, f_size(&o->fp));
@@ -33,13 +33,19 @@
 #include "extmod/vfs.h"
 #include "extmod/vfs_lfs.h"
 
+// CIRCUITPY-CHANGE: Largest automatic lookahead window, in blocks.
+#ifndef MP_VFS_LFS_LOOKAHEAD_MAX
+#define MP_VFS_LFS_LOOKAHEAD_MAX (1024)
+#endif
+
 enum { LFS_MAKE_ARG_bdev, LFS_MAKE_ARG_readsize, LFS_MAKE_ARG_progsize, LFS_MAKE_ARG_lookahead, LFS_MAKE_ARG_mtime };
 
 static const mp_arg_t lfs_make_allowed_args[] = {
     { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
     { MP_QSTR_readsize, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 32} },
     { MP_QSTR_progsize, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 32} },
-    { MP_QSTR_lookahead, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 32} },
+    // CIRCUITPY-CHANGE: 0 sizes the lookahead buffer to the block device
+    { MP_QSTR_lookahead, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
     { MP_QSTR_mtime, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = true} },
 };
 
@@ -140,6 +146,43 @@ static void lfs_get_mtime(uint8_t buf[8]) {
 #include "extmod/vfs_lfsx.c"
 #include "extmod/vfs_lfsx_file.c"
 
+// CIRCUITPY-CHANGE: CIRCUITPY itself can live on littlefs. The mount outlives
+// every VM, so the supervisor supplies a configuration whose callbacks and
+// buffers don't touch the VM heap, and the working directory has a fixed buffer.
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+
+static mp_obj_vfs_lfs2_t circuitpy_lfs2;
+static char circuitpy_lfs2_cur_dir[CIRCUITPY_LITTLEFS_PATH_MAX];
+
+int mp_vfs_lfs2_mount_static(const mp_vfs_blockdev_t *blockdev, const struct lfs2_config *config, bool format, mp_obj_t *vfs_out) {
+    mp_obj_vfs_lfs2_t *self = &circuitpy_lfs2;
+    self->base.type = &mp_type_vfs_lfs2;
+    self->blockdev = *blockdev;
+    self->enable_mtime = true;
+    self->config = *config;
+    vstr_init_fixed_buf(&self->cur_dir, sizeof(circuitpy_lfs2_cur_dir), circuitpy_lfs2_cur_dir);
+    vstr_add_byte(&self->cur_dir, '/');
+
+    int ret = 0;
+    if (format) {
+        ret = lfs2_format(&self->lfs, &self->config);
+    }
+    if (ret == 0) {
+        ret = lfs2_mount(&self->lfs, &self->config);
+    }
+    if (ret == 0) {
+        *vfs_out = MP_OBJ_FROM_PTR(self);
+    }
+    return ret;
+}
+
+lfs2_t *mp_vfs_lfs2_get_lfs(mp_obj_t self_in) {
+    mp_obj_vfs_lfs2_t *self = MP_OBJ_TO_PTR(self_in);
+    return &self->lfs;
+}
+
+#endif
+
 #endif // MICROPY_VFS_LFS2
 
 #endif // MICROPY_VFS && (MICROPY_VFS_LFS1 || MICROPY_VFS_LFS2)
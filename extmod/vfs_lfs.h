@@ -36,4 +36,15 @@ extern const mp_obj_type_t mp_type_vfs_lfs2;
 extern const mp_obj_type_t mp_type_vfs_lfs2_fileio;
 extern const mp_obj_type_t mp_type_vfs_lfs2_textio;
 
+// CIRCUITPY-CHANGE: CIRCUITPY on littlefs
+#if MICROPY_VFS_LFS2 && CIRCUITPY_FILESYSTEM_LITTLEFS
+#include "extmod/vfs.h"
+#include "lib/littlefs/lfs2.h"
+
+// Mounts littlefs with a configuration and buffers that outlive the VM,
+// formatting it first if asked. Returns 0 or a negative littlefs error.
+int mp_vfs_lfs2_mount_static(const mp_vfs_blockdev_t *blockdev, const struct lfs2_config *config, bool format, mp_obj_t *vfs_out);
+lfs2_t *mp_vfs_lfs2_get_lfs(mp_obj_t self_in);
+#endif
+
 #endif // MICROPY_INCLUDED_EXTMOD_VFS_LFS_H
@@ -92,6 +92,16 @@ static void MP_VFS_LFSx(init_config)(MP_OBJ_VFS_LFSx * self, mp_obj_t bdev, size
     config->block_size = bs;
     config->block_count = bc;
 
+    // CIRCUITPY-CHANGE: By default let one lookahead window cover the whole
+    // device, up to a limit, so the allocator rarely has to rescan it.
+    if (lookahead == 0) {
+        lookahead = MIN(MAX((size_t)bc, 64), MP_VFS_LFS_LOOKAHEAD_MAX);
+        lookahead = (lookahead + 63) / 64 * 64;
+        #if LFS_BUILD_VERSION == 2
+        lookahead /= 8;
+        #endif
+    }
+
     #if LFS_BUILD_VERSION == 1
     config->lookahead = lookahead;
     config->read_buffer = m_new(uint8_t, config->read_size);
@@ -219,7 +219,10 @@
 
 /* Re-entrancy related */
 #if FF_FS_REENTRANT
-#if FF_USE_LFN == 1
+// CIRCUITPY-CHANGE: CircuitPython has no threads. Its volume locks only keep
+// background callbacks out of a volume that is already in use, and the static
+// LFN work area is shared between volumes just as it is without them.
+#if FF_USE_LFN == 1 && !CIRCUITPY
 #error Static LFN work area cannot be used at thread-safe configuration
 #endif
 #define LEAVE_FF(fs, res)   { unlock_fs(fs, res); return res; }
@@ -247,6 +250,20 @@
 #endif
 
 
+/* File data buffer. At the tiny configuration a file transfers data through
+   the shared window, unless a private buffer was attached by f_setbuf(). */
+#if !FF_FS_TINY
+#define FIL_TINY(fp)    0
+#define FIL_BUF(fp)     ((fp)->buf)
+#elif FF_FS_FILE_BUF
+#define FIL_TINY(fp)    ((fp)->buf == 0)
+#define FIL_BUF(fp)     ((fp)->buf)
+#else
+#define FIL_TINY(fp)    1
+#define FIL_BUF(fp)     ((BYTE*)0)
+#endif
+
+
 /* Timestamp */
 #if FF_FS_NORTC == 1
 #if FF_NORTC_YEAR < 1980 || FF_NORTC_YEAR > 2107 || FF_NORTC_MON < 1 || FF_NORTC_MON > 12 || FF_NORTC_MDAY < 1 || FF_NORTC_MDAY > 31
@@ -887,7 +904,14 @@ static BYTE put_utf (   /* Returns number of encoding units written (0:buffer ov
 /*-----------------------------------------------------------------------*/
 /* Request/Release grant to access the volume                            */
 /*-----------------------------------------------------------------------*/
-static int lock_fs (        /* 1:Ok, 0:timeout */
+// CIRCUITPY-CHANGE: a volume that is already in use is reported as FR_LOCKED
+// rather than FR_TIMEOUT, as the grant is refused at once instead of timing out.
+// FR_LOCKED is otherwise only returned by file locking, which is off.
+#if FF_FS_LOCK
+#error "FR_LOCKED from lock_fs() is ambiguous with FF_FS_LOCK"
+#endif
+
+static int lock_fs (        /* 1:Ok, 0:busy */
     FATFS* fs       /* Filesystem object */
 )
 {
@@ -900,7 +924,8 @@ static void unlock_fs (
     FRESULT res     /* Result code to be returned */
 )
 {
-    if (fs && res != FR_NOT_ENABLED && res != FR_INVALID_DRIVE && res != FR_TIMEOUT) {
+    // CIRCUITPY-CHANGE: FR_LOCKED means the grant wasn't obtained
+    if (fs && res != FR_NOT_ENABLED && res != FR_INVALID_DRIVE && res != FR_TIMEOUT && res != FR_LOCKED) {
         ff_rel_grant(fs->sobj);
     }
 }
@@ -3142,7 +3167,8 @@ static FRESULT find_volume (    /* FR_OK(0): successful, !=0: an error occurred
 
 
 #if FF_FS_REENTRANT
-    if (!lock_fs(fs)) return FR_TIMEOUT;    /* Lock the volume */
+    // CIRCUITPY-CHANGE: FR_LOCKED
+    if (!lock_fs(fs)) return FR_LOCKED;     /* Lock the volume */
 #endif
 
     mode &= (BYTE)~FA_READ;             /* Desired access mode, write access or not */
@@ -3375,7 +3401,8 @@ static FRESULT validate (   /* Returns FR_OK or FR_INVALID_OBJECT */
                 unlock_fs(obj->fs, FR_OK);
             }
         } else {
-            res = FR_TIMEOUT;
+            // CIRCUITPY-CHANGE: FR_LOCKED
+            res = FR_LOCKED;
         }
 #else
         if (disk_ioctl(obj->fs->drv, IOCTL_STATUS, &stat) == RES_OK && !(stat & STA_NOINIT)) { /* Test if the phsical drive is kept initialized */
@@ -3578,6 +3605,9 @@ FRESULT f_open (
             }
 #if FF_USE_FASTSEEK
             fp->cltbl = 0;          /* Disable fast seek mode */
+#endif
+#if FF_FS_TINY && FF_FS_FILE_BUF
+            fp->buf = 0;            /* Use the shared window until f_setbuf() */
 #endif
             fp->obj.fs = fs;        /* Validate the file object */
             fp->obj.id = fs->id;
@@ -3681,40 +3711,38 @@ FRESULT f_read (
                 }
                 if (disk_read(fs->drv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
 #if !FF_FS_READONLY && FF_FS_MINIMIZE <= 2      /* Replace one of the read sectors with cached data if it contains a dirty sector */
-#if FF_FS_TINY
-                if (fs->wflag && fs->winsect - sect < cc) {
-                    mem_cpy(rbuff + ((fs->winsect - sect) * SS(fs)), fs->win, SS(fs));
-                }
-#else
-                if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc) {
-                    mem_cpy(rbuff + ((fp->sect - sect) * SS(fs)), fp->buf, SS(fs));
+                if (FIL_TINY(fp)) {
+                    if (fs->wflag && fs->winsect - sect < cc) {
+                        mem_cpy(rbuff + ((fs->winsect - sect) * SS(fs)), fs->win, SS(fs));
+                    }
+                } else {
+                    if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc) {
+                        mem_cpy(rbuff + ((fp->sect - sect) * SS(fs)), FIL_BUF(fp), SS(fs));
+                    }
                 }
-#endif
 #endif
                 rcnt = SS(fs) * cc;             /* Number of bytes transferred */
                 continue;
             }
-#if !FF_FS_TINY
-            if (fp->sect != sect) {         /* Load data sector if not in cache */
+            if (!FIL_TINY(fp) && fp->sect != sect) {   /* Load data sector if not in cache */
 #if !FF_FS_READONLY
                 if (fp->flag & FA_DIRTY) {      /* Write-back dirty sector cache */
-                    if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+                    if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
                     fp->flag &= (BYTE)~FA_DIRTY;
                 }
 #endif
-                if (disk_read(fs->drv, fp->buf, sect, 1) != RES_OK)    ABORT(fs, FR_DISK_ERR); /* Fill sector cache */
+                if (disk_read(fs->drv, FIL_BUF(fp), sect, 1) != RES_OK)    ABORT(fs, FR_DISK_ERR); /* Fill sector cache */
             }
-#endif
             fp->sect = sect;
         }
         rcnt = SS(fs) - (UINT)fp->fptr % SS(fs);    /* Number of bytes left in the sector */
         if (rcnt > btr) rcnt = btr;                 /* Clip it by btr if needed */
-#if FF_FS_TINY
-        if (move_window(fs, fp->sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window */
-        mem_cpy(rbuff, fs->win + fp->fptr % SS(fs), rcnt);  /* Extract partial sector */
-#else
-        mem_cpy(rbuff, fp->buf + fp->fptr % SS(fs), rcnt);  /* Extract partial sector */
-#endif
+        if (FIL_TINY(fp)) {
+            if (move_window(fs, fp->sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window */
+            mem_cpy(rbuff, fs->win + fp->fptr % SS(fs), rcnt);  /* Extract partial sector */
+        } else {
+            mem_cpy(rbuff, FIL_BUF(fp) + fp->fptr % SS(fs), rcnt);  /* Extract partial sector */
+        }
     }
 
     LEAVE_FF(fs, FR_OK);
@@ -3778,14 +3806,12 @@ FRESULT f_write (
                 fp->clust = clst;           /* Update current cluster */
                 if (fp->obj.sclust == 0) fp->obj.sclust = clst; /* Set start cluster if the first write */
             }
-#if FF_FS_TINY
-            if (fs->winsect == fp->sect && sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);    /* Write-back sector cache */
-#else
-            if (fp->flag & FA_DIRTY) {      /* Write-back sector cache */
-                if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+            if (FIL_TINY(fp)) {
+                if (fs->winsect == fp->sect && sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);    /* Write-back sector cache */
+            } else if (fp->flag & FA_DIRTY) {   /* Write-back sector cache */
+                if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
                 fp->flag &= (BYTE)~FA_DIRTY;
             }
-#endif
             sect = clst2sect(fs, fp->clust);    /* Get current sector */
             if (sect == 0) ABORT(fs, FR_INT_ERR);
             sect += csect;
@@ -3796,45 +3822,45 @@ FRESULT f_write (
                 }
                 if (disk_write(fs->drv, wbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
 #if FF_FS_MINIMIZE <= 2
-#if FF_FS_TINY
-                if (fs->winsect - sect < cc) {  /* Refill sector cache if it gets invalidated by the direct write */
-                    mem_cpy(fs->win, wbuff + ((fs->winsect - sect) * SS(fs)), SS(fs));
-                    fs->wflag = 0;
-                }
-#else
-                if (fp->sect - sect < cc) { /* Refill sector cache if it gets invalidated by the direct write */
-                    mem_cpy(fp->buf, wbuff + ((fp->sect - sect) * SS(fs)), SS(fs));
-                    fp->flag &= (BYTE)~FA_DIRTY;
+                if (FIL_TINY(fp)) {
+                    if (fs->winsect - sect < cc) {  /* Refill sector cache if it gets invalidated by the direct write */
+                        mem_cpy(fs->win, wbuff + ((fs->winsect - sect) * SS(fs)), SS(fs));
+                        fs->wflag = 0;
+                    }
+                } else {
+                    if (fp->sect - sect < cc) { /* Refill sector cache if it gets invalidated by the direct write */
+                        mem_cpy(FIL_BUF(fp), wbuff + ((fp->sect - sect) * SS(fs)), SS(fs));
+                        fp->flag &= (BYTE)~FA_DIRTY;
+                    }
                 }
-#endif
 #endif
                 wcnt = SS(fs) * cc;     /* Number of bytes transferred */
                 continue;
             }
-#if FF_FS_TINY
-            if (fp->fptr >= fp->obj.objsize) {  /* Avoid silly cache filling on the growing edge */
-                if (sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);
-                fs->winsect = sect;
-            }
-#else
-            if (fp->sect != sect &&         /* Fill sector cache with file data */
-                fp->fptr < fp->obj.objsize &&
-                disk_read(fs->drv, fp->buf, sect, 1) != RES_OK) {
-                    ABORT(fs, FR_DISK_ERR);
+            if (FIL_TINY(fp)) {
+                if (fp->fptr >= fp->obj.objsize) {  /* Avoid silly cache filling on the growing edge */
+                    if (sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);
+                    fs->winsect = sect;
+                }
+            } else {
+                if (fp->sect != sect &&         /* Fill sector cache with file data */
+                    fp->fptr < fp->obj.objsize &&
+                    disk_read(fs->drv, FIL_BUF(fp), sect, 1) != RES_OK) {
+                        ABORT(fs, FR_DISK_ERR);
+                }
             }
-#endif
             fp->sect = sect;
         }
         wcnt = SS(fs) - (UINT)fp->fptr % SS(fs);    /* Number of bytes left in the sector */
         if (wcnt > btw) wcnt = btw;                 /* Clip it by btw if needed */
-#if FF_FS_TINY
-        if (move_window(fs, fp->sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window */
-        mem_cpy(fs->win + fp->fptr % SS(fs), wbuff, wcnt);  /* Fit data to the sector */
-        fs->wflag = 1;
-#else
-        mem_cpy(fp->buf + fp->fptr % SS(fs), wbuff, wcnt);  /* Fit data to the sector */
-        fp->flag |= FA_DIRTY;
-#endif
+        if (FIL_TINY(fp)) {
+            if (move_window(fs, fp->sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window */
+            mem_cpy(fs->win + fp->fptr % SS(fs), wbuff, wcnt);  /* Fit data to the sector */
+            fs->wflag = 1;
+        } else {
+            mem_cpy(FIL_BUF(fp) + fp->fptr % SS(fs), wbuff, wcnt);  /* Fit data to the sector */
+            fp->flag |= FA_DIRTY;
+        }
     }
 
     fp->flag |= FA_MODIFIED;                /* Set file change flag */
@@ -3862,12 +3888,10 @@ FRESULT f_sync (
     res = validate(&fp->obj, &fs);  /* Check validity of the file object */
     if (res == FR_OK) {
         if (fp->flag & FA_MODIFIED) {   /* Is there any change to the file? */
-#if !FF_FS_TINY
-            if (fp->flag & FA_DIRTY) {  /* Write-back cached data if needed */
-                if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) LEAVE_FF(fs, FR_DISK_ERR);
+            if (!FIL_TINY(fp) && (fp->flag & FA_DIRTY)) {  /* Write-back cached data if needed */
+                if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) LEAVE_FF(fs, FR_DISK_ERR);
                 fp->flag &= (BYTE)~FA_DIRTY;
             }
-#endif
             /* Update the directory entry */
             tm = GET_FATTIME();             /* Modified time */
 #if FF_FS_EXFAT
@@ -3961,6 +3985,39 @@ FRESULT f_close (
 
 
 
+#if FF_FS_TINY && FF_FS_FILE_BUF
+/*-----------------------------------------------------------------------*/
+/* Attach a Private Sector Buffer to the File                            */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_setbuf (
+    FIL* fp,    /* Pointer to the file object */
+    BYTE* buf   /* Pointer to the sector buffer (FF_MAX_SS bytes) */
+)
+{
+    FRESULT res;
+    FATFS *fs;
+
+
+    res = validate(&fp->obj, &fs);      /* Check validity of the file object */
+    if (res == FR_OK && fp->buf == 0) {
+        if (fp->sect != 0) {            /* Move the current sector from the window into the buffer */
+            res = move_window(fs, fp->sect);
+#if !FF_FS_READONLY
+            if (res == FR_OK) res = sync_window(fs);    /* The window must not write it back later */
+#endif
+            if (res == FR_OK) mem_cpy(buf, fs->win, SS(fs));
+        }
+        if (res == FR_OK) fp->buf = buf;
+    }
+
+    LEAVE_FF(fs, res);
+}
+#endif
+
+
+
+
 #if FF_FS_RPATH >= 1
 /*-----------------------------------------------------------------------*/
 /* Change Current Directory or Current Drive, Get Current Directory      */
@@ -4186,15 +4243,15 @@ FRESULT f_lseek (
                 if (dsc == 0) ABORT(fs, FR_INT_ERR);
                 dsc += (DWORD)((ofs - 1) / SS(fs)) & (fs->csize - 1);
                 if (fp->fptr % SS(fs) && dsc != fp->sect) { /* Refill sector cache if needed */
-#if !FF_FS_TINY
+                    if (!FIL_TINY(fp)) {
 #if !FF_FS_READONLY
-                    if (fp->flag & FA_DIRTY) {      /* Write-back dirty sector cache */
-                        if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
-                        fp->flag &= (BYTE)~FA_DIRTY;
-                    }
-#endif
-                    if (disk_read(fs->drv, fp->buf, dsc, 1) != RES_OK) ABORT(fs, FR_DISK_ERR); /* Load current sector */
+                        if (fp->flag & FA_DIRTY) {      /* Write-back dirty sector cache */
+                            if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+                            fp->flag &= (BYTE)~FA_DIRTY;
+                        }
 #endif
+                        if (disk_read(fs->drv, FIL_BUF(fp), dsc, 1) != RES_OK) ABORT(fs, FR_DISK_ERR); /* Load current sector */
+                    }
                     fp->sect = dsc;
                 }
             }
@@ -4266,15 +4323,15 @@ FRESULT f_lseek (
             fp->flag |= FA_MODIFIED;
         }
         if (fp->fptr % SS(fs) && nsect != fp->sect) {   /* Fill sector cache if needed */
-#if !FF_FS_TINY
+            if (!FIL_TINY(fp)) {
 #if !FF_FS_READONLY
-            if (fp->flag & FA_DIRTY) {          /* Write-back dirty sector cache */
-                if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
-                fp->flag &= (BYTE)~FA_DIRTY;
-            }
-#endif
-            if (disk_read(fs->drv, fp->buf, nsect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);   /* Fill sector cache */
+                if (fp->flag & FA_DIRTY) {          /* Write-back dirty sector cache */
+                    if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+                    fp->flag &= (BYTE)~FA_DIRTY;
+                }
 #endif
+                if (disk_read(fs->drv, FIL_BUF(fp), nsect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);   /* Fill sector cache */
+            }
             fp->sect = nsect;
         }
     }
@@ -4624,15 +4681,13 @@ FRESULT f_truncate (
         }
         fp->obj.objsize = fp->fptr; /* Set file size to current read/write point */
         fp->flag |= FA_MODIFIED;
-#if !FF_FS_TINY
-        if (res == FR_OK && (fp->flag & FA_DIRTY)) {
-            if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) {
+        if (res == FR_OK && !FIL_TINY(fp) && (fp->flag & FA_DIRTY)) {
+            if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) {
                 res = FR_DISK_ERR;
             } else {
                 fp->flag &= (BYTE)~FA_DIRTY;
             }
         }
-#endif
         if (res != FR_OK) ABORT(fs, res);
     }
 
@@ -5384,21 +5439,21 @@ FRESULT f_forward (
         sect = clst2sect(fs, fp->clust);            /* Get current data sector */
         if (sect == 0) ABORT(fs, FR_INT_ERR);
         sect += csect;
-#if FF_FS_TINY
-        if (move_window(fs, sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window to the file data */
-        dbuf = fs->win;
-#else
-        if (fp->sect != sect) {     /* Fill sector cache with file data */
+        if (FIL_TINY(fp)) {
+            if (move_window(fs, sect) != FR_OK) ABORT(fs, FR_DISK_ERR); /* Move sector window to the file data */
+            dbuf = fs->win;
+        } else {
+            if (fp->sect != sect) {     /* Fill sector cache with file data */
 #if !FF_FS_READONLY
-            if (fp->flag & FA_DIRTY) {      /* Write-back dirty sector cache */
-                if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
-                fp->flag &= (BYTE)~FA_DIRTY;
-            }
+                if (fp->flag & FA_DIRTY) {      /* Write-back dirty sector cache */
+                    if (disk_write(fs->drv, FIL_BUF(fp), fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+                    fp->flag &= (BYTE)~FA_DIRTY;
+                }
 #endif
-            if (disk_read(fs->drv, fp->buf, sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+                if (disk_read(fs->drv, FIL_BUF(fp), sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+            }
+            dbuf = FIL_BUF(fp);
         }
-        dbuf = fp->buf;
-#endif
         fp->sect = sect;
         rcnt = SS(fs) - (UINT)fp->fptr % SS(fs);    /* Number of bytes left in the sector */
         if (rcnt > btf) rcnt = btf;                 /* Clip it by btr if needed */
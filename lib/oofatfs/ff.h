@@ -209,6 +209,8 @@ typedef struct {
 #endif
 #if !FF_FS_TINY
     BYTE    buf[FF_MAX_SS]; /* File private data read/write window */
+#elif FF_FS_FILE_BUF
+    BYTE*   buf;            /* Optional private data read/write window (nulled on open, set by f_setbuf) */
 #endif
 } FIL;
 
@@ -287,6 +289,7 @@ FRESULT f_write (FIL* fp, const void* buff, UINT btw, UINT* bw);    /* Write dat
 FRESULT f_lseek (FIL* fp, FSIZE_t ofs);                             /* Move file pointer of the file object */
 FRESULT f_truncate (FIL* fp);                                       /* Truncate the file */
 FRESULT f_sync (FIL* fp);                                           /* Flush cached data of the writing file */
+FRESULT f_setbuf (FIL* fp, BYTE* buf);                              /* Give the file a private sector buffer */
 FRESULT f_opendir (FATFS *fs, FF_DIR* dp, const TCHAR* path);       /* Open a directory */
 FRESULT f_closedir (FF_DIR* dp);                                    /* Close an open directory */
 FRESULT f_readdir (FF_DIR* dp, FILINFO* fno);                       /* Read a directory item */
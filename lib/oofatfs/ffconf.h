@@ -85,7 +85,12 @@
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
+// CIRCUITPY-CHANGE: optional f_expand, for preallocating files
+#ifdef MICROPY_FATFS_USE_EXPAND
+#define FF_USE_EXPAND   MICROPY_FATFS_USE_EXPAND
+#else
 #define FF_USE_EXPAND   0
+#endif
 /* This option switches f_expand function. (0:Disable or 1:Enable) */
 
 
@@ -307,6 +312,16 @@
 /  Instead of private sector buffer eliminated from the file object, common sector
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
+#ifdef MICROPY_FATFS_FILE_BUF
+#define FF_FS_FILE_BUF  (MICROPY_FATFS_FILE_BUF)
+#else
+#define FF_FS_FILE_BUF  0
+#endif
+/* At the tiny configuration, this option (0:Disable or 1:Enable) adds a pointer
+/  to the file object so that f_setbuf() can give a file its own sector buffer.
+/  Files reading or writing through their own buffer don't evict each other's
+/  data from the common buffer, at the cost of FF_MAX_SS bytes per such file. */
+
 
 #ifdef MICROPY_FATFS_EXFAT
 #define FF_FS_EXFAT (MICROPY_FATFS_EXFAT)
@@ -700,7 +700,8 @@ static void block_idct (
 /*-----------------------------------------------------------------------*/
 
 static JRESULT mcu_load (
-	JDEC* jd		/* Pointer to the decompressor object */
+	JDEC* jd,		/* Pointer to the decompressor object */
+	int skip		/* CIRCUITPY-CHANGE: only parse the stream, the MCU will not be output */
 )
 {
 	int32_t *tmp = (int32_t*)jd->workbuf;	/* Block working buffer for de-quantize and IDCT */
@@ -758,7 +759,7 @@ static JRESULT mcu_load (
 				}
 			} while (++z < 64);		/* Next AC element */
 
-			if (JD_FORMAT != 2 || !cmp) {	/* C components may not be processed if in grayscale output */
+			if (!skip && (JD_FORMAT != 2 || !cmp)) {	/* C components may not be processed if in grayscale output */
 				if (z == 1 || (JD_USE_SCALE && jd->scale == 3)) {	/* If no AC element or scale ratio is 1/8, IDCT can be ommited and the block is filled with DC value */
 					d = (jd_yuv_t)((*tmp / 256) + 128);
 					if (JD_FASTDECODE >= 1) {
@@ -983,6 +984,7 @@ JRESULT jd_prepare (
 	jd->sz_pool = sz_pool;	/* Size of given work memory */
 	jd->infunc = infunc;	/* Stream input function */
 	jd->device = dev;		/* I/O device identifier */
+	jd->clip.right = jd->clip.bottom = 0xFFFF;	/* CIRCUITPY-CHANGE: output the whole image by default */
 
 	jd->inbuf = seg = alloc_pool(jd, JD_SZBUF);		/* Allocate stream input buffer */
 	if (!seg) return JDR_MEM1;
@@ -1128,6 +1130,7 @@ JRESULT jd_decomp (
 	unsigned int x, y, mx, my;
 	uint16_t rst, rsc;
 	JRESULT rc;
+	int skip;
 
 
 	if (scale > (JD_USE_SCALE ? 3 : 0)) return JDR_PAR;
@@ -1140,14 +1143,21 @@ JRESULT jd_decomp (
 
 	rc = JDR_OK;
 	for (y = 0; y < jd->height; y += my) {		/* Vertical loop of MCUs */
+		/* CIRCUITPY-CHANGE: nothing below the clip region is needed */
+		if ((y >> scale) > jd->clip.bottom) break;
 		for (x = 0; x < jd->width; x += mx) {	/* Horizontal loop of MCUs */
 			if (jd->nrst && rst++ == jd->nrst) {	/* Process restart interval if enabled */
 				rc = restart(jd, rsc++);
 				if (rc != JDR_OK) return rc;
 				rst = 1;
 			}
-			rc = mcu_load(jd);					/* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
+			/* CIRCUITPY-CHANGE: The huffman stream has to be parsed for every MCU, but
+			   IDCT, color conversion and output are skipped outside the clip region */
+			skip = ((x + mx - 1) >> scale) < jd->clip.left || (x >> scale) > jd->clip.right
+				|| ((y + my - 1) >> scale) < jd->clip.top;
+			rc = mcu_load(jd, skip);			/* Load an MCU (decompress huffman coded stream, dequantize and apply IDCT) */
 			if (rc != JDR_OK) return rc;
+			if (skip) continue;
 			rc = mcu_output(jd, outfunc, x, y);	/* Output the MCU (YCbCr to RGB, scaling and output) */
 			if (rc != JDR_OK) return rc;
 		}
@@ -30,16 +30,22 @@
    They may be altered/distinct from the originals used in PuTTY source
    code. */
 
+#ifndef DEFL_STATIC_H
+#define DEFL_STATIC_H
+
+#include <stdint.h>
+
 struct Outbuf {
-    unsigned char *outbuf;
-    int outlen, outsize;
+    void *dest_write_data;
+    void (*dest_write_cb)(void *data, uint8_t byte);
     unsigned long outbits;
     int noutbits;
-    int comp_disabled;
 };
 
 void outbits(struct Outbuf *out, unsigned long bits, int nbits);
-void zlib_start_block(struct Outbuf *ctx);
-void zlib_finish_block(struct Outbuf *ctx);
-void zlib_literal(struct Outbuf *ectx, unsigned char c);
-void zlib_match(struct Outbuf *ectx, int distance, int len);
+void zlib_start_block(struct Outbuf *out);
+void zlib_finish_block(struct Outbuf *out);
+void zlib_literal(struct Outbuf *out, unsigned char c);
+void zlib_match(struct Outbuf *out, int distance, int len);
+
+#endif // DEFL_STATIC_H
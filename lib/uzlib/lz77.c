@@ -1,14 +1,23 @@
 /*
  * Simple LZ77 streaming compressor.
  *
- * The scheme implemented here doesn't use a hash table and instead does a brute
- * force search in the history for a previous string.  It is relatively slow
- * (but still O(N)) but gives good compression and minimal memory usage.  For a
- * small history window (eg 256 bytes) it's not too slow and compresses well.
+ * Two match finders are provided.  The default one doesn't use a hash table
+ * and instead does a brute force search in the history for a previous string.
+ * It is relatively slow (but still O(N)) but gives good compression and minimal
+ * memory usage.  For a small history window (eg 256 bytes) it's not too slow
+ * and compresses well.
+ *
+ * For larger windows, uzlib_lz77_init_level() enables a hash-chain match
+ * finder: each 3-byte prefix in the window is linked into a chain of earlier
+ * positions with the same hash, and only those candidates are compared.  The
+ * level bounds the length of chain that is walked per search, so the cost per
+ * input byte is bounded regardless of the window size.
  *
  * MIT license; Copyright (c) 2021 Damien P. George
  */
 
+#include <string.h>
+
 #include "uzlib.h"
 
 #include "defl_static.c"
@@ -16,6 +25,23 @@
 #define MATCH_LEN_MIN (3)
 #define MATCH_LEN_MAX (258)
 
+// Per-level search effort: the maximum number of chain entries to compare, and
+// a match length at which the search stops early.
+static const struct {
+    uint16_t max_chain;
+    uint16_t nice_len;
+} uzlib_lz77_levels[UZLIB_LZ77_LEVEL_MAX] = {
+    { 4, 16 },
+    { 8, 16 },
+    { 16, 32 },
+    { 32, 32 },
+    { 64, 64 },
+    { 128, 128 },
+    { 256, MATCH_LEN_MAX },
+    { 1024, MATCH_LEN_MAX },
+    { 4096, MATCH_LEN_MAX },
+};
+
 // hist should be a preallocated buffer of hist_max size bytes.
 // hist_max should be greater than 0 a power of 2 (ie 1, 2, 4, 8, ...).
 // It's possible to pass in hist=NULL, and then the history window will be taken from the
@@ -28,6 +54,41 @@ void uzlib_lz77_init(uzlib_lz77_state_t *state, uint8_t *hist, size_t hist_max)
     state->hist_len = 0;
 }
 
+// Return the number of hash bits to use for the given level and window size.
+// The caller must provide a hash_head table of (1 << bits) entries.
+unsigned int uzlib_lz77_hash_bits(int level, size_t hist_max) {
+    if (level < UZLIB_LZ77_LEVEL_MIN) {
+        level = UZLIB_LZ77_LEVEL_MIN;
+    } else if (level > UZLIB_LZ77_LEVEL_MAX) {
+        level = UZLIB_LZ77_LEVEL_MAX;
+    }
+    unsigned int bits = 8 + level / 2;
+    // More buckets than window positions just wastes RAM.
+    while (bits > 5 && ((size_t)1 << (bits - 1)) >= hist_max) {
+        --bits;
+    }
+    return bits;
+}
+
+// Switch the state (after uzlib_lz77_init) to use the hash-chain match finder.
+// hash_head must have (1 << hash_bits) entries and hash_prev must have hist_max
+// entries.  hist_max must be at most 32768.
+void uzlib_lz77_init_level(uzlib_lz77_state_t *state, int level, uint16_t *hash_head, unsigned int hash_bits, uint16_t *hash_prev) {
+    if (level < UZLIB_LZ77_LEVEL_MIN) {
+        level = UZLIB_LZ77_LEVEL_MIN;
+    } else if (level > UZLIB_LZ77_LEVEL_MAX) {
+        level = UZLIB_LZ77_LEVEL_MAX;
+    }
+    state->hash_head = hash_head;
+    state->hash_prev = hash_prev;
+    state->hash_bits = hash_bits;
+    state->max_chain = uzlib_lz77_levels[level - 1].max_chain;
+    state->nice_len = uzlib_lz77_levels[level - 1].nice_len;
+    state->pos = 0;
+    state->hash_pos = 0;
+    memset(hash_head, 0, sizeof(uint16_t) << hash_bits);
+}
+
 // Search back in the history for the maximum match of the given src data,
 // with support for searching beyond the end of the history and into the src buffer
 // (effectively the history and src buffer are concatenated).
@@ -60,24 +121,124 @@ static size_t uzlib_lz77_search_max_match(uzlib_lz77_state_t *state, const uint8
     return longest_len;
 }
 
+// Return the byte at absolute input position p, where src holds the byte at
+// state->pos.  p must be within the history window or the src buffer.
+static inline uint8_t uzlib_lz77_byte_at(uzlib_lz77_state_t *state, const uint8_t *src, size_t p) {
+    if (p < state->pos) {
+        return state->hist_buf[p & (state->hist_max - 1)];
+    }
+    return src[p - state->pos];
+}
+
+static inline unsigned int uzlib_lz77_hash(uzlib_lz77_state_t *state, uint8_t b0, uint8_t b1, uint8_t b2) {
+    uint32_t v = b0 | b1 << 8 | (uint32_t)b2 << 16;
+    return (v * 0x9e3779b1) >> (32 - state->hash_bits);
+}
+
+// Length of the match between src and the string dist bytes back from it, up
+// to limit bytes.  The string may run from the history window into src.
+static size_t uzlib_lz77_match_len(uzlib_lz77_state_t *state, const uint8_t *src, size_t dist, size_t limit) {
+    size_t mask = state->hist_max - 1;
+    size_t hist_pos = state->pos - dist;
+    size_t in_hist = dist < limit ? dist : limit;
+    size_t n = 0;
+    while (n < in_hist && state->hist_buf[(hist_pos + n) & mask] == src[n]) {
+        ++n;
+    }
+    if (n < in_hist) {
+        return n;
+    }
+    const uint8_t *p = src + n - dist;
+    while (n < limit && *p == src[n]) {
+        ++p;
+        ++n;
+    }
+    return n;
+}
+
+// Hash-chain version of uzlib_lz77_search_max_match: only positions with the
+// same 3-byte hash are compared, nearest first, for at most max_chain entries.
+static size_t uzlib_lz77_search_hash_chain(uzlib_lz77_state_t *state, const uint8_t *src, size_t len, size_t *longest_offset) {
+    size_t mask = state->hist_max - 1;
+    size_t end = state->pos + len;
+
+    // Link any positions before this one (that now have 3 bytes available)
+    // into their chains.  Positions that already left the window are skipped.
+    if (state->hash_pos + state->hist_len < state->pos) {
+        state->hash_pos = state->pos - state->hist_len;
+    }
+    while (state->hash_pos < state->pos && state->hash_pos + 2 < end) {
+        size_t p = state->hash_pos++;
+        unsigned int h = uzlib_lz77_hash(state,
+            uzlib_lz77_byte_at(state, src, p),
+            uzlib_lz77_byte_at(state, src, p + 1),
+            uzlib_lz77_byte_at(state, src, p + 2));
+        state->hash_prev[p & mask] = state->hash_head[h];
+        state->hash_head[h] = (uint16_t)p;
+    }
+
+    size_t limit = len < MATCH_LEN_MAX ? len : MATCH_LEN_MAX;
+    if (limit < MATCH_LEN_MIN) {
+        return 0;
+    }
+
+    size_t longest_len = 0;
+    size_t prev_dist = 0;
+    uint16_t cand = state->hash_head[uzlib_lz77_hash(state, src[0], src[1], src[2])];
+    for (unsigned int chain = state->max_chain; chain > 0; --chain) {
+        // Entries are 16-bit positions, so stale ones can alias; requiring the
+        // distance to strictly increase along the chain guarantees termination.
+        size_t dist = (uint16_t)((uint16_t)state->pos - cand);
+        if (dist <= prev_dist || dist > state->hist_len) {
+            break;
+        }
+        prev_dist = dist;
+
+        // Cheap reject: a longer match must also agree on the byte just past
+        // the current longest.
+        if (uzlib_lz77_byte_at(state, src, state->pos - dist + longest_len) == src[longest_len]) {
+            size_t match_len = uzlib_lz77_match_len(state, src, dist, limit);
+            // Only strictly longer matches are taken, so for equal lengths the
+            // nearest one (found first) is kept.
+            if (match_len >= MATCH_LEN_MIN && match_len > longest_len) {
+                longest_len = match_len;
+                *longest_offset = dist;
+                if (match_len >= state->nice_len || match_len >= limit) {
+                    break;
+                }
+            }
+        }
+
+        cand = state->hash_prev[(state->pos - dist) & mask];
+    }
+
+    return longest_len;
+}
+
 // Compress the given chunk of data.
 void uzlib_lz77_compress(uzlib_lz77_state_t *state, const uint8_t *src, unsigned len) {
     const uint8_t *top = src + len;
     while (src < top) {
         // Look for a match in the history window.
         size_t match_offset = 0;
-        size_t match_len = uzlib_lz77_search_max_match(state, src, top - src, &match_offset);
+        size_t match_len;
+        if (state->hash_head != NULL) {
+            match_len = uzlib_lz77_search_hash_chain(state, src, top - src, &match_offset);
+        } else {
+            match_len = uzlib_lz77_search_max_match(state, src, top - src, &match_offset);
+        }
 
         // Encode the literal byte or the match.
         if (match_len == 0) {
-            uzlib_literal(state, *src);
+            zlib_literal(&state->outbuf, *src);
             match_len = 1;
         } else {
-            uzlib_match(state, match_offset, match_len);
+            zlib_match(&state->outbuf, match_offset, match_len);
         }
 
         // Push the bytes into the history buffer.
         size_t mask = state->hist_max - 1;
+        state->pos += match_len;
         while (match_len--) {
             uint8_t b = *src++;
             state->hist_buf[(state->hist_start + state->hist_len) & mask] = b;
@@ -89,3 +250,11 @@ void uzlib_lz77_compress(uzlib_lz77_state_t *state, const uint8_t *src, unsigned
         }
     }
 }
+
+void uzlib_start_block(uzlib_lz77_state_t *state) {
+    zlib_start_block(&state->outbuf);
+}
+
+void uzlib_finish_block(uzlib_lz77_state_t *state) {
+    zlib_finish_block(&state->outbuf);
+}
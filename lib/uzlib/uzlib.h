@@ -157,6 +157,44 @@ struct uzlib_comp {
 
 void TINFCC uzlib_compress(struct uzlib_comp *c, const uint8_t *src, unsigned slen);
 
+/* Streaming LZ77 compression API */
+
+/* Compression levels select the hash-chain search effort (and hash table
+   size), trading speed and RAM for compression ratio. */
+#define UZLIB_LZ77_LEVEL_MIN 1
+#define UZLIB_LZ77_LEVEL_MAX 9
+
+typedef struct _uzlib_lz77_state_t {
+    struct Outbuf outbuf;
+
+    uint8_t *hist_buf;
+    size_t hist_max;
+    size_t hist_start;
+    size_t hist_len;
+
+    /* Hash-chain match finder.  hash_head has (1 << hash_bits) entries and
+       hash_prev has hist_max entries; both hold the low 16 bits of absolute
+       input positions.  If hash_head is NULL then a brute force search of the
+       history window is used instead. */
+    uint16_t *hash_head;
+    uint16_t *hash_prev;
+    unsigned int hash_bits;
+    unsigned int max_chain;
+    unsigned int nice_len;
+    /* Absolute position of the next input byte, and of the next position
+       still to be inserted into the hash chains. */
+    size_t pos;
+    size_t hash_pos;
+} uzlib_lz77_state_t;
+
+void TINFCC uzlib_lz77_init(uzlib_lz77_state_t *state, uint8_t *hist, size_t hist_max);
+unsigned int TINFCC uzlib_lz77_hash_bits(int level, size_t hist_max);
+void TINFCC uzlib_lz77_init_level(uzlib_lz77_state_t *state, int level, uint16_t *hash_head, unsigned int hash_bits, uint16_t *hash_prev);
+void TINFCC uzlib_lz77_compress(uzlib_lz77_state_t *state, const uint8_t *src, unsigned len);
+
+void TINFCC uzlib_start_block(uzlib_lz77_state_t *state);
+void TINFCC uzlib_finish_block(uzlib_lz77_state_t *state);
+
 /* Checksum API */
 
 /* prev_sum is previous value for incremental computation, 1 initially */
@@ -86,6 +86,9 @@ SUPEROPT_VM = 0
 
 CIRCUITPY_LTO_PARTITION = one
 
+# Cache only one sector of external flash in ram to leave room for the heap.
+CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS ?= 1
+
 # On smaller builds this saves about 180 bytes. On other boards, it may -increase- space used, so use with care.
 CFLAGS_BOARD = -fweb -frename-registers
 
@@ -5,6 +5,11 @@ MCU_CHIP = nrf52840
 SPI_FLASH_FILESYSTEM = 1
 EXTERNAL_FLASH_DEVICES = "XT25F64B,GD25Q64C"
 
+# Only reached over BLE and the serial REPL, so no host needs to read
+# CIRCUITPY: keep it on littlefs, through the flash translation layer.
+CIRCUITPY_EXTERNAL_FLASH_FTL = 1
+CIRCUITPY_FILESYSTEM_LITTLEFS = 1
+
 CIRCUITPY_FULL_BUILD = 1
 
 # Modules that aren't useful on the board.
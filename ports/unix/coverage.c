@@ -693,6 +693,30 @@ static mp_obj_t extra_coverage(void) {
         ringbuf_clear(&ringbuf);
         ringbuf_put(&ringbuf, 0xaa);
         mp_printf(&mp_plat_print, "%d\n", ringbuf_get16(&ringbuf));
+
+        // Bulk put/get that wraps around the end of the buffer.
+        ringbuf_clear(&ringbuf);
+        byte data[RINGBUF_SIZE + 1];
+        for (int i = 0; i < RINGBUF_SIZE + 1; ++i) {
+            data[i] = i;
+        }
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_put_n(&ringbuf, data, 90));
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_get_n(&ringbuf, data, 80));
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_put_n(&ringbuf, data, RINGBUF_SIZE + 1));
+        mp_printf(&mp_plat_print, "%d %d\n", ringbuf_num_empty(&ringbuf), ringbuf_num_filled(&ringbuf));
+        memset(data, 0, sizeof(data));
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_get_n(&ringbuf, data, sizeof(data)));
+        mp_printf(&mp_plat_print, "%d %d %d %d\n", data[0], data[9], data[10], data[98]);
+
+        // Contiguous spans stop at the end of the buffer.
+        const byte *get_span;
+        byte *put_span;
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_put_span(&ringbuf, &put_span));
+        ringbuf_put_advance(&ringbuf, 10);
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_put_span(&ringbuf, &put_span));
+        mp_printf(&mp_plat_print, "%d\n", (int)ringbuf_get_span(&ringbuf, &get_span));
+        ringbuf_get_advance(&ringbuf, 10);
+        mp_printf(&mp_plat_print, "%d %d\n", ringbuf_num_empty(&ringbuf), ringbuf_num_filled(&ringbuf));
     }
 
     // pairheap
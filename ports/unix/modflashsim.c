@@ -0,0 +1,749 @@
+// This file is part of the CircuitPython project: https://circuitpython.org
+//
+// SPDX-FileCopyrightText: Copyright (c) 2025 Adafruit Industries LLC
+//
+// SPDX-License-Identifier: MIT
+
+// A block device that behaves like NOR flash (or an SD card), for measuring
+// the storage stack on the host. Bits can only be programmed from 1 to 0,
+// erasing works on whole erase sectors, and every operation is charged a
+// configurable latency against a virtual clock, so results are repeatable.
+//
+// This is a model only. The filesystems and VFS above it are the real code,
+// but the sector cache below stands in for supervisor/shared/external_flash
+// rather than running it, so changes to that driver are not seen here unless
+// the model is updated to match. Its flash translation layer is the exception:
+// flashsim.FTL runs supervisor/shared/external_flash/ftl.c itself on top of a
+// BlockDevice, and can cut the power part way through a program or erase.
+
+#if MICROPY_PY_FLASHSIM
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "py/mperrno.h"
+#include "py/runtime.h"
+#include "extmod/vfs.h"
+#include "supervisor/shared/external_flash/ftl.h"
+
+typedef struct _flashsim_obj_t {
+    mp_obj_base_t base;
+    // The flash itself lives outside the GC heap, which is too small (and, when
+    // split, too fragmented) to hold a useful device.
+    uint8_t *data;
+    uint32_t block_count;
+    uint32_t block_size;
+    // 0 for media that manage erasing themselves, such as SD cards.
+    uint32_t erase_size;
+    uint32_t page_size;
+    uint32_t *erase_counts;
+    // Latencies in microseconds.
+    uint32_t command_us;
+    uint32_t read_us;
+    uint32_t program_us;
+    uint32_t erase_us;
+    // Write-back cache of whole erase sectors, modelled on the one the
+    // supervisor's external flash driver keeps when its translation layer is
+    // off.
+    uint8_t *cache;
+    uint32_t *cache_sector;
+    uint32_t *cache_last_used;
+    bool *cache_dirty;
+    // Pages of each cached sector whose contents are in the cache. As in the
+    // driver, they are only read in when written or when the sector is
+    // flushed.
+    bool *cache_loaded;
+    uint32_t cache_count;
+    uint32_t cache_clock;
+    // Statistics.
+    uint64_t elapsed_us;
+    uint32_t commands;
+    uint32_t reads;
+    uint32_t programs;
+    uint32_t erases;
+    uint32_t overwrites;
+} flashsim_obj_t;
+
+#define NO_SECTOR (0xffffffff)
+
+static uint32_t flashsim_size(flashsim_obj_t *self) {
+    return self->block_count * self->block_size;
+}
+
+static uint32_t flashsim_sector_count(flashsim_obj_t *self) {
+    return self->erase_size ? flashsim_size(self) / self->erase_size : 0;
+}
+
+static void flashsim_erase_sector(flashsim_obj_t *self, uint32_t sector) {
+    memset(self->data + sector * self->erase_size, 0xff, self->erase_size);
+    self->erase_counts[sector]++;
+    self->erases++;
+    self->elapsed_us += self->erase_us;
+}
+
+// Program len bytes at addr. Pages are charged individually, and on NOR any
+// attempt to set a programmed bit back to 1 is counted and, as on the real
+// part, has no effect.
+static void flashsim_program(flashsim_obj_t *self, uint32_t addr, const uint8_t *src, size_t len) {
+    uint8_t *dest = self->data + addr;
+    bool overwrite = false;
+    if (self->erase_size) {
+        for (size_t i = 0; i < len; i++) {
+            overwrite |= (dest[i] & src[i]) != src[i];
+            dest[i] &= src[i];
+        }
+    } else {
+        memcpy(dest, src, len);
+    }
+    if (overwrite) {
+        self->overwrites++;
+    }
+    uint32_t pages = (addr + len + self->page_size - 1) / self->page_size - addr / self->page_size;
+    self->programs += pages;
+    self->elapsed_us += (uint64_t)pages * self->program_us;
+}
+
+static void flashsim_read(flashsim_obj_t *self, uint32_t addr, uint8_t *dest, size_t len) {
+    memcpy(dest, self->data + addr, len);
+    uint32_t blocks = (addr + len + self->block_size - 1) / self->block_size - addr / self->block_size;
+    self->reads += blocks;
+    self->elapsed_us += (uint64_t)blocks * self->read_us;
+}
+
+static void flashsim_command(flashsim_obj_t *self) {
+    self->commands++;
+    self->elapsed_us += self->command_us;
+}
+
+// Erase a sector and program back every page that isn't blank.
+static void flashsim_rewrite_sector(flashsim_obj_t *self, uint32_t sector, const uint8_t *src) {
+    flashsim_command(self);
+    flashsim_erase_sector(self, sector);
+    uint32_t addr = sector * self->erase_size;
+    for (uint32_t offset = 0; offset < self->erase_size; offset += self->page_size) {
+        const uint8_t *page = src + offset;
+        for (uint32_t i = 0; i < self->page_size; i++) {
+            if (page[i] != 0xff) {
+                flashsim_program(self, addr + offset, page, self->page_size);
+                break;
+            }
+        }
+    }
+}
+
+static uint32_t flashsim_sector_pages(flashsim_obj_t *self) {
+    return self->erase_size / self->page_size;
+}
+
+// Read the pages in [first, last) of cache entry i that aren't loaded yet.
+static void flashsim_load_cache(flashsim_obj_t *self, uint32_t i, uint32_t first, uint32_t last) {
+    bool *loaded = self->cache_loaded + i * flashsim_sector_pages(self);
+    bool command = false;
+    for (uint32_t page = first; page < last; page++) {
+        if (loaded[page]) {
+            continue;
+        }
+        if (!command) {
+            flashsim_command(self);
+            command = true;
+        }
+        uint32_t offset = page * self->page_size;
+        flashsim_read(self, self->cache_sector[i] * self->erase_size + offset,
+            self->cache + i * self->erase_size + offset, self->page_size);
+        loaded[page] = true;
+    }
+}
+
+// Afterwards the whole sector is loaded and clean, so it can stay cached.
+static void flashsim_flush_cache(flashsim_obj_t *self, uint32_t i) {
+    if (self->cache_dirty[i]) {
+        flashsim_load_cache(self, i, 0, flashsim_sector_pages(self));
+        flashsim_rewrite_sector(self, self->cache_sector[i], self->cache + i * self->erase_size);
+        self->cache_dirty[i] = false;
+    }
+}
+
+static void flashsim_flush(flashsim_obj_t *self) {
+    for (uint32_t i = 0; i < self->cache_count; i++) {
+        flashsim_flush_cache(self, i);
+    }
+}
+
+// Write back and forget any cached sectors in [addr, addr + len), before the
+// flash underneath them is changed directly.
+static void flashsim_drop_cache(flashsim_obj_t *self, uint32_t addr, size_t len) {
+    for (uint32_t i = 0; i < self->cache_count; i++) {
+        uint32_t start = self->cache_sector[i] * self->erase_size;
+        if (self->cache_sector[i] != NO_SECTOR && start < addr + len && addr < start + self->erase_size) {
+            flashsim_flush_cache(self, i);
+            self->cache_sector[i] = NO_SECTOR;
+        }
+    }
+}
+
+// Return the cache entry holding the given sector, or -1, without counting it
+// as used.
+static int32_t flashsim_peek_cache(flashsim_obj_t *self, uint32_t sector) {
+    for (uint32_t i = 0; i < self->cache_count; i++) {
+        if (self->cache_sector[i] == sector) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Give a sector a cache entry, evicting the least recently used one. None of
+// its pages are loaded yet.
+static uint32_t flashsim_claim_cache(flashsim_obj_t *self, uint32_t sector) {
+    uint32_t victim = 0;
+    for (uint32_t i = 1; i < self->cache_count; i++) {
+        if (self->cache_last_used[i] < self->cache_last_used[victim]) {
+            victim = i;
+        }
+    }
+    flashsim_flush_cache(self, victim);
+    self->cache_sector[victim] = sector;
+    memset(self->cache_loaded + victim * flashsim_sector_pages(self), false, flashsim_sector_pages(self));
+    self->cache_last_used[victim] = ++self->cache_clock;
+    return victim;
+}
+
+static mp_obj_t flashsim_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_block_count, ARG_block_size, ARG_erase_size, ARG_page_size, ARG_cache_sectors,
+           ARG_command_us, ARG_read_us, ARG_program_us, ARG_erase_us };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_block_count, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_block_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 512} },
+        { MP_QSTR_erase_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 4096} },
+        { MP_QSTR_page_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 256} },
+        { MP_QSTR_cache_sectors, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1} },
+        { MP_QSTR_command_us, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_read_us, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_program_us, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_erase_us, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t block_count = mp_arg_validate_int_min(args[ARG_block_count].u_int, 1, MP_QSTR_block_count);
+    mp_int_t block_size = mp_arg_validate_int_min(args[ARG_block_size].u_int, 1, MP_QSTR_block_size);
+    mp_int_t erase_size = mp_arg_validate_int_min(args[ARG_erase_size].u_int, 0, MP_QSTR_erase_size);
+    mp_int_t page_size = mp_arg_validate_int_min(args[ARG_page_size].u_int, 1, MP_QSTR_page_size);
+    mp_int_t cache_sectors = mp_arg_validate_int_min(args[ARG_cache_sectors].u_int, 0, MP_QSTR_cache_sectors);
+    if (erase_size) {
+        // Blocks must tile erase sectors, and erase sectors the device.
+        if ((erase_size % block_size && block_size % erase_size)
+            || erase_size % page_size
+            || ((mp_uint_t)block_count * block_size) % erase_size) {
+            mp_raise_ValueError(NULL);
+        }
+    } else {
+        cache_sectors = 0;
+    }
+
+    flashsim_obj_t *self = mp_obj_malloc_with_finaliser(flashsim_obj_t, type);
+    self->block_count = block_count;
+    self->block_size = block_size;
+    self->erase_size = erase_size;
+    self->page_size = page_size;
+    self->command_us = args[ARG_command_us].u_int;
+    self->read_us = args[ARG_read_us].u_int;
+    self->program_us = args[ARG_program_us].u_int;
+    self->erase_us = args[ARG_erase_us].u_int;
+    self->data = malloc(flashsim_size(self));
+    if (self->data == NULL) {
+        m_malloc_fail(flashsim_size(self));
+    }
+    // Fresh flash reads as erased.
+    memset(self->data, erase_size ? 0xff : 0, flashsim_size(self));
+    self->erase_counts = m_new0(uint32_t, flashsim_sector_count(self));
+    self->cache_count = cache_sectors;
+    if (cache_sectors) {
+        self->cache = m_new(uint8_t, cache_sectors * erase_size);
+        self->cache_sector = m_new(uint32_t, cache_sectors);
+        self->cache_last_used = m_new0(uint32_t, cache_sectors);
+        self->cache_dirty = m_new0(bool, cache_sectors);
+        self->cache_loaded = m_new0(bool, cache_sectors * (erase_size / page_size));
+        for (mp_int_t i = 0; i < cache_sectors; i++) {
+            self->cache_sector[i] = NO_SECTOR;
+        }
+    }
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static mp_obj_t flashsim_del(mp_obj_t self_in) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    free(self->data);
+    self->data = NULL;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_del_obj, flashsim_del);
+
+static void flashsim_check_range(flashsim_obj_t *self, mp_int_t block_num, mp_int_t offset, size_t len) {
+    uint64_t addr = (uint64_t)block_num * self->block_size + offset;
+    if (block_num < 0 || offset < 0 || addr + len > flashsim_size(self)) {
+        mp_raise_OSError(MP_EIO);
+    }
+}
+
+// readblocks(block_num, buf, offset=0)
+static mp_obj_t flashsim_readblocks(size_t n_args, const mp_obj_t *args) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t block_num = mp_obj_get_int(args[1]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[2], &bufinfo, MP_BUFFER_WRITE);
+    mp_int_t offset = n_args == 4 ? mp_obj_get_int(args[3]) : 0;
+    flashsim_check_range(self, block_num, offset, bufinfo.len);
+
+    uint32_t addr = block_num * self->block_size + offset;
+    uint8_t *dest = bufinfo.buf;
+    size_t len = bufinfo.len;
+    bool command = false;
+    // Pages not loaded in the cache are read from flash in runs. Passing over
+    // a cached sector doesn't count as using it, only reading from it does.
+    uint32_t run_addr = addr;
+    size_t run_len = 0;
+    while (len > 0) {
+        uint32_t chunk = self->cache_count ? self->page_size - addr % self->page_size : len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        int32_t i = self->cache_count ? flashsim_peek_cache(self, addr / self->erase_size) : -1;
+        uint32_t sector_offset = self->erase_size ? addr % self->erase_size : 0;
+        if (i >= 0 && self->cache_loaded[i * flashsim_sector_pages(self) + sector_offset / self->page_size]) {
+            if (run_len > 0) {
+                flashsim_read(self, run_addr, dest - run_len, run_len);
+                run_len = 0;
+            }
+            self->cache_last_used[i] = ++self->cache_clock;
+            memcpy(dest, self->cache + i * self->erase_size + sector_offset, chunk);
+        } else {
+            if (!command) {
+                flashsim_command(self);
+                command = true;
+            }
+            if (run_len == 0) {
+                run_addr = addr;
+            }
+            run_len += chunk;
+        }
+        addr += chunk;
+        dest += chunk;
+        len -= chunk;
+    }
+    if (run_len > 0) {
+        flashsim_read(self, run_addr, dest - run_len, run_len);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(flashsim_readblocks_obj, 3, 4, flashsim_readblocks);
+
+// writeblocks(block_num, buf, offset=None)
+// Without an offset the sectors are erased as needed, through the cache. With
+// one (the extended block protocol) the data is programmed as is, and it is up
+// to the caller to have erased it with ioctl(BLOCK_ERASE) first.
+static mp_obj_t flashsim_writeblocks(size_t n_args, const mp_obj_t *args) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t block_num = mp_obj_get_int(args[1]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[2], &bufinfo, MP_BUFFER_READ);
+    bool raw = n_args == 4 || self->erase_size == 0;
+    mp_int_t offset = n_args == 4 ? mp_obj_get_int(args[3]) : 0;
+    flashsim_check_range(self, block_num, offset, bufinfo.len);
+
+    uint32_t addr = block_num * self->block_size + offset;
+    const uint8_t *src = bufinfo.buf;
+    size_t len = bufinfo.len;
+    if (raw) {
+        flashsim_drop_cache(self, addr, len);
+        flashsim_command(self);
+        flashsim_program(self, addr, src, len);
+        return mp_const_none;
+    }
+    while (len > 0) {
+        uint32_t sector = addr / self->erase_size;
+        uint32_t sector_offset = addr % self->erase_size;
+        uint32_t chunk = self->erase_size - sector_offset;
+        if (chunk > len) {
+            chunk = len;
+        }
+        if (self->cache_count == 0) {
+            // No cache: read-modify-write the whole sector straight away.
+            uint8_t *buf = m_new(uint8_t, self->erase_size);
+            flashsim_command(self);
+            flashsim_read(self, sector * self->erase_size, buf, self->erase_size);
+            memcpy(buf + sector_offset, src, chunk);
+            flashsim_rewrite_sector(self, sector, buf);
+            m_del(uint8_t, buf, self->erase_size);
+        } else {
+            int32_t found = flashsim_peek_cache(self, sector);
+            uint32_t i;
+            if (found < 0) {
+                i = flashsim_claim_cache(self, sector);
+            } else {
+                i = found;
+                self->cache_last_used[i] = ++self->cache_clock;
+            }
+            // Pages only partly written need the rest of their contents.
+            uint32_t first = sector_offset / self->page_size;
+            uint32_t last = (sector_offset + chunk + self->page_size - 1) / self->page_size;
+            if (sector_offset % self->page_size) {
+                flashsim_load_cache(self, i, first, first + 1);
+            }
+            if ((sector_offset + chunk) % self->page_size) {
+                flashsim_load_cache(self, i, last - 1, last);
+            }
+            memcpy(self->cache + i * self->erase_size + sector_offset, src, chunk);
+            memset(self->cache_loaded + i * flashsim_sector_pages(self) + first, true, last - first);
+            self->cache_dirty[i] = true;
+        }
+        addr += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(flashsim_writeblocks_obj, 3, 4, flashsim_writeblocks);
+
+static mp_obj_t flashsim_ioctl(mp_obj_t self_in, mp_obj_t cmd_in, mp_obj_t arg_in) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (mp_obj_get_int(cmd_in)) {
+        case MP_BLOCKDEV_IOCTL_INIT:
+            return MP_OBJ_NEW_SMALL_INT(0);
+        case MP_BLOCKDEV_IOCTL_DEINIT:
+        case MP_BLOCKDEV_IOCTL_SYNC:
+            flashsim_flush(self);
+            return MP_OBJ_NEW_SMALL_INT(0);
+        case MP_BLOCKDEV_IOCTL_BLOCK_COUNT:
+            return MP_OBJ_NEW_SMALL_INT(self->block_count);
+        case MP_BLOCKDEV_IOCTL_BLOCK_SIZE:
+            return MP_OBJ_NEW_SMALL_INT(self->block_size);
+        case MP_BLOCKDEV_IOCTL_BLOCK_ERASE: {
+            mp_int_t block_num = mp_obj_get_int(arg_in);
+            flashsim_check_range(self, block_num, 0, self->block_size);
+            if (self->erase_size) {
+                // Flash can't erase less than a sector, and erasing the whole
+                // one would wipe the blocks that share it.
+                if (self->block_size < self->erase_size) {
+                    return MP_OBJ_NEW_SMALL_INT(-MP_EINVAL);
+                }
+                uint32_t addr = block_num * self->block_size;
+                uint32_t end = addr + self->block_size;
+                flashsim_drop_cache(self, addr, end - addr);
+                flashsim_command(self);
+                for (; addr < end; addr += self->erase_size) {
+                    flashsim_erase_sector(self, addr / self->erase_size);
+                }
+            }
+            return MP_OBJ_NEW_SMALL_INT(0);
+        }
+        default:
+            return mp_const_none;
+    }
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(flashsim_ioctl_obj, flashsim_ioctl);
+
+static mp_obj_t flashsim_stats(mp_obj_t self_in) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t dict = mp_obj_new_dict(6);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_elapsed_us), mp_obj_new_int_from_ull(self->elapsed_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_commands), mp_obj_new_int_from_uint(self->commands));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_reads), mp_obj_new_int_from_uint(self->reads));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_programs), mp_obj_new_int_from_uint(self->programs));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_erases), mp_obj_new_int_from_uint(self->erases));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_overwrites), mp_obj_new_int_from_uint(self->overwrites));
+    return dict;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_stats_obj, flashsim_stats);
+
+// Clears the statistics. Erase counts are kept, since wear accumulates.
+static mp_obj_t flashsim_reset_stats(mp_obj_t self_in) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    self->elapsed_us = 0;
+    self->commands = 0;
+    self->reads = 0;
+    self->programs = 0;
+    self->erases = 0;
+    self->overwrites = 0;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_reset_stats_obj, flashsim_reset_stats);
+
+// wear() returns (min, max, total) erase counts over all erase sectors, and
+// wear(sector) the count for one sector.
+static mp_obj_t flashsim_wear(size_t n_args, const mp_obj_t *args) {
+    flashsim_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    uint32_t sector_count = flashsim_sector_count(self);
+    if (n_args == 2) {
+        mp_uint_t sector = mp_obj_get_int(args[1]);
+        if (sector >= sector_count) {
+            mp_raise_ValueError(NULL);
+        }
+        return mp_obj_new_int_from_uint(self->erase_counts[sector]);
+    }
+    uint32_t min = sector_count ? UINT32_MAX : 0;
+    uint32_t max = 0;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < sector_count; i++) {
+        uint32_t count = self->erase_counts[i];
+        min = MIN(min, count);
+        max = MAX(max, count);
+        total += count;
+    }
+    mp_obj_t items[3] = {
+        mp_obj_new_int_from_uint(min),
+        mp_obj_new_int_from_uint(max),
+        mp_obj_new_int_from_ull(total),
+    };
+    return mp_obj_new_tuple(3, items);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(flashsim_wear_obj, 1, 2, flashsim_wear);
+
+static const mp_rom_map_elem_t flashsim_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&flashsim_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readblocks), MP_ROM_PTR(&flashsim_readblocks_obj) },
+    { MP_ROM_QSTR(MP_QSTR_writeblocks), MP_ROM_PTR(&flashsim_writeblocks_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ioctl), MP_ROM_PTR(&flashsim_ioctl_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&flashsim_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats), MP_ROM_PTR(&flashsim_reset_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wear), MP_ROM_PTR(&flashsim_wear_obj) },
+};
+static MP_DEFINE_CONST_DICT(flashsim_locals_dict, flashsim_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(
+    flashsim_type,
+    MP_QSTR_BlockDevice,
+    MP_TYPE_FLAG_NONE,
+    make_new, flashsim_make_new,
+    locals_dict, &flashsim_locals_dict
+    );
+
+/******************************************************************************/
+// FTL class
+
+typedef struct _flashsim_ftl_obj_t {
+    mp_obj_base_t base;
+    flashsim_obj_t *dev;
+    // The translation layer's tables, outside the GC heap like the flash.
+    void *ram;
+    // Programs and erases left before the power is cut, or -1 for never.
+    mp_int_t power_ops;
+    bool powered;
+} flashsim_ftl_obj_t;
+
+// ftl.c has a single translation layer, so only one FTL object is mounted at a
+// time. Using another mounts that one instead, as a reset would.
+static flashsim_ftl_obj_t *flashsim_ftl_mounted;
+
+// Whether the next program or erase reaches the flash. The one that the power
+// is cut during only gets half way, and nothing after it happens at all.
+static bool flashsim_ftl_power(bool *torn) {
+    flashsim_ftl_obj_t *self = flashsim_ftl_mounted;
+    *torn = false;
+    if (!self->powered) {
+        return false;
+    }
+    if (self->power_ops >= 0 && self->power_ops-- == 0) {
+        self->powered = false;
+        *torn = true;
+    }
+    return true;
+}
+
+bool ftl_flash_read(uint32_t address, uint8_t *data, uint32_t length) {
+    flashsim_obj_t *dev = flashsim_ftl_mounted->dev;
+    if (!flashsim_ftl_mounted->powered || address + length > flashsim_size(dev)) {
+        return false;
+    }
+    flashsim_command(dev);
+    flashsim_read(dev, address, data, length);
+    return true;
+}
+
+bool ftl_flash_program(uint32_t address, const uint8_t *data, uint32_t length) {
+    flashsim_obj_t *dev = flashsim_ftl_mounted->dev;
+    bool torn;
+    if (address + length > flashsim_size(dev) || !flashsim_ftl_power(&torn)) {
+        return false;
+    }
+    flashsim_command(dev);
+    flashsim_program(dev, address, data, torn ? length / 2 : length);
+    return !torn;
+}
+
+bool ftl_flash_erase(uint32_t address) {
+    flashsim_obj_t *dev = flashsim_ftl_mounted->dev;
+    bool torn;
+    if (address % dev->erase_size || address >= flashsim_size(dev) || !flashsim_ftl_power(&torn)) {
+        return false;
+    }
+    flashsim_command(dev);
+    if (torn) {
+        memset(dev->data + address, 0xff, dev->erase_size / 2);
+        return false;
+    }
+    flashsim_erase_sector(dev, address / dev->erase_size);
+    return true;
+}
+
+// Find the blocks on the flash, as the driver does at startup.
+static void flashsim_ftl_mount(flashsim_ftl_obj_t *self) {
+    flashsim_ftl_mounted = self;
+    self->power_ops = -1;
+    self->powered = true;
+    ftl_init(flashsim_size(self->dev), self->ram);
+}
+
+static flashsim_ftl_obj_t *flashsim_ftl_get(mp_obj_t self_in) {
+    flashsim_ftl_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->ram == NULL) {
+        mp_raise_OSError(MP_EIO);
+    }
+    if (flashsim_ftl_mounted != self) {
+        flashsim_ftl_mount(self);
+    }
+    return self;
+}
+
+static mp_obj_t flashsim_ftl_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    flashsim_obj_t *dev = MP_OBJ_TO_PTR(mp_arg_validate_type(args[0], &flashsim_type, MP_QSTR_device));
+    // The driver's flash geometry, with programs and erases going straight to
+    // the flash.
+    size_t ram_size = ftl_ram_size(flashsim_size(dev));
+    if (dev->block_size != FTL_BLOCK_SIZE || dev->erase_size != FTL_ERASE_SIZE ||
+        dev->page_size != FTL_PAGE_SIZE || dev->cache_count != 0 || ram_size == 0) {
+        mp_raise_ValueError(NULL);
+    }
+    flashsim_ftl_obj_t *self = mp_obj_malloc_with_finaliser(flashsim_ftl_obj_t, type);
+    self->dev = dev;
+    self->ram = malloc(ram_size);
+    if (self->ram == NULL) {
+        m_malloc_fail(ram_size);
+    }
+    flashsim_ftl_mount(self);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static mp_obj_t flashsim_ftl_del(mp_obj_t self_in) {
+    flashsim_ftl_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (flashsim_ftl_mounted == self) {
+        flashsim_ftl_mounted = NULL;
+    }
+    free(self->ram);
+    self->ram = NULL;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_ftl_del_obj, flashsim_ftl_del);
+
+static size_t flashsim_ftl_get_blocks(mp_obj_t block_num_in, mp_obj_t buf_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    mp_get_buffer_raise(buf_in, bufinfo, flags);
+    mp_int_t block_num = mp_obj_get_int(block_num_in);
+    if (block_num < 0 || bufinfo->len % FTL_BLOCK_SIZE) {
+        mp_raise_OSError(MP_EIO);
+    }
+    return block_num;
+}
+
+static mp_obj_t flashsim_ftl_readblocks(mp_obj_t self_in, mp_obj_t block_num_in, mp_obj_t buf_in) {
+    flashsim_ftl_get(self_in);
+    mp_buffer_info_t bufinfo;
+    size_t block_num = flashsim_ftl_get_blocks(block_num_in, buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (!ftl_read_blocks(bufinfo.buf, block_num, bufinfo.len / FTL_BLOCK_SIZE)) {
+        mp_raise_OSError(MP_EIO);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(flashsim_ftl_readblocks_obj, flashsim_ftl_readblocks);
+
+static mp_obj_t flashsim_ftl_writeblocks(mp_obj_t self_in, mp_obj_t block_num_in, mp_obj_t buf_in) {
+    flashsim_ftl_get(self_in);
+    mp_buffer_info_t bufinfo;
+    size_t block_num = flashsim_ftl_get_blocks(block_num_in, buf_in, &bufinfo, MP_BUFFER_READ);
+    const uint8_t *src = bufinfo.buf;
+    for (size_t i = 0; i < bufinfo.len / FTL_BLOCK_SIZE; i++) {
+        if (!ftl_write_block(src + i * FTL_BLOCK_SIZE, block_num + i)) {
+            mp_raise_OSError(MP_EIO);
+        }
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(flashsim_ftl_writeblocks_obj, flashsim_ftl_writeblocks);
+
+static mp_obj_t flashsim_ftl_ioctl(mp_obj_t self_in, mp_obj_t cmd_in, mp_obj_t arg_in) {
+    flashsim_ftl_obj_t *self = flashsim_ftl_get(self_in);
+    switch (mp_obj_get_int(cmd_in)) {
+        case MP_BLOCKDEV_IOCTL_INIT:
+        case MP_BLOCKDEV_IOCTL_DEINIT:
+            return MP_OBJ_NEW_SMALL_INT(0);
+        case MP_BLOCKDEV_IOCTL_SYNC:
+            // Writes aren't cached, so the driver's flush gets ahead on
+            // garbage collection instead.
+            ftl_background();
+            return MP_OBJ_NEW_SMALL_INT(self->powered ? 0 : -MP_EIO);
+        case MP_BLOCKDEV_IOCTL_BLOCK_COUNT:
+            return MP_OBJ_NEW_SMALL_INT(ftl_get_block_count());
+        case MP_BLOCKDEV_IOCTL_BLOCK_SIZE:
+            return MP_OBJ_NEW_SMALL_INT(FTL_BLOCK_SIZE);
+        default:
+            return mp_const_none;
+    }
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(flashsim_ftl_ioctl_obj, flashsim_ftl_ioctl);
+
+// Power up again, finding the blocks on the flash as after a reset.
+static mp_obj_t flashsim_ftl_mount_meth(mp_obj_t self_in) {
+    flashsim_ftl_mount(flashsim_ftl_get(self_in));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_ftl_mount_obj, flashsim_ftl_mount_meth);
+
+// cut_power(n) lets n more programs or erases through, then cuts the power
+// half way through the next one. After that every access fails until mount().
+static mp_obj_t flashsim_ftl_cut_power(mp_obj_t self_in, mp_obj_t n_in) {
+    flashsim_ftl_obj_t *self = flashsim_ftl_get(self_in);
+    self->power_ops = mp_arg_validate_int_min(mp_obj_get_int(n_in), 0, MP_QSTR_n);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(flashsim_ftl_cut_power_obj, flashsim_ftl_cut_power);
+
+// Whether the power is still on.
+static mp_obj_t flashsim_ftl_powered(mp_obj_t self_in) {
+    return mp_obj_new_bool(flashsim_ftl_get(self_in)->powered);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flashsim_ftl_powered_obj, flashsim_ftl_powered);
+
+static const mp_rom_map_elem_t flashsim_ftl_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&flashsim_ftl_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readblocks), MP_ROM_PTR(&flashsim_ftl_readblocks_obj) },
+    { MP_ROM_QSTR(MP_QSTR_writeblocks), MP_ROM_PTR(&flashsim_ftl_writeblocks_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ioctl), MP_ROM_PTR(&flashsim_ftl_ioctl_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mount), MP_ROM_PTR(&flashsim_ftl_mount_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cut_power), MP_ROM_PTR(&flashsim_ftl_cut_power_obj) },
+    { MP_ROM_QSTR(MP_QSTR_powered), MP_ROM_PTR(&flashsim_ftl_powered_obj) },
+};
+static MP_DEFINE_CONST_DICT(flashsim_ftl_locals_dict, flashsim_ftl_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(
+    flashsim_ftl_type,
+    MP_QSTR_FTL,
+    MP_TYPE_FLAG_NONE,
+    make_new, flashsim_ftl_make_new,
+    locals_dict, &flashsim_ftl_locals_dict
+    );
+
+static const mp_rom_map_elem_t mp_module_flashsim_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_flashsim) },
+    { MP_ROM_QSTR(MP_QSTR_BlockDevice), MP_ROM_PTR(&flashsim_type) },
+    { MP_ROM_QSTR(MP_QSTR_FTL), MP_ROM_PTR(&flashsim_ftl_type) },
+};
+static MP_DEFINE_CONST_DICT(mp_module_flashsim_globals, mp_module_flashsim_globals_table);
+
+const mp_obj_module_t mp_module_flashsim = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_flashsim_globals,
+};
+
+MP_REGISTER_MODULE(MP_QSTR_flashsim, mp_module_flashsim);
+
+#endif // MICROPY_PY_FLASHSIM
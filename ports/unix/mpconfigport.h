@@ -139,6 +139,11 @@ typedef long mp_off_t;
 // with EINTR, updates remaining timeout value.
 #define MICROPY_SELECT_REMAINING_TIME (1)
 
+// Keep file descriptors registered with epoll in select.poll objects.
+#if defined(__linux__) && !defined(MICROPY_PY_SELECT_EPOLL)
+#define MICROPY_PY_SELECT_EPOLL (1)
+#endif
+
 // Disable stackless by default.
 #ifndef MICROPY_STACKLESS
 #define MICROPY_STACKLESS           (0)
@@ -160,6 +165,14 @@ typedef long mp_off_t;
 #define MICROPY_FATFS_MKFS_FAT32       (1)
 // CIRCUITPY-CHANGE: allow FAT label access
 #define MICROPY_FATFS_USE_LABEL (1)
+// CIRCUITPY-CHANGE: allow files to have their own sector buffer
+#define MICROPY_FATFS_FILE_BUF (1)
+// CIRCUITPY-CHANGE: cache recent stat results
+#define MICROPY_FATFS_STAT_CACHE (16)
+// CIRCUITPY-CHANGE: allow files to read ahead
+#define MICROPY_FATFS_READAHEAD (1)
+// CIRCUITPY-CHANGE: allow files to be preallocated
+#define MICROPY_FATFS_USE_EXPAND (1)
 
 #define MICROPY_ALLOC_PATH_MAX      (PATH_MAX)
 
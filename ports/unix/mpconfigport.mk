@@ -18,6 +18,9 @@ MICROPY_PY_THREAD = 1
 # Subset of CPython termios module
 MICROPY_PY_TERMIOS = 1
 
+# CIRCUITPY-CHANGE: flashsim module, a simulated NOR flash/SD block device
+MICROPY_PY_FLASHSIM = 1
+
 # CIRCUITPY-CHANGE: not present
 # Subset of CPython socket module
 MICROPY_PY_SOCKET = 0
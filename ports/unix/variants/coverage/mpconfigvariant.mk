@@ -25,6 +25,10 @@ $(BUILD)/lib/quirc/lib/%.o: CFLAGS += -Wno-shadow -Wno-sign-compare -include sha
 SRC_C += lib/tjpgd/src/tjpgd.c
 $(BUILD)/lib/tjpgd/src/tjpgd.o: CFLAGS += -Wno-shadow -Wno-cast-align
 
+# CIRCUITPY-CHANGE: littlefs, to compare it with FAT as a CIRCUITPY filesystem
+MICROPY_VFS_LFS2 = 1
+$(BUILD)/lib/littlefs/lfs2.o: CFLAGS += -Wno-shadow
+
 SRC_BITMAP := \
 	shared/runtime/context_manager_helpers.c \
 	displayio_min.c \
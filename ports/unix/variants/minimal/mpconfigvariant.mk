@@ -7,6 +7,7 @@ MICROPY_PY_FFI = 0
 MICROPY_PY_SOCKET = 0
 MICROPY_PY_THREAD = 0
 MICROPY_PY_TERMIOS = 0
+MICROPY_PY_FLASHSIM = 0
 MICROPY_PY_SSL = 0
 MICROPY_USE_READLINE = 0
 
@@ -44,7 +44,9 @@ extern void common_hal_mcu_enable_interrupts(void);
 #define MICROPY_PY_OS_DUPTERM            (0)
 #define MICROPY_ROM_TEXT_COMPRESSION     (0)
 #define MICROPY_VFS_LFS1                 (0)
+#ifndef MICROPY_VFS_LFS2
 #define MICROPY_VFS_LFS2                 (0)
+#endif
 
 // Sorted alphabetically for easy finding.
 //
@@ -167,6 +169,19 @@ extern void common_hal_mcu_enable_interrupts(void);
 // the preprocessor.
 #define MICROPY_FATFS_LFN_CODE_PAGE   437
 #define MICROPY_FATFS_USE_LABEL       (1)
+// Allow files to have their own sector buffer, see VfsFat.file_buffers.
+#define MICROPY_FATFS_FILE_BUF        (1)
+// Remember recent stat results so imports don't rescan lib/ for every probe.
+#ifndef MICROPY_FATFS_STAT_CACHE
+#define MICROPY_FATFS_STAT_CACHE      (16)
+#endif
+// Let sequential readers such as audio files keep data buffered ahead.
+#define MICROPY_FATFS_READAHEAD       (1)
+#define MICROPY_FATFS_READAHEAD_BACKGROUND (1)
+// Background callbacks can run in the middle of a FatFs call, so each volume
+// is locked while FatFs uses it.
+#define MICROPY_FATFS_REENTRANT       (1)
+#define MICROPY_FATFS_SYNC_T          struct _fs_user_mount_t *
 #define MICROPY_FATFS_RPATH           (2)
 #define MICROPY_FATFS_MULTI_PARTITION (1)
 #define MICROPY_FATFS_LFN_UNICODE      2  // UTF-8
@@ -273,6 +288,10 @@ typedef long mp_off_t;
 #define MICROPY_PY_FUNCTION_ATTRS            (CIRCUITPY_FULL_BUILD)
 #endif
 
+#ifndef MICROPY_PY_ASYNCIO_NATIVE_LOOP
+#define MICROPY_PY_ASYNCIO_NATIVE_LOOP       (MICROPY_PY_ASYNCIO && CIRCUITPY_FULL_BUILD)
+#endif
+
 #ifndef MICROPY_PY_REVERSE_SPECIAL_METHODS
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS   (CIRCUITPY_FULL_BUILD)
 #endif
@@ -280,6 +299,9 @@ typedef long mp_off_t;
 #define MICROPY_PY_RE_MATCH_GROUPS           (CIRCUITPY_RE)
 #define MICROPY_PY_RE_MATCH_SPAN_START_END   (CIRCUITPY_RE)
 #define MICROPY_PY_RE_SUB                    (CIRCUITPY_RE)
+#ifndef MICROPY_PY_RE_CACHE_SIZE
+#define MICROPY_PY_RE_CACHE_SIZE             (CIRCUITPY_RE ? 4 : 0)
+#endif
 
 #define CIRCUITPY_MICROPYTHON_ADVANCED        (0)
 
@@ -291,6 +313,20 @@ typedef long mp_off_t;
 #define MICROPY_FATFS_MKFS_FAT32           (CIRCUITPY_FULL_BUILD)
 #endif
 
+// Lets files reserve contiguous space with preallocate().
+#ifndef MICROPY_FATFS_USE_EXPAND
+#define MICROPY_FATFS_USE_EXPAND           (CIRCUITPY_FULL_BUILD)
+#endif
+
+// os.VfsRom mounts ROMFS images so assets can be used in place. No port
+// provides a ROM partition yet, so vfs.rom_ioctl stays off.
+#ifndef MICROPY_VFS_ROM
+#define MICROPY_VFS_ROM                    (CIRCUITPY_FULL_BUILD)
+#endif
+#ifndef MICROPY_VFS_ROM_IOCTL
+#define MICROPY_VFS_ROM_IOCTL              (0)
+#endif
+
 // LONGINT_IMPL_xxx are defined in the Makefile.
 //
 #ifdef LONGINT_IMPL_NONE
@@ -463,6 +499,26 @@ void background_callback_run_all(void);
 #define CIRCUITPY_FILESYSTEM_FLUSH_INTERVAL_MS 1000
 #endif
 
+// Maximum number of 4 KiB erase sectors of external flash that are cached in
+// ram between filesystem flushes. Entries are only allocated as needed.
+#ifndef CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS
+#define CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS (4)
+#endif
+
+// Write external flash through a log-structured flash translation layer, so
+// that small writes program a page instead of erasing a sector, and erases are
+// spread across the flash. It keeps a 2 byte map entry per filesystem block in
+// ram, and uses a different layout on flash, so turning it on for a board
+// reformats CIRCUITPY. Some sectors are kept spare for garbage collection.
+// Set it in mpconfigboard.mk, since the makefiles check it too.
+#ifndef CIRCUITPY_EXTERNAL_FLASH_FTL
+#define CIRCUITPY_EXTERNAL_FLASH_FTL (0)
+#endif
+
+#ifndef CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS
+#define CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS (8)
+#endif
+
 #ifndef CIRCUITPY_PYSTACK_SIZE
 #define CIRCUITPY_PYSTACK_SIZE 2048
 #endif
@@ -492,7 +548,26 @@ void background_callback_run_all(void);
 #define CIRCUITPY_STATUS_LED_POWER_INVERTED (0)
 #endif
 
+// boot_out.txt is written with FatFs directly.
+#if !CIRCUITPY_FILESYSTEM_LITTLEFS
 #define CIRCUITPY_BOOT_OUTPUT_FILE "/boot_out.txt"
+#endif
+
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+// One littlefs block per flash erase sector, so a sync only rewrites the
+// sectors that changed.
+#ifndef CIRCUITPY_LITTLEFS_BLOCK_SIZE
+#define CIRCUITPY_LITTLEFS_BLOCK_SIZE (4096)
+#endif
+// Bytes of allocation bitmap; each covers 8 blocks. 128 covers 4MB of 4k blocks.
+#ifndef CIRCUITPY_LITTLEFS_LOOKAHEAD_SIZE
+#define CIRCUITPY_LITTLEFS_LOOKAHEAD_SIZE (128)
+#endif
+// Longest working directory plus relative path.
+#ifndef CIRCUITPY_LITTLEFS_PATH_MAX
+#define CIRCUITPY_LITTLEFS_PATH_MAX (256)
+#endif
+#endif
 
 #ifndef CIRCUITPY_BOOT_COUNTER
 #define CIRCUITPY_BOOT_COUNTER 0
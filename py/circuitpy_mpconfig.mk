@@ -655,6 +655,39 @@ CIRCUITPY_USB_VENDOR ?= 0
 CFLAGS += -DCIRCUITPY_USB_VENDOR=$(CIRCUITPY_USB_VENDOR)
 endif
 
+# Maximum number of external flash sectors cached in ram. See
+# CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS in circuitpy_mpconfig.h.
+CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS ?= 4
+CFLAGS += -DCIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS=$(CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS)
+
+# Write external flash through a log-structured flash translation layer. See
+# CIRCUITPY_EXTERNAL_FLASH_FTL in circuitpy_mpconfig.h.
+CIRCUITPY_EXTERNAL_FLASH_FTL ?= 0
+CFLAGS += -DCIRCUITPY_EXTERNAL_FLASH_FTL=$(CIRCUITPY_EXTERNAL_FLASH_FTL)
+
+# Keep CIRCUITPY on littlefs instead of FAT, for boards that are reached over
+# the serial REPL or the web and BLE workflows. Hosts can't read littlefs, so
+# USB mass storage must be off. littlefs relies on each program reaching flash
+# by itself without disturbing what was already written, which only the flash
+# translation layer provides; the sector cache rewrites whole erase sectors.
+CIRCUITPY_FILESYSTEM_LITTLEFS ?= 0
+CFLAGS += -DCIRCUITPY_FILESYSTEM_LITTLEFS=$(CIRCUITPY_FILESYSTEM_LITTLEFS)
+ifeq ($(CIRCUITPY_FILESYSTEM_LITTLEFS),1)
+ifeq ($(CIRCUITPY_USB_MSC),1)
+$(error CIRCUITPY_FILESYSTEM_LITTLEFS requires CIRCUITPY_USB_MSC = 0)
+endif
+ifeq ($(CIRCUITPY_STORAGE_EXTEND),1)
+$(error CIRCUITPY_FILESYSTEM_LITTLEFS requires CIRCUITPY_STORAGE_EXTEND = 0)
+endif
+ifeq ($(filter 1,$(SPI_FLASH_FILESYSTEM) $(QSPI_FLASH_FILESYSTEM)),)
+$(error CIRCUITPY_FILESYSTEM_LITTLEFS requires CIRCUITPY on external flash)
+endif
+ifneq ($(CIRCUITPY_EXTERNAL_FLASH_FTL),1)
+$(error CIRCUITPY_FILESYSTEM_LITTLEFS requires CIRCUITPY_EXTERNAL_FLASH_FTL = 1)
+endif
+MICROPY_VFS_LFS2 = 1
+endif
+
 
 CIRCUITPY_PYUSB ?= $(call enable-if-any,$(CIRCUITPY_USB_HOST) $(CIRCUITPY_MAX3421E))
 CFLAGS += -DCIRCUITPY_PYUSB=$(CIRCUITPY_PYUSB)
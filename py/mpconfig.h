@@ -650,6 +650,27 @@
 #define MICROPY_FATFS_NUM_PERSISTENT (0)
 #endif
 
+// CIRCUITPY-CHANGE
+// Number of recent stat results, including misses, to keep per FAT mount.
+// Any write to the block device empties the cache. 0 disables it.
+#ifndef MICROPY_FATFS_STAT_CACHE
+#define MICROPY_FATFS_STAT_CACHE (0)
+#endif
+
+// CIRCUITPY-CHANGE
+// Whether FAT files can keep a buffer of data read ahead of the reader, set
+// with open(..., buffering=N) or MP_STREAM_SET_READAHEAD.
+#ifndef MICROPY_FATFS_READAHEAD
+#define MICROPY_FATFS_READAHEAD (0)
+#endif
+
+// CIRCUITPY-CHANGE
+// Whether read-ahead buffers are topped up from a background callback rather
+// than when the reader runs out.
+#ifndef MICROPY_FATFS_READAHEAD_BACKGROUND
+#define MICROPY_FATFS_READAHEAD_BACKGROUND (0)
+#endif
+
 // Hook for the VM at the start of the opcode loop (can contain variable
 // definitions usable by the other hook functions)
 #ifndef MICROPY_VM_HOOK_INIT
@@ -1664,6 +1685,13 @@ typedef double mp_float_t;
 #define MICROPY_PY_SELECT_POSIX_OPTIMISATIONS (0)
 #endif
 
+// Whether select.poll objects keep objects that have a file descriptor
+// registered with Linux epoll, so waiting doesn't scan each one (requires
+// epoll and MICROPY_PY_SELECT_POSIX_OPTIMISATIONS)
+#ifndef MICROPY_PY_SELECT_EPOLL
+#define MICROPY_PY_SELECT_EPOLL (0)
+#endif
+
 // Whether to enable the select() function in the "select" module (baremetal
 // implementation). This is present for compatibility but can be disabled to
 // save space.
@@ -1728,6 +1756,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_ASYNCIO_TASK_QUEUE_PUSH_CALLBACK (0)
 #endif
 
+// Whether _asyncio provides a native IOQueue and run_until_complete, so the
+// core run loop and IO polling don't run as bytecode
+#ifndef MICROPY_PY_ASYNCIO_NATIVE_LOOP
+#define MICROPY_PY_ASYNCIO_NATIVE_LOOP (MICROPY_PY_ASYNCIO)
+#endif
+
 #ifndef MICROPY_PY_UCTYPES
 #define MICROPY_PY_UCTYPES (MICROPY_CONFIG_ROM_LEVEL_AT_LEAST_EXTRA_FEATURES)
 #endif
@@ -1791,6 +1825,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_RE_SUB (MICROPY_CONFIG_ROM_LEVEL_AT_LEAST_EXTRA_FEATURES)
 #endif
 
+// Number of compiled patterns kept by re.compile and the module-level
+// re.match/search/sub functions, so repeated calls don't recompile (0 to disable)
+#ifndef MICROPY_PY_RE_CACHE_SIZE
+#define MICROPY_PY_RE_CACHE_SIZE (MICROPY_CONFIG_ROM_LEVEL_AT_LEAST_EXTRA_FEATURES ? 8 : 0)
+#endif
+
 #ifndef MICROPY_PY_HEAPQ
 #define MICROPY_PY_HEAPQ (MICROPY_CONFIG_ROM_LEVEL_AT_LEAST_EXTRA_FEATURES)
 #endif
@@ -7,14 +7,47 @@
 // SPDX-License-Identifier: MIT
 
 // CIRCUITPY-CHANGE: API and implementation thoroughly reworked
-// No attempt to have atomic operations. Add guards if atomicity required.
+// Lock-free for a single producer and a single consumer. Add guards for anything else.
+
+#include <string.h>
 
 #include "ringbuf.h"
 
+// The producer publishes next_write only after the data is in the buffer, and
+// the consumer publishes next_read only after it has copied the data out, so
+// each side must read the other's position with acquire ordering.
+static inline uint32_t ringbuf_load_acquire(const uint32_t *pos) {
+    return __atomic_load_n(pos, __ATOMIC_ACQUIRE);
+}
+
+static inline void ringbuf_store_release(uint32_t *pos, uint32_t value) {
+    __atomic_store_n(pos, value, __ATOMIC_RELEASE);
+}
+
+// Positions run over [0, 2 * size); these map them into the buffer and move
+// them along without any division, so any capacity works.
+static inline uint32_t ringbuf_index(ringbuf_t *r, uint32_t pos) {
+    return pos < r->size ? pos : pos - r->size;
+}
+
+static inline uint32_t ringbuf_advance(ringbuf_t *r, uint32_t pos, size_t n) {
+    pos += n;
+    if (pos >= 2 * r->size) {
+        pos -= 2 * r->size;
+    }
+    return pos;
+}
+
+static inline size_t ringbuf_filled(ringbuf_t *r, uint32_t read_pos, uint32_t write_pos) {
+    if (write_pos >= read_pos) {
+        return write_pos - read_pos;
+    }
+    return write_pos + 2 * r->size - read_pos;
+}
+
 bool ringbuf_init(ringbuf_t *r, uint8_t *buf, size_t size) {
     r->buf = buf;
     r->size = size;
-    r->used = 0;
     r->next_read = 0;
     r->next_write = 0;
     return r->buf != NULL;
@@ -40,87 +73,122 @@ size_t ringbuf_size(ringbuf_t *r) {
 
 // Return -1 if buffer is empty, else return byte fetched.
 int ringbuf_get(ringbuf_t *r) {
-    if (r->used < 1) {
+    uint32_t read_pos = r->next_read;
+    if (read_pos == ringbuf_load_acquire(&r->next_write)) {
         return -1;
     }
-    uint8_t v = r->buf[r->next_read];
-    r->next_read++;
-    if (r->next_read >= r->size) {
-        r->next_read = 0;
-    }
-    r->used--;
+    uint8_t v = r->buf[ringbuf_index(r, read_pos)];
+    ringbuf_store_release(&r->next_read, ringbuf_advance(r, read_pos, 1));
     return v;
 }
 
 int ringbuf_get16(ringbuf_t *r) {
-    if (r->used < 2) {
+    uint8_t data[2];
+    if (ringbuf_num_filled(r) < 2) {
         return -1;
     }
-    int high_byte = ringbuf_get(r);
-    int low_byte = ringbuf_get(r);
-    return (high_byte << 8) | low_byte;
+    ringbuf_get_n(r, data, 2);
+    return (data[0] << 8) | data[1];
 }
 
 // Return -1 if no room in buffer, else return 0.
 int ringbuf_put(ringbuf_t *r, uint8_t v) {
-    if (r->used >= r->size) {
+    uint32_t write_pos = r->next_write;
+    if (ringbuf_filled(r, ringbuf_load_acquire(&r->next_read), write_pos) >= r->size) {
         return -1;
     }
-    r->buf[r->next_write] = v;
-    r->next_write++;
-    if (r->next_write >= r->size) {
-        r->next_write = 0;
-    }
-    r->used++;
+    r->buf[ringbuf_index(r, write_pos)] = v;
+    ringbuf_store_release(&r->next_write, ringbuf_advance(r, write_pos, 1));
     return 0;
 }
 
 int ringbuf_put16(ringbuf_t *r, uint16_t v) {
-    if (r->size - r->used < 2) {
+    // Both bytes are published together, so a consumer never sees half a value.
+    uint8_t data[2] = { (v >> 8) & 0xff, v & 0xff };
+    if (ringbuf_num_empty(r) < 2) {
         return -1;
     }
-    ringbuf_put(r, (v >> 8) & 0xff);
-    ringbuf_put(r, v & 0xff);
+    ringbuf_put_n(r, data, 2);
     return 0;
 }
 
 void ringbuf_clear(ringbuf_t *r) {
     r->next_write = 0;
     r->next_read = 0;
-    r->used = 0;
 }
 
 // Number of free slots that can be written.
 size_t ringbuf_num_empty(ringbuf_t *r) {
-    return r->size - r->used;
+    return r->size - ringbuf_num_filled(r);
 }
 
 // Number of bytes available to read.
 size_t ringbuf_num_filled(ringbuf_t *r) {
-    return r->used;
+    return ringbuf_filled(r, ringbuf_load_acquire(&r->next_read), ringbuf_load_acquire(&r->next_write));
+}
+
+size_t ringbuf_get_span(ringbuf_t *r, const uint8_t **data) {
+    uint32_t read_pos = r->next_read;
+    size_t filled = ringbuf_filled(r, read_pos, ringbuf_load_acquire(&r->next_write));
+    uint32_t index = ringbuf_index(r, read_pos);
+    size_t contiguous = r->size - index;
+    *data = r->buf + index;
+    return filled < contiguous ? filled : contiguous;
+}
+
+void ringbuf_get_advance(ringbuf_t *r, size_t n) {
+    ringbuf_store_release(&r->next_read, ringbuf_advance(r, r->next_read, n));
+}
+
+size_t ringbuf_put_span(ringbuf_t *r, uint8_t **data) {
+    uint32_t write_pos = r->next_write;
+    size_t empty = r->size - ringbuf_filled(r, ringbuf_load_acquire(&r->next_read), write_pos);
+    uint32_t index = ringbuf_index(r, write_pos);
+    size_t contiguous = r->size - index;
+    *data = r->buf + index;
+    return empty < contiguous ? empty : contiguous;
+}
+
+void ringbuf_put_advance(ringbuf_t *r, size_t n) {
+    ringbuf_store_release(&r->next_write, ringbuf_advance(r, r->next_write, n));
 }
 
 // If the ring buffer fills up, not all bytes will be written.
 // Returns how many bytes were successfully written.
 size_t ringbuf_put_n(ringbuf_t *r, const uint8_t *buf, size_t bufsize) {
-    for (size_t i = 0; i < bufsize; i++) {
-        if (ringbuf_put(r, buf[i]) < 0) {
-            // If ringbuf is full, give up and return how many bytes
-            // we wrote so far.
-            return i;
+    size_t written = 0;
+    // At most two spans: up to the end of the buffer, then from the start.
+    while (written < bufsize) {
+        uint8_t *dest;
+        size_t n = ringbuf_put_span(r, &dest);
+        if (n == 0) {
+            break;
+        }
+        if (n > bufsize - written) {
+            n = bufsize - written;
         }
+        memcpy(dest, buf + written, n);
+        ringbuf_put_advance(r, n);
+        written += n;
     }
-    return bufsize;
+    return written;
 }
 
 // Returns how many bytes were fetched.
 size_t ringbuf_get_n(ringbuf_t *r, uint8_t *buf, size_t bufsize) {
-    for (size_t i = 0; i < bufsize; i++) {
-        int b = ringbuf_get(r);
-        if (b < 0) {
-            return i;
+    size_t fetched = 0;
+    while (fetched < bufsize) {
+        const uint8_t *src;
+        size_t n = ringbuf_get_span(r, &src);
+        if (n == 0) {
+            break;
+        }
+        if (n > bufsize - fetched) {
+            n = bufsize - fetched;
         }
-        buf[i] = b;
+        memcpy(buf + fetched, src, n);
+        ringbuf_get_advance(r, n);
+        fetched += n;
     }
-    return bufsize;
+    return fetched;
 }
@@ -17,7 +17,10 @@
 typedef struct _ringbuf_t {
     uint8_t *buf;
     uint32_t size;
-    uint32_t used;
+    // Read and write positions, each in [0, 2 * size) so that a full buffer
+    // can be told apart from an empty one without a separate count.  Only the
+    // consumer moves next_read and only the producer moves next_write, so one
+    // side may run in an interrupt handler without any locking.
     uint32_t next_read;
     uint32_t next_write;
 } ringbuf_t;
@@ -31,7 +34,9 @@ bool ringbuf_alloc(ringbuf_t *r, size_t capacity);
 // Mark ringbuf as no longer in use, and allow any heap storage to be freed by gc.
 void ringbuf_deinit(ringbuf_t *r);
 
-// Note: Ringbuf operations are not atomic.
+// Ringbuf operations are safe with one producer (the put functions) and one
+// consumer (the get functions) running concurrently, eg an interrupt handler
+// and the VM.  Anything else, including ringbuf_clear(), needs a guard.
 size_t ringbuf_size(ringbuf_t *r);
 int ringbuf_get(ringbuf_t *r);
 int ringbuf_put(ringbuf_t *r, uint8_t v);
@@ -41,6 +46,16 @@ size_t ringbuf_num_filled(ringbuf_t *r);
 size_t ringbuf_put_n(ringbuf_t *r, const uint8_t *buf, size_t bufsize);
 size_t ringbuf_get_n(ringbuf_t *r, uint8_t *buf, size_t bufsize);
 
+// Zero-copy access for drivers that DMA or memcpy directly into or out of the
+// buffer.  The span functions return the number of contiguous bytes that can
+// be read from (or written to) *data, which may be less than the total if the
+// data wraps around.  After using some of them, call the matching advance
+// function with the number of bytes consumed (or produced).
+size_t ringbuf_get_span(ringbuf_t *r, const uint8_t **data);
+void ringbuf_get_advance(ringbuf_t *r, size_t n);
+size_t ringbuf_put_span(ringbuf_t *r, uint8_t **data);
+void ringbuf_put_advance(ringbuf_t *r, size_t n);
+
 // Note: big-endian. Return -1 if can't read or write two bytes.
 int ringbuf_get16(ringbuf_t *r);
 int ringbuf_put16(ringbuf_t *r, uint16_t v);
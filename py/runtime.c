@@ -144,6 +144,13 @@ void mp_init(void) {
     }
     #endif
 
+    #if MICROPY_PY_RE && MICROPY_PY_RE_CACHE_SIZE
+    // Cached compiled patterns live on the heap, which is new after a soft reset.
+    for (size_t i = 0; i < MICROPY_PY_RE_CACHE_SIZE; ++i) {
+        MP_STATE_VM(re_cache[i]) = MP_OBJ_NULL;
+    }
+    #endif
+
     // CIRCUITPY-CHANGE: do not unmount /
     #if MICROPY_VFS && 0
     // initialise the VFS sub-system
@@ -46,6 +46,8 @@
 #define MP_STREAM_SET_DATA_OPTS (9)  // Set data/message options
 #define MP_STREAM_GET_FILENO    (10) // Get fileno of underlying file
 #define MP_STREAM_GET_BUFFER_SIZE (11) // Get preferred buffer size for file
+// CIRCUITPY-CHANGE
+#define MP_STREAM_SET_READAHEAD (12) // Set size of read-ahead buffer, 0 for none
 
 // These poll ioctl values are compatible with Linux
 #define MP_STREAM_POLL_RD       (0x0001)
@@ -87,7 +87,27 @@ static mp_float_t get_m(mp_obj_t mul_obj, int sum) {
     return mul_obj != mp_const_none ? mp_obj_get_float(mul_obj) : sum ? 1 / (mp_float_t)sum : 1;
 }
 
-static mp_obj_t bitmapfilter_morph(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+// Parses the arguments of one of the filter functions into a pipeline step.
+// Returns the bitmap argument and stores the mask argument, if any, in *mask.
+typedef displayio_bitmap_t *(*bitmapfilter_parse_fun_t)(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask);
+
+static mp_obj_t bitmapfilter_apply(bitmapfilter_parse_fun_t parse, size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    bitmapfilter_step_t step;
+    displayio_bitmap_t *mask;
+    displayio_bitmap_t *bitmap = parse(n_args, pos_args, kw_args, &step, &mask);
+    shared_module_bitmapfilter_pipeline(bitmap, mask, &step, 1);
+    return MP_OBJ_FROM_PTR(bitmap);
+}
+
+static displayio_bitmap_t *parse_mask(mp_obj_t mask_obj) {
+    if (mask_obj == mp_const_none) {
+        return NULL;
+    }
+    mp_arg_validate_type(mask_obj, &displayio_bitmap_type, MP_QSTR_mask);
+    return MP_OBJ_TO_PTR(mask_obj);
+}
+
+static displayio_bitmap_t *parse_morph(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask) {
     enum { ARG_bitmap, ARG_weights, ARG_mul, ARG_add, ARG_threshold, ARG_offset, ARG_invert, ARG_mask };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
@@ -103,13 +123,9 @@ static mp_obj_t bitmapfilter_morph(size_t n_args, const mp_obj_t *pos_args, mp_m
     mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
     mp_arg_validate_type(args[ARG_bitmap].u_obj, &displayio_bitmap_type, MP_QSTR_bitmap);
-    displayio_bitmap_t *bitmap = args[ARG_bitmap].u_obj;
+    displayio_bitmap_t *bitmap = MP_OBJ_TO_PTR(args[ARG_bitmap].u_obj);
 
-    displayio_bitmap_t *mask = NULL; // the mask bitmap
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    *mask = parse_mask(args[ARG_mask].u_obj);
 
     mp_float_t b = mp_obj_get_float(args[ARG_add].u_obj);
 
@@ -126,7 +142,8 @@ static mp_obj_t bitmapfilter_morph(size_t n_args, const mp_obj_t *pos_args, mp_m
         mp_raise_ValueError(MP_ERROR_TEXT("weights must be a sequence with an odd square number of elements (usually 9 or 25)"));
     }
 
-    int iweights[n_weights];
+    // Kept on the heap, as a pipeline step refers to it after parsing
+    int *iweights = m_new(int, n_weights);
     int weight_sum = 0;
     for (size_t i = 0; i < n_weights; i++) {
         mp_int_t j = mp_obj_get_int(mp_obj_subscr(weights, MP_OBJ_NEW_SMALL_INT(i), MP_OBJ_SENTINEL));
@@ -136,9 +153,19 @@ static mp_obj_t bitmapfilter_morph(size_t n_args, const mp_obj_t *pos_args, mp_m
 
     mp_float_t m = get_m(args[ARG_mul].u_obj, weight_sum);
 
-    shared_module_bitmapfilter_morph(bitmap, mask, sq_n_weights / 2, iweights, m, b,
-        args[ARG_threshold].u_bool, args[ARG_offset].u_bool, args[ARG_invert].u_bool);
-    return args[ARG_bitmap].u_obj;
+    step->kind = BITMAPFILTER_STEP_MORPH;
+    step->morph.ksize = sq_n_weights / 2;
+    step->morph.krn = iweights;
+    step->morph.m = m;
+    step->morph.b = b;
+    step->morph.threshold = args[ARG_threshold].u_bool;
+    step->morph.offset = args[ARG_offset].u_int;
+    step->morph.invert = args[ARG_invert].u_bool;
+    return bitmap;
+}
+
+static mp_obj_t bitmapfilter_morph(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return bitmapfilter_apply(parse_morph, n_args, pos_args, kw_args);
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_morph_obj, 0, bitmapfilter_morph);
 static mp_obj_t subscr(mp_obj_t o, int i) {
@@ -358,7 +385,7 @@ static const mp_obj_namedtuple_type_t bitmapfilter_channel_mixer_offset_type = {
 //|     """
 //|
 //|
-static mp_obj_t bitmapfilter_mix(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+static displayio_bitmap_t *parse_mix(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask) {
     enum { ARG_bitmap, ARG_weights, ARG_mask };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
@@ -371,8 +398,9 @@ static mp_obj_t bitmapfilter_mix(size_t n_args, const mp_obj_t *pos_args, mp_map
     mp_arg_validate_type(args[ARG_bitmap].u_obj, &displayio_bitmap_type, MP_QSTR_bitmap);
     displayio_bitmap_t *bitmap = MP_OBJ_TO_PTR(args[ARG_bitmap].u_obj);
 
-    mp_float_t weights[12];
-    memset(weights, 0, sizeof(weights));
+    step->kind = BITMAPFILTER_STEP_MIX;
+    mp_float_t *weights = step->mix;
+    memset(weights, 0, sizeof(step->mix));
 
     mp_obj_t weights_obj = args[ARG_weights].u_obj;
     if (mp_obj_is_type(weights_obj, (const mp_obj_type_t *)&bitmapfilter_channel_scale_type)) {
@@ -402,14 +430,12 @@ static mp_obj_t bitmapfilter_mix(size_t n_args, const mp_obj_t *pos_args, mp_map
     }
 
 
-    displayio_bitmap_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    *mask = parse_mask(args[ARG_mask].u_obj);
+    return bitmap;
+}
 
-    shared_module_bitmapfilter_mix(bitmap, mask, weights);
-    return args[ARG_bitmap].u_obj;
+static mp_obj_t bitmapfilter_mix(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return bitmapfilter_apply(parse_mix, n_args, pos_args, kw_args);
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_mix_obj, 0, bitmapfilter_mix);
 
@@ -432,7 +458,7 @@ MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_mix_obj, 0, bitmapfilter_mix);
 //|     """
 //|
 //|
-static mp_obj_t bitmapfilter_solarize(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+static displayio_bitmap_t *parse_solarize(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask) {
     enum { ARG_bitmap, ARG_threshold, ARG_mask };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
@@ -447,14 +473,14 @@ static mp_obj_t bitmapfilter_solarize(size_t n_args, const mp_obj_t *pos_args, m
     displayio_bitmap_t *bitmap = MP_OBJ_TO_PTR(args[ARG_bitmap].u_obj);
 
 
-    displayio_bitmap_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    *mask = parse_mask(args[ARG_mask].u_obj);
+    step->kind = BITMAPFILTER_STEP_SOLARIZE;
+    step->solarize = threshold;
+    return bitmap;
+}
 
-    shared_module_bitmapfilter_solarize(bitmap, mask, threshold);
-    return args[ARG_bitmap].u_obj;
+static mp_obj_t bitmapfilter_solarize(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return bitmapfilter_apply(parse_solarize, n_args, pos_args, kw_args);
 }
 
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_solarize_obj, 0, bitmapfilter_solarize);
@@ -504,7 +530,7 @@ static int scaled_lut(int maxval, mp_obj_t func, int i) {
     return (int)MICROPY_FLOAT_C_FUN(round)(val * maxval);
 }
 
-static mp_obj_t bitmapfilter_lookup(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+static displayio_bitmap_t *parse_lookup(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask) {
     enum { ARG_bitmap, ARG_lookup, ARG_mask };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
@@ -529,24 +555,24 @@ static mp_obj_t bitmapfilter_lookup(size_t n_args, const mp_obj_t *pos_args, mp_
         lookup_r = lookup_g = lookup_b = args[ARG_lookup].u_obj;
     }
 
-    bitmapfilter_lookup_table_t table;
+    bitmapfilter_lookup_table_t *table = m_new(bitmapfilter_lookup_table_t, 1);
 
     for (int i = 0; i < 32; i++) {
-        table.r[i] = scaled_lut(31, lookup_r, i);
-        table.b[i] = lookup_r == lookup_b ? table.r[i] : scaled_lut(31, lookup_b, i);
+        table->r[i] = scaled_lut(31, lookup_r, i);
+        table->b[i] = lookup_r == lookup_b ? table->r[i] : scaled_lut(31, lookup_b, i);
     }
     for (int i = 0; i < 64; i++) {
-        table.g[i] = scaled_lut(63, lookup_g, i);
+        table->g[i] = scaled_lut(63, lookup_g, i);
     }
 
-    displayio_bitmap_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    *mask = parse_mask(args[ARG_mask].u_obj);
+    step->kind = BITMAPFILTER_STEP_LOOKUP;
+    step->lookup = table;
+    return bitmap;
+}
 
-    shared_module_bitmapfilter_lookup(bitmap, mask, &table);
-    return args[ARG_bitmap].u_obj;
+static mp_obj_t bitmapfilter_lookup(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return bitmapfilter_apply(parse_lookup, n_args, pos_args, kw_args);
 }
 
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_lookup_obj, 0, bitmapfilter_lookup);
@@ -577,7 +603,7 @@ MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_lookup_obj, 0, bitmapfilter_lookup);
 //|     """
 //|
 //|
-static mp_obj_t bitmapfilter_false_color(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+static displayio_bitmap_t *parse_false_color(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args, bitmapfilter_step_t *step, displayio_bitmap_t **mask) {
     enum { ARG_bitmap, ARG_palette, ARG_mask };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
@@ -594,14 +620,14 @@ static mp_obj_t bitmapfilter_false_color(size_t n_args, const mp_obj_t *pos_args
     displayio_palette_t *palette = MP_OBJ_TO_PTR(args[ARG_palette].u_obj);
     mp_arg_validate_length(palette->color_count, 256, MP_QSTR_palette);
 
-    displayio_bitmap_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    *mask = parse_mask(args[ARG_mask].u_obj);
+    step->kind = BITMAPFILTER_STEP_FALSE_COLOR;
+    step->false_color = palette->colors;
+    return bitmap;
+}
 
-    shared_module_bitmapfilter_false_color(bitmap, mask, palette->colors);
-    return args[ARG_bitmap].u_obj;
+static mp_obj_t bitmapfilter_false_color(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    return bitmapfilter_apply(parse_false_color, n_args, pos_args, kw_args);
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_false_color_obj, 0, bitmapfilter_false_color);
 
@@ -721,17 +747,116 @@ static mp_obj_t bitmapfilter_blend(size_t n_args, const mp_obj_t *pos_args, mp_m
             mp_obj_get_type_qstr(lookup));
     }
 
-    displayio_bitmap_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mp_arg_validate_type(args[ARG_mask].u_obj, &displayio_bitmap_type, MP_QSTR_mask);
-        mask = MP_OBJ_TO_PTR(args[ARG_mask].u_obj);
-    }
+    displayio_bitmap_t *mask = parse_mask(args[ARG_mask].u_obj);
 
     shared_module_bitmapfilter_blend(dest, src1, src2, mask, lookup_buf);
     return args[ARG_dest].u_obj;
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_blend_obj, 0, bitmapfilter_blend);
 
+//| def pipeline(
+//|     bitmap: displayio.Bitmap,
+//|     steps: Sequence[Tuple[Any, ...]],
+//|     mask: displayio.Bitmap | None = None,
+//| ) -> displayio.Bitmap:
+//|     """Apply several filters to the bitmap in a single pass
+//|
+//|     Each step is a tuple of one of the functions `morph`, `mix`, `solarize`,
+//|     `lookup` or `false_color`, followed by the arguments that would be passed
+//|     to it after ``bitmap``. A `dict` at the end of the tuple gives keyword
+//|     arguments. Steps may not have their own ``mask``; the ``mask`` given here
+//|     applies to all of them.
+//|
+//|     The result is the same as calling each function in turn, but each pixel
+//|     is read and written once, and instead of a copy of the whole bitmap only
+//|     a few rows per `morph` kernel are buffered.
+//|
+//|     .. code-block:: python
+//|
+//|         bitmapfilter.pipeline(bitmap, (
+//|             (bitmapfilter.morph, kernel_gauss_3),
+//|             (bitmapfilter.mix, sepia_weights),
+//|             (bitmapfilter.morph, sharpen, None, 0, {"threshold": True}),
+//|         ))
+//|     """
+//|
+//|
+
+static const struct {
+    const mp_obj_fun_builtin_var_t *fun;
+    bitmapfilter_parse_fun_t parse;
+} pipeline_funs[] = {
+    { &bitmapfilter_morph_obj, parse_morph },
+    { &bitmapfilter_mix_obj, parse_mix },
+    { &bitmapfilter_solarize_obj, parse_solarize },
+    { &bitmapfilter_lookup_obj, parse_lookup },
+    { &bitmapfilter_false_color_obj, parse_false_color },
+};
+
+// The most arguments any of them takes, those of morph.
+#define PIPELINE_MAX_STEP_ARGS (8)
+
+static mp_obj_t bitmapfilter_pipeline(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_bitmap, ARG_steps, ARG_mask };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_bitmap, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_steps, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_mask, MP_ARG_OBJ, { .u_obj = MP_ROM_NONE } },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_arg_validate_type(args[ARG_bitmap].u_obj, &displayio_bitmap_type, MP_QSTR_bitmap);
+    displayio_bitmap_t *bitmap = MP_OBJ_TO_PTR(args[ARG_bitmap].u_obj);
+    displayio_bitmap_t *mask = parse_mask(args[ARG_mask].u_obj);
+
+    size_t n_steps;
+    mp_obj_t *step_objs;
+    mp_obj_get_array(args[ARG_steps].u_obj, &n_steps, &step_objs);
+    bitmapfilter_step_t *steps = m_new(bitmapfilter_step_t, n_steps);
+
+    for (size_t i = 0; i < n_steps; i++) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(step_objs[i], &len, &items);
+        mp_arg_validate_length_min(len, 1, MP_QSTR_steps);
+
+        bitmapfilter_parse_fun_t parse = NULL;
+        for (size_t j = 0; j < MP_ARRAY_SIZE(pipeline_funs); j++) {
+            if (items[0] == MP_OBJ_FROM_PTR(pipeline_funs[j].fun)) {
+                parse = pipeline_funs[j].parse;
+            }
+        }
+        if (!parse) {
+            mp_arg_error_invalid(MP_QSTR_steps);
+        }
+
+        mp_map_t *step_kw_args = NULL;
+        if (len > 1 && mp_obj_is_type(items[len - 1], &mp_type_dict)) {
+            mp_obj_dict_t *dict = MP_OBJ_TO_PTR(items[len - 1]);
+            step_kw_args = &dict->map;
+            len--;
+        }
+
+        // The step's arguments, with the bitmap in place of the function
+        mp_arg_validate_length_max(len, PIPELINE_MAX_STEP_ARGS, MP_QSTR_steps);
+        mp_obj_t step_args[PIPELINE_MAX_STEP_ARGS];
+        step_args[0] = args[ARG_bitmap].u_obj;
+        memcpy(step_args + 1, items + 1, (len - 1) * sizeof(mp_obj_t));
+
+        displayio_bitmap_t *step_mask;
+        parse(len, step_args, step_kw_args, &steps[i], &step_mask);
+        if (step_mask) {
+            mp_arg_error_invalid(MP_QSTR_mask);
+        }
+    }
+
+    shared_module_bitmapfilter_pipeline(bitmap, mask, steps, n_steps);
+    m_del(bitmapfilter_step_t, steps, n_steps);
+    return args[ARG_bitmap].u_obj;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(bitmapfilter_pipeline_obj, 0, bitmapfilter_pipeline);
+
 static const mp_rom_map_elem_t bitmapfilter_module_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_bitmapfilter) },
     { MP_ROM_QSTR(MP_QSTR_morph), MP_ROM_PTR(&bitmapfilter_morph_obj) },
@@ -745,6 +870,7 @@ static const mp_rom_map_elem_t bitmapfilter_module_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_ChannelMixerOffset), MP_ROM_PTR(&bitmapfilter_channel_mixer_offset_type) },
     { MP_ROM_QSTR(MP_QSTR_blend), MP_ROM_PTR(&bitmapfilter_blend_obj) },
     { MP_ROM_QSTR(MP_QSTR_blend_precompute), MP_ROM_PTR(&bitmapfilter_blend_precompute_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pipeline), MP_ROM_PTR(&bitmapfilter_pipeline_obj) },
 };
 static MP_DEFINE_CONST_DICT(bitmapfilter_module_globals, bitmapfilter_module_globals_table);
 
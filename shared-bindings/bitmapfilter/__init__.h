@@ -8,16 +8,45 @@
 
 #include "shared-module/displayio/Bitmap.h"
 
-void shared_module_bitmapfilter_morph(
+typedef struct {
+    uint8_t r[32], g[64], b[32];
+} bitmapfilter_lookup_table_t;
+
+typedef enum {
+    BITMAPFILTER_STEP_MORPH,
+    BITMAPFILTER_STEP_MIX,
+    BITMAPFILTER_STEP_SOLARIZE,
+    BITMAPFILTER_STEP_LOOKUP,
+    BITMAPFILTER_STEP_FALSE_COLOR,
+} bitmapfilter_step_kind_t;
+
+// One operation of a filter pipeline. Pointed-to data must stay valid until
+// shared_module_bitmapfilter_pipeline returns.
+typedef struct {
+    bitmapfilter_step_kind_t kind;
+    union {
+        struct {
+            int ksize;
+            const int *krn;
+            mp_float_t m;
+            mp_float_t b;
+            bool threshold;
+            int offset;
+            bool invert;
+        } morph;
+        mp_float_t mix[12];
+        mp_float_t solarize;
+        const bitmapfilter_lookup_table_t *lookup;
+        const _displayio_color_t *false_color; // 256 entries
+    };
+} bitmapfilter_step_t;
+
+// Apply the steps in order, in a single pass over the bitmap.
+void shared_module_bitmapfilter_pipeline(
     displayio_bitmap_t *bitmap,
     displayio_bitmap_t *mask,
-    const int ksize,
-    const int *krn,
-    const mp_float_t m,
-    const mp_float_t b,
-    bool threshold,
-    int offset,
-    bool invert);
+    const bitmapfilter_step_t *steps,
+    size_t n_steps);
 
 void shared_module_bitmapfilter_morph9(
     displayio_bitmap_t *bitmap,
@@ -30,30 +59,6 @@ void shared_module_bitmapfilter_morph9(
     int offset,
     bool invert);
 
-void shared_module_bitmapfilter_mix(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const mp_float_t weights[12]);
-
-void shared_module_bitmapfilter_solarize(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const mp_float_t threshold);
-
-typedef struct {
-    uint8_t r[32], g[64], b[32];
-} bitmapfilter_lookup_table_t;
-
-void shared_module_bitmapfilter_lookup(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const bitmapfilter_lookup_table_t *table);
-
-void shared_module_bitmapfilter_false_color(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    _displayio_color_t palette[256]);
-
 void shared_module_bitmapfilter_blend_precompute(mp_obj_t fun, uint8_t lookup[4096]);
 
 void shared_module_bitmapfilter_blend(
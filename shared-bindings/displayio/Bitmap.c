@@ -30,21 +30,44 @@
 //|     `bitmaptools.arrayblit` can also be useful to move data efficiently
 //|     into a Bitmap."""
 //|
-//|     def __init__(self, width: int, height: int, value_count: int) -> None:
+//|     def __init__(
+//|         self,
+//|         width: int,
+//|         height: int,
+//|         value_count: int,
+//|         *,
+//|         buffer: Optional[circuitpython_typing.ReadableBuffer] = None,
+//|     ) -> None:
 //|         """Create a Bitmap object with the given fixed size. Each pixel stores a value that is used to
 //|         index into a corresponding palette. This enables differently colored sprites to share the
 //|         underlying Bitmap. value_count is used to minimize the memory used to store the Bitmap.
 //|
+//|         When ``buffer`` is given the Bitmap uses it in place instead of allocating its own storage.
+//|         It must be word aligned and hold the pixels in the same layout as the Bitmap's own buffer,
+//|         such as the bytes of an existing Bitmap of the same size. A memoryview of a file on an
+//|         `os.VfsRom` filesystem works, so image data can stay in flash. The Bitmap is read-only
+//|         unless the buffer is writable.
+//|
 //|         :param int width: The number of values wide
 //|         :param int height: The number of values high
-//|         :param int value_count: The number of possible pixel values."""
+//|         :param int value_count: The number of possible pixel values.
+//|         :param ~circuitpython_typing.ReadableBuffer buffer: Existing pixel storage to use"""
 //|         ...
 //|
 static mp_obj_t displayio_bitmap_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
-    mp_arg_check_num(n_args, n_kw, 3, 3, false);
-    uint32_t width = mp_arg_validate_int_range(mp_obj_get_int(all_args[0]), 0, 32767, MP_QSTR_width);
-    uint32_t height = mp_arg_validate_int_range(mp_obj_get_int(all_args[1]), 0, 32767, MP_QSTR_height);
-    uint32_t value_count = mp_arg_validate_int_range(mp_obj_get_int(all_args[2]), 1, 65536, MP_QSTR_value_count);
+    enum { ARG_width, ARG_height, ARG_value_count, ARG_buffer };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_width, MP_ARG_REQUIRED | MP_ARG_INT, {} },
+        { MP_QSTR_height, MP_ARG_REQUIRED | MP_ARG_INT, {} },
+        { MP_QSTR_value_count, MP_ARG_REQUIRED | MP_ARG_INT, {} },
+        { MP_QSTR_buffer, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    uint32_t width = mp_arg_validate_int_range(args[ARG_width].u_int, 0, 32767, MP_QSTR_width);
+    uint32_t height = mp_arg_validate_int_range(args[ARG_height].u_int, 0, 32767, MP_QSTR_height);
+    uint32_t value_count = mp_arg_validate_int_range(args[ARG_value_count].u_int, 1, 65536, MP_QSTR_value_count);
     uint32_t bits = 1;
 
     while ((value_count - 1) >> bits) {
@@ -55,9 +78,30 @@ static mp_obj_t displayio_bitmap_make_new(const mp_obj_type_t *type, size_t n_ar
         }
     }
 
-    displayio_bitmap_t *self = mp_obj_malloc(displayio_bitmap_t, &displayio_bitmap_type);
-    common_hal_displayio_bitmap_construct(self, width, height, bits);
+    mp_obj_t buffer = args[ARG_buffer].u_obj;
+    if (buffer == mp_const_none) {
+        displayio_bitmap_t *self = mp_obj_malloc(displayio_bitmap_t, &displayio_bitmap_type);
+        common_hal_displayio_bitmap_construct(self, width, height, bits);
+        return MP_OBJ_FROM_PTR(self);
+    }
 
+    // Use the caller's storage in place. A read-only buffer, such as a file in
+    // a ROMFS image, gives a read-only bitmap.
+    mp_buffer_info_t bufinfo;
+    bool read_only = !mp_get_buffer(buffer, &bufinfo, MP_BUFFER_WRITE);
+    if (read_only) {
+        mp_get_buffer_raise(buffer, &bufinfo, MP_BUFFER_READ);
+    }
+    if ((uintptr_t)bufinfo.buf & (sizeof(uint32_t) - 1)) {
+        mp_raise_ValueError_varg(MP_ERROR_TEXT("%q must be word aligned"), MP_QSTR_buffer);
+    }
+    size_t row_words = (width * bits + 31) / 32;
+    mp_arg_validate_length_min(bufinfo.len, row_words * sizeof(uint32_t) * height, MP_QSTR_buffer);
+
+    displayio_bitmap_t *self = mp_obj_malloc(displayio_bitmap_t, &displayio_bitmap_type);
+    common_hal_displayio_bitmap_construct_from_buffer(self, width, height, bits, bufinfo.buf, read_only);
+    // Keep the owner alive; the data pointer may point into the middle of it.
+    self->data_owner = buffer;
     return MP_OBJ_FROM_PTR(self);
 }
 
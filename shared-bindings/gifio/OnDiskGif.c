@@ -204,7 +204,11 @@ MP_PROPERTY_GETTER(gifio_ondiskgif_palette_obj,
     (mp_obj_t)&gifio_ondiskgif_get_palette_obj);
 
 //|     def next_frame(self) -> float:
-//|         """Loads the next frame. Returns expected delay before the next frame in seconds."""
+//|         """Loads the next frame. Returns expected delay before the next frame in seconds.
+//|
+//|         Only the area of the bitmap covered by the new frame, plus the previous
+//|         frame's area when it is restored to the background, is marked as changed.
+//|         """
 //|
 static mp_obj_t gifio_ondiskgif_obj_next_frame(mp_obj_t self_in) {
     gifio_ondiskgif_t *self = MP_OBJ_TO_PTR(self_in);
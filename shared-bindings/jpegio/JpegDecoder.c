@@ -191,9 +191,84 @@ static mp_obj_t jpegio_jpegdecoder_decode(mp_uint_t n_args, const mp_obj_t *pos_
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(jpegio_jpegdecoder_decode_obj, 1, jpegio_jpegdecoder_decode);
 
+//|     def decode_rows(
+//|         self,
+//|         callback: Callable[[displayio.Bitmap, int], None],
+//|         scale: int = 0,
+//|         *,
+//|         x1: int,
+//|         y1: int,
+//|         x2: int,
+//|         y2: int,
+//|     ) -> None:
+//|         """Decode JPEG data a band of rows at a time
+//|
+//|         Instead of needing a bitmap for the whole image, the image is decoded
+//|         one row of MCUs (8 or 16 rows of pixels, fewer when scaled) at a time into
+//|         a small bitmap, and ``callback(band, y)`` is called for each band. ``y``
+//|         is the row of the cropped image held in the first row of ``band``. The
+//|         pixel data is in the `displayio.Colorspace.RGB565_SWAPPED` colorspace.
+//|
+//|         The callback should copy the pixels where they are needed, such as
+//|         to a display bus or a framebuffer. The same ``band`` is reused for
+//|         each call, so it is only valid during the callback. Its height may
+//|         be smaller for the last band.
+//|
+//|         The image is optionally downscaled by a factor of ``2**scale``, as for `decode`.
+//|         Only the region from ``(x1, y1)`` to ``(x2, y2)`` (exclusive) of the
+//|         scaled image is output. Parts of the image outside this region are
+//|         skipped over without being fully decoded, and decoding stops after
+//|         the last row of the region.
+//|
+//|         After a call to ``decode_rows``, you must ``open`` a new JPEG.
+//|
+//|         .. code-block:: python
+//|
+//|             def show(band, y):
+//|                 bitmaptools.blit(framebuffer, band, x=0, y=y)
+//|
+//|             decoder.open("/sd/example.jpg")
+//|             decoder.decode_rows(show, scale=1)
+//|
+//|         :param callable callback: Called with each band of decoded rows
+//|         :param int scale: Scale factor from 0 to 3, inclusive.
+//|         :param int x1: Minimum x-value of the region of the scaled image to output
+//|         :param int y1: Minimum y-value of the region of the scaled image to output
+//|         :param int x2: Maximum x-value (exclusive) of the region of the scaled image to output
+//|         :param int y2: Maximum y-value (exclusive) of the region of the scaled image to output
+//|         """
+//|
+//|
+static mp_obj_t jpegio_jpegdecoder_decode_rows(mp_uint_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    jpegio_jpegdecoder_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+
+    enum { ARG_callback, ARG_scale, ARGS_X1_Y1_X2_Y2 };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_callback, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = mp_const_none } },
+        { MP_QSTR_scale, MP_ARG_INT, {.u_int = 0 } },
+        ALLOWED_ARGS_X1_Y1_X2_Y2(MP_ARG_KW_ONLY, MP_ARG_KW_ONLY),
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t callback = args[ARG_callback].u_obj;
+    if (!mp_obj_is_callable(callback)) {
+        mp_raise_TypeError_varg(MP_ERROR_TEXT("%q must be of type %q, not %q"), MP_QSTR_callback, MP_QSTR_callable, mp_obj_get_type_qstr(callback));
+    }
+
+    int scale = args[ARG_scale].u_int;
+    mp_arg_validate_int_range(scale, 0, 3, MP_QSTR_scale);
+
+    common_hal_jpegio_jpegdecoder_decode_rows(self, callback, scale, &args[ARG_x1]);
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(jpegio_jpegdecoder_decode_rows_obj, 1, jpegio_jpegdecoder_decode_rows);
+
 static const mp_rom_map_elem_t jpegio_jpegdecoder_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_open), MP_ROM_PTR(&jpegio_jpegdecoder_open_obj) },
     { MP_ROM_QSTR(MP_QSTR_decode), MP_ROM_PTR(&jpegio_jpegdecoder_decode_obj) },
+    { MP_ROM_QSTR(MP_QSTR_decode_rows), MP_ROM_PTR(&jpegio_jpegdecoder_decode_rows_obj) },
 };
 static MP_DEFINE_CONST_DICT(jpegio_jpegdecoder_locals_dict, jpegio_jpegdecoder_locals_dict_table);
 
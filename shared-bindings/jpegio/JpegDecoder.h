@@ -25,3 +25,7 @@ void common_hal_jpegio_jpegdecoder_decode_into(
     bitmaptools_rect_t *lim,
     uint32_t skip_source_index, bool skip_source_index_none,
     uint32_t skip_dest_index, bool skip_dest_index_none);
+void common_hal_jpegio_jpegdecoder_decode_rows(
+    jpegio_jpegdecoder_obj_t *self,
+    mp_obj_t callback, int scale,
+    const mp_arg_val_t crop[4]);
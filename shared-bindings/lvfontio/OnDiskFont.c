@@ -48,7 +48,6 @@ MP_PROPERTY_GETTER(lvfontio_ondiskfont_bitmap_obj,
 //|         """Returns the maximum bounds of all glyphs in the font in a tuple of two values: width, height."""
 //|         ...
 //|
-//|
 static mp_obj_t lvfontio_ondiskfont_obj_get_bounding_box(mp_obj_t self_in) {
     lvfontio_ondiskfont_t *self = MP_OBJ_TO_PTR(self_in);
 
@@ -56,9 +55,27 @@ static mp_obj_t lvfontio_ondiskfont_obj_get_bounding_box(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(lvfontio_ondiskfont_get_bounding_box_obj, lvfontio_ondiskfont_obj_get_bounding_box);
 
+//|     def prefetch(self, text: str) -> None:
+//|         """Load the glyphs for ``text`` into the glyph cache ahead of drawing it, so
+//|         the file reads happen now rather than while the text is laid out. Glyphs
+//|         that aren't in use may still be evicted to make room for others."""
+//|         ...
+//|
+//|
+static mp_obj_t lvfontio_ondiskfont_obj_prefetch(mp_obj_t self_in, mp_obj_t text_in) {
+    lvfontio_ondiskfont_t *self = MP_OBJ_TO_PTR(self_in);
+    size_t len;
+    const char *text = mp_obj_str_get_data(text_in, &len);
+
+    common_hal_lvfontio_ondiskfont_prefetch(self, (const byte *)text, len);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(lvfontio_ondiskfont_prefetch_obj, lvfontio_ondiskfont_obj_prefetch);
+
 static const mp_rom_map_elem_t lvfontio_ondiskfont_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_bitmap), MP_ROM_PTR(&lvfontio_ondiskfont_bitmap_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_bounding_box), MP_ROM_PTR(&lvfontio_ondiskfont_get_bounding_box_obj) },
+    { MP_ROM_QSTR(MP_QSTR_prefetch), MP_ROM_PTR(&lvfontio_ondiskfont_prefetch_obj) },
 };
 static MP_DEFINE_CONST_DICT(lvfontio_ondiskfont_locals_dict, lvfontio_ondiskfont_locals_dict_table);
 
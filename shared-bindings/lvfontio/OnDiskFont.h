@@ -20,3 +20,4 @@ void common_hal_lvfontio_ondiskfont_deinit(lvfontio_ondiskfont_t *self);
 bool common_hal_lvfontio_ondiskfont_deinited(lvfontio_ondiskfont_t *self);
 int16_t common_hal_lvfontio_ondiskfont_cache_glyph(lvfontio_ondiskfont_t *self, uint32_t codepoint, bool *is_full_width);
 void common_hal_lvfontio_ondiskfont_release_glyph(lvfontio_ondiskfont_t *self, uint32_t slot);
+void common_hal_lvfontio_ondiskfont_prefetch(lvfontio_ondiskfont_t *self, const byte *text, size_t len);
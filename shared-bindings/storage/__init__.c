@@ -261,6 +261,13 @@ static const mp_rom_map_elem_t storage_module_globals_table[] = {
 //|     """``True`` when the device is mounted as readonly by the microcontroller.
 //|     This property cannot be changed, use `storage.remount` instead."""
 //|     ...
+//|     file_buffers: bool
+//|     """When ``True``, files opened afterwards get their own sector buffer,
+//|     if memory allows, instead of sharing one with all other open files.
+//|     This avoids re-reading sectors when several files are read at the same
+//|     time, for example an audio file and a bitmap, at the cost of a sector
+//|     (usually 512 bytes) per open file. Defaults to ``False``."""
+//|     ...
 //|
 //|     @staticmethod
 //|     def mkfs(block_device: BlockDevice) -> None:
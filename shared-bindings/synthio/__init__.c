@@ -217,9 +217,9 @@ static mp_obj_t synthio_from_file(size_t n_args, const mp_obj_t *pos_args, mp_ma
     pyb_file_obj_t *file = MP_OBJ_TO_PTR(args[ARG_file].u_obj);
 
     uint8_t chunk_header[14];
-    f_rewind(&file->fp);
+    fat_file_seek(file, 0);
     UINT bytes_read;
-    if (f_read(&file->fp, chunk_header, sizeof(chunk_header), &bytes_read) != FR_OK) {
+    if (fat_file_read(file, chunk_header, sizeof(chunk_header), &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != sizeof(chunk_header) ||
@@ -235,7 +235,7 @@ static mp_obj_t synthio_from_file(size_t n_args, const mp_obj_t *pos_args, mp_ma
         tempo = 2 * ((chunk_header[12] << 8) | chunk_header[13]);
     }
 
-    if (f_read(&file->fp, chunk_header, 8, &bytes_read) != FR_OK) {
+    if (fat_file_read(file, chunk_header, 8, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != 8 || memcmp(chunk_header, "MTrk", 4)) {
@@ -244,7 +244,7 @@ static mp_obj_t synthio_from_file(size_t n_args, const mp_obj_t *pos_args, mp_ma
     uint32_t track_size = (chunk_header[4] << 24) |
         (chunk_header[5] << 16) | (chunk_header[6] << 8) | chunk_header[7];
     uint8_t *buffer = m_malloc_without_collect(track_size);
-    if (f_read(&file->fp, buffer, track_size, &bytes_read) != FR_OK) {
+    if (fat_file_read(file, buffer, track_size, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != track_size) {
@@ -36,9 +36,9 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
     // Load the wave
     self->file = file;
     uint8_t chunk_header[16];
-    f_rewind(&self->file->fp);
+    fat_file_seek(self->file, 0);
     UINT bytes_read;
-    if (f_read(&self->file->fp, chunk_header, 16, &bytes_read) != FR_OK) {
+    if (fat_file_read(self->file, chunk_header, 16, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != 16 ||
@@ -47,7 +47,7 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
         mp_arg_error_invalid(MP_QSTR_file);
     }
     uint32_t format_size;
-    if (f_read(&self->file->fp, &format_size, 4, &bytes_read) != FR_OK) {
+    if (fat_file_read(self->file, &format_size, 4, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != 4 ||
@@ -55,7 +55,7 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
         mp_raise_ValueError(MP_ERROR_TEXT("Invalid format chunk size"));
     }
     struct wave_format_chunk format;
-    if (f_read(&self->file->fp, &format, format_size, &bytes_read) != FR_OK) {
+    if (fat_file_read(self->file, &format, format_size, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     if (bytes_read != format_size) {
@@ -84,7 +84,7 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
     bool found_data_chunk = false;
 
     while (!found_data_chunk) {
-        if (f_read(&self->file->fp, &chunk_tag, 4, &bytes_read) != FR_OK) {
+        if (fat_file_read(self->file, &chunk_tag, 4, &bytes_read) != FR_OK) {
             mp_raise_OSError(MP_EIO);
         }
         if (bytes_read != 4) {
@@ -94,7 +94,7 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
             found_data_chunk = true;
         }
 
-        if (f_read(&self->file->fp, &chunk_length, 4, &bytes_read) != FR_OK) {
+        if (fat_file_read(self->file, &chunk_length, 4, &bytes_read) != FR_OK) {
             mp_raise_OSError(MP_EIO);
         }
         if (bytes_read != 4) {
@@ -102,14 +102,14 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t *self,
         }
 
         if (!found_data_chunk) {
-            if (f_lseek(&self->file->fp, f_tell(&self->file->fp) + chunk_length) != FR_OK) {
+            if (fat_file_seek(self->file, fat_file_tell(self->file) + chunk_length) != FR_OK) {
                 mp_raise_OSError(MP_EIO);
             }
         }
     }
 
     self->file_length = chunk_length;
-    self->data_start = self->file->fp.fptr;
+    self->data_start = fat_file_tell(self->file);
 
     // Try to allocate two buffers, one will be loaded from file and the other
     // DMAed to DAC.
@@ -148,7 +148,7 @@ void audioio_wavefile_reset_buffer(audioio_wavefile_obj_t *self,
     // We don't reset the buffer index in case we're looping and we have an odd number of buffer
     // loads
     self->bytes_remaining = self->file_length;
-    f_lseek(&self->file->fp, self->data_start);
+    fat_file_seek(self->file, self->data_start);
     self->read_count = 0;
     self->left_read_count = 0;
     self->right_read_count = 0;
@@ -187,7 +187,7 @@ audioio_get_buffer_result_t audioio_wavefile_get_buffer(audioio_wavefile_obj_t *
         } else {
             *buffer = self->buffer;
         }
-        if (f_read(&self->file->fp, *buffer, num_bytes_to_load, &length_read) != FR_OK || length_read != num_bytes_to_load) {
+        if (fat_file_read(self->file, *buffer, num_bytes_to_load, &length_read) != FR_OK || length_read != num_bytes_to_load) {
             return GET_BUFFER_ERROR;
         }
         self->bytes_remaining -= length_read;
@@ -7,6 +7,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "py/runtime.h"
@@ -18,7 +19,6 @@
 #include "shared-module/bitmapfilter/macros.h"
 
 #if defined(UNIX)
-#include <stdlib.h>
 #define port_free free
 #define port_malloc(sz, hint) (malloc(sz))
 #define port_realloc(ptr, size, dma_capable) realloc(ptr, size)
@@ -68,17 +68,6 @@ static void *scratchpad_alloc(size_t sz) {
     return scratchpad;
 }
 
-static void scratch_bitmap16(displayio_bitmap_t *buf, int rows, int cols) {
-    int stride = (cols + 1) / 2;
-    size_t sz = rows * stride * sizeof(uint32_t);
-    void *data = scratchpad_alloc(sz);
-    // memset(data, 0, sz);
-    buf->width = cols;
-    buf->height = rows;
-    buf->stride = stride;
-    buf->data = data;
-}
-
 // https://en.wikipedia.org/wiki/YCbCr -> JPEG Conversion
 uint16_t imlib_yuv_to_rgb(uint8_t y, int8_t u, int8_t v) {
     uint32_t r = IM_MAX(IM_MIN(y + ((91881 * v) >> 16), COLOR_R8_MAX), COLOR_R8_MIN);
@@ -88,280 +77,576 @@ uint16_t imlib_yuv_to_rgb(uint8_t y, int8_t u, int8_t v) {
     return COLOR_R8_G8_B8_TO_RGB565(r, g, b);
 }
 
-void shared_module_bitmapfilter_morph(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const int ksize,
-    const int *krn,
-    const mp_float_t m,
-    const mp_float_t b,
-    bool threshold,
-    int offset,
-    bool invert) {
-
-    int brows = ksize + 1;
-
-    const int32_t m_int = (int32_t)MICROPY_FLOAT_C_FUN(round)(65536 * m);
-    const int32_t b_int = (int32_t)MICROPY_FLOAT_C_FUN(round)(65536 * COLOR_G6_MAX * b);
-
-    switch (bitmap->bits_per_value) {
-        default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
-        case 16: {
-            displayio_bitmap_t buf;
-            scratch_bitmap16(&buf, brows, bitmap->width);
+// How a morph kernel is evaluated. A separable kernel is the outer product
+// of a column and a row vector, so it can be applied as a vertical pass and
+// then a horizontal pass in O(k) per pixel; a box kernel additionally uses a
+// running sum for the horizontal pass.
+typedef enum {
+    MORPH_GENERAL,
+    MORPH_SEPARABLE,
+    MORPH_BOX,
+} morph_kind_t;
+
+// Channel sums are accumulated three at a time in one word, with B in bits
+// 0-10, R in bits 11-20 and G in bits 21-31. The fields do not carry into
+// each other as long as the weights are non-negative and add up to at most
+// SWAR_MAX_WEIGHT.
+#define SWAR_MAX_WEIGHT (32)
+#define SWAR_SPREAD(pixel) ((((uint32_t)(pixel) << 16) | (pixel)) & 0x07e0f81f)
+#define SWAR_B(acc) ((acc) & 0x7ff)
+#define SWAR_R(acc) (((acc) >> 11) & 0x3ff)
+#define SWAR_G(acc) ((acc) >> 21)
+
+// A step with its parameters converted to the fixed point form used per pixel.
+typedef struct {
+    bitmapfilter_step_kind_t kind;
+    union {
+        struct {
+            int ksize;
+            const int *krn;
+            morph_kind_t morph_kind;
+            int *col, *row; // separable factors, 2 * ksize + 1 each
+            bool swar; // the column weights are small enough for SWAR_SPREAD sums
+            bool symmetric; // row[ksize - k] == row[ksize + k]
+            int32_t m_int, b_int;
+            bool threshold;
+            int offset;
+            bool invert;
+        } morph;
+        int32_t mix[12];
+        int32_t solarize;
+        const bitmapfilter_lookup_table_t *lookup;
+        uint16_t false_color[256];
+    };
+} bitmapfilter_op_t;
+
+// The steps are split into stages at each morph. A stage produces rows on
+// demand into a ring just deep enough for the next stage's kernel, so a chain
+// of filters makes a single pass over the bitmap.
+typedef struct {
+    const bitmapfilter_op_t *morph; // NULL for the first stage, which reads the bitmap
+    const bitmapfilter_op_t *ops; // point operations applied after the morph
+    size_t n_ops;
+    uint16_t *ring;
+    int ring_rows;
+    int next_row;
+} bitmapfilter_stage_t;
+
+typedef struct {
+    displayio_bitmap_t *bitmap;
+    displayio_bitmap_t *mask;
+    bitmapfilter_stage_t *stages;
+    const uint16_t **rows; // input rows of the morph being computed
+    int32_t *cols; // column sums of a separable morph, with ksize padding at each end
+    int cols_stride;
+} bitmapfilter_pipeline_t;
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
 
-            for (int y = 0, yy = bitmap->height; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y);
-                uint16_t *buf_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows));
+// Find integer vectors with krn == col * row, if there are any. row is made
+// primitive (its entries have no common factor), which forces col to be
+// integers too.
+static bool factor_kernel(const int *krn, int n, int *col, int *row) {
+    int first = 0;
+    while (first < n * n && krn[first] == 0) {
+        first++;
+    }
+    if (first == n * n) {
+        return false;
+    }
+    int j0 = first / n, k0 = first % n;
+    int g = 0;
+    for (int k = 0; k < n; k++) {
+        g = gcd(g, abs(krn[j0 * n + k]));
+    }
+    for (int k = 0; k < n; k++) {
+        row[k] = krn[j0 * n + k] / g;
+    }
+    for (int j = 0; j < n; j++) {
+        if (krn[j * n + k0] % row[k0]) {
+            return false;
+        }
+        col[j] = krn[j * n + k0] / row[k0];
+        for (int k = 0; k < n; k++) {
+            if (krn[j * n + k] != col[j] * row[k]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-                for (int x = 0, xx = bitmap->width; x < xx; x++) {
-                    if (mask && common_hal_displayio_bitmap_get_pixel(mask, x, y)) {
-                        IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                        continue; // Short circuit.
+static void classify_kernel(bitmapfilter_op_t *op) {
+    int n = 2 * op->morph.ksize + 1;
+    const int *krn = op->morph.krn;
+    int *col = op->morph.col, *row = op->morph.row;
 
-                    }
-                    int32_t r_acc = 0, g_acc = 0, b_acc = 0, ptr = 0;
-
-                    if (x >= ksize && x < bitmap->width - ksize && y >= ksize && y < bitmap->height - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y + j);
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x + k);
-                                r_acc += krn[ptr] * COLOR_RGB565_TO_R5(pixel);
-                                g_acc += krn[ptr] * COLOR_RGB565_TO_G6(pixel);
-                                b_acc += krn[ptr++] * COLOR_RGB565_TO_B5(pixel);
-                            }
-                        }
-                    } else {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap,
-                                IM_MIN(IM_MAX(y + j, 0), (bitmap->height - 1)));
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr,
-                                    IM_MIN(IM_MAX(x + k, 0), (bitmap->width - 1)));
-                                r_acc += krn[ptr] * COLOR_RGB565_TO_R5(pixel);
-                                g_acc += krn[ptr] * COLOR_RGB565_TO_G6(pixel);
-                                b_acc += krn[ptr++] * COLOR_RGB565_TO_B5(pixel);
-                            }
-                        }
-                    }
-                    r_acc = (r_acc * m_int + b_int) >> 16;
-                    if (r_acc > COLOR_R5_MAX) {
-                        r_acc = COLOR_R5_MAX;
-                    } else if (r_acc < 0) {
-                        r_acc = 0;
-                    }
-                    g_acc = (g_acc * m_int + b_int * 2) >> 16;
-                    if (g_acc > COLOR_G6_MAX) {
-                        g_acc = COLOR_G6_MAX;
-                    } else if (g_acc < 0) {
-                        g_acc = 0;
-                    }
-                    b_acc = (b_acc * m_int + b_int) >> 16;
-                    if (b_acc > COLOR_B5_MAX) {
-                        b_acc = COLOR_B5_MAX;
-                    } else if (b_acc < 0) {
-                        b_acc = 0;
-                    }
+    op->morph.morph_kind = MORPH_GENERAL;
+    if (!factor_kernel(krn, n, col, row)) {
+        return;
+    }
+    op->morph.morph_kind = MORPH_SEPARABLE;
 
-                    int pixel = COLOR_R5_G6_B5_TO_RGB565(r_acc, g_acc, b_acc);
+    bool box = true;
+    for (int i = 1; i < n * n; i++) {
+        box = box && krn[i] == krn[0];
+    }
+    if (box) {
+        // Sum plain columns and rows, then scale by the common weight.
+        op->morph.morph_kind = MORPH_BOX;
+        for (int i = 0; i < n; i++) {
+            col[i] = row[i] = 1;
+        }
+    }
 
-                    if (threshold) {
-                        if (((COLOR_RGB565_TO_Y(pixel) - offset) < COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x))) ^ invert) {
-                            pixel = COLOR_RGB565_BINARY_MAX;
-                        } else {
-                            pixel = COLOR_RGB565_BINARY_MIN;
-                        }
-                    }
+    int col_sum = 0;
+    op->morph.swar = true;
+    for (int j = 0; j < n; j++) {
+        op->morph.swar = op->morph.swar && col[j] >= 0;
+        col_sum += abs(col[j]);
+    }
+    op->morph.swar = op->morph.swar && col_sum <= SWAR_MAX_WEIGHT;
 
-                    IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
-                }
+    op->morph.symmetric = true;
+    for (int k = 0; k < n; k++) {
+        op->morph.symmetric = op->morph.symmetric && row[k] == row[n - 1 - k];
+    }
+}
 
-                if (y >= ksize) {     // Transfer buffer lines...
-                    memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, (y - ksize)),
-                        IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, ((y - ksize) % brows)),
-                        IMAGE_RGB565_LINE_LEN_BYTES(bitmap));
-                }
+// factors has room for the separable factors of a morph kernel.
+static void prepare_op(bitmapfilter_op_t *op, const bitmapfilter_step_t *step, int *factors) {
+    op->kind = step->kind;
+    switch (step->kind) {
+        case BITMAPFILTER_STEP_MORPH:
+            op->morph.ksize = step->morph.ksize;
+            op->morph.krn = step->morph.krn;
+            op->morph.col = factors;
+            op->morph.row = factors + 2 * step->morph.ksize + 1;
+            classify_kernel(op);
+            op->morph.m_int = (int32_t)MICROPY_FLOAT_C_FUN(round)(65536 * step->morph.m);
+            op->morph.b_int = (int32_t)MICROPY_FLOAT_C_FUN(round)(65536 * COLOR_G6_MAX * step->morph.b);
+            op->morph.threshold = step->morph.threshold;
+            op->morph.offset = step->morph.offset;
+            op->morph.invert = step->morph.invert;
+            break;
+        case BITMAPFILTER_STEP_MIX:
+            for (int i = 0; i < 12; i++) {
+                // The different scale factors correct for G having 6 bits while R, G have 5
+                // by doubling the scale for R/B->G and halving the scale for G->R/B.
+                // As well, the final value in each row has to be scaled up by the
+                // component's maxval.
+                int scale =
+                    (i == 1 || i == 9) ? 32768 : // Mixing G into R/B
+                    (i == 4 || i == 6) ? 131072 : // Mixing R/B into G
+                    (i == 3 || i == 11) ? 65535 * COLOR_B5_MAX : // Offset for R/B
+                    (i == 7) ? 65535 * COLOR_G6_MAX : // Offset for G
+                    65536;
+                op->mix[i] = (int32_t)MICROPY_FLOAT_C_FUN(round)(scale * step->mix[i]);
             }
+            break;
+        case BITMAPFILTER_STEP_SOLARIZE:
+            op->solarize = (int32_t)MICROPY_FLOAT_C_FUN(round)(256 * step->solarize);
+            break;
+        case BITMAPFILTER_STEP_LOOKUP:
+            op->lookup = step->lookup;
+            break;
+        case BITMAPFILTER_STEP_FALSE_COLOR:
+            for (int i = 0; i < 256; i++) {
+                uint32_t rgb888 = step->false_color[i].rgb888;
+                int r = rgb888 >> 16;
+                int g = (rgb888 >> 8) & 0xff;
+                int b = rgb888 & 0xff;
+                op->false_color[i] = COLOR_R8_G8_B8_TO_RGB565(r, g, b);
+            }
+            break;
+    }
+}
 
-            // Copy any remaining lines from the buffer image...
-            for (int y = IM_MAX(bitmap->height - ksize, 0), yy = bitmap->height; y < yy; y++) {
-                memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y),
-                    IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows)),
-                    IMAGE_RGB565_LINE_LEN_BYTES(bitmap));
+static int apply_point_op(const bitmapfilter_op_t *op, int pixel) {
+    switch (op->kind) {
+        case BITMAPFILTER_STEP_MIX: {
+            const int32_t *wt = op->mix;
+            int r = COLOR_RGB565_TO_R5(pixel);
+            int g = COLOR_RGB565_TO_G6(pixel);
+            int b = COLOR_RGB565_TO_B5(pixel);
+            int32_t r_acc = (r * wt[0] + g * wt[1] + b * wt[2] + wt[3]) >> 16;
+            int32_t g_acc = (r * wt[4] + g * wt[5] + b * wt[6] + wt[7]) >> 16;
+            int32_t b_acc = (r * wt[8] + g * wt[9] + b * wt[10] + wt[11]) >> 16;
+            r_acc = IM_MIN(IM_MAX(r_acc, 0), COLOR_R5_MAX);
+            g_acc = IM_MIN(IM_MAX(g_acc, 0), COLOR_G6_MAX);
+            b_acc = IM_MIN(IM_MAX(b_acc, 0), COLOR_B5_MAX);
+            return COLOR_R5_G6_B5_TO_RGB565(r_acc, g_acc, b_acc);
+        }
+        case BITMAPFILTER_STEP_SOLARIZE: {
+            int y = COLOR_RGB565_TO_Y(pixel);
+            if (y > op->solarize) {
+                y = MIN(255, MAX(0, 2 * op->solarize - y));
+                int u = COLOR_RGB565_TO_U(pixel);
+                int v = COLOR_RGB565_TO_V(pixel);
+                pixel = COLOR_YUV_TO_RGB565(y, u, v);
             }
+            return pixel;
+        }
+        case BITMAPFILTER_STEP_LOOKUP: {
+            const bitmapfilter_lookup_table_t *table = op->lookup;
+            int r = table->r[COLOR_RGB565_TO_R5(pixel)];
+            int g = table->g[COLOR_RGB565_TO_G6(pixel)];
+            int b = table->b[COLOR_RGB565_TO_B5(pixel)];
+            return COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+        }
+        case BITMAPFILTER_STEP_FALSE_COLOR:
+            return op->false_color[COLOR_RGB565_TO_Y(pixel)];
+        default:
+            return pixel;
+    }
+}
 
-            break;
+// Each pixel is loaded and stored once however many point operations there are.
+static void point_ops_row(const bitmapfilter_pipeline_t *p, const bitmapfilter_stage_t *s, uint16_t *row_ptr, int y) {
+    if (s->n_ops == 0) {
+        return;
+    }
+    for (int x = 0, xx = p->bitmap->width; x < xx; x++) {
+        if (p->mask && common_hal_displayio_bitmap_get_pixel(p->mask, x, y)) {
+            continue; // Short circuit.
+        }
+        int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
+        for (size_t i = 0; i < s->n_ops; i++) {
+            pixel = apply_point_op(&s->ops[i], pixel);
         }
+        IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
     }
 }
 
-void shared_module_bitmapfilter_mix(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const mp_float_t weights[12]) {
-
-    int wt[12];
-    for (int i = 0; i < 12; i++) {
-        // The different scale factors correct for G having 6 bits while R, G have 5
-        // by doubling the scale for R/B->G and halving the scale for G->R/B.
-        // As well, the final value in each row has to be scaled up by the
-        // component's maxval.
-        int scale =
-            (i == 1 || i == 9) ? 32768 : // Mixing G into R/B
-            (i == 4 || i == 6) ? 131072 : // Mixing R/B into G
-            (i == 3 || i == 11) ? 65535 * COLOR_B5_MAX : // Offset for R/B
-            (i == 7) ? 65535 * COLOR_G6_MAX : // Offset for G
-            65536;
-        wt[i] = (int32_t)MICROPY_FLOAT_C_FUN(round)(scale * weights[i]);
+// Scale the channel sums of a morph and store the resulting pixel.
+static inline void morph_put_pixel(const bitmapfilter_op_t *op, uint16_t *buf_row_ptr, int x,
+    int32_t r_acc, int32_t g_acc, int32_t b_acc, int center) {
+    const int32_t m_int = op->morph.m_int, b_int = op->morph.b_int;
+    r_acc = (r_acc * m_int + b_int) >> 16;
+    if (r_acc > COLOR_R5_MAX) {
+        r_acc = COLOR_R5_MAX;
+    } else if (r_acc < 0) {
+        r_acc = 0;
+    }
+    g_acc = (g_acc * m_int + b_int * 2) >> 16;
+    if (g_acc > COLOR_G6_MAX) {
+        g_acc = COLOR_G6_MAX;
+    } else if (g_acc < 0) {
+        g_acc = 0;
+    }
+    b_acc = (b_acc * m_int + b_int) >> 16;
+    if (b_acc > COLOR_B5_MAX) {
+        b_acc = COLOR_B5_MAX;
+    } else if (b_acc < 0) {
+        b_acc = 0;
     }
 
-    switch (bitmap->bits_per_value) {
-        default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
-        case 16: {
-            for (int y = 0, yy = bitmap->height; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y);
-                for (int x = 0, xx = bitmap->width; x < xx; x++) {
-                    if (mask && common_hal_displayio_bitmap_get_pixel(mask, x, y)) {
-                        continue; // Short circuit.
-                    }
-                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                    int32_t r_acc = 0, g_acc = 0, b_acc = 0;
-                    int r = COLOR_RGB565_TO_R5(pixel);
-                    int g = COLOR_RGB565_TO_G6(pixel);
-                    int b = COLOR_RGB565_TO_B5(pixel);
-                    r_acc = r * wt[0] + g * wt[1] + b * wt[2] + wt[3];
-                    r_acc >>= 16;
-                    if (r_acc < 0) {
-                        r_acc = 0;
-                    } else if (r_acc > COLOR_R5_MAX) {
-                        r_acc = COLOR_R5_MAX;
-                    }
+    int pixel = COLOR_R5_G6_B5_TO_RGB565(r_acc, g_acc, b_acc);
 
-                    g_acc = r * wt[4] + g * wt[5] + b * wt[6] + wt[7];
-                    g_acc >>= 16;
-                    if (g_acc < 0) {
-                        g_acc = 0;
-                    } else if (g_acc > COLOR_G6_MAX) {
-                        g_acc = COLOR_G6_MAX;
-                    }
+    if (op->morph.threshold) {
+        if (((COLOR_RGB565_TO_Y(pixel) - op->morph.offset) < COLOR_RGB565_TO_Y(center)) ^ op->morph.invert) {
+            pixel = COLOR_RGB565_BINARY_MAX;
+        } else {
+            pixel = COLOR_RGB565_BINARY_MIN;
+        }
+    }
 
-                    b_acc = r * wt[8] + g * wt[9] + b * wt[10] + wt[11];
-                    b_acc >>= 16;
-                    if (b_acc < 0) {
-                        b_acc = 0;
-                    } else if (b_acc > COLOR_B5_MAX) {
-                        b_acc = COLOR_B5_MAX;
-                    }
+    IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
+}
 
-                    pixel = COLOR_R5_G6_B5_TO_RGB565(r_acc, g_acc, b_acc);
-                    IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
+static inline bool morph_masked(const bitmapfilter_pipeline_t *p, const uint16_t *row_ptr, uint16_t *buf_row_ptr, int x, int y) {
+    if (p->mask && common_hal_displayio_bitmap_get_pixel(p->mask, x, y)) {
+        buf_row_ptr[x] = row_ptr[x];
+        return true;
+    }
+    return false;
+}
+
+// rows[] holds the 2 * ksize + 1 input rows centered on y, already clamped to the image.
+static void morph_row_general(const bitmapfilter_pipeline_t *p, const bitmapfilter_op_t *op, const uint16_t **rows, uint16_t *buf_row_ptr, int y) {
+    const int ksize = op->morph.ksize;
+    const int *krn = op->morph.krn;
+    const uint16_t *row_ptr = rows[ksize];
+    const int width = p->bitmap->width;
+
+    for (int x = 0; x < width; x++) {
+        if (morph_masked(p, row_ptr, buf_row_ptr, x, y)) {
+            continue; // Short circuit.
+        }
+        int32_t r_acc = 0, g_acc = 0, b_acc = 0, ptr = 0;
+
+        if (x >= ksize && x < width - ksize) {
+            for (int j = 0; j <= 2 * ksize; j++) {
+                const uint16_t *k_row_ptr = rows[j];
+                for (int k = -ksize; k <= ksize; k++) {
+                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x + k);
+                    r_acc += krn[ptr] * COLOR_RGB565_TO_R5(pixel);
+                    g_acc += krn[ptr] * COLOR_RGB565_TO_G6(pixel);
+                    b_acc += krn[ptr++] * COLOR_RGB565_TO_B5(pixel);
+                }
+            }
+        } else {
+            for (int j = 0; j <= 2 * ksize; j++) {
+                const uint16_t *k_row_ptr = rows[j];
+                for (int k = -ksize; k <= ksize; k++) {
+                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr,
+                        IM_MIN(IM_MAX(x + k, 0), (width - 1)));
+                    r_acc += krn[ptr] * COLOR_RGB565_TO_R5(pixel);
+                    g_acc += krn[ptr] * COLOR_RGB565_TO_G6(pixel);
+                    b_acc += krn[ptr++] * COLOR_RGB565_TO_B5(pixel);
                 }
             }
-            break;
         }
+        morph_put_pixel(op, buf_row_ptr, x, r_acc, g_acc, b_acc, IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
     }
 }
 
-void shared_module_bitmapfilter_solarize(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const mp_float_t threshold) {
+// Vertical pass of a separable morph: weighted sums down each column, one
+// array per channel, with copies of the edge columns at each end so the
+// horizontal pass needs no clamping.
+static void morph_columns(const bitmapfilter_pipeline_t *p, const bitmapfilter_op_t *op, const uint16_t **rows,
+    int32_t *r_col, int32_t *g_col, int32_t *b_col) {
+    const int n = 2 * op->morph.ksize + 1;
+    const int *col = op->morph.col;
+    const int width = p->bitmap->width;
+
+    if (op->morph.swar) {
+        for (int x = 0; x < width; x++) {
+            uint32_t acc = 0;
+            for (int j = 0; j < n; j++) {
+                // The byte swap of RGB565_SWAPPED is undone once per pixel,
+                // then all three channels are weighted in one multiply.
+                acc += col[j] * SWAR_SPREAD(IMAGE_GET_RGB565_PIXEL_FAST(rows[j], x));
+            }
+            r_col[x] = SWAR_R(acc);
+            g_col[x] = SWAR_G(acc);
+            b_col[x] = SWAR_B(acc);
+        }
+    } else {
+        for (int x = 0; x < width; x++) {
+            int32_t r_acc = 0, g_acc = 0, b_acc = 0;
+            for (int j = 0; j < n; j++) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(rows[j], x);
+                r_acc += col[j] * COLOR_RGB565_TO_R5(pixel);
+                g_acc += col[j] * COLOR_RGB565_TO_G6(pixel);
+                b_acc += col[j] * COLOR_RGB565_TO_B5(pixel);
+            }
+            r_col[x] = r_acc;
+            g_col[x] = g_acc;
+            b_col[x] = b_acc;
+        }
+    }
 
-    int threshold_i = (int32_t)MICROPY_FLOAT_C_FUN(round)(256 * threshold);
-    switch (bitmap->bits_per_value) {
-        default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
-        case 16: {
-            for (int y = 0, yy = bitmap->height; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y);
-                for (int x = 0, xx = bitmap->width; x < xx; x++) {
-                    if (mask && common_hal_displayio_bitmap_get_pixel(mask, x, y)) {
-                        continue; // Short circuit.
-                    }
-                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                    int y = COLOR_RGB565_TO_Y(pixel);
-                    if (y > threshold_i) {
-                        y = MIN(255, MAX(0, 2 * threshold_i - y));
-                        int u = COLOR_RGB565_TO_U(pixel);
-                        int v = COLOR_RGB565_TO_V(pixel);
-                        pixel = COLOR_YUV_TO_RGB565(y, u, v);
-                        IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
-                    }
-                }
+    for (int k = 1; k <= op->morph.ksize; k++) {
+        r_col[-k] = r_col[0];
+        g_col[-k] = g_col[0];
+        b_col[-k] = b_col[0];
+    }
+    // One more on the right, where the box running sum reads past the end.
+    for (int k = 1; k <= op->morph.ksize + 1; k++) {
+        r_col[width - 1 + k] = r_col[width - 1];
+        g_col[width - 1 + k] = g_col[width - 1];
+        b_col[width - 1 + k] = b_col[width - 1];
+    }
+}
+
+static void morph_row_separable(const bitmapfilter_pipeline_t *p, const bitmapfilter_op_t *op, const uint16_t **rows, uint16_t *buf_row_ptr, int y) {
+    const int ksize = op->morph.ksize;
+    const int *row = op->morph.row + ksize; // row[-ksize..ksize]
+    const uint16_t *row_ptr = rows[ksize];
+    const int width = p->bitmap->width;
+    int32_t *r_col = p->cols + ksize;
+    int32_t *g_col = r_col + p->cols_stride;
+    int32_t *b_col = g_col + p->cols_stride;
+
+    morph_columns(p, op, rows, r_col, g_col, b_col);
+
+    for (int x = 0; x < width; x++) {
+        if (morph_masked(p, row_ptr, buf_row_ptr, x, y)) {
+            continue; // Short circuit.
+        }
+        int32_t r_acc = row[0] * r_col[x];
+        int32_t g_acc = row[0] * g_col[x];
+        int32_t b_acc = row[0] * b_col[x];
+        if (op->morph.symmetric) {
+            // Symmetric kernels such as gaussians need half the multiplies.
+            for (int k = 1; k <= ksize; k++) {
+                r_acc += row[k] * (r_col[x - k] + r_col[x + k]);
+                g_acc += row[k] * (g_col[x - k] + g_col[x + k]);
+                b_acc += row[k] * (b_col[x - k] + b_col[x + k]);
+            }
+        } else {
+            for (int k = 1; k <= ksize; k++) {
+                r_acc += row[-k] * r_col[x - k] + row[k] * r_col[x + k];
+                g_acc += row[-k] * g_col[x - k] + row[k] * g_col[x + k];
+                b_acc += row[-k] * b_col[x - k] + row[k] * b_col[x + k];
             }
-            break;
         }
+        morph_put_pixel(op, buf_row_ptr, x, r_acc, g_acc, b_acc, IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
     }
 }
 
-void shared_module_bitmapfilter_lookup(
-    displayio_bitmap_t *bitmap,
-    displayio_bitmap_t *mask,
-    const bitmapfilter_lookup_table_t *table) {
+// A box kernel sums a window that moves along the row, so each output pixel
+// costs one add and one subtract regardless of the kernel size.
+static void morph_row_box(const bitmapfilter_pipeline_t *p, const bitmapfilter_op_t *op, const uint16_t **rows, uint16_t *buf_row_ptr, int y) {
+    const int ksize = op->morph.ksize;
+    const int weight = op->morph.krn[0];
+    const uint16_t *row_ptr = rows[ksize];
+    const int width = p->bitmap->width;
+    int32_t *r_col = p->cols + ksize;
+    int32_t *g_col = r_col + p->cols_stride;
+    int32_t *b_col = g_col + p->cols_stride;
+
+    morph_columns(p, op, rows, r_col, g_col, b_col);
+
+    int32_t r_sum = 0, g_sum = 0, b_sum = 0;
+    for (int k = -ksize; k <= ksize; k++) {
+        r_sum += r_col[k];
+        g_sum += g_col[k];
+        b_sum += b_col[k];
+    }
+    for (int x = 0; x < width; x++) {
+        if (!morph_masked(p, row_ptr, buf_row_ptr, x, y)) {
+            morph_put_pixel(op, buf_row_ptr, x, r_sum * weight, g_sum * weight, b_sum * weight,
+                IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+        }
+        r_sum += r_col[x + ksize + 1] - r_col[x - ksize];
+        g_sum += g_col[x + ksize + 1] - g_col[x - ksize];
+        b_sum += b_col[x + ksize + 1] - b_col[x - ksize];
+    }
+}
 
-    switch (bitmap->bits_per_value) {
+static void morph_row(const bitmapfilter_pipeline_t *p, const bitmapfilter_op_t *op, const uint16_t **rows, uint16_t *buf_row_ptr, int y) {
+    switch (op->morph.morph_kind) {
+        case MORPH_BOX:
+            morph_row_box(p, op, rows, buf_row_ptr, y);
+            break;
+        case MORPH_SEPARABLE:
+            morph_row_separable(p, op, rows, buf_row_ptr, y);
+            break;
         default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
-        case 16: {
-            for (int y = 0, yy = bitmap->height; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y);
-                for (int x = 0, xx = bitmap->width; x < xx; x++) {
-                    if (mask && common_hal_displayio_bitmap_get_pixel(mask, x, y)) {
-                        continue; // Short circuit.
-                    }
-                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                    int r = COLOR_RGB565_TO_R5(pixel);
-                    int g = COLOR_RGB565_TO_G6(pixel);
-                    int b = COLOR_RGB565_TO_B5(pixel);
-
-                    r = table->r[r];
-                    g = table->g[g];
-                    b = table->b[b];
+            morph_row_general(p, op, rows, buf_row_ptr, y);
+            break;
+    }
+}
 
-                    pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
-                    IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
-                }
+// Return row y of stage si, computing any rows up to it that are not ready
+// yet. Rows are produced in order, and a ring keeps the last ring_rows of
+// them for the following morph.
+static const uint16_t *stage_row(const bitmapfilter_pipeline_t *p, size_t si, int y) {
+    bitmapfilter_stage_t *s = &p->stages[si];
+    int width = p->bitmap->width;
+    y = IM_MIN(IM_MAX(y, 0), p->bitmap->height - 1);
+    while (s->next_row <= y) {
+        int r = s->next_row++;
+        uint16_t *out = s->ring + (r % s->ring_rows) * width;
+        if (!s->morph) {
+            memcpy(out, IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(p->bitmap, r), width * sizeof(uint16_t));
+        } else {
+            int ksize = s->morph->morph.ksize;
+            // Bring the previous stage up to date first, as doing so can
+            // reuse p->rows for its own morph.
+            stage_row(p, si - 1, r + ksize);
+            for (int j = -ksize; j <= ksize; j++) {
+                p->rows[j + ksize] = stage_row(p, si - 1, r + j);
             }
-            break;
+            morph_row(p, s->morph, p->rows, out, r);
         }
+        point_ops_row(p, s, out, r);
     }
+    return s->ring + (y % s->ring_rows) * width;
 }
 
-void shared_module_bitmapfilter_false_color(
+void shared_module_bitmapfilter_pipeline(
     displayio_bitmap_t *bitmap,
     displayio_bitmap_t *mask,
-    _displayio_color_t palette[256]) {
+    const bitmapfilter_step_t *steps,
+    size_t n_steps) {
+    displayio_bitmap_check_writable(bitmap);
 
-    uint16_t table[256];
-    for (int i = 0; i < 256; i++) {
-        uint32_t rgb888 = palette[i].rgb888;
-        int r = rgb888 >> 16;
-        int g = (rgb888 >> 8) & 0xff;
-        int b = rgb888 & 0xff;
-        table[i] = COLOR_R8_G8_B8_TO_RGB565(r, g, b);
+    if (bitmap->bits_per_value != 16) {
+        mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
     }
 
-    switch (bitmap->bits_per_value) {
-        default:
-            mp_raise_ValueError(MP_ERROR_TEXT("unsupported bitmap depth"));
-        case 16: {
-            for (int y = 0, yy = bitmap->height; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y);
-                for (int x = 0, xx = bitmap->width; x < xx; x++) {
-                    if (mask && common_hal_displayio_bitmap_get_pixel(mask, x, y)) {
-                        continue; // Short circuit.
-                    }
-                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                    int y = COLOR_RGB565_TO_Y(pixel);
-                    pixel = table[y];
-                    IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
-                }
-            }
+    size_t n_stages = 1;
+    int max_ksize = 0;
+    for (size_t i = 0; i < n_steps; i++) {
+        if (steps[i].kind == BITMAPFILTER_STEP_MORPH) {
+            n_stages++;
+            max_ksize = IM_MAX(max_ksize, steps[i].morph.ksize);
+        }
+    }
+
+    // The ring of each stage but the last is sized for the kernel of the
+    // morph that consumes it, so the scratch space is proportional to the
+    // kernel heights rather than to the bitmap.
+    int width = bitmap->width;
+    size_t kernel_rows = 0;
+    for (size_t i = 0; i < n_steps; i++) {
+        if (steps[i].kind == BITMAPFILTER_STEP_MORPH) {
+            kernel_rows += 2 * steps[i].morph.ksize + 1;
+        }
+    }
+    size_t ring_rows = kernel_rows + (n_stages > 1 ? 1 : 0);
+    size_t ops_size = n_steps * sizeof(bitmapfilter_op_t);
+    size_t stages_size = n_stages * sizeof(bitmapfilter_stage_t);
+    size_t rows_size = (2 * max_ksize + 1) * sizeof(uint16_t *);
+    size_t factors_size = 2 * kernel_rows * sizeof(int);
+    int cols_stride = width + 2 * max_ksize + 1;
+    size_t cols_size = n_stages > 1 ? 3 * cols_stride * sizeof(int32_t) : 0;
+    uint8_t *scratch = scratchpad_alloc(ops_size + stages_size + rows_size + factors_size + cols_size + ring_rows * width * sizeof(uint16_t));
+
+    bitmapfilter_op_t *ops = (bitmapfilter_op_t *)scratch;
+    bitmapfilter_pipeline_t p = {
+        .bitmap = bitmap,
+        .mask = mask,
+        .stages = (bitmapfilter_stage_t *)(scratch + ops_size),
+        .rows = (const uint16_t **)(scratch + ops_size + stages_size),
+        .cols = (int32_t *)(scratch + ops_size + stages_size + rows_size + factors_size),
+        .cols_stride = cols_stride,
+    };
+    int *factors = (int *)(scratch + ops_size + stages_size + rows_size);
+    uint16_t *ring = (uint16_t *)(scratch + ops_size + stages_size + rows_size + factors_size + cols_size);
+
+    bitmapfilter_stage_t *s = p.stages;
+    *s = (bitmapfilter_stage_t) { .ops = ops };
+    for (size_t i = 0; i < n_steps; i++) {
+        prepare_op(&ops[i], &steps[i], factors);
+        if (ops[i].kind == BITMAPFILTER_STEP_MORPH) {
+            factors += 2 * (2 * ops[i].morph.ksize + 1);
+            s->ring = ring;
+            s->ring_rows = 2 * ops[i].morph.ksize + 1;
+            ring += s->ring_rows * width;
+            s++;
+            *s = (bitmapfilter_stage_t) { .morph = &ops[i], .ops = &ops[i + 1] };
+        } else {
+            s->n_ops++;
         }
     }
+
+    if (n_stages == 1) {
+        // Only point operations, which can be done in place.
+        for (int y = 0, yy = bitmap->height; y < yy; y++) {
+            point_ops_row(&p, s, IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y), y);
+        }
+        return;
+    }
+
+    s->ring = ring;
+    s->ring_rows = 1;
+    // By the time output row y is ready, the first stage has already read
+    // every bitmap row it needs up to y, so it can be stored back in place.
+    for (int y = 0, yy = bitmap->height; y < yy; y++) {
+        memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(bitmap, y), stage_row(&p, n_stages - 1, y),
+            IMAGE_RGB565_LINE_LEN_BYTES(bitmap));
+    }
 }
 
 void shared_module_bitmapfilter_blend_precompute(mp_obj_t fun, uint8_t lookup[4096]) {
@@ -385,6 +670,7 @@ void shared_module_bitmapfilter_blend(
     displayio_bitmap_t *src2,
     displayio_bitmap_t *mask,
     const uint8_t lookup[4096]) {
+    displayio_bitmap_check_writable(bitmap);
 
     check_matching_details(bitmap, src1);
     check_matching_details(bitmap, src2);
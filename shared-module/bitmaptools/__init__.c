@@ -23,6 +23,81 @@
 #define BITMAP_DEBUG(...) (void)0
 // #define BITMAP_DEBUG(...) mp_printf(&mp_plat_print, __VA_ARGS__)
 
+// Pixel access for inner loops, with the row already looked up and the
+// coordinates already clipped.
+static inline uint32_t row_get_pixel(const displayio_bitmap_t *bitmap, const uint32_t *row, int16_t x) {
+    switch (bitmap->bits_per_value) {
+        case 8:
+            return ((const uint8_t *)row)[x];
+        case 16:
+            return ((const uint16_t *)row)[x];
+        case 32:
+            return row[x];
+        default: {
+            uint8_t bits = ((const uint8_t *)row)[x >> bitmap->x_shift];
+            uint8_t bit_position = (8 / bitmap->bits_per_value - (x & bitmap->x_mask) - 1) * bitmap->bits_per_value;
+            return (bits >> bit_position) & bitmap->bitmask;
+        }
+    }
+}
+
+static inline void row_put_pixel(const displayio_bitmap_t *bitmap, uint32_t *row, int16_t x, uint32_t value) {
+    switch (bitmap->bits_per_value) {
+        case 8:
+            ((uint8_t *)row)[x] = value;
+            break;
+        case 16:
+            ((uint16_t *)row)[x] = value;
+            break;
+        case 32:
+            row[x] = value;
+            break;
+        default: {
+            uint8_t *data = ((uint8_t *)row) + (x >> bitmap->x_shift);
+            uint8_t bit_position = (8 / bitmap->bits_per_value - (x & bitmap->x_mask) - 1) * bitmap->bits_per_value;
+            *data = (*data & ~(bitmap->bitmask << bit_position)) | ((value & bitmap->bitmask) << bit_position);
+            break;
+        }
+    }
+}
+
+static int32_t rotozoom_fixed(mp_float_t value) {
+    return (int32_t)MICROPY_FLOAT_C_FUN(floor)(value * 65536 + MICROPY_FLOAT_CONST(0.5));
+}
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) {
+        q--;
+    }
+    return q;
+}
+
+// Narrows the steps [*first, *last] along a row to those where
+// min <= start + step * k < max. Returns false if none are left.
+static bool rotozoom_span(int64_t start, int32_t step, int64_t min, int64_t max, int32_t *first, int32_t *last) {
+    int64_t lo, hi;
+    if (step == 0) {
+        if (start < min || start >= max) {
+            return false;
+        }
+        return *first <= *last;
+    } else if (step > 0) {
+        lo = -floor_div(start - min, step);
+        hi = -floor_div(start - max, step) - 1;
+    } else {
+        lo = floor_div(start - max, -step) + 1;
+        hi = floor_div(start - min, -step);
+    }
+    if (lo > *first) {
+        *first = lo > *last ? *last + 1 : lo;
+    }
+    if (hi < *last) {
+        *last = hi < *first ? *first - 1 : hi;
+    }
+    return *first <= *last;
+}
+
 void common_hal_bitmaptools_rotozoom(displayio_bitmap_t *self, int16_t ox, int16_t oy,
     int16_t dest_clip0_x, int16_t dest_clip0_y,
     int16_t dest_clip1_x, int16_t dest_clip1_y,
@@ -32,6 +107,7 @@ void common_hal_bitmaptools_rotozoom(displayio_bitmap_t *self, int16_t ox, int16
     mp_float_t angle,
     mp_float_t scale,
     uint32_t skip_index, bool skip_index_none) {
+    displayio_bitmap_check_writable(self);
 
     // Copies region from source to the destination bitmap, including rotation,
     // scaling and clipping of either the source or destination regions
@@ -171,6 +247,11 @@ void common_hal_bitmaptools_rotozoom(displayio_bitmap_t *self, int16_t ox, int16
         maxy = dest_clip1_y - 1;
     }
 
+    // The clip regions have been constrained to the bitmaps already.
+    if (minx > maxx || miny > maxy) {
+        return;
+    }
+
     mp_float_t dvCol = cosAngle / scale;
     mp_float_t duCol = sinAngle / scale;
 
@@ -186,21 +267,65 @@ void common_hal_bitmaptools_rotozoom(displayio_bitmap_t *self, int16_t ox, int16
     displayio_area_t dirty_area = {minx, miny, maxx + 1, maxy + 1, NULL};
     displayio_bitmap_set_dirty_area(self, &dirty_area);
 
+    // Along a row the source position moves by a fixed step, so it is
+    // stepped in 16.16 fixed point. Each row starts again from the floating
+    // point position so rounding can't build up down the bitmap.
+    int32_t du = rotozoom_fixed(duRow);
+    int32_t dv = rotozoom_fixed(dvRow);
+    int64_t clip0_u = (int64_t)source_clip0_x << 16;
+    int64_t clip1_u = (int64_t)source_clip1_x << 16;
+    int64_t clip0_v = (int64_t)source_clip0_y << 16;
+    int64_t clip1_v = (int64_t)source_clip1_y << 16;
+    // Values are at most 16 bits wide for the specialised loops, so this
+    // never matches one.
+    uint32_t skip = skip_index_none ? 0xffffffff : skip_index;
+
     for (y = miny; y <= maxy; y++) {
-        mp_float_t u = rowu + minx * duRow;
-        mp_float_t v = rowv + minx * dvRow;
-        for (x = minx; x <= maxx; x++) {
-            if (u >= source_clip0_x && u < source_clip1_x && v >= source_clip0_y && v < source_clip1_y) {
-                uint32_t c = common_hal_displayio_bitmap_get_pixel(source, (int)u, (int)v);
-                if ((skip_index_none) || (c != skip_index)) {
-                    displayio_bitmap_write_pixel(self, x, y, c);
+        int64_t row_start_u = rotozoom_fixed(rowu + minx * duRow);
+        int64_t row_start_v = rotozoom_fixed(rowv + minx * dvRow);
+        rowu += duCol;
+        rowv += dvCol;
+
+        // Only sample the part of the row that lands inside the source clip.
+        int32_t first = 0;
+        int32_t last = maxx - minx;
+        if (!rotozoom_span(row_start_u, du, clip0_u, clip1_u, &first, &last) ||
+            !rotozoom_span(row_start_v, dv, clip0_v, clip1_v, &first, &last)) {
+            continue;
+        }
+        int32_t u = row_start_u + (int64_t)first * du;
+        int32_t v = row_start_v + (int64_t)first * dv;
+        int16_t x_end = minx + last;
+        uint32_t *dest_row = self->data + y * self->stride;
+
+        if (source->bits_per_value == 8 && self->bits_per_value == 8) {
+            const uint8_t *src = (const uint8_t *)source->data;
+            size_t src_stride = source->stride * sizeof(uint32_t);
+            uint8_t *dest = (uint8_t *)dest_row;
+            for (x = minx + first; x <= x_end; x++, u += du, v += dv) {
+                uint8_t c = src[(v >> 16) * src_stride + (u >> 16)];
+                if (c != skip) {
+                    dest[x] = c;
+                }
+            }
+        } else if (source->bits_per_value == 16 && self->bits_per_value == 16) {
+            const uint16_t *src = (const uint16_t *)source->data;
+            size_t src_stride = source->stride * sizeof(uint32_t) / sizeof(uint16_t);
+            uint16_t *dest = (uint16_t *)dest_row;
+            for (x = minx + first; x <= x_end; x++, u += du, v += dv) {
+                uint16_t c = src[(v >> 16) * src_stride + (u >> 16)];
+                if (c != skip) {
+                    dest[x] = c;
+                }
+            }
+        } else {
+            for (x = minx + first; x <= x_end; x++, u += du, v += dv) {
+                uint32_t c = row_get_pixel(source, source->data + (v >> 16) * source->stride, u >> 16);
+                if (skip_index_none || c != skip_index) {
+                    row_put_pixel(self, dest_row, x, c);
                 }
             }
-            u += duRow;
-            v += dvRow;
         }
-        rowu += duCol;
-        rowv += dvCol;
     }
 }
 
@@ -208,6 +333,7 @@ void common_hal_bitmaptools_fill_region(displayio_bitmap_t *destination,
     int16_t x1, int16_t y1,
     int16_t x2, int16_t y2,
     uint32_t value) {
+    displayio_bitmap_check_writable(destination);
     // writes the value (a bitmap color index) into a bitmap in the specified rectangular region
     //
     // input checks should ensure that x1 < x2 and y1 < y2 and are within the bitmap region
@@ -232,6 +358,7 @@ void common_hal_bitmaptools_fill_region(displayio_bitmap_t *destination,
 void common_hal_bitmaptools_boundary_fill(displayio_bitmap_t *destination,
     int16_t x, int16_t y,
     uint32_t fill_color_value, uint32_t replaced_color_value) {
+    displayio_bitmap_check_writable(destination);
 
     if (fill_color_value == replaced_color_value) {
         // There is nothing to do
@@ -454,6 +581,7 @@ void common_hal_bitmaptools_draw_line(displayio_bitmap_t *destination,
     int16_t x0, int16_t y0,
     int16_t x1, int16_t y1,
     uint32_t value) {
+    displayio_bitmap_check_writable(destination);
 
     //
     // adapted from Adafruit_CircuitPython_Display_Shapes.Polygon._line
@@ -497,6 +625,7 @@ static int32_t ith(void *data, size_t i, int element_size) {
 }
 
 void common_hal_bitmaptools_draw_polygon(displayio_bitmap_t *destination, void *xs, void *ys, size_t points_len, int point_size, uint32_t value, bool close) {
+    displayio_bitmap_check_writable(destination);
     int16_t x0, y0, xmin, xmax, ymin, ymax, xprev, yprev, x, y;
     x0 = ith(xs, 0, point_size);
     xmin = x0;
@@ -529,6 +658,7 @@ void common_hal_bitmaptools_draw_polygon(displayio_bitmap_t *destination, void *
 }
 
 void common_hal_bitmaptools_arrayblit(displayio_bitmap_t *self, void *data, int element_size, int x1, int y1, int x2, int y2, bool skip_specified, uint32_t skip_value) {
+    displayio_bitmap_check_writable(self);
     uint32_t mask = (1 << common_hal_displayio_bitmap_get_bits_per_value(self)) - 1;
 
     for (int y = y1; y < y2; y++) {
@@ -559,6 +689,7 @@ void common_hal_bitmaptools_arrayblit(displayio_bitmap_t *self, void *data, int
 }
 
 void common_hal_bitmaptools_readinto(displayio_bitmap_t *self, mp_obj_t *file, int element_size, int bits_per_pixel, bool reverse_pixels_in_element, bool swap_bytes, bool reverse_rows) {
+    displayio_bitmap_check_writable(self);
     uint32_t mask = (1 << common_hal_displayio_bitmap_get_bits_per_value(self)) - 1;
 
     const mp_stream_p_t *file_proto = mp_get_stream_raise(file, MP_STREAM_OP_READ);
@@ -752,6 +883,7 @@ static void write_pixels(displayio_bitmap_t *bitmap, int y, bool *data) {
 }
 
 void common_hal_bitmaptools_dither(displayio_bitmap_t *dest_bitmap, displayio_bitmap_t *source_bitmap, displayio_colorspace_t colorspace, bitmaptools_dither_algorithm_t algorithm) {
+    displayio_bitmap_check_writable(dest_bitmap);
     int height = dest_bitmap->height, width = dest_bitmap->width;
 
     int swap = 0;
@@ -843,6 +975,7 @@ void common_hal_bitmaptools_dither(displayio_bitmap_t *dest_bitmap, displayio_bi
 
 void common_hal_bitmaptools_alphablend(displayio_bitmap_t *dest, displayio_bitmap_t *source1, displayio_bitmap_t *source2, displayio_colorspace_t colorspace, mp_float_t factor1, mp_float_t factor2,
     bitmaptools_blendmode_t blendmode, uint32_t skip_source1_index, bool skip_source1_index_none, uint32_t skip_source2_index, bool skip_source2_index_none) {
+    displayio_bitmap_check_writable(dest);
     displayio_area_t a = {0, 0, dest->width, dest->height, NULL};
     displayio_bitmap_set_dirty_area(dest, &a);
 
@@ -1015,6 +1148,7 @@ void common_hal_bitmaptools_draw_circle(displayio_bitmap_t *destination,
     int16_t x, int16_t y,
     int16_t radius,
     uint32_t value) {
+    displayio_bitmap_check_writable(destination);
 
 
     // update the dirty area
@@ -1034,13 +1168,135 @@ void common_hal_bitmaptools_draw_circle(displayio_bitmap_t *destination,
     draw_circle(destination, x, y, radius, value);
 }
 
+typedef struct {
+    const displayio_bitmap_t *source;
+    const displayio_bitmap_t *destination;
+    int16_t src_x;
+    int16_t dest_x;
+    int16_t width;
+    bool reverse;
+    uint32_t skip_source_index;
+    bool skip_source_index_none;
+    uint32_t skip_dest_index;
+    bool skip_dest_index_none;
+} blit_row_t;
+
+static void blit_row_pixels(const blit_row_t *b, const uint32_t *src_row, uint32_t *dest_row, int16_t start, int16_t end) {
+    for (int16_t n = start; n < end; n++) {
+        int16_t i = b->reverse ? start + end - n - 1 : n;
+        uint32_t value = row_get_pixel(b->source, src_row, b->src_x + i);
+        if (!b->skip_source_index_none && value == b->skip_source_index) {
+            continue;
+        }
+        if (!b->skip_dest_index_none && row_get_pixel(b->destination, dest_row, b->dest_x + i) == b->skip_dest_index) {
+            continue;
+        }
+        row_put_pixel(b->destination, dest_row, b->dest_x + i, value);
+    }
+}
+
+// Same depth, no skipping, and pixels that start at the same bit within a
+// byte: the whole bytes are a plain memmove.
+static void blit_row_bytes(const blit_row_t *b, const uint32_t *src_row, uint32_t *dest_row) {
+    uint8_t bits = b->destination->bits_per_value;
+    uint8_t *dest = (uint8_t *)dest_row;
+    const uint8_t *src = (const uint8_t *)src_row;
+    if (bits >= 8) {
+        memmove(dest + b->dest_x * bits / 8, src + b->src_x * bits / 8, b->width * bits / 8);
+        return;
+    }
+    uint8_t pixels_per_byte = 8 / bits;
+    int16_t head = (pixels_per_byte - b->dest_x % pixels_per_byte) % pixels_per_byte;
+    if (head > b->width) {
+        head = b->width;
+    }
+    int16_t whole = (b->width - head) / pixels_per_byte;
+    int16_t tail = head + whole * pixels_per_byte;
+    // Copy the partial bytes on either side in the same order as memmove
+    // would, in case source and destination overlap.
+    if (!b->reverse) {
+        blit_row_pixels(b, src_row, dest_row, 0, head);
+    } else {
+        blit_row_pixels(b, src_row, dest_row, tail, b->width);
+    }
+    memmove(dest + (b->dest_x + head) / pixels_per_byte, src + (b->src_x + head) / pixels_per_byte, whole);
+    if (!b->reverse) {
+        blit_row_pixels(b, src_row, dest_row, tail, b->width);
+    } else {
+        blit_row_pixels(b, src_row, dest_row, 0, head);
+    }
+}
+
+#if MP_ENDIANNESS_LITTLE
+// Mask of the bits of pixels [first, last) in a little endian word of packed
+// pixels, where each byte holds its first pixel in the most significant bits.
+static uint32_t blit_word_mask(const displayio_bitmap_t *bitmap, int16_t first, int16_t last) {
+    uint8_t bits = bitmap->bits_per_value;
+    uint32_t mask = 0;
+    for (int16_t i = first; i < last; i++) {
+        uint16_t bit = i * bits;
+        mask |= (uint32_t)bitmap->bitmask << ((bit & ~7) + 8 - bits - (bit & 7));
+    }
+    return mask;
+}
+
+// Sets all the bits of each pixel in word that isn't zero.
+static inline uint32_t blit_nonzero_pixels(uint32_t word, uint8_t bits, uint32_t low_bits, uint32_t bitmask) {
+    for (uint8_t shift = 1; shift < bits; shift <<= 1) {
+        word |= word >> shift;
+    }
+    return (word & low_bits) * bitmask;
+}
+
+// Same depth below a byte, and pixels that start at the same bit within a
+// word: copy a word at a time, masking off the edges and skipped pixels.
+static void blit_row_words(const blit_row_t *b, const uint32_t *src_row, uint32_t *dest_row) {
+    const displayio_bitmap_t *bitmap = b->destination;
+    uint8_t bits = bitmap->bits_per_value;
+    uint8_t pixels_per_word = 32 / bits;
+    // One bit at the bottom of each pixel.
+    uint32_t low_bits = 0xffffffff / bitmap->bitmask;
+    uint32_t skip_source = b->skip_source_index * low_bits;
+    uint32_t skip_dest = b->skip_dest_index * low_bits;
+    // Skip values that don't fit in a pixel never match one.
+    bool check_source = !b->skip_source_index_none && b->skip_source_index <= bitmap->bitmask;
+    bool check_dest = !b->skip_dest_index_none && b->skip_dest_index <= bitmap->bitmask;
+
+    const uint32_t *src = src_row + b->src_x / pixels_per_word;
+    uint32_t *dest = dest_row + b->dest_x / pixels_per_word;
+    int16_t first = b->dest_x % pixels_per_word;
+    int16_t last = (b->dest_x + b->width - 1) % pixels_per_word + 1;
+    int16_t words = (first + b->width + pixels_per_word - 1) / pixels_per_word;
+    uint32_t first_mask = blit_word_mask(bitmap, first, pixels_per_word);
+    uint32_t last_mask = blit_word_mask(bitmap, 0, last);
+
+    for (int16_t n = 0; n < words; n++) {
+        int16_t w = b->reverse ? words - n - 1 : n;
+        uint32_t keep = 0xffffffff;
+        if (w == 0) {
+            keep &= first_mask;
+        }
+        if (w == words - 1) {
+            keep &= last_mask;
+        }
+        uint32_t s = src[w];
+        uint32_t d = dest[w];
+        if (check_source) {
+            keep &= blit_nonzero_pixels(s ^ skip_source, bits, low_bits, bitmap->bitmask);
+        }
+        if (check_dest) {
+            keep &= blit_nonzero_pixels(d ^ skip_dest, bits, low_bits, bitmap->bitmask);
+        }
+        dest[w] = (d & ~keep) | (s & keep);
+    }
+}
+#endif
+
 void common_hal_bitmaptools_blit(displayio_bitmap_t *destination, displayio_bitmap_t *source, int16_t x, int16_t y,
     int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint32_t skip_source_index, bool skip_source_index_none, uint32_t skip_dest_index,
     bool skip_dest_index_none) {
 
-    if (destination->read_only) {
-        mp_raise_RuntimeError(MP_ERROR_TEXT("Read-only"));
-    }
+    displayio_bitmap_check_writable(destination);
     // Copy region of "source" bitmap into "destination" bitmap at location x,y in the "destination"
     // If skip_value is encountered in the source bitmap, it will not be copied.
     // If skip_value is `None`, then all pixels are copied.
@@ -1059,45 +1315,49 @@ void common_hal_bitmaptools_blit(displayio_bitmap_t *destination, displayio_bitm
     displayio_area_t a = { x, y, dirty_x_max, dirty_y_max, NULL};
     displayio_bitmap_set_dirty_area(destination, &a);
 
-    bool x_reverse = false;
-    bool y_reverse = false;
-
-    // Add reverse direction option to protect blitting of destination bitmap back into destination bitmap
-    if (x > x1) {
-        x_reverse = true;
+    // Clip to the destination once, up front.
+    int16_t left = x < 0 ? -x : 0;
+    int16_t top = y < 0 ? -y : 0;
+    blit_row_t b = {
+        .source = source,
+        .destination = destination,
+        .src_x = x1 + left,
+        .dest_x = x + left,
+        .width = MIN(x + (x2 - x1), destination->width) - (x + left),
+        // Work from the far end when copying within a bitmap, so source
+        // pixels are read before they're overwritten.
+        .reverse = x > x1,
+        .skip_source_index = skip_source_index,
+        .skip_source_index_none = skip_source_index_none,
+        .skip_dest_index = skip_dest_index,
+        .skip_dest_index_none = skip_dest_index_none,
+    };
+    int16_t height = MIN(y + (y2 - y1), destination->height) - (y + top);
+    if (b.width <= 0 || height <= 0) {
+        return;
     }
-    if (y > y1) {
-        y_reverse = true;
+    bool y_reverse = y > y1;
+
+    uint8_t bits = destination->bits_per_value;
+    bool same_depth = source->bits_per_value == bits;
+    bool no_skip = skip_source_index_none && skip_dest_index_none;
+    void (*blit_row)(const blit_row_t *b, const uint32_t *src_row, uint32_t *dest_row) = NULL;
+    if (same_depth && no_skip && (b.src_x * bits) % 8 == (b.dest_x * bits) % 8) {
+        blit_row = blit_row_bytes;
+    #if MP_ENDIANNESS_LITTLE
+    } else if (same_depth && bits < 8 && (b.src_x * bits) % 32 == (b.dest_x * bits) % 32) {
+        blit_row = blit_row_words;
+    #endif
     }
 
-    // simplest version - use internal functions for get/set pixels
-    for (int16_t i = 0; i < (x2 - x1); i++) {
-
-        const int xs_index = x_reverse ? ((x2) - i - 1) : x1 + i; // x-index into the source bitmap
-        const int xd_index = x_reverse ? ((x + (x2 - x1)) - i - 1) : x + i; // x-index into the destination bitmap
-
-        if ((xd_index >= 0) && (xd_index < destination->width)) {
-            for (int16_t j = 0; j < (y2 - y1); j++) {
-
-                const int ys_index = y_reverse ? ((y2) - j - 1) : y1 + j;  // y-index into the source bitmap
-                const int yd_index = y_reverse ? ((y + (y2 - y1)) - j - 1) : y + j; // y-index into the destination bitmap
-
-                if ((yd_index >= 0) && (yd_index < destination->height)) {
-                    uint32_t value = common_hal_displayio_bitmap_get_pixel(source, xs_index, ys_index);
-                    if (skip_dest_index_none) { // if skip_dest_index is none, then only check source skip
-                        if ((skip_source_index_none) || (value != skip_source_index)) {   // write if skip_value_none is True
-                            displayio_bitmap_write_pixel(destination, xd_index, yd_index, value);
-                        }
-                    } else { // check dest_value index against skip_dest_index and skip if they match
-                        uint32_t dest_value = common_hal_displayio_bitmap_get_pixel(destination, xd_index, yd_index);
-                        if (dest_value != skip_dest_index) {
-                            if ((skip_source_index_none) || (value != skip_source_index)) {   // write if skip_value_none is True
-                                displayio_bitmap_write_pixel(destination, xd_index, yd_index, value);
-                            }
-                        }
-                    }
-                }
-            }
+    for (int16_t n = 0; n < height; n++) {
+        int16_t j = y_reverse ? height - n - 1 : n;
+        const uint32_t *src_row = source->data + (y1 + top + j) * source->stride;
+        uint32_t *dest_row = destination->data + (y + top + j) * destination->stride;
+        if (blit_row != NULL) {
+            blit_row(&b, src_row, dest_row);
+        } else {
+            blit_row_pixels(&b, src_row, dest_row, 0, b.width);
         }
     }
 }
@@ -30,6 +30,7 @@ void common_hal_displayio_bitmap_construct_from_buffer(displayio_bitmap_t *self,
     self->height = height;
     self->stride = stride(width, bits_per_value);
     self->data_alloc = false;
+    self->data_owner = MP_OBJ_NULL;
     if (!data) {
         data = m_malloc_without_collect(self->stride * height * sizeof(uint32_t));
         self->data_alloc = true;
@@ -67,6 +68,7 @@ void common_hal_displayio_bitmap_deinit(displayio_bitmap_t *self) {
         gc_free(self->data);
     }
     self->data = NULL;
+    self->data_owner = MP_OBJ_NULL;
 }
 
 bool common_hal_displayio_bitmap_deinited(displayio_bitmap_t *self) {
@@ -109,10 +111,17 @@ uint32_t common_hal_displayio_bitmap_get_pixel(displayio_bitmap_t *self, int16_t
     return 0;
 }
 
-void displayio_bitmap_set_dirty_area(displayio_bitmap_t *self, const displayio_area_t *dirty_area) {
+// Raise if the bitmap's data is read-only, such as a Bitmap on bytes or on a
+// file in a ROMFS image. Anything that writes self->data directly must call this
+// first.
+void displayio_bitmap_check_writable(const displayio_bitmap_t *self) {
     if (self->read_only) {
         mp_raise_RuntimeError(MP_ERROR_TEXT("Read-only"));
     }
+}
+
+void displayio_bitmap_set_dirty_area(displayio_bitmap_t *self, const displayio_area_t *dirty_area) {
+    displayio_bitmap_check_writable(self);
 
     displayio_area_t area = *dirty_area;
     displayio_area_canon(&area);
@@ -122,9 +131,7 @@ void displayio_bitmap_set_dirty_area(displayio_bitmap_t *self, const displayio_a
 }
 
 void displayio_bitmap_write_pixel(displayio_bitmap_t *self, int16_t x, int16_t y, uint32_t value) {
-    if (self->read_only) {
-        mp_raise_RuntimeError(MP_ERROR_TEXT("Read-only"));
-    }
+    displayio_bitmap_check_writable(self);
     // Writes the color index value into a pixel position
     // Must update the dirty area separately
 
@@ -156,9 +163,7 @@ void displayio_bitmap_write_pixel(displayio_bitmap_t *self, int16_t x, int16_t y
 }
 
 void common_hal_displayio_bitmap_set_pixel(displayio_bitmap_t *self, int16_t x, int16_t y, uint32_t value) {
-    if (self->read_only) {
-        mp_raise_RuntimeError(MP_ERROR_TEXT("Read-only"));
-    }
+    displayio_bitmap_check_writable(self);
     // update the dirty region
     displayio_area_t a = {x, y, x + 1, y + 1, NULL};
     displayio_bitmap_set_dirty_area(self, &a);
@@ -185,9 +190,7 @@ void displayio_bitmap_finish_refresh(displayio_bitmap_t *self) {
 }
 
 void common_hal_displayio_bitmap_fill(displayio_bitmap_t *self, uint32_t value) {
-    if (self->read_only) {
-        mp_raise_RuntimeError(MP_ERROR_TEXT("Read-only"));
-    }
+    displayio_bitmap_check_writable(self);
     displayio_area_t a = {0, 0, self->width, self->height, NULL};
     displayio_bitmap_set_dirty_area(self, &a);
 
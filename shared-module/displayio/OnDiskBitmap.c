@@ -29,12 +29,12 @@ void common_hal_displayio_ondiskbitmap_construct(displayio_ondiskbitmap_t *self,
     // Load the wave
     self->file = file;
     uint16_t bmp_header[69];
-    f_rewind(&self->file->fp);
+    fat_file_seek(self->file, 0);
     UINT bytes_read;
 
     // Read the minimum amount of bytes required to parse a BITMAPCOREHEADER.
     // If needed, we will read more bytes down below.
-    if (f_read(&self->file->fp, bmp_header, 26, &bytes_read) != FR_OK) {
+    if (fat_file_read(self->file, bmp_header, 26, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
     DISPLAYIO_ODBMP_DEBUG("bytes_read: %d\n", bytes_read);
@@ -48,7 +48,7 @@ void common_hal_displayio_ondiskbitmap_construct(displayio_ondiskbitmap_t *self,
 
     if (header_size == 40 || header_size == 108 || header_size == 124) {
         // Read the remaining header bytes
-        if (f_read(&self->file->fp, bmp_header + 13, header_size - 12, &bytes_read) != FR_OK) {
+        if (fat_file_read(self->file, bmp_header + 13, header_size - 12, &bytes_read) != FR_OK) {
             mp_raise_OSError(MP_EIO);
         }
         DISPLAYIO_ODBMP_DEBUG("bytes_read: %d\n", bytes_read);
@@ -116,11 +116,10 @@ void common_hal_displayio_ondiskbitmap_construct(displayio_ondiskbitmap_t *self,
 
             uint32_t *palette_data = m_malloc_without_collect(palette_size);
 
-            f_rewind(&self->file->fp);
-            f_lseek(&self->file->fp, palette_offset);
+            fat_file_seek(self->file, palette_offset);
 
             UINT palette_bytes_read;
-            if (f_read(&self->file->fp, palette_data, palette_size, &palette_bytes_read) != FR_OK) {
+            if (fat_file_read(self->file, palette_data, palette_size, &palette_bytes_read) != FR_OK) {
                 mp_raise_OSError(MP_EIO);
             }
             if (palette_bytes_read != palette_size) {
@@ -176,10 +175,10 @@ uint32_t common_hal_displayio_ondiskbitmap_get_pixel(displayio_ondiskbitmap_t *s
         location = self->data_offset + (self->height - y - 1) * self->stride + x / pixels_per_byte;
     }
     // We don't cache here because the underlying FS caches sectors.
-    f_lseek(&self->file->fp, location);
+    fat_file_seek(self->file, location);
     UINT bytes_read;
     uint32_t pixel_data = 0;
-    uint32_t result = f_read(&self->file->fp, &pixel_data, bytes_per_pixel, &bytes_read);
+    uint32_t result = fat_file_read(self->file, &pixel_data, bytes_per_pixel, &bytes_read);
     if (result == FR_OK) {
         uint32_t tmp = 0;
         uint8_t red;
@@ -285,7 +285,8 @@ uint16_t common_hal_displayio_tilegrid_get_tile(displayio_tilegrid_t *self, uint
     }
 }
 
-void displayio_tilegrid_mark_tile_dirty(displayio_tilegrid_t *self, uint16_t x, uint16_t y) {
+// Mark tiles x1 to x2 - 1 of row y dirty as a single area.
+static void tilegrid_mark_run_dirty(displayio_tilegrid_t *self, uint16_t x1, uint16_t x2, uint16_t y) {
     displayio_area_t temp_area;
     displayio_area_t *tile_area;
     if (!self->partial_change) {
@@ -293,12 +294,18 @@ void displayio_tilegrid_mark_tile_dirty(displayio_tilegrid_t *self, uint16_t x,
     } else {
         tile_area = &temp_area;
     }
-    int16_t tx = (x - self->top_left_x) % self->width_in_tiles;
-    if (tx < 0) {
-        tx += self->width_in_tiles;
+    int16_t tx1 = (x1 - self->top_left_x) % self->width_in_tiles;
+    if (tx1 < 0) {
+        tx1 += self->width_in_tiles;
+    }
+    int16_t tx2 = tx1 + (x2 - x1);
+    if (tx2 > self->width_in_tiles) {
+        // The run wraps around the right edge of the grid.
+        tx1 = 0;
+        tx2 = self->width_in_tiles;
     }
-    tile_area->x1 = tx * self->tile_width;
-    tile_area->x2 = tile_area->x1 + self->tile_width;
+    tile_area->x1 = tx1 * self->tile_width;
+    tile_area->x2 = tx2 * self->tile_width;
     int16_t ty = (y - self->top_left_y) % self->height_in_tiles;
     if (ty < 0) {
         ty += self->height_in_tiles;
@@ -312,6 +319,37 @@ void displayio_tilegrid_mark_tile_dirty(displayio_tilegrid_t *self, uint16_t x,
     self->partial_change = true;
 }
 
+void displayio_tilegrid_mark_tile_dirty(displayio_tilegrid_t *self, uint16_t x, uint16_t y) {
+    tilegrid_mark_run_dirty(self, x, x + 1, y);
+}
+
+void displayio_tilegrid_set_tile_run(displayio_tilegrid_t *self, uint16_t x, uint16_t y, const uint16_t *tile_indices, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        if (tile_indices[i] >= self->tiles_in_bitmap) {
+            mp_raise_ValueError(MP_ERROR_TEXT("Tile index out of bounds"));
+        }
+    }
+
+    void *tiles = self->tiles;
+    if (self->inline_tiles) {
+        tiles = &self->tiles;
+    }
+    if (tiles == NULL || count == 0) {
+        return;
+    }
+
+    uint32_t index = y * self->width_in_tiles + x;
+    if (self->tiles_in_bitmap > 255) {
+        memcpy((uint16_t *)tiles + index, tile_indices, count * sizeof(uint16_t));
+    } else {
+        uint8_t *tiles8 = (uint8_t *)tiles + index;
+        for (uint16_t i = 0; i < count; i++) {
+            tiles8[i] = (uint8_t)tile_indices[i];
+        }
+    }
+    tilegrid_mark_run_dirty(self, x, x + count, y);
+}
+
 void common_hal_displayio_tilegrid_set_tile(displayio_tilegrid_t *self, uint16_t x, uint16_t y, uint16_t tile_index) {
     if (tile_index >= self->tiles_in_bitmap) {
         mp_raise_ValueError(MP_ERROR_TEXT("Tile index out of bounds"));
@@ -116,6 +116,94 @@ static const displayio_area_t *_get_refresh_areas(framebufferio_framebufferdispl
 }
 
 #define MARK_ROW_DIRTY(r) (dirty_row_bitmask[r / 8] |= (1 << (r & 7)))
+
+static void _refresh_background_tasks(void) {
+    // Run background tasks so they can run during an explicit refresh.
+    // Auto-refresh won't run background tasks here because it is a background task itself.
+    RUN_BACKGROUND_TASKS;
+
+    // Run USB background tasks so they can run during an implicit refresh.
+    #if CIRCUITPY_TINYUSB
+    usb_background();
+    #endif
+}
+
+// Composite straight into the framebuffer, without the intermediate area
+// buffer, when the rows being drawn are laid out in the framebuffer exactly as
+// fill_area lays them out: whole rows with no padding between them, or one
+// row at a time. Only the mask is kept on the stack, so each pass covers many
+// more pixels than the area buffer would. Returns false, having drawn nothing,
+// when the area can't be drawn this way.
+static bool _refresh_area_direct(framebufferio_framebufferdisplay_obj_t *self, const displayio_area_t *clipped, uint8_t *dirty_row_bitmask) {
+    // fill_area ORs pixels narrower than a byte into place, so they need a
+    // zeroed buffer.
+    uint8_t depth = self->core.colorspace.depth;
+    if (depth < 8) {
+        return false;
+    }
+    size_t bytes_per_pixel = depth / 8;
+    size_t rowsize = displayio_area_width(clipped) * bytes_per_pixel;
+    size_t rowstride = self->row_stride;
+    bool whole_rows = clipped->x1 == 0 && clipped->x2 == self->core.area.x2 && rowstride == rowsize;
+    // Narrow areas pack several rows into each pass through the area buffer,
+    // which is cheaper than compositing them one row at a time.
+    if (!whole_rows && rowsize < CIRCUITPY_DISPLAY_AREA_BUFFER_SIZE) {
+        return false;
+    }
+
+    uint8_t *buf = (uint8_t *)self->bufinfo.buf + self->first_pixel_offset;
+    uint8_t *endbuf = (uint8_t *)self->bufinfo.buf + self->bufinfo.len;
+    (void)endbuf; // Hint to compiler that endbuf is "used" even if NDEBUG
+    // 16 and 32 bit pixels are stored through aligned pointers.
+    size_t alignment = bytes_per_pixel == 3 ? 1 : bytes_per_pixel;
+    if (((uintptr_t)buf | rowstride | (clipped->x1 * bytes_per_pixel)) % alignment != 0) {
+        return false;
+    }
+
+    uint32_t mask[CIRCUITPY_DISPLAY_AREA_BUFFER_SIZE / sizeof(uint32_t)];
+    if (displayio_area_width(clipped) > sizeof(mask) * 8) {
+        return false;
+    }
+    uint16_t rows_per_pass = 1;
+    if (whole_rows) {
+        rows_per_pass = sizeof(mask) * 8 / displayio_area_width(clipped);
+    }
+
+    for (uint16_t y = clipped->y1; y < clipped->y2; y += rows_per_pass) {
+        displayio_area_t subrectangle = {
+            .x1 = clipped->x1,
+            .y1 = y,
+            .x2 = clipped->x2,
+            .y2 = MIN(y + rows_per_pass, clipped->y2),
+        };
+        uint8_t *dest = buf + subrectangle.y1 * rowstride + subrectangle.x1 * bytes_per_pixel;
+        size_t pixels = displayio_area_size(&subrectangle);
+        assert(dest >= buf && dest + pixels * bytes_per_pixel <= endbuf);
+
+        // The old contents stay in place until they're overwritten, so every
+        // pixel is only written once, and those that no layer covers are
+        // cleared afterwards.
+        memset(mask, 0, (pixels + 31) / 32 * sizeof(mask[0]));
+        displayio_display_core_fill_area(&self->core, &subrectangle, mask, (uint32_t *)dest);
+        for (size_t i = 0; i < pixels; i++) {
+            uint32_t word = mask[i / 32];
+            if (word == 0xffffffff) {
+                i += 31 - i % 32;
+                continue;
+            }
+            if ((word & (1u << (i % 32))) == 0) {
+                memset(dest + i * bytes_per_pixel, 0, bytes_per_pixel);
+            }
+        }
+
+        for (uint16_t i = subrectangle.y1; i < subrectangle.y2; i++) {
+            MARK_ROW_DIRTY(i);
+        }
+        _refresh_background_tasks();
+    }
+    return true;
+}
+
 static bool _refresh_area(framebufferio_framebufferdisplay_obj_t *self, const displayio_area_t *area, uint8_t *dirty_row_bitmask) {
     uint16_t buffer_size = CIRCUITPY_DISPLAY_AREA_BUFFER_SIZE / sizeof(uint32_t); // In uint32_ts
 
@@ -124,6 +212,9 @@ static bool _refresh_area(framebufferio_framebufferdisplay_obj_t *self, const di
     if (!displayio_display_core_clip_area(&self->core, area, &clipped)) {
         return true;
     }
+    if (_refresh_area_direct(self, &clipped, dirty_row_bitmask)) {
+        return true;
+    }
     uint16_t subrectangles = 1;
 
     // If pixels are packed by row then rows are on byte boundaries
@@ -200,14 +291,7 @@ static bool _refresh_area(framebufferio_framebufferdisplay_obj_t *self, const di
             dest += rowstride;
             src += rowsize;
         }
-        // Run background tasks so they can run during an explicit refresh.
-        // Auto-refresh won't run background tasks here because it is a background task itself.
-        RUN_BACKGROUND_TASKS;
-
-        // Run USB background tasks so they can run during an implicit refresh.
-        #if CIRCUITPY_TINYUSB
-        usb_background();
-        #endif
+        _refresh_background_tasks();
     }
     return true;
 }
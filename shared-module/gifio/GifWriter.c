@@ -16,7 +16,14 @@
 #include "shared-bindings/displayio/ColorConverter.h"
 #include "shared-bindings/util.h"
 
-#define BLOCK_SIZE (126) // (2^7) - 2 // (DO NOT CHANGE!)
+#define BUFFER_SIZE (1024)
+
+#define LZW_MAX_CODE (4095)
+#define LZW_TABLE_SIZE (5003) // prime, at most about 80% full
+#define LZW_EMPTY (0xffffffff)
+
+#define QUANT_BINS (4096) // 4 bits per channel
+#define QUANT_COLORS (256)
 
 static void handle_error(gifio_gifwriter_t *self) {
     if (self->error != 0) {
@@ -36,10 +43,13 @@ static void flush_data(gifio_gifwriter_t *self) {
     }
 }
 
-// These "write" calls _MUST_ have enough buffer space available!  This is
-// ensured by allocating the proper buffer size in construct.
+// Data is buffered and written out whenever the buffer fills up. Any error
+// is raised by handle_error() once the frame is done.
 static void write_data(gifio_gifwriter_t *self, const void *data, size_t size) {
-    assert(self->cur + size <= self->size);
+    if (self->cur + size > self->size) {
+        flush_data(self);
+    }
+    assert(size <= self->size);
     memcpy(self->data + self->cur, data, size);
     self->cur += size;
 }
@@ -48,15 +58,161 @@ static void write_byte(gifio_gifwriter_t *self, uint8_t value) {
     write_data(self, &value, sizeof(value));
 }
 
-static void write_long(gifio_gifwriter_t *self, uint32_t value) {
+static void write_word(gifio_gifwriter_t *self, uint16_t value) {
     write_data(self, &value, sizeof(value));
 }
 
-static void write_word(gifio_gifwriter_t *self, uint16_t value) {
-    write_data(self, &value, sizeof(value));
+static void lzw_flush_block(gifio_gifwriter_t *self) {
+    gifio_lzw_t *lzw = &self->lzw;
+    if (lzw->block[0]) {
+        write_data(self, lzw->block, 1 + lzw->block[0]);
+        lzw->block[0] = 0;
+    }
+}
+
+static void lzw_put_byte(gifio_gifwriter_t *self, uint8_t value) {
+    gifio_lzw_t *lzw = &self->lzw;
+    lzw->block[1 + lzw->block[0]++] = value;
+    if (lzw->block[0] == 255) {
+        lzw_flush_block(self);
+    }
+}
+
+// Codes are packed least significant bit first.
+static void lzw_put_code(gifio_gifwriter_t *self, int code) {
+    gifio_lzw_t *lzw = &self->lzw;
+    lzw->bits |= (uint32_t)code << lzw->bit_count;
+    lzw->bit_count += lzw->code_size;
+    lzw->segment_bits += lzw->code_size;
+    while (lzw->bit_count >= 8) {
+        lzw_put_byte(self, lzw->bits & 0xff);
+        lzw->bits >>= 8;
+        lzw->bit_count -= 8;
+    }
+    // The decoder widens its codes as soon as the dictionary outgrows them.
+    if (lzw->next_code >= (1 << lzw->code_size) && lzw->code_size < 12) {
+        lzw->code_size++;
+    }
+}
+
+static void lzw_clear(gifio_gifwriter_t *self) {
+    gifio_lzw_t *lzw = &self->lzw;
+    lzw_put_code(self, 1 << lzw->min_code_size);
+    lzw->next_code = (1 << lzw->min_code_size) + 2;
+    lzw->code_size = lzw->min_code_size + 1;
+    if (!lzw->raw_left) {
+        memset(lzw->table, 0xff, LZW_TABLE_SIZE * sizeof(uint32_t));
+        lzw->segment_pixels = 0;
+        lzw->segment_bits = 0;
+    }
+}
+
+static void lzw_begin(gifio_gifwriter_t *self, int min_code_size) {
+    gifio_lzw_t *lzw = &self->lzw;
+    write_byte(self, min_code_size);
+    lzw->min_code_size = min_code_size;
+    lzw->code_size = min_code_size + 1;
+    lzw->next_code = (1 << min_code_size) + 2;
+    lzw->bits = 0;
+    lzw->bit_count = 0;
+    lzw->block[0] = 0;
+    lzw->prefix = -1;
+    lzw->raw_left = 0;
+    lzw_clear(self);
+}
+
+// Plain codes cost min_code_size + 1 bits per pixel plus a clear code each
+// time the decoder's dictionary is about to need wider codes.
+static bool lzw_worse_than_raw(gifio_lzw_t *lzw) {
+    int raw_codes = (1 << lzw->min_code_size) - 2;
+    uint32_t raw_bits = lzw->segment_pixels * (lzw->min_code_size + 1);
+    raw_bits += raw_bits / raw_codes;
+    return lzw->segment_bits > raw_bits;
 }
 
-void shared_module_gifio_gifwriter_construct(gifio_gifwriter_t *self, mp_obj_t *file, int width, int height, displayio_colorspace_t colorspace, bool loop, bool dither, bool own_file) {
+static void lzw_encode(gifio_gifwriter_t *self, const uint8_t *pixels, int count) {
+    gifio_lzw_t *lzw = &self->lzw;
+    uint32_t *table = lzw->table;
+    int prefix = lzw->prefix;
+
+    for (int i = 0; i < count; i++) {
+        int pixel = pixels[i];
+        if (prefix < 0) {
+            prefix = pixel;
+            continue;
+        }
+
+        if (lzw->raw_left) {
+            // Every pixel is its own code. The decoder still adds an entry for
+            // each one, so clear before its codes would get wider.
+            lzw_put_code(self, prefix);
+            prefix = pixel;
+            // Go back to LZW only at a clear code, once enough pixels are done.
+            if (lzw->raw_left > 1) {
+                lzw->raw_left--;
+            }
+            if (lzw->next_code + 1 >= (1 << lzw->code_size)) {
+                if (lzw->raw_left == 1) {
+                    lzw->raw_left = 0;
+                }
+                lzw_clear(self);
+            } else {
+                lzw->next_code++;
+            }
+            continue;
+        }
+
+        lzw->segment_pixels++;
+        // Entries hold the 20 bit (prefix, pixel) key above the 12 bit code,
+        // and collisions are resolved by double hashing.
+        uint32_t key = (prefix << 8) | pixel;
+        int slot = ((pixel << 12) ^ prefix) % LZW_TABLE_SIZE;
+        int step = slot ? LZW_TABLE_SIZE - slot : 1;
+        uint32_t entry;
+        while ((entry = table[slot]) != LZW_EMPTY && (entry >> 12) != key) {
+            slot -= step;
+            if (slot < 0) {
+                slot += LZW_TABLE_SIZE;
+            }
+        }
+        if (entry != LZW_EMPTY) {
+            prefix = entry & 0xfff;
+            continue;
+        }
+
+        lzw_put_code(self, prefix);
+        prefix = pixel;
+        if (lzw->next_code >= LZW_MAX_CODE) {
+            // Noisy images make LZW codes longer than the pixels they stand
+            // for. Write plain codes for as long again before trying again.
+            if (lzw_worse_than_raw(lzw)) {
+                lzw->raw_left = 4 * lzw->segment_pixels;
+            }
+            lzw_clear(self);
+        } else {
+            table[slot] = (key << 12) | lzw->next_code++;
+        }
+    }
+
+    lzw->prefix = prefix;
+}
+
+static void lzw_end(gifio_gifwriter_t *self) {
+    gifio_lzw_t *lzw = &self->lzw;
+    if (lzw->prefix >= 0) {
+        lzw_put_code(self, lzw->prefix);
+    }
+    lzw_put_code(self, (1 << lzw->min_code_size) + 1);
+    if (lzw->bit_count > 0) {
+        lzw_put_byte(self, lzw->bits & 0xff);
+        lzw->bits = 0;
+        lzw->bit_count = 0;
+    }
+    lzw_flush_block(self);
+    write_byte(self, 0); // block terminator
+}
+
+void shared_module_gifio_gifwriter_construct(gifio_gifwriter_t *self, mp_obj_t *file, int width, int height, displayio_colorspace_t colorspace, bool loop, bool dither, bool quantize, bool diff, bool own_file) {
     self->file = file;
     self->file_proto = mp_get_stream_raise(file, MP_STREAM_OP_WRITE | MP_STREAM_OP_IOCTL);
     if (self->file_proto->is_text) {
@@ -68,8 +224,7 @@ void shared_module_gifio_gifwriter_construct(gifio_gifwriter_t *self, mp_obj_t *
     self->dither = dither;
     self->own_file = own_file;
 
-    size_t nblocks = (width * height + 125) / 126;
-    self->size = nblocks * 128 + 4;
+    self->size = BUFFER_SIZE;
     self->data = m_malloc_without_collect(self->size);
     self->cur = 0;
     self->error = 0;
@@ -92,6 +247,28 @@ void shared_module_gifio_gifwriter_construct(gifio_gifwriter_t *self, mp_obj_t *
     }
 
     bool color = (colorspace != DISPLAYIO_COLORSPACE_L8);
+    int bytes_per_pixel = color ? 2 : 1;
+
+    self->lzw.table = m_malloc_without_collect(LZW_TABLE_SIZE * sizeof(uint32_t));
+    self->row = m_malloc_without_collect(width);
+
+    // Greyscale already uses the whole palette, so only color is quantized.
+    self->quantize = quantize && color;
+    self->histogram = NULL;
+    self->color_map = NULL;
+    self->boxes = NULL;
+    if (self->quantize) {
+        self->histogram = m_malloc_without_collect(QUANT_BINS * sizeof(uint32_t));
+        self->color_map = m_malloc_without_collect(QUANT_BINS);
+        self->boxes = m_malloc_without_collect(QUANT_COLORS * sizeof(gifio_quant_box_t));
+    }
+
+    self->diff = diff;
+    self->have_previous = false;
+    self->previous = NULL;
+    if (diff) {
+        self->previous = m_malloc_without_collect(width * height * bytes_per_pixel);
+    }
 
     bool bgr = (colorspace == DISPLAYIO_COLORSPACE_BGR565 || colorspace == DISPLAYIO_COLORSPACE_BGR565_SWAPPED);
     self->byteswap = (colorspace == DISPLAYIO_COLORSPACE_RGB565_SWAPPED || colorspace == DISPLAYIO_COLORSPACE_BGR565_SWAPPED);
@@ -154,96 +331,264 @@ static const uint8_t g_bayer[4][4] = {
     {31, 14, 26, 10}
 };
 
-void shared_module_gifio_gifwriter_add_frame(gifio_gifwriter_t *self, const mp_buffer_info_t *bufinfo, int16_t delay) {
-    if (delay) {
-        write_data(self, (uint8_t []) {'!', 0xF9, 0x04, 0x04}, 4);
-        write_word(self, delay);
-        write_word(self, 0); // end
+static inline int get_pixel(gifio_gifwriter_t *self, const uint16_t *pixels, int i) {
+    int pixel = pixels[i];
+    if (self->byteswap) {
+        pixel = __builtin_bswap16(pixel);
     }
+    return pixel;
+}
 
-    write_byte(self, 0x2C);
-    write_long(self, 0);
-    write_word(self, self->width);
-    write_word(self, self->height);
-    write_data(self, (uint8_t []) {0x00, 0x07}, 2); // 7-bits
+// The top 4 bits of each 565 channel.
+static inline int quant_bin(int pixel) {
+    return ((pixel >> 4) & 0xf00) | ((pixel >> 3) & 0xf0) | ((pixel >> 1) & 0xf);
+}
 
-    int pixel_count = self->width * self->height;
-    int blocks = (pixel_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+#define FOR_EACH_BIN(box, c0, c1, c2) \
+    for (int c0 = (box)->lo[0]; c0 <= (box)->hi[0]; c0++) \
+        for (int c1 = (box)->lo[1]; c1 <= (box)->hi[1]; c1++) \
+            for (int c2 = (box)->lo[2]; c2 <= (box)->hi[2]; c2++)
+
+// Shrink a box to the bins that are in use and count its pixels.
+static void quant_box_shrink(const uint32_t *histogram, gifio_quant_box_t *box) {
+    uint8_t lo[3] = {15, 15, 15}, hi[3] = {0, 0, 0};
+    uint32_t count = 0;
+    FOR_EACH_BIN(box, c0, c1, c2) {
+        uint32_t n = histogram[(c0 << 8) | (c1 << 4) | c2];
+        if (n) {
+            count += n;
+            lo[0] = MIN(lo[0], c0);
+            hi[0] = MAX(hi[0], c0);
+            lo[1] = MIN(lo[1], c1);
+            hi[1] = MAX(hi[1], c1);
+            lo[2] = MIN(lo[2], c2);
+            hi[2] = MAX(hi[2], c2);
+        }
+    }
+    memcpy(box->lo, lo, sizeof(lo));
+    memcpy(box->hi, hi, sizeof(hi));
+    box->count = count;
+}
 
-    uint8_t *data = self->data + self->cur;
+static int quant_box_longest_axis(const gifio_quant_box_t *box) {
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (box->hi[i] - box->lo[i] > box->hi[axis] - box->lo[axis]) {
+            axis = i;
+        }
+    }
+    return axis;
+}
 
-    if (self->colorspace == DISPLAYIO_COLORSPACE_L8) {
-        mp_get_index(&mp_type_memoryview, bufinfo->len, MP_OBJ_NEW_SMALL_INT(pixel_count - 1), false);
-
-        uint8_t *pixels = bufinfo->buf;
-        for (int i = 0; i < blocks; i++) {
-            assert(pixel_count >= 0);
-            int block_size = MIN(BLOCK_SIZE, pixel_count);
-            pixel_count -= block_size;
-            *data++ = 1 + block_size;
-            *data++ = 0x80;
-            for (int j = 0; j < block_size; j++) {
-                *data++ = (*pixels++) >> 1;
+// Split a box at the weighted median of its longest side. Both halves keep
+// at least one used bin because the box has been shrunk to fit.
+static void quant_box_split(const uint32_t *histogram, gifio_quant_box_t *box, gifio_quant_box_t *other) {
+    int axis = quant_box_longest_axis(box);
+    uint32_t slices[16] = {0};
+    FOR_EACH_BIN(box, c0, c1, c2) {
+        int c[3] = {c0, c1, c2};
+        slices[c[axis]] += histogram[(c0 << 8) | (c1 << 4) | c2];
+    }
+
+    int cut = box->lo[axis];
+    uint32_t sum = slices[cut];
+    while (cut + 1 < box->hi[axis] && sum < box->count / 2) {
+        sum += slices[++cut];
+    }
+
+    *other = *box;
+    box->hi[axis] = cut;
+    other->lo[axis] = cut + 1;
+    quant_box_shrink(histogram, box);
+    quant_box_shrink(histogram, other);
+}
+
+// Median cut over a 4-4-4 histogram of the area being encoded, written out
+// as the frame's local color table.
+static void quantize_area(gifio_gifwriter_t *self, const uint16_t *pixels, int x1, int y1, int x2, int y2) {
+    uint32_t *histogram = self->histogram;
+    gifio_quant_box_t *boxes = self->boxes;
+
+    memset(histogram, 0, QUANT_BINS * sizeof(uint32_t));
+    for (int y = y1; y < y2; y++) {
+        const uint16_t *row = pixels + y * self->width;
+        for (int x = x1; x < x2; x++) {
+            histogram[quant_bin(get_pixel(self, row, x))]++;
+        }
+    }
+
+    boxes[0] = (gifio_quant_box_t) { .lo = {0, 0, 0}, .hi = {15, 15, 15} };
+    quant_box_shrink(histogram, &boxes[0]);
+    int n_boxes = 1;
+    while (n_boxes < QUANT_COLORS) {
+        // Prefer boxes that hold many pixels spread over a wide range.
+        int best = -1;
+        uint32_t best_score = 0;
+        for (int i = 0; i < n_boxes; i++) {
+            int axis = quant_box_longest_axis(&boxes[i]);
+            uint32_t score = boxes[i].count * (boxes[i].hi[axis] - boxes[i].lo[axis]);
+            if (score > best_score) {
+                best = i;
+                best_score = score;
             }
         }
-    } else if (!self->dither) {
-        mp_get_index(&mp_type_memoryview, bufinfo->len, MP_OBJ_NEW_SMALL_INT(2 * pixel_count - 1), false);
-
-        uint16_t *pixels = bufinfo->buf;
-        for (int i = 0; i < blocks; i++) {
-            int block_size = MIN(BLOCK_SIZE, pixel_count);
-            pixel_count -= block_size;
-
-            *data++ = 1 + block_size;
-            *data++ = 0x80;
-            for (int j = 0; j < block_size; j++) {
-                int pixel = *pixels++;
-                if (self->byteswap) {
-                    pixel = __builtin_bswap16(pixel);
-                }
-                int red = (pixel >> (11 + (5 - 2))) & 0x3;
-                int green = (pixel >> (5 + (6 - 3))) & 0x7;
-                int blue = (pixel >> (0 + (5 - 2))) & 0x3;
-                *data++ = (red << 5) | (green << 2) | blue;
+        if (best < 0) {
+            break;
+        }
+        quant_box_split(histogram, &boxes[best], &boxes[n_boxes++]);
+    }
+
+    bool bgr = (self->colorspace == DISPLAYIO_COLORSPACE_BGR565 || self->colorspace == DISPLAYIO_COLORSPACE_BGR565_SWAPPED);
+    for (int i = 0; i < QUANT_COLORS; i++) {
+        uint8_t rgb[3] = {0, 0, 0};
+        if (i < n_boxes) {
+            gifio_quant_box_t *box = &boxes[i];
+            uint32_t sums[3] = {0, 0, 0};
+            FOR_EACH_BIN(box, c0, c1, c2) {
+                int bin = (c0 << 8) | (c1 << 4) | c2;
+                uint32_t n = histogram[bin];
+                sums[0] += n * c0;
+                sums[1] += n * c1;
+                sums[2] += n * c2;
+                self->color_map[bin] = i;
+            }
+            for (int c = 0; c < 3; c++) {
+                // Scale the 4 bit mean to 8 bits.
+                rgb[bgr ? 2 - c : c] = (sums[c] * 17 + box->count / 2) / box->count;
             }
         }
-    } else {
-        mp_get_index(&mp_type_memoryview, bufinfo->len, MP_OBJ_NEW_SMALL_INT(2 * pixel_count - 1), false);
-
-        uint16_t *pixels = bufinfo->buf;
-        int x = 0, y = 0;
-        for (int i = 0; i < blocks; i++) {
-            int block_size = MIN(BLOCK_SIZE, pixel_count);
-            pixel_count -= block_size;
-
-            *data++ = 1 + block_size;
-            *data++ = 0x80;
-            for (int j = 0; j < block_size; j++) {
-                int pixel = *pixels++;
-                if (self->byteswap) {
-                    pixel = __builtin_bswap16(pixel);
-                }
-                int red = (pixel >> 8) & 0xf8;
-                int green = (pixel >> 3) & 0xfc;
-                int blue = (pixel << 3) & 0xf8;
-
-                red = MAX(0, red - rb_bayer[x % 4][y % 4]);
-                green = MAX(0, green - g_bayer[x % 4][(y + 2) % 4]);
-                blue = MAX(0, blue - rb_bayer[(x + 2) % 4][y % 4]);
-                x++;
-                if (x == self->width) {
-                    x = 0;
-                    y++;
-                }
+        write_data(self, rgb, 3);
+    }
+}
 
-                *data++ = ((red >> 1) & 0x60) | ((green >> 3) & 0x1c) | (blue >> 6);
+// Find the bounding box of the pixels that changed since the last frame.
+static void changed_area(gifio_gifwriter_t *self, const uint8_t *pixels, int bytes_per_pixel, int *x1, int *y1, int *x2, int *y2) {
+    int stride = self->width * bytes_per_pixel;
+    const uint8_t *previous = self->previous;
+
+    int top = 0;
+    while (top < self->height && memcmp(pixels + top * stride, previous + top * stride, stride) == 0) {
+        top++;
+    }
+    if (top == self->height) {
+        // Nothing changed; a single unchanged pixel still carries the delay.
+        *x1 = *y1 = 0;
+        *x2 = *y2 = 1;
+        return;
+    }
+    int bottom = self->height;
+    while (memcmp(pixels + (bottom - 1) * stride, previous + (bottom - 1) * stride, stride) == 0) {
+        bottom--;
+    }
+
+    int left = self->width, right = 0;
+    for (int y = top; y < bottom; y++) {
+        const uint8_t *a = pixels + y * stride, *b = previous + y * stride;
+        for (int x = 0; x < left; x++) {
+            if (memcmp(a + x * bytes_per_pixel, b + x * bytes_per_pixel, bytes_per_pixel)) {
+                left = x;
+                break;
+            }
+        }
+        for (int x = self->width - 1; x >= right; x--) {
+            if (memcmp(a + x * bytes_per_pixel, b + x * bytes_per_pixel, bytes_per_pixel)) {
+                right = x + 1;
+                break;
             }
         }
     }
 
-    self->cur = data - self->data;
+    *x1 = left;
+    *y1 = top;
+    *x2 = right;
+    *y2 = bottom;
+}
+
+// Convert one row of the area being encoded to palette indices in self->row.
+static void convert_row(gifio_gifwriter_t *self, const void *buf, int x1, int x2, int y) {
+    uint8_t *data = self->row;
+
+    if (self->colorspace == DISPLAYIO_COLORSPACE_L8) {
+        const uint8_t *pixels = (const uint8_t *)buf + y * self->width;
+        for (int x = x1; x < x2; x++) {
+            *data++ = pixels[x] >> 1;
+        }
+        return;
+    }
+
+    const uint16_t *pixels = (const uint16_t *)buf + y * self->width;
+    if (self->quantize) {
+        for (int x = x1; x < x2; x++) {
+            *data++ = self->color_map[quant_bin(get_pixel(self, pixels, x))];
+        }
+    } else if (!self->dither) {
+        for (int x = x1; x < x2; x++) {
+            int pixel = get_pixel(self, pixels, x);
+            int red = (pixel >> (11 + (5 - 2))) & 0x3;
+            int green = (pixel >> (5 + (6 - 3))) & 0x7;
+            int blue = (pixel >> (0 + (5 - 2))) & 0x3;
+            *data++ = (red << 5) | (green << 2) | blue;
+        }
+    } else {
+        for (int x = x1; x < x2; x++) {
+            int pixel = get_pixel(self, pixels, x);
+            int red = (pixel >> 8) & 0xf8;
+            int green = (pixel >> 3) & 0xfc;
+            int blue = (pixel << 3) & 0xf8;
+
+            red = MAX(0, red - rb_bayer[x % 4][y % 4]);
+            green = MAX(0, green - g_bayer[x % 4][(y + 2) % 4]);
+            blue = MAX(0, blue - rb_bayer[(x + 2) % 4][y % 4]);
+
+            *data++ = ((red >> 1) & 0x60) | ((green >> 3) & 0x1c) | (blue >> 6);
+        }
+    }
+}
+
+void shared_module_gifio_gifwriter_add_frame(gifio_gifwriter_t *self, const mp_buffer_info_t *bufinfo, int16_t delay) {
+    int bytes_per_pixel = (self->colorspace == DISPLAYIO_COLORSPACE_L8) ? 1 : 2;
+    int frame_size = self->width * self->height * bytes_per_pixel;
+    mp_get_index(&mp_type_memoryview, bufinfo->len, MP_OBJ_NEW_SMALL_INT(frame_size - 1), false);
+    const uint8_t *pixels = bufinfo->buf;
+
+    int x1 = 0, y1 = 0, x2 = self->width, y2 = self->height;
+    if (self->diff && self->have_previous) {
+        changed_area(self, pixels, bytes_per_pixel, &x1, &y1, &x2, &y2);
+    }
+
+    if (delay) {
+        // Disposal method 1 leaves the frame in place, so a later frame that
+        // covers only the changed area is drawn over it.
+        write_data(self, (uint8_t []) {'!', 0xF9, 0x04, 0x04}, 4);
+        write_word(self, delay);
+        write_word(self, 0); // end
+    }
+
+    write_byte(self, 0x2C);
+    write_word(self, x1);
+    write_word(self, y1);
+    write_word(self, x2 - x1);
+    write_word(self, y2 - y1);
+    if (self->quantize) {
+        write_byte(self, 0x87); // 256 entry local color table
+        quantize_area(self, (const uint16_t *)pixels, x1, y1, x2, y2);
+        lzw_begin(self, 8);
+    } else {
+        write_byte(self, 0x00);
+        lzw_begin(self, 7);
+    }
+
+    for (int y = y1; y < y2; y++) {
+        convert_row(self, pixels, x1, x2, y);
+        lzw_encode(self, self->row, x2 - x1);
+    }
+    lzw_end(self);
+
+    if (self->diff) {
+        memcpy(self->previous, pixels, frame_size);
+        self->have_previous = true;
+    }
 
-    write_data(self, (uint8_t []) {0x01, 0x81, 0x00}, 3); // end code
     flush_data(self);
     handle_error(self);
 }
@@ -10,6 +10,29 @@
 #include "py/stream.h"
 #include "shared-bindings/displayio/__init__.h"
 
+// State of the LZW encoder for the frame being written.
+typedef struct {
+    uint32_t *table; // (prefix, pixel) -> code, open addressed
+    uint32_t bits;
+    int bit_count;
+    int min_code_size;
+    int code_size;
+    int next_code;
+    int prefix;
+    // Pixels and bits since the last dictionary reset, to spot incompressible data.
+    uint32_t segment_pixels;
+    uint32_t segment_bits;
+    // Pixels left to write as plain codes without building a dictionary.
+    int raw_left;
+    uint8_t block[256]; // data sub-block being filled, length byte first
+} gifio_lzw_t;
+
+// A box of the color histogram during median cut quantization.
+typedef struct {
+    uint8_t lo[3], hi[3];
+    uint32_t count;
+} gifio_quant_box_t;
+
 typedef struct gifio_gifwriter {
     mp_obj_base_t base;
     mp_obj_t *file;
@@ -22,4 +45,13 @@ typedef struct gifio_gifwriter {
     bool own_file;
     bool byteswap;
     bool dither;
+    bool quantize;
+    bool diff;
+    bool have_previous;
+    gifio_lzw_t lzw;
+    uint8_t *row; // palette indices of the row being encoded
+    uint32_t *histogram; // 4-4-4 color histogram when quantizing
+    uint8_t *color_map; // histogram bin -> local palette index
+    gifio_quant_box_t *boxes;
+    uint8_t *previous; // previous frame's pixels for diff
 } gifio_gifwriter_t;
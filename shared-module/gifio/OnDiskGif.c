@@ -26,10 +26,10 @@ static int32_t GIFReadFile(GIFFILE *pFile, uint8_t *pBuf, int32_t iLen) {
         return 0;
     }
     UINT bytes_read;
-    if (f_read(&f->fp, pBuf, iBytesRead, &bytes_read) != FR_OK) {
+    if (fat_file_read(f, pBuf, iBytesRead, &bytes_read) != FR_OK) {
         mp_raise_OSError(MP_EIO);
     }
-    pFile->iPos = f->fp.fptr;
+    pFile->iPos = fat_file_tell(f);
 
     return bytes_read;
 } /* GIFReadFile() */
@@ -37,23 +37,38 @@ static int32_t GIFReadFile(GIFFILE *pFile, uint8_t *pBuf, int32_t iLen) {
 static int32_t GIFSeekFile(GIFFILE *pFile, int32_t iPosition) {
     pyb_file_obj_t *f = pFile->fHandle;
 
-    f_lseek(&f->fp, iPosition);
-    pFile->iPos = f->fp.fptr;
+    fat_file_seek(f, iPosition);
+    pFile->iPos = fat_file_tell(f);
     return pFile->iPos;
 } /* GIFSeekFile() */
 
-static void GIFDraw(GIFDRAW *pDraw) {
-    // Called for every scan line of the image as it decodes
-    // The pixels delivered are the 8-bit native GIF output
-    // The palette is either RGB565 or the original 24-bit RGB values
-    // depending on the pixel type selected with gif.begin()
-
-    gifio_ondiskgif_t *ondiskgif = (gifio_ondiskgif_t *)pDraw->pUser;
+// Called on the first line of every frame, before any pixels are written.
+static void GIFStartFrame(gifio_ondiskgif_t *ondiskgif, GIFDRAW *pDraw) {
     displayio_bitmap_t *bitmap = ondiskgif->bitmap;
     displayio_palette_t *palette = ondiskgif->palette;
 
-    // Update the palette if we have one in RGB888
+    ondiskgif->frame_started = true;
+
+    // Only the frame's own rectangle changes, so remember it for the dirty
+    // area and for disposal before the next frame.
+    displayio_area_t frame_area = {
+        .x1 = MIN(pDraw->iX, bitmap->width),
+        .y1 = MIN(pDraw->iY, bitmap->height),
+        .x2 = MIN(pDraw->iX + pDraw->iWidth, bitmap->width),
+        .y2 = MIN(pDraw->iY + pDraw->iHeight, bitmap->height),
+        .next = NULL,
+    };
+    ondiskgif->frame_area = frame_area;
+    ondiskgif->disposal = pDraw->ucDisposalMethod;
+
     if (palette != NULL) {
+        // Restoring to the background shows whatever is behind the bitmap
+        // when the frame has a transparent color.
+        ondiskgif->background = pDraw->ucHasTransparency ? pDraw->ucTransparent : pDraw->ucBackground;
+
+        // The palette is the same for every line of a frame. Colors that do
+        // not change leave the palette clean, so transparency is only touched
+        // when it moves to keep untouched areas from being redrawn.
         uint8_t *pPal = pDraw->pPalette24;
         for (int p = 0; p < 256; p++) {
             uint8_t r = *pPal++;
@@ -61,11 +76,34 @@ static void GIFDraw(GIFDRAW *pDraw) {
             uint8_t b = *pPal++;
             uint32_t color = (r << 16) + (g << 8) + b;
             common_hal_displayio_palette_set_color(palette, p, color);
-            common_hal_displayio_palette_make_opaque(palette, p); // Transparency can change frame to frame
         }
-        if (pDraw->ucHasTransparency) {
-            common_hal_displayio_palette_make_transparent(palette, pDraw->ucTransparent);
+        int16_t transparent_index = pDraw->ucHasTransparency ? pDraw->ucTransparent : -1;
+        if (transparent_index != ondiskgif->transparent_index) {
+            if (ondiskgif->transparent_index >= 0) {
+                common_hal_displayio_palette_make_opaque(palette, ondiskgif->transparent_index);
+            }
+            if (transparent_index >= 0) {
+                common_hal_displayio_palette_make_transparent(palette, transparent_index);
+            }
+            ondiskgif->transparent_index = transparent_index;
         }
+    } else {
+        // The background index refers to the global color table.
+        ondiskgif->background = ondiskgif->gif.pPalette[pDraw->ucBackground];
+    }
+}
+
+static void GIFDraw(GIFDRAW *pDraw) {
+    // Called for every scan line of the image as it decodes
+    // The pixels delivered are the 8-bit native GIF output
+    // The palette is either RGB565 or the original 24-bit RGB values
+    // depending on the pixel type selected with gif.begin()
+
+    gifio_ondiskgif_t *ondiskgif = (gifio_ondiskgif_t *)pDraw->pUser;
+    displayio_bitmap_t *bitmap = ondiskgif->bitmap;
+
+    if (!ondiskgif->frame_started) {
+        GIFStartFrame(ondiskgif, pDraw);
     }
 
     int iWidth = pDraw->iWidth;
@@ -80,27 +118,12 @@ static void GIFDraw(GIFDRAW *pDraw) {
     int32_t row_start = (pDraw->y + pDraw->iY) * bitmap->stride;
     uint32_t *row = bitmap->data + row_start;
 
-    if (pDraw->ucDisposalMethod == 2) { // restore to background color
-        // Not supported currently. Need to reset the area the previous frame occupied
-        // to the background color before the previous frame was drawn
-        // See: https://github.com/bitbank2/AnimatedGIF/issues/3
-
-        // To workaround clear the gif.bitmap object yourself as required.
-    }
-
-    if (palette != NULL) {
-        uint8_t *s = pDraw->pPixels;
-        uint8_t *d = (uint8_t *)row;
-
-        d += pDraw->iX;
-        for (int x = 0; x < iWidth; x++)
-        {
-            *d++ = *s++;
-        }
+    if (ondiskgif->palette != NULL) {
+        // Palette indices are stored as is; transparency is left to the palette.
+        memcpy((uint8_t *)row + pDraw->iX, pDraw->pPixels, iWidth);
     } else {
         // No palette writing RGB565_SWAPPED right to bitmap buffer
         uint8_t *s = pDraw->pPixels;
-        ;
         uint16_t *d = (uint16_t *)row;
 
         uint16_t *pPal;
@@ -127,6 +150,27 @@ static void GIFDraw(GIFDRAW *pDraw) {
     }
 }
 
+// Disposal method 2: restore the previous frame's area to the background.
+// Method 3 (restore to previous) would need a copy of the canvas and is
+// treated like method 1, leaving the frame in place.
+static void GIFDisposeFrame(gifio_ondiskgif_t *self) {
+    displayio_bitmap_t *bitmap = self->bitmap;
+    const displayio_area_t *area = &self->frame_area;
+    int16_t width = area->x2 - area->x1;
+
+    for (int16_t y = area->y1; y < area->y2; y++) {
+        uint32_t *row = bitmap->data + y * bitmap->stride;
+        if (self->palette != NULL) {
+            memset((uint8_t *)row + area->x1, self->background, width);
+        } else {
+            uint16_t *d = (uint16_t *)row + area->x1;
+            for (int16_t x = 0; x < width; x++) {
+                *d++ = self->background;
+            }
+        }
+    }
+}
+
 void common_hal_gifio_ondiskgif_construct(gifio_ondiskgif_t *self, pyb_file_obj_t *file, bool use_palette) {
     self->file = file;
 
@@ -144,7 +188,7 @@ void common_hal_gifio_ondiskgif_construct(gifio_ondiskgif_t *self, pyb_file_obj_
     self->gif.pfnOpen = NULL;
     self->gif.GIFFile.fHandle = self->file;
 
-    f_rewind(&self->file->fp);
+    fat_file_seek(self->file, 0);
     self->gif.GIFFile.iSize = (int32_t)f_size(&self->file->fp);
 
     int result = GIF_init(&self->gif);
@@ -163,6 +207,9 @@ void common_hal_gifio_ondiskgif_construct(gifio_ondiskgif_t *self, pyb_file_obj_
     if (use_palette == true) {
         displayio_palette_t *palette = mp_obj_malloc(displayio_palette_t, &displayio_palette_type);
         common_hal_displayio_palette_construct(palette, 256, false);
+        for (int p = 0; p < 256; p++) {
+            common_hal_displayio_palette_make_opaque(palette, p);
+        }
         self->palette = palette;
         bpp = 8;
     } else {
@@ -179,6 +226,10 @@ void common_hal_gifio_ondiskgif_construct(gifio_ondiskgif_t *self, pyb_file_obj_
     self->frame_count = info.iFrameCount;
     self->min_delay = info.iMinDelay;
     self->max_delay = info.iMaxDelay;
+
+    self->frame_area = (displayio_area_t) {0};
+    self->disposal = 0;
+    self->transparent_index = -1;
 }
 
 void common_hal_gifio_ondiskgif_deinit(gifio_ondiskgif_t *self) {
@@ -230,17 +281,26 @@ int32_t common_hal_gifio_ondiskgif_get_max_delay(gifio_ondiskgif_t *self) {
 uint32_t common_hal_gifio_ondiskgif_next_frame(gifio_ondiskgif_t *self, bool setDirty) {
     int nextDelay = 0;
     int result = 0;
+
+    displayio_area_t disposed_area = {0};
+    if (self->disposal == 2) {
+        GIFDisposeFrame(self);
+        disposed_area = self->frame_area;
+    }
+    // An empty frame never calls GIFDraw and so changes nothing.
+    self->frame_area = (displayio_area_t) {0};
+    self->disposal = 0;
+    self->frame_started = false;
+
     result = GIF_playFrame(&self->gif, &nextDelay, self);
 
     if ((result >= 0) && (setDirty)) {
-        displayio_area_t dirty_area = {
-            .x1 = 0,
-            .y1 = 0,
-            .x2 = self->bitmap->width,
-            .y2 = self->bitmap->height,
-        };
-
-        displayio_bitmap_set_dirty_area(self->bitmap, &dirty_area);
+        // Only the disposed area and the new frame's rectangle have changed.
+        displayio_area_t dirty_area;
+        displayio_area_union(&disposed_area, &self->frame_area, &dirty_area);
+        if (!displayio_area_empty(&dirty_area)) {
+            displayio_bitmap_set_dirty_area(self->bitmap, &dirty_area);
+        }
     }
 
     return nextDelay;
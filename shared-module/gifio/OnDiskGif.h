@@ -27,4 +27,12 @@ typedef struct {
     int32_t frame_count;
     int32_t min_delay;
     int32_t max_delay;
+    // Canvas area covered by the last frame and how it is disposed of before the next one.
+    displayio_area_t frame_area;
+    uint8_t disposal;
+    // Pixel value the frame area is restored to by disposal method 2.
+    uint16_t background;
+    // Palette index currently marked transparent, or -1 when none is.
+    int16_t transparent_index;
+    bool frame_started;
 } gifio_ondiskgif_t;
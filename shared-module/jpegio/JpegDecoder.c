@@ -8,6 +8,7 @@
 
 #include "shared-bindings/jpegio/JpegDecoder.h"
 #include "shared-bindings/bitmaptools/__init__.h"
+#include "shared-bindings/displayio/Bitmap.h"
 #include "shared-module/jpegio/JpegDecoder.h"
 
 typedef size_t (*input_func)(JDEC *jd, uint8_t *dest, size_t len);
@@ -54,6 +55,15 @@ static void check_jresult(JRESULT j) {
 
 void common_hal_jpegio_jpegdecoder_construct(jpegio_jpegdecoder_obj_t *self) {
     self->data_obj = MP_OBJ_NULL;
+    self->callback = MP_OBJ_NULL;
+}
+
+// decode_rows() calls back into Python in the middle of decoding, and the
+// decoder can't be used again until it returns.
+static void check_not_busy(jpegio_jpegdecoder_obj_t *self) {
+    if (self->callback != MP_OBJ_NULL) {
+        mp_raise_RuntimeError_varg(MP_ERROR_TEXT("%q in use"), MP_QSTR_JpegDecoder);
+    }
 }
 
 void common_hal_jpegio_jpegdecoder_close(jpegio_jpegdecoder_obj_t *self) {
@@ -101,6 +111,7 @@ static size_t file_input(JDEC *jd, uint8_t *dest, size_t len) {
 }
 
 mp_obj_t common_hal_jpegio_jpegdecoder_set_source_file(jpegio_jpegdecoder_obj_t *self, mp_obj_t file_obj) {
+    check_not_busy(self);
     self->data_obj = file_obj;
     return common_hal_jpegio_jpegdecoder_decode_common(self, file_input);
 }
@@ -118,6 +129,7 @@ static size_t buffer_input(JDEC *jd, uint8_t *dest, size_t len) {
 }
 
 mp_obj_t common_hal_jpegio_jpegdecoder_set_source_buffer(jpegio_jpegdecoder_obj_t *self, mp_obj_t buffer_obj) {
+    check_not_busy(self);
     self->data_obj = buffer_obj;
     mp_get_buffer_raise(buffer_obj, &self->bufinfo, MP_BUFFER_READ);
     return common_hal_jpegio_jpegdecoder_decode_common(self, buffer_input);
@@ -185,14 +197,128 @@ static int bitmap_output(JDEC *jd, void *data, JRECT *rect) {
     return 1;
 }
 
+static void check_open(jpegio_jpegdecoder_obj_t *self, qstr what) {
+    check_not_busy(self);
+    if (self->data_obj == MP_OBJ_NULL) {
+        mp_raise_RuntimeError_varg(MP_ERROR_TEXT("%q() without %q()"), what, MP_QSTR_open);
+    }
+}
+
+// Limit IDCT and output to the MCUs that overlap `lim`, which is in output
+// (scaled) pixels. Returns false if there is nothing to decode.
+static bool set_clip(jpegio_jpegdecoder_obj_t *self, const bitmaptools_rect_t *lim) {
+    if (lim->x2 <= lim->x1 || lim->y2 <= lim->y1) {
+        return false;
+    }
+    self->decoder.clip = (JRECT) {
+        .left = lim->x1, .right = lim->x2 - 1,
+        .top = lim->y1, .bottom = lim->y2 - 1,
+    };
+    return true;
+}
+
+static void decode_rows_call_callback(jpegio_jpegdecoder_obj_t *self) {
+    self->band->height = self->band_rows;
+    mp_obj_t args[] = {
+        MP_OBJ_FROM_PTR(self->band),
+        MP_OBJ_NEW_SMALL_INT(self->band_y - self->lim.y1),
+    };
+    self->band_rows = 0;
+    mp_call_function_n_kw(self->callback, MP_ARRAY_SIZE(args), 0, args);
+}
+
+// Output for decode_rows: MCUs arrive left to right, one MCU row at a time.
+// The part of each MCU inside the crop is copied into the band, which is
+// handed to the callback when the next MCU row starts.
+static int rows_output(JDEC *jd, void *data, JRECT *rect) {
+    jpegio_jpegdecoder_obj_t *self = CONTAINER_OF(jd, jpegio_jpegdecoder_obj_t, decoder);
+    bitmaptools_rect_t *lim = &self->lim;
+
+    int top = MAX(rect->top, lim->y1);
+    int bottom = MIN(rect->bottom + 1, lim->y2);
+    int left = MAX(rect->left, lim->x1);
+    int right = MIN(rect->right + 1, lim->x2);
+    if (top >= bottom) {
+        return top >= lim->y2 ? DECODER_INTERRUPT : DECODER_CONTINUE;
+    }
+
+    if (self->band_rows && self->band_y != top) {
+        decode_rows_call_callback(self);
+    }
+    self->band_y = top;
+    self->band_rows = bottom - top;
+
+    if (left < right) {
+        int src_width = rect->right - rect->left + 1;
+        const uint16_t *src = (const uint16_t *)data + (top - rect->top) * src_width + (left - rect->left);
+        for (int y = 0; y < bottom - top; y++) {
+            uint16_t *dest = (uint16_t *)(self->band->data + y * self->band->stride) + (left - lim->x1);
+            memcpy(dest, src, (right - left) * sizeof(uint16_t));
+            src += src_width;
+        }
+    }
+    return DECODER_CONTINUE;
+}
+
+static void decode_rows_finish(jpegio_jpegdecoder_obj_t *self) {
+    self->band = NULL;
+    self->callback = MP_OBJ_NULL;
+    common_hal_jpegio_jpegdecoder_close(self);
+}
+
+void common_hal_jpegio_jpegdecoder_decode_rows(
+    jpegio_jpegdecoder_obj_t *self,
+    mp_obj_t callback, int scale,
+    const mp_arg_val_t crop[4]) {
+    check_open(self, MP_QSTR_decode_rows);
+
+    // This is the same as the sum of the scaled MCU sizes.
+    int width = self->decoder.width >> scale;
+    int height = self->decoder.height >> scale;
+    self->lim = bitmaptools_validate_coord_range_pair(crop, width, height);
+    if (!set_clip(self, &self->lim)) {
+        common_hal_jpegio_jpegdecoder_close(self);
+        return;
+    }
+
+    // One MCU row, as wide as the crop.
+    int band_height = MAX((self->decoder.msy * 8) >> scale, 1);
+    displayio_bitmap_t *band = mp_obj_malloc(displayio_bitmap_t, &displayio_bitmap_type);
+    common_hal_displayio_bitmap_construct(band, self->lim.x2 - self->lim.x1, band_height, 16);
+    self->band = band;
+    self->band_rows = 0;
+    self->callback = callback;
+
+    // The callback may raise, so make sure the decoder is left closed.
+    nlr_buf_t nlr;
+    JRESULT result;
+    if (nlr_push(&nlr) == 0) {
+        result = jd_decomp(&self->decoder, rows_output, scale);
+        if (self->band_rows) {
+            decode_rows_call_callback(self);
+        }
+        nlr_pop();
+        decode_rows_finish(self);
+    } else {
+        decode_rows_finish(self);
+        nlr_raise(MP_OBJ_FROM_PTR(nlr.ret_val));
+    }
+    if (result != JDR_INTR) {
+        check_jresult(result);
+    }
+}
+
 void common_hal_jpegio_jpegdecoder_decode_into(
     jpegio_jpegdecoder_obj_t *self,
     displayio_bitmap_t *bitmap, int scale, int16_t x, int16_t y,
     bitmaptools_rect_t *lim,
     uint32_t skip_source_index, bool skip_source_index_none,
     uint32_t skip_dest_index, bool skip_dest_index_none) {
-    if (self->data_obj == MP_OBJ_NULL) {
-        mp_raise_RuntimeError_varg(MP_ERROR_TEXT("%q() without %q()"), MP_QSTR_decode, MP_QSTR_open);
+    check_open(self, MP_QSTR_decode);
+    displayio_bitmap_check_writable(bitmap);
+    if (!set_clip(self, lim)) {
+        common_hal_jpegio_jpegdecoder_close(self);
+        return;
     }
 
     self->x = x;
@@ -19,6 +19,11 @@ typedef struct jpegio_jpegdecoder_obj {
     mp_obj_t data_obj;
     mp_buffer_info_t bufinfo;
     displayio_bitmap_t *dest;
+    // Used by decode_rows: the band of rows passed to the callback, and the
+    // output row of the image that its first row holds.
+    mp_obj_t callback;
+    displayio_bitmap_t *band;
+    int band_y, band_rows;
     uint16_t x, y;
     bitmaptools_rect_t lim;
     uint32_t skip_source_index, skip_dest_index;
@@ -46,11 +46,102 @@ static inline void free_memory(lvfontio_ondiskfont_t *self, void *ptr) {
     }
 }
 
+// Reads go through a buffer holding one aligned sector of the file so that
+// unpacking glyph bits and looking up cmap entries doesn't call into FatFs for
+// every byte.
+#define LVFONTIO_READ_BUFFER_SIZE (512)
+
+// Marks the end of a hash chain.
+#define LVFONTIO_NO_SLOT (UINT16_MAX)
+
+// Bit reader over the buffered file. Holds count unread bits at the bottom of
+// bits, most significant first.
+typedef struct {
+    uint32_t bits;
+    uint8_t count;
+} lvfontio_bit_reader_t;
+
 // Forward declarations for helper functions
 static int16_t find_codepoint_slot(lvfontio_ondiskfont_t *self, uint32_t codepoint);
-static uint16_t find_free_slot(lvfontio_ondiskfont_t *self, uint32_t codepoint);
-static FRESULT read_bits(FIL *file, size_t num_bits, uint8_t *byte_val, uint8_t *remaining_bits, uint32_t *result);
-static FRESULT read_glyph_dimensions(FIL *file, lvfontio_ondiskfont_t *self, uint32_t *advance_width, int32_t *bbox_x, int32_t *bbox_y, uint32_t *bbox_w, uint32_t *bbox_h, uint8_t *byte_val, uint8_t *remaining_bits);
+static uint16_t find_free_slot(lvfontio_ondiskfont_t *self, uint16_t slots_needed);
+static FRESULT read_bits(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader, size_t num_bits, uint32_t *result);
+static FRESULT skip_bits(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader, size_t num_bits);
+static FRESULT read_glyph_dimensions(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader, uint32_t *advance_width, int32_t *bbox_x, int32_t *bbox_y, uint32_t *bbox_w, uint32_t *bbox_h);
+
+static inline void font_seek(lvfontio_ondiskfont_t *self, uint32_t position) {
+    self->read_position = position;
+}
+
+static FRESULT font_read(lvfontio_ondiskfont_t *self, void *data, size_t len) {
+    uint8_t *dest = data;
+    while (len > 0) {
+        uint32_t offset = self->read_position - self->read_buffer_start;
+        if (self->read_position < self->read_buffer_start || offset >= self->read_buffer_length) {
+            // Refill with the sector holding the read position.
+            uint32_t sector_start = self->read_position & ~(LVFONTIO_READ_BUFFER_SIZE - 1);
+            FRESULT res = f_lseek(&self->file, sector_start);
+            if (res != FR_OK) {
+                return res;
+            }
+            UINT bytes_read;
+            self->read_buffer_length = 0;
+            res = f_read(&self->file, self->read_buffer, LVFONTIO_READ_BUFFER_SIZE, &bytes_read);
+            if (res != FR_OK) {
+                return res;
+            }
+            self->read_buffer_start = sector_start;
+            self->read_buffer_length = bytes_read;
+            offset = self->read_position - sector_start;
+            if (offset >= bytes_read) {
+                return FR_DISK_ERR; // Past the end of the file
+            }
+        }
+        size_t chunk = MIN(len, (size_t)(self->read_buffer_length - offset));
+        memcpy(dest, self->read_buffer + offset, chunk);
+        dest += chunk;
+        len -= chunk;
+        self->read_position += chunk;
+    }
+    return FR_OK;
+}
+
+static inline FRESULT font_read_byte(lvfontio_ondiskfont_t *self, uint8_t *value) {
+    uint32_t offset = self->read_position - self->read_buffer_start;
+    if (self->read_position >= self->read_buffer_start && offset < self->read_buffer_length) {
+        *value = self->read_buffer[offset];
+        self->read_position++;
+        return FR_OK;
+    }
+    return font_read(self, value, 1);
+}
+
+// Keep the sparse cmap tables in RAM so looking up a codepoint doesn't touch the
+// file. This is optional: when there isn't room, lookups read the file instead.
+static void load_cmap_entries(lvfontio_ondiskfont_t *self, FIL *file) {
+    for (uint16_t i = 0; i < self->cmap_range_count; i++) {
+        lvfontio_cmap_range_t *range = &self->cmap_ranges[i];
+        if ((range->format_type != 0 && range->format_type != 3) || range->entries_count == 0) {
+            continue;
+        }
+        size_t size = range->entries_count * (range->format_type == 3 ? sizeof(uint16_t) : sizeof(uint8_t));
+        void *entries;
+        if (self->use_gc_allocator) {
+            entries = m_malloc_maybe(size);
+        } else {
+            entries = port_malloc(size, false);
+        }
+        if (entries == NULL) {
+            continue;
+        }
+        UINT bytes_read;
+        if (f_lseek(file, range->data_offset) != FR_OK ||
+            f_read(file, entries, size, &bytes_read) != FR_OK || bytes_read < size) {
+            free_memory(self, entries);
+            continue;
+        }
+        range->entries = entries;
+    }
+}
 
 // Load font header data from file
 static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max_slots) {
@@ -144,6 +235,8 @@ static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max
             if (self->cmap_ranges == NULL) {
                 return false;
             }
+            // Skipped subtables are left as empty ranges that never match.
+            memset(self->cmap_ranges, 0, sizeof(lvfontio_cmap_range_t) * subtable_count);
 
             // Read each subtable
             for (uint16_t i = 0; i < subtable_count; i++) {
@@ -180,6 +273,8 @@ static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max
                 self->cmap_ranges[i].entries_count = entries_count;
             }
 
+            load_cmap_entries(self, file);
+
             found_cmap = true;
         } else if (memcmp(buffer, "loca", 4) == 0) {
             // Read max_cid
@@ -209,6 +304,7 @@ static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max
 
             // Set the default advance width based on the first character in the
             // file.
+            font_seek(self, current_position + 8);
             size_t cid = 0;
             while (cid < self->max_cid - 1) {
                 // Read glyph header fields
@@ -216,14 +312,16 @@ static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max
                 int32_t bbox_x, bbox_y;
                 uint32_t bbox_w, bbox_h;
 
-                uint8_t byte_val = 0;
-                uint8_t remaining_bits = 0;
+                // Each glyph starts on a byte boundary.
+                lvfontio_bit_reader_t reader = { 0 };
 
                 // Use the helper function to read glyph dimensions
-                read_glyph_dimensions(file, self, &glyph_advance, &bbox_x, &bbox_y, &bbox_w, &bbox_h, &byte_val, &remaining_bits);
+                if (read_glyph_dimensions(self, &reader, &glyph_advance, &bbox_x, &bbox_y, &bbox_w, &bbox_h) != FR_OK) {
+                    break;
+                }
 
                 // Throw away the bitmap bits.
-                read_bits(file, self->header.bits_per_pixel * bbox_w * bbox_h, &byte_val, &remaining_bits, NULL);
+                skip_bits(self, &reader, self->header.bits_per_pixel * bbox_w * bbox_h);
                 if (advances[0] == glyph_advance) {
                     advance_count[0]++;
                 } else if (advances[1] == glyph_advance) {
@@ -285,71 +383,79 @@ static bool load_font_header(lvfontio_ondiskfont_t *self, FIL *file, size_t *max
 static int32_t get_char_id(lvfontio_ondiskfont_t *self, uint32_t codepoint) {
     // Find codepoint in cmap ranges
     for (uint16_t i = 0; i < self->cmap_range_count; i++) {
+        const lvfontio_cmap_range_t *range = &self->cmap_ranges[i];
         // Check if codepoint is in range for this subtable
-        if (codepoint >= self->cmap_ranges[i].range_start &&
-            codepoint < self->cmap_ranges[i].range_end) {
+        if (codepoint >= range->range_start &&
+            codepoint < range->range_end) {
 
             // Handle according to format type
-            switch (self->cmap_ranges[i].format_type) {
+            switch (range->format_type) {
                 case 0: { // Sparse mapping - need to look up in a sparse table
-                    if (!self->file_is_open) {
-                        return -1;
-                    }
-
                     // Calculate the relative position within the range
-                    uint32_t idx = codepoint - self->cmap_ranges[i].range_start;
+                    uint32_t idx = codepoint - range->range_start;
 
-                    if (idx >= self->cmap_ranges[i].entries_count) {
+                    if (idx >= range->entries_count) {
                         return -1;
                     }
 
-                    // Calculate the absolute data position in the file
-                    uint32_t data_pos = self->cmap_ranges[i].data_offset + idx; // 1 byte per entry
-                    FRESULT res = f_lseek(&self->file, data_pos);
-                    if (res != FR_OK) {
-                        return -1;
-                    }
-
-                    // Read the glyph ID (1 byte)
                     uint8_t glyph_id;
-                    UINT bytes_read;
-                    res = f_read(&self->file, &glyph_id, 1, &bytes_read);
-
-                    if (res != FR_OK || bytes_read < 1) {
-                        return -1;
+                    if (range->entries != NULL) {
+                        glyph_id = ((const uint8_t *)range->entries)[idx];
+                    } else {
+                        if (!self->file_is_open) {
+                            return -1;
+                        }
+                        // 1 byte per entry
+                        font_seek(self, range->data_offset + idx);
+                        if (font_read(self, &glyph_id, 1) != FR_OK) {
+                            return -1;
+                        }
                     }
 
-
-                    return self->cmap_ranges[i].glyph_offset + glyph_id;
+                    return range->glyph_offset + glyph_id;
                 }
 
                 case 2: // Range to range - calculate based on offset within range
-                    uint16_t idx = codepoint - self->cmap_ranges[i].range_start;
-                    uint16_t glyph_id = self->cmap_ranges[i].glyph_offset + idx;
+                    uint16_t idx = codepoint - range->range_start;
+                    uint16_t glyph_id = range->glyph_offset + idx;
                     return glyph_id;
 
                 case 3: { // Direct mapping - need to look up in the table
-                    if (!self->file_is_open) {
+                    uint16_t codepoint_delta = codepoint - range->range_start;
+
+                    if (range->entries != NULL) {
+                        // lv_font_conv writes the deltas in ascending order.
+                        const uint16_t *deltas = range->entries;
+                        size_t low = 0;
+                        size_t high = range->entries_count;
+                        while (low < high) {
+                            size_t mid = (low + high) / 2;
+                            if (deltas[mid] < codepoint_delta) {
+                                low = mid + 1;
+                            } else {
+                                high = mid;
+                            }
+                        }
+                        if (low < range->entries_count && deltas[low] == codepoint_delta) {
+                            return range->glyph_offset + low;
+                        }
                         return -1;
                     }
 
-                    FRESULT res;
-                    res = f_lseek(&self->file, self->cmap_ranges[i].data_offset);
-                    if (res != FR_OK) {
+                    if (!self->file_is_open) {
                         return -1;
                     }
-                    uint16_t codepoint_delta = codepoint - self->cmap_ranges[i].range_start;
 
-                    for (size_t j = 0; j < self->cmap_ranges[i].entries_count; j++) {
+                    font_seek(self, range->data_offset);
+                    for (size_t j = 0; j < range->entries_count; j++) {
                         // Read code point at the index
                         uint16_t candidate_codepoint_delta;
-                        res = f_read(&self->file, &candidate_codepoint_delta, 2, NULL);
-                        if (res != FR_OK) {
+                        if (font_read(self, &candidate_codepoint_delta, 2) != FR_OK) {
                             return -1;
                         }
 
                         if (candidate_codepoint_delta == codepoint_delta) {
-                            return self->cmap_ranges[i].glyph_offset + j;
+                            return range->glyph_offset + j;
                         }
                     }
                     return -1;
@@ -365,44 +471,58 @@ static int32_t get_char_id(lvfontio_ondiskfont_t *self, uint32_t codepoint) {
 }
 
 // Load glyph bitmap data into a slot
-// This function assumes the file is already open and positioned after reading the glyph dimensions
-static bool load_glyph_bitmap(FIL *file, lvfontio_ondiskfont_t *self, uint32_t codepoint, uint16_t slot,
-    uint32_t glyph_advance, int32_t bbox_x, int32_t bbox_y, uint32_t bbox_w, uint32_t bbox_h,
-    uint8_t *byte_val, uint8_t *remaining_bits) {
-    // Store codepoint at slot
-    self->codepoints[slot] = codepoint;
-    self->reference_counts[slot] = 1;
-
-    // Read bitmap data pixel by pixel
-    uint16_t x_offset = slot * self->header.default_advance_width;
-    uint16_t y_offset = self->header.ascent - bbox_y - bbox_h;
+// This function assumes the reader is positioned after the glyph dimensions
+static bool load_glyph_bitmap(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader,
+    uint16_t slot, uint16_t slots_needed,
+    int32_t bbox_x, int32_t bbox_y, uint32_t bbox_w, uint32_t bbox_h) {
+    displayio_bitmap_t *bitmap = self->bitmap;
+    displayio_area_t area = {
+        .x1 = slot * self->header.default_advance_width,
+        .y1 = 0,
+        .x2 = (slot + slots_needed) * self->header.default_advance_width,
+        .y2 = self->header.font_size,
+        .next = NULL,
+    };
+
+    // Clear whatever glyph was in the slot before.
+    for (int16_t y = area.y1; y < area.y2; y++) {
+        for (int16_t x = area.x1; x < area.x2; x++) {
+            displayio_bitmap_write_pixel(bitmap, x, y, 0);
+        }
+    }
+
+    // Unpack the pixels straight from the read buffer
+    uint8_t bits_per_pixel = self->header.bits_per_pixel;
+    uint32_t pixel_mask = (1 << bits_per_pixel) - 1;
+    int16_t y_offset = self->header.ascent - bbox_y - bbox_h;
     for (uint16_t y = 0; y < bbox_h; y++) {
+        int16_t bitmap_y = y_offset + y;
         for (uint16_t x = 0; x < bbox_w; x++) {
-            uint32_t pixel_value;
-            FRESULT res = read_bits(file, self->header.bits_per_pixel, byte_val, remaining_bits, &pixel_value);
-            if (res != FR_OK) {
-                return false;
+            if (reader->count < bits_per_pixel) {
+                uint8_t next_byte;
+                if (font_read_byte(self, &next_byte) != FR_OK) {
+                    return false;
+                }
+                reader->bits = (reader->bits << 8) | next_byte;
+                reader->count += 8;
             }
-
-            // Adjust for bbox position within the glyph bounding box
-            int16_t bitmap_x = x_offset + x + bbox_x;
-            int16_t bitmap_y = y_offset + y;
-
-            // Make sure we're in bounds
-            if (bitmap_x >= 0 &&
-                bitmap_x < self->header.default_advance_width * self->max_glyphs &&
+            reader->count -= bits_per_pixel;
+            uint32_t pixel_value = (reader->bits >> reader->count) & pixel_mask;
+
+            // Adjust for bbox position within the glyph bounding box, and keep
+            // to the glyph's own slots
+            int16_t bitmap_x = area.x1 + x + bbox_x;
+            if (pixel_value != 0 &&
+                bitmap_x >= area.x1 &&
+                bitmap_x < area.x2 &&
                 bitmap_y >= 0 &&
-                bitmap_y < self->header.font_size) {
-                common_hal_displayio_bitmap_set_pixel(
-                    self->bitmap,
-                    bitmap_x,
-                    bitmap_y,
-                    pixel_value
-                    );
+                bitmap_y < area.y2) {
+                displayio_bitmap_write_pixel(bitmap, bitmap_x, bitmap_y, pixel_value);
             }
         }
     }
 
+    displayio_bitmap_set_dirty_area(bitmap, &area);
     return true;
 }
 
@@ -417,14 +537,27 @@ void common_hal_lvfontio_ondiskfont_construct(lvfontio_ondiskfont_t *self,
     // Store parameters
     self->file_path = file_path; // Store the provided path string directly
     self->max_glyphs = max_glyphs;
+    self->bitmap = NULL;
+    self->codepoints = NULL;
+    self->reference_counts = NULL;
+    self->last_used = NULL;
+    self->use_count = 0;
+    self->hash_heads = NULL;
+    self->hash_next = NULL;
     self->cmap_ranges = NULL;
+    self->cmap_range_count = 0;
+    self->read_buffer = NULL;
+    self->read_buffer_start = 0;
+    self->read_buffer_length = 0;
+    self->read_position = 0;
     self->file_is_open = false;
 
     // Determine which filesystem to use based on the path
     const char *path_under_mount;
     fs_user_mount_t *vfs = filesystem_for_path(file_path, &path_under_mount);
 
-    if (vfs == NULL) {
+    // Fonts are read with FatFs, so a littlefs or ROM mount can't hold them.
+    if (vfs == NULL || vfs->base.type != &mp_fat_vfs_type || filesystem_littlefs(vfs)) {
         if (self->use_gc_allocator) {
             mp_raise_ValueError(MP_ERROR_TEXT("File not found"));
         }
@@ -443,11 +576,15 @@ void common_hal_lvfontio_ondiskfont_construct(lvfontio_ondiskfont_t *self,
 
     self->file_is_open = true;
 
+    self->read_buffer = allocate_memory(self, LVFONTIO_READ_BUFFER_SIZE);
+    if (self->read_buffer == NULL) {
+        return;
+    }
+
     // Load font headers
-    size_t max_slots;
+    size_t max_slots = max_glyphs;
     if (!load_font_header(self, &self->file, &max_slots)) {
-        f_close(&self->file);
-        self->file_is_open = false;
+        common_hal_lvfontio_ondiskfont_deinit(self);
         if (self->use_gc_allocator) {
             mp_raise_ValueError_varg(MP_ERROR_TEXT("Invalid %q"), MP_QSTR_file);
         }
@@ -456,6 +593,7 @@ void common_hal_lvfontio_ondiskfont_construct(lvfontio_ondiskfont_t *self,
     // Cap the number of slots to the number of slots needed by the font. That way
     // small font files don't need a bunch of extra cache space.
     max_glyphs = MIN(max_glyphs, max_slots);
+    self->max_glyphs = max_glyphs;
 
     // Allocate codepoints array. allocate_memory will raise an exception if
     // allocation fails and the VM is active.
@@ -478,14 +616,38 @@ void common_hal_lvfontio_ondiskfont_construct(lvfontio_ondiskfont_t *self,
     // Initialize reference counts to 0
     memset(self->reference_counts, 0, sizeof(uint16_t) * max_glyphs);
 
+    self->last_used = allocate_memory(self, sizeof(uint16_t) * max_glyphs);
+    if (self->last_used == NULL) {
+        return;
+    }
+    memset(self->last_used, 0, sizeof(uint16_t) * max_glyphs);
+
+    // Size the hash to the next power of two with room for every slot.
+    uint32_t hash_size = 1;
+    while (hash_size < max_glyphs) {
+        hash_size <<= 1;
+    }
+    self->hash_mask = hash_size - 1;
+    self->hash_heads = allocate_memory(self, sizeof(uint16_t) * hash_size);
+    if (self->hash_heads == NULL) {
+        return;
+    }
+    self->hash_next = allocate_memory(self, sizeof(uint16_t) * max_glyphs);
+    if (self->hash_next == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < hash_size; i++) {
+        self->hash_heads[i] = LVFONTIO_NO_SLOT;
+    }
+
     self->half_width_px = self->header.default_advance_width;
 
     // Create bitmap for glyph cache
     displayio_bitmap_t *bitmap = allocate_memory(self, sizeof(displayio_bitmap_t));
-    bitmap->base.type = &displayio_bitmap_type;
     if (bitmap == NULL) {
         return;
     }
+    bitmap->base.type = &displayio_bitmap_type;
 
     // Calculate bitmap stride
     uint32_t bits_per_pixel = 1 << self->header.bits_per_pixel;
@@ -497,6 +659,7 @@ void common_hal_lvfontio_ondiskfont_construct(lvfontio_ondiskfont_t *self,
     uint32_t buffer_size = stride * self->header.font_size * sizeof(uint32_t);
     uint32_t *bitmap_buffer = allocate_memory(self, buffer_size);
     if (bitmap_buffer == NULL) {
+        free_memory(self, bitmap);
         return;
     }
 
@@ -533,13 +696,36 @@ void common_hal_lvfontio_ondiskfont_deinit(lvfontio_ondiskfont_t *self) {
         self->reference_counts = NULL;
     }
 
+    if (self->last_used != NULL) {
+        free_memory(self, self->last_used);
+        self->last_used = NULL;
+    }
 
+    if (self->hash_heads != NULL) {
+        free_memory(self, self->hash_heads);
+        self->hash_heads = NULL;
+    }
+
+    if (self->hash_next != NULL) {
+        free_memory(self, self->hash_next);
+        self->hash_next = NULL;
+    }
 
     if (self->cmap_ranges != NULL) {
+        for (uint16_t i = 0; i < self->cmap_range_count; i++) {
+            if (self->cmap_ranges[i].entries != NULL) {
+                free_memory(self, self->cmap_ranges[i].entries);
+            }
+        }
         free_memory(self, self->cmap_ranges);
         self->cmap_ranges = NULL;
     }
 
+    if (self->read_buffer != NULL) {
+        free_memory(self, self->read_buffer);
+        self->read_buffer = NULL;
+    }
+
     f_close(&self->file);
     self->file_is_open = false;
 }
@@ -569,34 +755,77 @@ void common_hal_lvfontio_ondiskfont_get_dimensions(const lvfontio_ondiskfont_t *
     }
 }
 
-int16_t common_hal_lvfontio_ondiskfont_cache_glyph(lvfontio_ondiskfont_t *self, uint32_t codepoint, bool *is_full_width) {
+static inline bool slot_is_full_width(lvfontio_ondiskfont_t *self, uint16_t slot) {
+    return slot + 1 < self->max_glyphs &&
+           self->codepoints[slot + 1] == self->codepoints[slot];
+}
+
+// Mark a slot (and the second half of a full-width glyph) as just used.
+static void touch_slot(lvfontio_ondiskfont_t *self, uint16_t slot, uint16_t slots_needed) {
+    if (self->use_count == UINT16_MAX) {
+        // Halve every age to make room while keeping their order.
+        for (uint16_t i = 0; i < self->max_glyphs; i++) {
+            self->last_used[i] >>= 1;
+        }
+        self->use_count >>= 1;
+    }
+    self->use_count++;
+    for (uint16_t i = 0; i < slots_needed; i++) {
+        self->last_used[slot + i] = self->use_count;
+    }
+}
+
+static void hash_insert(lvfontio_ondiskfont_t *self, uint16_t slot) {
+    uint16_t *head = &self->hash_heads[self->codepoints[slot] & self->hash_mask];
+    self->hash_next[slot] = *head;
+    *head = slot;
+}
+
+static void hash_remove(lvfontio_ondiskfont_t *self, uint16_t slot) {
+    uint16_t *link = &self->hash_heads[self->codepoints[slot] & self->hash_mask];
+    while (*link != LVFONTIO_NO_SLOT) {
+        if (*link == slot) {
+            *link = self->hash_next[slot];
+            return;
+        }
+        link = &self->hash_next[*link];
+    }
+}
+
+// Forget the glyph held in a slot, including both halves of a full-width glyph.
+static void clear_slot(lvfontio_ondiskfont_t *self, uint16_t slot) {
+    uint32_t codepoint = self->codepoints[slot];
+    if (codepoint == LVFONTIO_INVALID_CODEPOINT) {
+        return;
+    }
+    if (slot > 0 && self->codepoints[slot - 1] == codepoint) {
+        slot--;
+    }
+    hash_remove(self, slot);
+    if (slot_is_full_width(self, slot)) {
+        self->codepoints[slot + 1] = LVFONTIO_INVALID_CODEPOINT;
+    }
+    self->codepoints[slot] = LVFONTIO_INVALID_CODEPOINT;
+}
+
+// Make sure a glyph is in the cache without taking a reference to it. Returns
+// its first slot or -1 if it can't be loaded.
+static int16_t load_glyph(lvfontio_ondiskfont_t *self, uint32_t codepoint, bool *is_full_width) {
     // Check if already cached
     int16_t existing_slot = find_codepoint_slot(self, codepoint);
     if (existing_slot >= 0) {
-        // Glyph is already cached, increment reference count
-        self->reference_counts[existing_slot]++;
-
         // Check if this is a full-width character by looking for a second slot
         // with the same codepoint right after this one
+        bool full_width = slot_is_full_width(self, existing_slot);
+        touch_slot(self, existing_slot, full_width ? 2 : 1);
         if (is_full_width != NULL) {
-            if (existing_slot + 1 < self->max_glyphs &&
-                self->codepoints[existing_slot + 1] == codepoint) {
-                *is_full_width = true;
-            } else {
-                *is_full_width = false;
-            }
+            *is_full_width = full_width;
         }
-
         return existing_slot;
     }
 
-    // First check if the glyph is full-width before allocating slots
-    // This way we know if we need one or two slots before committing
-    bool is_full_width_glyph = false;
-
     // Check if file is already open
-    if (!self->file_is_open) {
-
+    if (!self->file_is_open || self->bitmap == NULL) {
         return -1;
     }
 
@@ -608,96 +837,52 @@ int16_t common_hal_lvfontio_ondiskfont_cache_glyph(lvfontio_ondiskfont_t *self,
 
     // Get glyph offset from location table
     uint32_t glyph_offset = 0;
-    uint32_t loca_offset = self->loca_table_offset + char_id *
-        (self->header.index_to_loc_format == 1 ? 4 : 2);
-
-    FRESULT res = f_lseek(&self->file, loca_offset);
-    if (res != FR_OK) {
+    uint8_t offset_buf[4] = { 0 };
+    uint8_t offset_size = self->header.index_to_loc_format == 1 ? 4 : 2;
+    font_seek(self, self->loca_table_offset + char_id * offset_size);
+    if (font_read(self, offset_buf, offset_size) != FR_OK) {
         return -1;
     }
+    glyph_offset = offset_buf[0] | (offset_buf[1] << 8) |
+        (offset_buf[2] << 16) | (offset_buf[3] << 24);
 
-    UINT bytes_read;
-    if (self->header.index_to_loc_format == 1) {
-        // 4-byte offset
-        uint8_t offset_buf[4];
-        res = f_read(&self->file, offset_buf, 4, &bytes_read);
-        if (res != FR_OK || bytes_read < 4) {
-            return -1;
-        }
-        glyph_offset = offset_buf[0] | (offset_buf[1] << 8) |
-            (offset_buf[2] << 16) | (offset_buf[3] << 24);
-    } else {
-        // 2-byte offset
-        uint8_t offset_buf[2];
-        res = f_read(&self->file, offset_buf, 2, &bytes_read);
-        if (res != FR_OK || bytes_read < 2) {
-            return -1;
-        }
-        glyph_offset = offset_buf[0] | (offset_buf[1] << 8);
-    }
     // Seek to glyph data
-    res = f_lseek(&self->file, self->glyf_table_offset + glyph_offset);
-    if (res != FR_OK) {
-        return -1;
-    }
+    font_seek(self, self->glyf_table_offset + glyph_offset);
 
     // Read glyph header fields to determine width
     uint32_t glyph_advance;
     int32_t bbox_x, bbox_y;
     uint32_t bbox_w, bbox_h;
 
-    // Initialize bit reading state
-    uint8_t byte_val = 0;
-    uint8_t remaining_bits = 0;
-
-    // Use the helper function to read glyph dimensions
-    res = read_glyph_dimensions(&self->file, self, &glyph_advance, &bbox_x, &bbox_y, &bbox_w, &bbox_h, &byte_val, &remaining_bits);
-    if (res != FR_OK) {
+    lvfontio_bit_reader_t reader = { 0 };
+    if (read_glyph_dimensions(self, &reader, &glyph_advance, &bbox_x, &bbox_y, &bbox_w, &bbox_h) != FR_OK) {
         return -1;
     }
 
-    // Check if the glyph is full-width based on its advance width
-    // Full-width characters typically have an advance width close to or greater than the font height
-    is_full_width_glyph = glyph_advance > self->half_width_px;
-
-    // Now we know if we need one or two slots
+    // Check if the glyph is full-width based on its advance width. Full-width
+    // glyphs take two adjacent slots so we know how many before committing.
+    bool is_full_width_glyph = glyph_advance > self->half_width_px;
     uint16_t slots_needed = is_full_width_glyph ? 2 : 1;
 
-    // Find an appropriate slot (or consecutive slots for full-width)
-    uint16_t slot = UINT16_MAX;
-
-    if (slots_needed == 1) {
-        // For regular width, find a free slot starting at codepoint's position
-        slot = find_free_slot(self, codepoint);
-    } else {
-        // For full-width, find two consecutive free slots
-        for (uint16_t i = 0; i < self->max_glyphs - 1; i++) {
-            if (self->codepoints[i] == LVFONTIO_INVALID_CODEPOINT &&
-                self->reference_counts[i] == 0 &&
-                self->codepoints[i + 1] == LVFONTIO_INVALID_CODEPOINT &&
-                self->reference_counts[i + 1] == 0) {
-                slot = i;
-                break;
-            }
-        }
-    }
-
-    // Check if we found appropriate slot(s)
-    if (slot == UINT16_MAX) {
+    uint16_t slot = find_free_slot(self, slots_needed);
+    if (slot == LVFONTIO_NO_SLOT) {
         return -1; // No slots available
     }
+    for (uint16_t i = 0; i < slots_needed; i++) {
+        clear_slot(self, slot + i);
+    }
 
     // Load glyph into the slot
-    if (!load_glyph_bitmap(&self->file, self, codepoint, slot, glyph_advance,
-        bbox_x, bbox_y, bbox_w, bbox_h, &byte_val, &remaining_bits)) {
+    if (!load_glyph_bitmap(self, &reader, slot, slots_needed, bbox_x, bbox_y, bbox_w, bbox_h)) {
         return -1; // Failed to load glyph
     }
 
     // For full-width characters, mark both slots with the same codepoint
-    if (is_full_width_glyph && slot + 1 < self->max_glyphs) {
-        self->codepoints[slot + 1] = codepoint;
-        self->reference_counts[slot + 1] = 1;
+    for (uint16_t i = 0; i < slots_needed; i++) {
+        self->codepoints[slot + i] = codepoint;
     }
+    hash_insert(self, slot);
+    touch_slot(self, slot, slots_needed);
 
     if (is_full_width != NULL) {
         *is_full_width = is_full_width_glyph;
@@ -706,6 +891,25 @@ int16_t common_hal_lvfontio_ondiskfont_cache_glyph(lvfontio_ondiskfont_t *self,
     return slot;
 }
 
+int16_t common_hal_lvfontio_ondiskfont_cache_glyph(lvfontio_ondiskfont_t *self, uint32_t codepoint, bool *is_full_width) {
+    bool full_width;
+    int16_t slot = load_glyph(self, codepoint, &full_width);
+    if (slot < 0) {
+        return -1;
+    }
+
+    // Both halves of a full-width glyph are placed, and released, separately.
+    self->reference_counts[slot]++;
+    if (full_width) {
+        self->reference_counts[slot + 1]++;
+    }
+
+    if (is_full_width != NULL) {
+        *is_full_width = full_width;
+    }
+    return slot;
+}
+
 void common_hal_lvfontio_ondiskfont_release_glyph(lvfontio_ondiskfont_t *self, uint32_t slot) {
     if (slot >= self->max_glyphs) {
         return;
@@ -716,56 +920,93 @@ void common_hal_lvfontio_ondiskfont_release_glyph(lvfontio_ondiskfont_t *self, u
     }
 }
 
+void common_hal_lvfontio_ondiskfont_prefetch(lvfontio_ondiskfont_t *self, const byte *text, size_t len) {
+    const byte *end = text + len;
+    while (text < end) {
+        unichar codepoint = utf8_get_char(text);
+        text = utf8_next_char(text);
+        // Glyphs that can't be loaded are skipped here, the same as when drawn.
+        load_glyph(self, codepoint, NULL);
+    }
+}
+
 static int16_t find_codepoint_slot(lvfontio_ondiskfont_t *self, uint32_t codepoint) {
-    size_t offset = codepoint % self->max_glyphs;
-    for (uint16_t i = 0; i < self->max_glyphs; i++) {
-        int16_t slot = (i + offset) % self->max_glyphs;
+    if (self->hash_heads == NULL) {
+        return -1;
+    }
+    uint16_t slot = self->hash_heads[codepoint & self->hash_mask];
+    while (slot != LVFONTIO_NO_SLOT) {
         if (self->codepoints[slot] == codepoint) {
             return slot;
         }
+        slot = self->hash_next[slot];
     }
     return -1;
 }
 
-static uint16_t find_free_slot(lvfontio_ondiskfont_t *self, uint32_t codepoint) {
-    size_t offset = codepoint % self->max_glyphs;
-
-    // First look for completely unused slots, starting at the offset
-    for (uint16_t i = 0; i < self->max_glyphs; i++) {
-        int16_t slot = (i + offset) % self->max_glyphs;
-        if (self->codepoints[slot] == LVFONTIO_INVALID_CODEPOINT && self->reference_counts[slot] == 0) {
-            return slot;
-        }
+// A slot can be reused when nothing references it, nor the other half of the
+// full-width glyph it belongs to.
+static bool slot_is_unreferenced(lvfontio_ondiskfont_t *self, uint16_t slot) {
+    if (self->reference_counts[slot] != 0) {
+        return false;
     }
+    uint32_t codepoint = self->codepoints[slot];
+    if (codepoint == LVFONTIO_INVALID_CODEPOINT) {
+        return true;
+    }
+    if (slot > 0 && self->codepoints[slot - 1] == codepoint && self->reference_counts[slot - 1] != 0) {
+        return false;
+    }
+    if (slot + 1 < self->max_glyphs && self->codepoints[slot + 1] == codepoint && self->reference_counts[slot + 1] != 0) {
+        return false;
+    }
+    return true;
+}
 
-    // If none found, look for slots with zero reference count, starting at the offset
-    for (uint16_t i = 0; i < self->max_glyphs; i++) {
-        int16_t slot = (i + offset) % self->max_glyphs;
-        if (self->reference_counts[slot] == 0) {
-            return slot;
+// Find slots_needed adjacent slots to load a glyph into. Empty slots are used
+// first, then the unreferenced ones that were used least recently.
+static uint16_t find_free_slot(lvfontio_ondiskfont_t *self, uint16_t slots_needed) {
+    uint16_t best_slot = LVFONTIO_NO_SLOT;
+    uint32_t best_age = UINT32_MAX;
+    for (uint16_t slot = 0; slot + slots_needed <= self->max_glyphs; slot++) {
+        // Empty slots count as the oldest. A pair is as new as its newest half.
+        uint32_t age = 0;
+        bool usable = true;
+        for (uint16_t i = 0; i < slots_needed; i++) {
+            if (!slot_is_unreferenced(self, slot + i)) {
+                usable = false;
+                break;
+            }
+            if (self->codepoints[slot + i] != LVFONTIO_INVALID_CODEPOINT) {
+                age = MAX(age, (uint32_t)self->last_used[slot + i] + 1);
+            }
+        }
+        if (usable && age < best_age) {
+            best_slot = slot;
+            best_age = age;
+            if (age == 0) {
+                break;
+            }
         }
     }
-
-    // No slots available
-    return UINT16_MAX;
+    return best_slot;
 }
 
-static FRESULT read_glyph_dimensions(FIL *file, lvfontio_ondiskfont_t *self,
+static FRESULT read_glyph_dimensions(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader,
     uint32_t *advance_width, int32_t *bbox_x, int32_t *bbox_y,
-    uint32_t *bbox_w, uint32_t *bbox_h,
-    uint8_t *byte_val, uint8_t *remaining_bits) {
+    uint32_t *bbox_w, uint32_t *bbox_h) {
     FRESULT res;
     uint32_t temp_value;
 
     // Read glyph_advance
-    res = read_bits(file, self->header.glyph_advance_bits, byte_val, remaining_bits, &temp_value);
+    res = read_bits(self, reader, self->header.glyph_advance_bits, &temp_value);
     if (res != FR_OK) {
         return res;
     }
     *advance_width = temp_value;
 
     // Read bbox_x (signed)
-    res = read_bits(file, self->header.glyph_bbox_xy_bits, byte_val, remaining_bits, &temp_value);
+    res = read_bits(self, reader, self->header.glyph_bbox_xy_bits, &temp_value);
     if (res != FR_OK) {
         return res;
     }
@@ -777,7 +1018,7 @@ static FRESULT read_glyph_dimensions(FIL *file, lvfontio_ondiskfont_t *self,
     }
 
     // Read bbox_y (signed)
-    res = read_bits(file, self->header.glyph_bbox_xy_bits, byte_val, remaining_bits, &temp_value);
+    res = read_bits(self, reader, self->header.glyph_bbox_xy_bits, &temp_value);
     if (res != FR_OK) {
         return res;
     }
@@ -789,14 +1030,14 @@ static FRESULT read_glyph_dimensions(FIL *file, lvfontio_ondiskfont_t *self,
     }
 
     // Read bbox_w
-    res = read_bits(file, self->header.glyph_bbox_wh_bits, byte_val, remaining_bits, &temp_value);
+    res = read_bits(self, reader, self->header.glyph_bbox_wh_bits, &temp_value);
     if (res != FR_OK) {
         return res;
     }
     *bbox_w = temp_value;
 
     // Read bbox_h
-    res = read_bits(file, self->header.glyph_bbox_wh_bits, byte_val, remaining_bits, &temp_value);
+    res = read_bits(self, reader, self->header.glyph_bbox_wh_bits, &temp_value);
     if (res != FR_OK) {
         return res;
     }
@@ -805,35 +1046,24 @@ static FRESULT read_glyph_dimensions(FIL *file, lvfontio_ondiskfont_t *self,
     return FR_OK;
 }
 
-static FRESULT read_bits(FIL *file, size_t num_bits, uint8_t *byte_val, uint8_t *remaining_bits, uint32_t *result) {
-    FRESULT res = FR_OK;
-    UINT bytes_read;
-
+static FRESULT read_bits(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader, size_t num_bits, uint32_t *result) {
     uint32_t value = 0;
-    // Bits will be lost when num_bits > 32. However, this is good for skipping bits.
-    size_t bits_needed = num_bits;
-
-    while (bits_needed > 0) {
-        // If no bits remaining, read a new byte
-        if (*remaining_bits == 0) {
-            res = f_read(file, byte_val, 1, &bytes_read);
-            if (res != FR_OK || bytes_read < 1) {
-                return FR_DISK_ERR;
+    while (num_bits > 0) {
+        // Refill a byte at a time.
+        if (reader->count == 0) {
+            uint8_t next_byte;
+            FRESULT res = font_read_byte(self, &next_byte);
+            if (res != FR_OK) {
+                return res;
             }
-            *remaining_bits = 8;
+            reader->bits = next_byte;
+            reader->count = 8;
         }
-
-        // Calculate how many bits to take from current byte
-        uint8_t bits_to_take = (*remaining_bits < bits_needed) ? *remaining_bits : bits_needed;
-        value = (value << bits_to_take) | (*byte_val >> (8 - bits_to_take));
-
-        // Update state
-        *remaining_bits -= bits_to_take;
-        bits_needed -= bits_to_take;
-
-        // Shift byte for next read
-        *byte_val <<= bits_to_take;
-        *byte_val &= 0xFF;
+        uint8_t bits_to_take = MIN(reader->count, num_bits);
+        reader->count -= bits_to_take;
+        value = (value << bits_to_take) |
+            ((reader->bits >> reader->count) & ((1 << bits_to_take) - 1));
+        num_bits -= bits_to_take;
     }
 
     if (result != NULL) {
@@ -841,3 +1071,12 @@ static FRESULT read_bits(FIL *file, size_t num_bits, uint8_t *byte_val, uint8_t
     }
     return FR_OK;
 }
+
+// Skip over bits without unpacking them, moving whole bytes with a seek.
+static FRESULT skip_bits(lvfontio_ondiskfont_t *self, lvfontio_bit_reader_t *reader, size_t num_bits) {
+    size_t buffered = MIN(reader->count, num_bits);
+    reader->count -= buffered;
+    num_bits -= buffered;
+    font_seek(self, self->read_position + num_bits / 8);
+    return read_bits(self, reader, num_bits % 8, NULL);
+}
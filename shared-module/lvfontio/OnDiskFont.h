@@ -40,6 +40,7 @@ typedef struct {
     uint8_t format_type;    // Format type: 0=sparse mapping, 2=range to range, 3=direct mapping
     uint16_t entries_count; // Number of entries in sparse data
     uint32_t data_offset;   // File offset to the cmap data
+    void *entries;          // Sparse data loaded into RAM, or NULL to read it from the file
 } lvfontio_cmap_range_t;
 
 typedef struct {
@@ -52,6 +53,13 @@ typedef struct {
     uint32_t *codepoints;
     // Array of reference counts for each glyph slot
     uint16_t *reference_counts; // Use uint16_t to handle higher reference counts
+    // When each slot was last used, for least recently used eviction
+    uint16_t *last_used;
+    uint16_t use_count;
+    // Chained hash from codepoint to the first slot of its glyph
+    uint16_t *hash_heads;
+    uint16_t *hash_next;
+    uint16_t hash_mask;
     // Maximum number of glyphs to cache at once
     uint16_t max_glyphs;
     // Flag indicating whether to use m_malloc (true) or port_malloc (false)
@@ -61,6 +69,12 @@ typedef struct {
     FIL file;
     bool file_is_open;
 
+    // One aligned sector of the file, read ahead for the bit unpacking
+    uint8_t *read_buffer;
+    uint32_t read_buffer_start;
+    uint16_t read_buffer_length;
+    uint32_t read_position;
+
     // Font metrics information loaded from file
     lvfontio_header_t header;
 
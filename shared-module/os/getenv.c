@@ -29,6 +29,31 @@
 #include "extmod/vfs_fat.h"
 
 #if CIRCUITPY_OS_GETENV
+#if CIRCUITPY_FILESYSTEM_LITTLEFS && !defined(UNIX)
+// CIRCUITPY is littlefs, so read settings.toml through it directly.
+typedef lfs2_file_t file_arg;
+static bool open_file(const char *name, file_arg *active_file) {
+    return filesystem_lfs_open(active_file, name, LFS2_O_RDONLY) == 0;
+}
+static void close_file(file_arg *active_file) {
+    lfs2_file_close(filesystem_circuitpy_lfs(), active_file);
+}
+static bool is_eof(file_arg *active_file) {
+    lfs2_t *lfs = filesystem_circuitpy_lfs();
+    return lfs2_file_tell(lfs, active_file) >= lfs2_file_size(lfs, active_file);
+}
+
+// Return 0 if there is no next character (EOF).
+static uint8_t get_next_byte(file_arg *active_file) {
+    uint8_t character = 0;
+    // If there's an error or nothing is read, character will remain 0.
+    lfs2_file_read(filesystem_circuitpy_lfs(), active_file, &character, 1);
+    return character;
+}
+static void seek_eof(file_arg *active_file) {
+    lfs2_file_seek(filesystem_circuitpy_lfs(), active_file, 0, LFS2_SEEK_END);
+}
+#else
 typedef FIL file_arg;
 static bool open_file(const char *name, file_arg *active_file) {
     #if defined(UNIX)
@@ -71,6 +96,7 @@ static uint8_t get_next_byte(FIL *active_file) {
 static void seek_eof(file_arg *active_file) {
     f_lseek(active_file, f_size(active_file));
 }
+#endif
 
 // For a fixed buffer, record the required size rather than throwing
 static void vstr_add_byte_nonstd(vstr_t *vstr, byte b) {
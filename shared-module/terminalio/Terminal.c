@@ -6,6 +6,8 @@
 
 #include "shared-module/terminalio/Terminal.h"
 
+#include <string.h>
+
 #include "shared-module/fontio/BuiltinFont.h"
 #include "shared-bindings/displayio/TileGrid.h"
 #include "shared-bindings/displayio/Palette.h"
@@ -84,6 +86,36 @@ static void release_current_glyph(displayio_tilegrid_t *tilegrid, mp_obj_t font,
     #endif
 }
 
+// Tiles written to the TileGrid at once by the batched paths below.
+#define TERMINALIO_RUN_LENGTH (32)
+
+// lvfontio fonts count references to their glyph slots, so every tile placed
+// or replaced must go through the font. Other fonts are plain lookups.
+static bool terminalio_terminal_font_has_slots(terminalio_terminal_obj_t *self) {
+    #if CIRCUITPY_LVFONTIO
+    return mp_obj_is_type(self->font, &lvfontio_ondiskfont_type);
+    #else
+    return false;
+    #endif
+}
+
+static uint16_t terminalio_terminal_get_glyph(terminalio_terminal_obj_t *self, mp_uint_t codepoint, bool *is_full_width) {
+    if (terminalio_terminal_font_has_slots(self)) {
+        return terminalio_terminal_get_glyph_index(self->font, codepoint, is_full_width);
+    }
+    if (is_full_width != NULL) {
+        *is_full_width = false;
+    }
+    // Non-ASCII lookups in a BuiltinFont are a linear search, so keep recent
+    // results. Codepoint 0 is never looked up and marks an empty entry.
+    size_t slot = codepoint % TERMINALIO_GLYPH_CACHE_SIZE;
+    if (self->glyph_cache_codepoints[slot] != codepoint) {
+        self->glyph_cache_codepoints[slot] = codepoint;
+        self->glyph_cache_tiles[slot] = terminalio_terminal_get_glyph_index(self->font, codepoint, NULL);
+    }
+    return self->glyph_cache_tiles[slot];
+}
+
 static void terminalio_terminal_set_tile(terminalio_terminal_obj_t *self, bool status_bar, mp_uint_t character, bool release_glyphs) {
     displayio_tilegrid_t *tilegrid = self->scroll_area;
     uint16_t *x = &self->cursor_x;
@@ -101,14 +133,14 @@ static void terminalio_terminal_set_tile(terminalio_terminal_obj_t *self, bool s
         release_current_glyph(tilegrid, self->font, *x, *y);
     }
     bool is_full_width;
-    uint16_t new_tile = terminalio_terminal_get_glyph_index(self->font, character, &is_full_width);
+    uint16_t new_tile = terminalio_terminal_get_glyph(self, character, &is_full_width);
     if (new_tile == 0xffff) {
         // Missing glyph.
         return;
     }
     // If there is only half width left, then fill it with a space and wrap to the next line.
     if (is_full_width && *x == w - 1) {
-        uint16_t space = terminalio_terminal_get_glyph_index(self->font, ' ', NULL);
+        uint16_t space = terminalio_terminal_get_glyph(self, ' ', NULL);
         common_hal_displayio_tilegrid_set_tile(tilegrid, *x, *y, space);
         *x = *x + 1;
         wrap_cursor(w, h, x, y);
@@ -145,6 +177,73 @@ static void terminalio_terminal_set_all_tiles(terminalio_terminal_obj_t *self, b
     }
 }
 
+// Fill tiles x1 to x2 - 1 of row y in the scroll area with spaces. The cursor is left unchanged.
+static void terminalio_terminal_clear_span(terminalio_terminal_obj_t *self, uint16_t y, uint16_t x1, uint16_t x2) {
+    if (terminalio_terminal_font_has_slots(self)) {
+        uint16_t old_x = self->cursor_x;
+        uint16_t old_y = self->cursor_y;
+        self->cursor_x = x1;
+        self->cursor_y = y;
+        for (uint16_t x = x1; x < x2; x++) {
+            terminalio_terminal_set_tile(self, false, ' ', true);
+        }
+        self->cursor_x = old_x;
+        self->cursor_y = old_y;
+        return;
+    }
+    uint16_t space = terminalio_terminal_get_glyph(self, ' ', NULL);
+    if (space == 0xffff) {
+        return;
+    }
+    uint16_t tiles[TERMINALIO_RUN_LENGTH];
+    for (uint16_t k = 0; k < TERMINALIO_RUN_LENGTH; k++) {
+        tiles[k] = space;
+    }
+    while (x1 < x2) {
+        uint16_t count = MIN(x2 - x1, TERMINALIO_RUN_LENGTH);
+        displayio_tilegrid_set_tile_run(self->scroll_area, x1, y, tiles, count);
+        x1 += count;
+    }
+}
+
+// Write c and the printable characters after it, up to the end of the row,
+// as runs of tiles. Returns the position after the last character consumed.
+static const byte *terminalio_terminal_write_run(terminalio_terminal_obj_t *self, unichar c, const byte *i, const byte *end) {
+    if (terminalio_terminal_font_has_slots(self)) {
+        terminalio_terminal_set_tile(self, false, c, true);
+        return i;
+    }
+    uint16_t width = self->scroll_area->width_in_tiles;
+    uint16_t tiles[TERMINALIO_RUN_LENGTH];
+    uint16_t count = 0;
+    while (true) {
+        uint16_t tile = terminalio_terminal_get_glyph(self, c, NULL);
+        // Missing glyphs are skipped without moving the cursor.
+        if (tile != 0xffff) {
+            tiles[count++] = tile;
+            if (count == TERMINALIO_RUN_LENGTH || self->cursor_x + count == width) {
+                displayio_tilegrid_set_tile_run(self->scroll_area, self->cursor_x, self->cursor_y, tiles, count);
+                self->cursor_x += count;
+                count = 0;
+                if (self->cursor_x == width) {
+                    // Wrapping and scrolling are left to the caller.
+                    break;
+                }
+            }
+        }
+        if (i >= end || *i < 0x20) {
+            break;
+        }
+        c = utf8_get_char(i);
+        i = utf8_next_char(i);
+    }
+    if (count > 0) {
+        displayio_tilegrid_set_tile_run(self->scroll_area, self->cursor_x, self->cursor_y, tiles, count);
+        self->cursor_x += count;
+    }
+    return i;
+}
+
 void terminalio_terminal_clear_status_bar(terminalio_terminal_obj_t *self) {
     if (self->status_bar) {
         terminalio_terminal_set_all_tiles(self, true, ' ', true);
@@ -165,6 +264,7 @@ void common_hal_terminalio_terminal_construct(terminalio_terminal_obj_t *self,
     self->first_row = 0;
     self->vt_scroll_top = 0;
     self->vt_scroll_end = self->scroll_area->height_in_tiles - 1;
+    memset(self->glyph_cache_codepoints, 0, sizeof(self->glyph_cache_codepoints));
     terminalio_terminal_set_all_tiles(self, false, ' ', false);
     if (self->status_bar) {
         terminalio_terminal_set_all_tiles(self, true, ' ', false);
@@ -283,7 +383,6 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                         #endif
                     } else {
                         if (c == 'K') {
-                            int16_t original_cursor_x = self->cursor_x;
                             int16_t original_cursor_y = self->cursor_y;
                             int16_t clr_start = self->cursor_x;
                             int16_t clr_end = self->scroll_area->width_in_tiles;
@@ -294,14 +393,9 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                             } else if (vt_args[0] == 2) {
                                 clr_start = 0;
                             }
-                            self->cursor_x = clr_start;
                             #endif
                             // Clear the (start/rest/all) of the line.
-                            for (uint16_t k = clr_start; k < clr_end; k++) {
-                                terminalio_terminal_set_tile(self, false, ' ', true);
-                            }
-                            self->cursor_x = original_cursor_x;
-                            self->cursor_y = original_cursor_y;
+                            terminalio_terminal_clear_span(self, original_cursor_y, clr_start, clr_end);
                         } else if (c == 'D') {
                             if (vt_args[0] > self->cursor_x) {
                                 self->cursor_x = 0;
@@ -374,12 +468,8 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                                 }
                             }
                             self->cursor_x = 0;
-                            int16_t old_y = self->cursor_y;
                             // Fill the row with spaces.
-                            for (int16_t icol = 0; icol < self->scroll_area->width_in_tiles; icol++) {
-                                terminalio_terminal_set_tile(self, false, ' ', true);
-                            }
-                            self->cursor_y = old_y;
+                            terminalio_terminal_clear_span(self, self->cursor_y, 0, self->scroll_area->width_in_tiles);
                         } else {
                             // Full screen scroll, just set new top_y pointer and clear row
                             if (self->cursor_y > 0) {
@@ -391,10 +481,7 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                             self->cursor_x = 0;
                             self->cursor_y = self->scroll_area->top_left_y;
                             // Fill the row with spaces.
-                            for (int16_t icol = 0; icol < self->scroll_area->width_in_tiles; icol++) {
-                                terminalio_terminal_set_tile(self, false, ' ', true);
-                            }
-                            self->cursor_y = self->scroll_area->top_left_y;
+                            terminalio_terminal_clear_span(self, self->cursor_y, 0, self->scroll_area->width_in_tiles);
                         }
                         self->cursor_x = 0;
                     }
@@ -411,7 +498,7 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                 }
             }
         } else {
-            terminalio_terminal_set_tile(self, false, c, true);
+            i = terminalio_terminal_write_run(self, c, i, data + len);
         }
         if (self->cursor_x >= self->scroll_area->width_in_tiles) {
             self->cursor_y++;
@@ -440,12 +527,7 @@ size_t common_hal_terminalio_terminal_write(terminalio_terminal_obj_t *self, con
                 }
                 // clear the new row in case of scroll up
                 self->cursor_x = 0;
-                int16_t old_y = self->cursor_y;
-                for (int16_t icol = 0; icol < self->scroll_area->width_in_tiles; icol++) {
-                    terminalio_terminal_set_tile(self, false, ' ', true);
-                }
-                self->cursor_x = 0;
-                self->cursor_y = old_y;
+                terminalio_terminal_clear_span(self, self->cursor_y, 0, self->scroll_area->width_in_tiles);
             }
             start_y = self->cursor_y;
         }
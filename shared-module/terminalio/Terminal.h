@@ -13,6 +13,8 @@
 #include "shared-module/fontio/BuiltinFont.h"
 #include "shared-module/displayio/TileGrid.h"
 
+#define TERMINALIO_GLYPH_CACHE_SIZE (16)
+
 typedef struct  {
     mp_obj_base_t base;
     mp_obj_t font;  // Can be fontio_builtinfont_t or lvfontio_ondiskfont_t
@@ -27,6 +29,9 @@ typedef struct  {
     uint16_t vt_scroll_end;
     uint16_t osc_command;
     bool in_osc_command;
+    // Recent codepoint to tile lookups for fonts without glyph slots.
+    mp_uint_t glyph_cache_codepoints[TERMINALIO_GLYPH_CACHE_SIZE];
+    uint16_t glyph_cache_tiles[TERMINALIO_GLYPH_CACHE_SIZE];
 } terminalio_terminal_obj_t;
 
 extern void terminalio_terminal_clear_status_bar(terminalio_terminal_obj_t *self);
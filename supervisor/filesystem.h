@@ -32,9 +32,13 @@ bool filesystem_is_writable_by_python(fs_user_mount_t *vfs);
 // happens, then USB will be readonly.
 bool filesystem_is_writable_by_usb(fs_user_mount_t *vfs);
 
+// CIRCUITPY's mount. With CIRCUITPY_FILESYSTEM_LITTLEFS it only holds the
+// block device and its locks; its FATFS is never mounted.
 fs_user_mount_t *filesystem_circuitpy(void);
 fs_user_mount_t *filesystem_for_path(const char *path_in, const char **path_under_mount);
 bool filesystem_native_fatfs(fs_user_mount_t *fs_mount);
+// Whether fs_mount is CIRCUITPY kept on littlefs.
+bool filesystem_littlefs(fs_user_mount_t *fs_mount);
 
 // We have two levels of locking. filesystem_* calls grab a shared blockdev lock to allow
 // CircuitPython's fatfs code to edit the blocks. blockdev_* calls grab a lock to mutate blocks
@@ -45,3 +49,14 @@ void filesystem_unlock(fs_user_mount_t *fs_mount);
 
 bool blockdev_lock(fs_user_mount_t *fs_mount);
 void blockdev_unlock(fs_user_mount_t *fs_mount);
+
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+#include "lib/littlefs/lfs2.h"
+
+// CIRCUITPY on littlefs, for supervisor code that reads it without the VM.
+// Returns NULL when there is no filesystem.
+lfs2_t *filesystem_circuitpy_lfs(void);
+// Opens a file on CIRCUITPY using a shared static buffer, so only one file
+// opened this way may be open at a time. Returns a negative littlefs error on failure.
+int filesystem_lfs_open(lfs2_file_t *file, const char *path, int flags);
+#endif
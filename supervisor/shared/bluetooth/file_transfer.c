@@ -128,7 +128,7 @@ static uint64_t truncate_time(uint64_t input_time, DWORD *fattime) {
 }
 
 // Used by read and write.
-static FIL active_file;
+static supervisor_workflow_file_t active_file;
 static fs_user_mount_t *active_mount;
 static uint8_t _process_read(const uint8_t *raw_buf, size_t command_len) {
     struct read_command *command = (struct read_command *)raw_buf;
@@ -153,21 +153,22 @@ static uint8_t _process_read(const uint8_t *raw_buf, size_t command_len) {
     full_path[command->path_length] = '\0';
 
     const char *mount_path;
-    active_mount = filesystem_for_path(full_path, &mount_path);
-    if (active_mount == NULL || !filesystem_native_fatfs(active_mount)) {
+    active_mount = supervisor_workflow_mount_for_path(full_path, &mount_path);
+    if (active_mount == NULL) {
         response.status = STATUS_ERROR;
         common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, response_size, NULL, 0);
         return ANY_COMMAND;
     }
 
-    FATFS *fs = &active_mount->fatfs;
-    FRESULT result = f_open(fs, &active_file, mount_path, FA_READ);
+    // An earlier transfer may have stopped part way, leaving its file open.
+    supervisor_workflow_close(&active_file);
+    FRESULT result = supervisor_workflow_open(active_mount, &active_file, mount_path, FA_READ);
     if (result != FR_OK) {
         response.status = STATUS_ERROR;
         common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, response_size, NULL, 0);
         return ANY_COMMAND;
     }
-    uint32_t total_length = f_size(&active_file);
+    uint32_t total_length = supervisor_workflow_size(&active_file);
     // Write out the response header.
     uint32_t offset = command->chunk_offset;
     uint32_t chunk_size = command->chunk_size;
@@ -176,20 +177,20 @@ static uint8_t _process_read(const uint8_t *raw_buf, size_t command_len) {
     response.total_length = total_length;
     response.data_size = chunk_size;
     common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, response_size, NULL, 0);
-    f_lseek(&active_file, offset);
+    supervisor_workflow_lseek(&active_file, offset);
     // Write out the chunk contents. We can do this in small pieces because PacketBuffer
     // will assemble them into larger packets of its own.
     size_t chunk_end = offset + chunk_size;
     while (offset < chunk_end) {
-        size_t quantity_read;
+        UINT quantity_read;
         size_t read_amount = MIN(response_size, chunk_end - offset);
-        f_read(&active_file, data_buffer, read_amount, &quantity_read);
+        supervisor_workflow_read(&active_file, data_buffer, read_amount, &quantity_read);
         offset += quantity_read;
         // TODO: Do something if the read fails
         common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, data_buffer, quantity_read, NULL, 0);
     }
     if (offset >= total_length) {
-        f_close(&active_file);
+        supervisor_workflow_close(&active_file);
         return ANY_COMMAND;
     }
     return READ_PACING;
@@ -202,22 +203,22 @@ static uint8_t _process_read_pacing(const uint8_t *raw_buf, size_t command_len)
     response.status = STATUS_OK;
     size_t response_size = sizeof(struct read_data);
 
-    uint32_t total_length = f_size(&active_file);
+    uint32_t total_length = supervisor_workflow_size(&active_file);
     // Write out the response header.
     uint32_t chunk_size = MIN(command->chunk_size, total_length - command->chunk_offset);
     response.chunk_offset = command->chunk_offset;
     response.total_length = total_length;
     response.data_size = chunk_size;
     common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, response_size, NULL, 0);
-    f_lseek(&active_file, command->chunk_offset);
+    supervisor_workflow_lseek(&active_file, command->chunk_offset);
     // Write out the chunk contents. We can do this in small pieces because PacketBuffer
     // will assemble them into larger packets of its own.
     size_t chunk_offset = 0;
     uint8_t data[20];
     while (chunk_offset < chunk_size) {
-        size_t quantity_read;
+        UINT quantity_read;
         size_t read_size = MIN(chunk_size - chunk_offset, sizeof(data));
-        FRESULT result = f_read(&active_file, &data, read_size, &quantity_read);
+        FRESULT result = supervisor_workflow_read(&active_file, &data, read_size, &quantity_read);
         if (quantity_read == 0 || result != FR_OK) {
             // TODO: If we can't read everything, then the file must have been shortened. Maybe we
             // should return 0s to pad it out.
@@ -227,7 +228,7 @@ static uint8_t _process_read_pacing(const uint8_t *raw_buf, size_t command_len)
         chunk_offset += quantity_read;
     }
     if ((chunk_offset + chunk_size) >= total_length) {
-        f_close(&active_file);
+        supervisor_workflow_close(&active_file);
         return ANY_COMMAND;
     }
     return READ_PACING;
@@ -259,8 +260,8 @@ static uint8_t _process_write(const uint8_t *raw_buf, size_t command_len) {
     full_path[command->path_length] = '\0';
 
     const char *mount_path;
-    active_mount = filesystem_for_path(full_path, &mount_path);
-    if (active_mount == NULL || !filesystem_native_fatfs(active_mount)) {
+    active_mount = supervisor_workflow_mount_for_path(full_path, &mount_path);
+    if (active_mount == NULL) {
         response.status = STATUS_ERROR;
         common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, sizeof(struct write_pacing), NULL, 0);
         return ANY_COMMAND;
@@ -271,11 +272,11 @@ static uint8_t _process_write(const uint8_t *raw_buf, size_t command_len) {
         return ANY_COMMAND;
     }
 
-    FATFS *fs = &active_mount->fatfs;
     DWORD fattime;
     _truncated_time = truncate_time(command->modification_time, &fattime);
     override_fattime(fattime);
-    FRESULT result = f_open(fs, &active_file, mount_path, FA_WRITE | FA_OPEN_ALWAYS);
+    supervisor_workflow_close(&active_file);
+    FRESULT result = supervisor_workflow_open(active_mount, &active_file, mount_path, FA_WRITE | FA_OPEN_ALWAYS);
     if (result != FR_OK) {
         response.status = STATUS_ERROR;
         common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, sizeof(struct write_pacing), NULL, 0);
@@ -290,9 +291,9 @@ static uint8_t _process_write(const uint8_t *raw_buf, size_t command_len) {
     size_t chunk_size = MIN(total_write_length - offset, 512 - (offset % 512));
     // Special case when truncating the file. (Deleting stuff off the end.)
     if (chunk_size == 0) {
-        f_lseek(&active_file, offset);
-        f_truncate(&active_file);
-        f_close(&active_file);
+        supervisor_workflow_lseek(&active_file, offset);
+        supervisor_workflow_truncate(&active_file);
+        supervisor_workflow_close(&active_file);
         override_fattime(0);
         filesystem_unlock(active_mount);
     }
@@ -328,9 +329,9 @@ static uint8_t _process_write_data(const uint8_t *raw_buf, size_t command_len) {
         return THIS_COMMAND;
     }
     uint32_t offset = command->offset;
-    f_lseek(&active_file, offset);
+    supervisor_workflow_lseek(&active_file, offset);
     UINT actual;
-    f_write(&active_file, command->data, command->data_size, &actual);
+    supervisor_workflow_write(&active_file, command->data, command->data_size, &actual);
     if (actual < command->data_size) { // -1 for the null we'll write
         // TODO: throw away any more packets of path.
         response.status = STATUS_ERROR;
@@ -347,8 +348,8 @@ static uint8_t _process_write_data(const uint8_t *raw_buf, size_t command_len) {
     response.truncated_time = _truncated_time;
     common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, (const uint8_t *)&response, sizeof(struct write_pacing), NULL, 0);
     if (total_write_length == offset) {
-        f_truncate(&active_file);
-        f_close(&active_file);
+        supervisor_workflow_truncate(&active_file);
+        supervisor_workflow_close(&active_file);
         override_fattime(0);
         filesystem_unlock(active_mount);
         // Don't reload until everything is written out of the packet buffer.
@@ -476,17 +477,15 @@ static uint8_t _process_listdir(uint8_t *raw_buf, size_t command_len) {
     _terminate_path(full_path, command->path_length);
 
     const char *mount_path;
-    active_mount = filesystem_for_path(full_path, &mount_path);
-    if (active_mount == NULL || !filesystem_native_fatfs(active_mount)) {
+    active_mount = supervisor_workflow_mount_for_path(full_path, &mount_path);
+    if (active_mount == NULL) {
         entry->command = LISTDIR_ENTRY;
         entry->status = STATUS_ERROR_NO_FILE;
         send_listdir_entry_header(entry, max_packet_size);
         return ANY_COMMAND;
     }
-    FATFS *fs = &active_mount->fatfs;
-
-    FF_DIR dir;
-    FRESULT res = f_opendir(fs, &dir, mount_path);
+    supervisor_workflow_dir_t dir;
+    FRESULT res = supervisor_workflow_opendir(active_mount, &dir, mount_path);
 
     entry->command = LISTDIR_ENTRY;
     entry->status = STATUS_OK;
@@ -500,46 +499,39 @@ static uint8_t _process_listdir(uint8_t *raw_buf, size_t command_len) {
         send_listdir_entry_header(entry, max_packet_size);
         return ANY_COMMAND;
     }
-    FILINFO file_info;
-    res = f_readdir(&dir, &file_info);
-    char *fn = file_info.fname;
+    supervisor_workflow_entry_t file_info;
+    res = supervisor_workflow_readdir(&dir, &file_info);
+    char *fn = file_info.name;
     size_t total_entries = 0;
     while (res == FR_OK && fn[0] != 0) {
-        res = f_readdir(&dir, &file_info);
+        res = supervisor_workflow_readdir(&dir, &file_info);
         total_entries += 1;
     }
     // Rewind the directory.
-    f_readdir(&dir, NULL);
+    supervisor_workflow_rewinddir(&dir);
     entry->entry_count = total_entries;
     for (size_t i = 0; i < total_entries; i++) {
-        res = f_readdir(&dir, &file_info);
+        res = supervisor_workflow_readdir(&dir, &file_info);
         entry->entry_number = i;
-        uint64_t truncated_time = timeutils_mktime(1980 + (file_info.fdate >> 9),
-            (file_info.fdate >> 5) & 0xf,
-            file_info.fdate & 0x1f,
-            file_info.ftime >> 11,
-            (file_info.ftime >> 5) & 0x1f,
-            (file_info.ftime & 0x1f) * 2) * 1000000000ULL;
-        entry->truncated_time = truncated_time;
-        if ((file_info.fattrib & AM_DIR) != 0) {
+        entry->truncated_time = file_info.mtime * 1000000000ULL;
+        if (file_info.directory) {
             entry->flags = 1; // Directory
-            entry->file_size = 0;
         } else {
             entry->flags = 0;
-            entry->file_size = file_info.fsize;
         }
+        entry->file_size = file_info.size;
 
-        size_t name_length = strlen(file_info.fname);
+        size_t name_length = strlen(file_info.name);
         entry->path_length = name_length;
         send_listdir_entry_header(entry, max_packet_size);
         size_t fn_offset = 0;
         while (fn_offset < name_length) {
             size_t fn_size = MIN(name_length - fn_offset, 4);
-            common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, ((uint8_t *)file_info.fname) + fn_offset, fn_size, NULL, 0);
+            common_hal_bleio_packet_buffer_write(&_transfer_packet_buffer, ((uint8_t *)file_info.name) + fn_offset, fn_size, NULL, 0);
             fn_offset += fn_size;
         }
     }
-    f_closedir(&dir);
+    supervisor_workflow_closedir(&dir);
     entry->path_length = 0;
     entry->entry_number = entry->entry_count;
     entry->flags = 0;
@@ -674,6 +666,6 @@ void supervisor_bluetooth_file_transfer_background(void) {
 void supervisor_bluetooth_file_transfer_disconnected(void) {
     next_command = ANY_COMMAND;
     current_offset = 0;
-    f_close(&active_file);
+    supervisor_workflow_close(&active_file);
     autoreload_resume(AUTORELOAD_SUSPEND_BLE);
 }
@@ -57,7 +57,7 @@ static bool check_for_custom_font(const char **font_path_out) {
     }
 
     fs_user_mount_t *vfs = filesystem_circuitpy();
-    if (vfs == NULL) {
+    if (vfs == NULL || !filesystem_native_fatfs(vfs)) {
         return false;
     }
 
@@ -12,6 +12,7 @@
 #include "supervisor/port.h"
 #include "supervisor/spi_flash_api.h"
 #include "supervisor/shared/external_flash/common_commands.h"
+#include "supervisor/shared/external_flash/ftl.h"
 #include "extmod/vfs.h"
 #include "extmod/vfs_fat.h"
 #include "py/misc.h"
@@ -22,7 +23,8 @@
 
 #define NO_SECTOR_LOADED 0xFFFFFFFF
 
-// The currently cached sector in the cache, ram or flash based.
+// The sector cached in the scratch sector at the end of flash. Only used when
+// there isn't enough ram for even one sector.
 static uint32_t current_sector;
 
 static const external_flash_device possible_devices[] = {EXTERNAL_FLASH_DEVICES};
@@ -30,8 +32,8 @@ static const external_flash_device possible_devices[] = {EXTERNAL_FLASH_DEVICES}
 
 static const external_flash_device *flash_device = NULL;
 
-// Track which blocks (up to 32) in the current sector currently live in the
-// cache.
+// Track which blocks (up to 32) in current_sector currently live in the
+// scratch sector.
 static uint32_t dirty_mask;
 
 // Table of pointers to each cached block. Should be zero'd after allocation.
@@ -39,7 +41,20 @@ static uint32_t dirty_mask;
 #define PAGES_PER_BLOCK (FILESYSTEM_BLOCK_SIZE / SPI_FLASH_PAGE_SIZE)
 #define FLASH_CACHE_TABLE_NUM_ENTRIES (BLOCKS_PER_SECTOR * PAGES_PER_BLOCK)
 #define FLASH_CACHE_TABLE_SIZE (FLASH_CACHE_TABLE_NUM_ENTRIES * sizeof (uint8_t *))
-static uint8_t **flash_cache_table = NULL;
+
+// A sector cached in ram. Writes to any of the cached sectors only touch ram,
+// so the FAT, directory and data sectors of a file being written can all stay
+// cached until the next flush, instead of each write erasing a sector.
+typedef struct {
+    uint32_t sector; // NO_SECTOR_LOADED if the entry is unused.
+    uint32_t loaded_mask; // Blocks whose contents are in table.
+    uint32_t dirty_mask; // Blocks in table that haven't been written to flash.
+    uint32_t last_used; // For least recently used eviction.
+    uint8_t **table; // Pointers to each cached page, or NULL if not allocated.
+} flash_cache_entry_t;
+
+static flash_cache_entry_t flash_cache[CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS];
+static uint32_t flash_cache_clock;
 
 // Wait until both the write enable and write in progress bits have cleared.
 static bool wait_for_flash_ready(void) {
@@ -135,7 +150,7 @@ static bool page_erased(uint32_t sector_address) {
     uint8_t full_buffer[FILESYSTEM_BLOCK_SIZE];
     if (read_flash(sector_address, full_buffer, FILESYSTEM_BLOCK_SIZE)) {
         for (uint16_t i = 0; i < FILESYSTEM_BLOCK_SIZE; i++) {
-            if (short_buffer[i] != 0xff) {
+            if (full_buffer[i] != 0xff) {
                 return false;
             }
         }
@@ -180,6 +195,54 @@ static bool copy_block(uint32_t src_address, uint32_t dest_address) {
     return true;
 }
 
+#if CIRCUITPY_EXTERNAL_FLASH_FTL
+// The flash translation layer in ftl.c reaches the flash through these.
+bool ftl_flash_read(uint32_t address, uint8_t *data, uint32_t length) {
+    return read_flash(address, data, length);
+}
+
+bool ftl_flash_program(uint32_t address, const uint8_t *data, uint32_t length) {
+    return wait_for_flash_ready() && write_enable() &&
+           spi_flash_write_data(address, (uint8_t *)data, length);
+}
+
+bool ftl_flash_erase(uint32_t address) {
+    return erase_sector(address);
+}
+
+static bool ftl_active;
+// The translation layer's tables, kept from one init to the next.
+static void *ftl_ram;
+
+static void external_flash_ftl_init(void) {
+    MP_STATIC_ASSERT(FTL_BLOCK_SIZE == FILESYSTEM_BLOCK_SIZE);
+    MP_STATIC_ASSERT(FTL_ERASE_SIZE == SPI_FLASH_ERASE_SIZE);
+    MP_STATIC_ASSERT(FTL_PAGE_SIZE == SPI_FLASH_PAGE_SIZE);
+    ftl_active = false;
+    if (flash_device->no_erase_cmd) {
+        return;
+    }
+    size_t ram_size = ftl_ram_size(flash_device->total_size);
+    if (ram_size == 0) {
+        return;
+    }
+    if (ftl_ram == NULL) {
+        ftl_ram = port_malloc(ram_size, false);
+    }
+    // Without its tables the log can't be read. Use the flash directly instead,
+    // where a filesystem written through the log won't be found.
+    if (ftl_ram == NULL) {
+        return;
+    }
+    ftl_init(flash_device->total_size, ftl_ram);
+    ftl_active = true;
+}
+
+bool supervisor_external_flash_ftl_active(void) {
+    return ftl_active;
+}
+#endif
+
 #define READ_JEDEC_ID_RETRY_COUNT (100)
 
 // If this fails, flash_device will remain NULL.
@@ -283,7 +346,16 @@ void supervisor_flash_init(void) {
 
     current_sector = NO_SECTOR_LOADED;
     dirty_mask = 0;
-    flash_cache_table = NULL;
+    for (size_t i = 0; i < CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS; i++) {
+        flash_cache[i].sector = NO_SECTOR_LOADED;
+        flash_cache[i].loaded_mask = 0;
+        flash_cache[i].dirty_mask = 0;
+        flash_cache[i].table = NULL;
+    }
+
+    #if CIRCUITPY_EXTERNAL_FLASH_FTL
+    external_flash_ftl_init();
+    #endif
 }
 
 // The size of each individual block.
@@ -296,6 +368,11 @@ uint32_t supervisor_flash_get_block_count(void) {
     if (flash_device == NULL) {
         return 0;
     }
+    #if CIRCUITPY_EXTERNAL_FLASH_FTL
+    if (ftl_active) {
+        return ftl_get_block_count();
+    }
+    #endif
     // We subtract one erase sector size because we may use it as a staging area
     // for writes.
     return (flash_device->total_size - SPI_FLASH_ERASE_SIZE) / FILESYSTEM_BLOCK_SIZE;
@@ -333,123 +410,101 @@ static bool flush_scratch_flash(void) {
     return true;
 }
 
-// Free all entries in the partially or completely filled flash_cache_table, and then free the table itself.
-static void release_ram_cache(void) {
-    if (flash_cache_table == NULL) {
-        return;
-    }
-
+// Free all entries in the partially or completely filled table, and then free the table itself.
+static void release_ram_cache(uint8_t **table) {
     for (size_t i = 0; i < FLASH_CACHE_TABLE_NUM_ENTRIES; i++) {
         // Table may not be completely full. Stop at first NULL entry.
-        if (flash_cache_table[i] == NULL) {
+        if (table[i] == NULL) {
             break;
         }
-        port_free(flash_cache_table[i]);
+        port_free(table[i]);
     }
-    port_free(flash_cache_table);
-    flash_cache_table = NULL;
+    port_free(table);
 }
 
 // Attempts to allocate a new set of page buffers for caching a full sector in
 // ram. Each page is allocated separately so that the GC doesn't need to provide
 // one huge block. We can free it as we write if we want to also.
-static bool allocate_ram_cache(void) {
-    flash_cache_table = port_malloc(FLASH_CACHE_TABLE_SIZE, false);
-    if (flash_cache_table == NULL) {
+static uint8_t **allocate_ram_cache(void) {
+    uint8_t **table = port_malloc(FLASH_CACHE_TABLE_SIZE, false);
+    if (table == NULL) {
         // Not enough space even for the cache table.
-        return false;
+        return NULL;
     }
 
     // Clear all the entries so it's easy to find the last entry.
-    memset(flash_cache_table, 0, FLASH_CACHE_TABLE_SIZE);
-
-    bool success = true;
-    for (size_t i = 0; i < BLOCKS_PER_SECTOR && success; i++) {
-        for (size_t j = 0; j < PAGES_PER_BLOCK && success; j++) {
-            uint8_t *page_cache = port_malloc(SPI_FLASH_PAGE_SIZE, false);
-            if (page_cache == NULL) {
-                success = false;
-                break;
-            }
-            flash_cache_table[i * PAGES_PER_BLOCK + j] = page_cache;
-        }
-    }
+    memset(table, 0, FLASH_CACHE_TABLE_SIZE);
 
-    // We couldn't allocate enough so give back what we got.
-    if (!success) {
-        release_ram_cache();
+    for (size_t i = 0; i < FLASH_CACHE_TABLE_NUM_ENTRIES; i++) {
+        uint8_t *page_cache = port_malloc(SPI_FLASH_PAGE_SIZE, false);
+        if (page_cache == NULL) {
+            // We couldn't allocate enough so give back what we got.
+            release_ram_cache(table);
+            return NULL;
+        }
+        table[i] = page_cache;
     }
-    return success;
+    return table;
 }
 
-// Flush the cached sector from ram onto the flash. We'll free the cache unless
-// keep_cache is true.
-static bool flush_ram_cache(bool keep_cache) {
-    if (flash_cache_table == NULL) {
-        // Nothing to flush because there is no cache.
+// Write a sector cached in ram back onto the flash. Afterwards the whole
+// sector is loaded and clean, so it can stay cached.
+static bool flush_ram_cache(flash_cache_entry_t *entry) {
+    if (entry->sector == NO_SECTOR_LOADED || entry->dirty_mask == 0) {
         return true;
     }
-
-    if (current_sector == NO_SECTOR_LOADED) {
-        if (!keep_cache) {
-            release_ram_cache();
-        }
-        return true;
-    }
-    // First, copy out any blocks that we haven't touched from the sector
-    // we've cached. If we don't do this we'll erase the data during the sector
-    // erase below.
-    bool copy_to_ram_ok = true;
+    // First, copy out any blocks that we haven't loaded from the sector. If we
+    // don't do this we'll erase the data during the sector erase below.
     for (size_t i = 0; i < BLOCKS_PER_SECTOR; i++) {
-        if ((dirty_mask & (1 << i)) == 0) {
-            for (size_t j = 0; j < PAGES_PER_BLOCK; j++) {
-                copy_to_ram_ok = read_flash(
-                    current_sector + (i * PAGES_PER_BLOCK + j) * SPI_FLASH_PAGE_SIZE,
-                    flash_cache_table[i * PAGES_PER_BLOCK + j],
-                    SPI_FLASH_PAGE_SIZE);
-                if (!copy_to_ram_ok) {
-                    break;
-                }
-            }
+        if ((entry->loaded_mask & (1 << i)) != 0) {
+            continue;
         }
-        if (!copy_to_ram_ok) {
-            break;
+        for (size_t j = 0; j < PAGES_PER_BLOCK; j++) {
+            if (!read_flash(entry->sector + (i * PAGES_PER_BLOCK + j) * SPI_FLASH_PAGE_SIZE,
+                entry->table[i * PAGES_PER_BLOCK + j],
+                SPI_FLASH_PAGE_SIZE)) {
+                return false;
+            }
         }
+        entry->loaded_mask |= 1 << i;
     }
 
-    if (!copy_to_ram_ok) {
-        return false;
-    }
-    // Second, erase the current sector.
-    erase_sector(current_sector);
+    // Second, erase the sector.
+    erase_sector(entry->sector);
     // Lastly, write all the data in ram that we've cached.
-    for (size_t i = 0; i < BLOCKS_PER_SECTOR; i++) {
-        for (size_t j = 0; j < PAGES_PER_BLOCK; j++) {
-            write_flash(current_sector + (i * PAGES_PER_BLOCK + j) * SPI_FLASH_PAGE_SIZE,
-                flash_cache_table[i * PAGES_PER_BLOCK + j],
-                SPI_FLASH_PAGE_SIZE);
-        }
-    }
-    // We're done with the cache for now so give it back.
-    if (!keep_cache) {
-        release_ram_cache();
+    for (size_t i = 0; i < FLASH_CACHE_TABLE_NUM_ENTRIES; i++) {
+        write_flash(entry->sector + i * SPI_FLASH_PAGE_SIZE, entry->table[i], SPI_FLASH_PAGE_SIZE);
     }
+    entry->dirty_mask = 0;
     return true;
 }
 
 // Delegates to the correct flash flush method depending on the existing cache.
 // TODO Don't blink the status indicator if we don't actually do any writing (hard to tell right now).
 static void spi_flash_flush_keep_cache(bool keep_cache) {
+    #if CIRCUITPY_EXTERNAL_FLASH_FTL
+    if (ftl_active) {
+        // Nothing is cached, so use the time to get ahead on erasing.
+        ftl_background();
+        return;
+    }
+    #endif
     #ifdef MICROPY_HW_LED_MSC
     port_pin_set_output_level(MICROPY_HW_LED_MSC, true);
     #endif
     // If we've cached to the flash itself flush from there.
-    if (flash_cache_table == NULL) {
-        flush_scratch_flash();
-    } else {
-        flush_ram_cache(keep_cache);
-    }
+    flush_scratch_flash();
     current_sector = NO_SECTOR_LOADED;
+    for (size_t i = 0; i < CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS; i++) {
+        flash_cache_entry_t *entry = &flash_cache[i];
+        flush_ram_cache(entry);
+        if (!keep_cache && entry->table != NULL) {
+            // We're done with the cache for now so give it back.
+            release_ram_cache(entry->table);
+            entry->table = NULL;
+            entry->sector = NO_SECTOR_LOADED;
+        }
+    }
     #ifdef MICROPY_HW_LED_MSC
     port_pin_set_output_level(MICROPY_HW_LED_MSC, false);
     #endif
@@ -472,6 +527,70 @@ static int32_t convert_block_to_flash_addr(uint32_t block) {
     return -1;
 }
 
+// Return the ram cache entry holding the given sector, or NULL, without
+// counting it as used.
+static flash_cache_entry_t *peek_ram_cache(uint32_t sector) {
+    for (size_t i = 0; i < CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS; i++) {
+        if (flash_cache[i].sector == sector) {
+            return &flash_cache[i];
+        }
+    }
+    return NULL;
+}
+
+// Return the ram cache entry holding the given sector, or NULL.
+static flash_cache_entry_t *find_ram_cache(uint32_t sector) {
+    flash_cache_entry_t *entry = peek_ram_cache(sector);
+    if (entry != NULL) {
+        entry->last_used = ++flash_cache_clock;
+    }
+    return entry;
+}
+
+// Find a ram cache entry for the given sector, which isn't cached yet. Unused
+// entries are allocated up to CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS, and
+// after that (or when allocation fails) the least recently used sector is
+// flushed and its entry reused. Returns NULL if there's no ram for any entry.
+static flash_cache_entry_t *claim_ram_cache(uint32_t sector) {
+    flash_cache_entry_t *entry = NULL;
+    flash_cache_entry_t *lru = NULL;
+    for (size_t i = 0; i < CIRCUITPY_EXTERNAL_FLASH_CACHE_SECTORS; i++) {
+        flash_cache_entry_t *e = &flash_cache[i];
+        if (e->table == NULL) {
+            if (entry == NULL) {
+                entry = e;
+            }
+        } else if (e->sector == NO_SECTOR_LOADED) {
+            entry = e;
+            break;
+        } else if (lru == NULL || (int32_t)(e->last_used - lru->last_used) < 0) {
+            lru = e;
+        }
+    }
+    if (entry != NULL && entry->table == NULL) {
+        entry->table = allocate_ram_cache();
+        if (entry->table == NULL) {
+            entry = NULL;
+        }
+    }
+    if (entry == NULL) {
+        if (lru == NULL || !flush_ram_cache(lru)) {
+            return NULL;
+        }
+        entry = lru;
+    }
+    // Switching from the scratch sector to ram, so flush what's there.
+    if (current_sector != NO_SECTOR_LOADED) {
+        flush_scratch_flash();
+        current_sector = NO_SECTOR_LOADED;
+    }
+    entry->sector = sector;
+    entry->loaded_mask = 0;
+    entry->dirty_mask = 0;
+    entry->last_used = ++flash_cache_clock;
+    return entry;
+}
+
 static bool external_flash_read_block(uint8_t *dest, uint32_t block) {
     int32_t address = convert_block_to_flash_addr(block);
     if (address == -1) {
@@ -483,19 +602,20 @@ static bool external_flash_read_block(uint8_t *dest, uint32_t block) {
     uint32_t this_sector = address & (~(SPI_FLASH_ERASE_SIZE - 1));
     size_t block_index = (address / FILESYSTEM_BLOCK_SIZE) % BLOCKS_PER_SECTOR;
     uint32_t mask = 1 << (block_index);
-    // We're reading from the currently cached sector.
-    if (current_sector == this_sector && (mask & dirty_mask) > 0) {
-        if (flash_cache_table != NULL) {
-            for (int i = 0; i < PAGES_PER_BLOCK; i++) {
-                memcpy(dest + i * SPI_FLASH_PAGE_SIZE,
-                    flash_cache_table[block_index * PAGES_PER_BLOCK + i],
-                    SPI_FLASH_PAGE_SIZE);
-            }
-            return true;
-        } else {
-            uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE + block_index * FILESYSTEM_BLOCK_SIZE;
-            return read_flash(scratch_address, dest, FILESYSTEM_BLOCK_SIZE);
+    // We're reading from a sector cached in ram.
+    flash_cache_entry_t *entry = find_ram_cache(this_sector);
+    if (entry != NULL && (mask & entry->loaded_mask) > 0) {
+        for (int i = 0; i < PAGES_PER_BLOCK; i++) {
+            memcpy(dest + i * SPI_FLASH_PAGE_SIZE,
+                entry->table[block_index * PAGES_PER_BLOCK + i],
+                SPI_FLASH_PAGE_SIZE);
         }
+        return true;
+    }
+    // We're reading from the sector cached in the scratch sector.
+    if (current_sector == this_sector && (mask & dirty_mask) > 0) {
+        uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE + block_index * FILESYSTEM_BLOCK_SIZE;
+        return read_flash(scratch_address, dest, FILESYSTEM_BLOCK_SIZE);
     }
     return read_flash(address, dest, FILESYSTEM_BLOCK_SIZE);
 }
@@ -513,49 +633,107 @@ static bool external_flash_write_block(const uint8_t *data, uint32_t block) {
     uint32_t this_sector = address & (~(SPI_FLASH_ERASE_SIZE - 1));
     size_t block_index = (address / FILESYSTEM_BLOCK_SIZE) % BLOCKS_PER_SECTOR;
     uint32_t mask = 1 << (block_index);
-    // Flush the cache if we're moving onto a sector or we're writing the
-    // same block again.
-    if (current_sector != this_sector || (mask & dirty_mask) > 0) {
+    flash_cache_entry_t *entry = find_ram_cache(this_sector);
+    // Start caching a new sector if we're moving onto one, or if we're writing
+    // the same block of the scratch sector again.
+    if (entry == NULL && (current_sector != this_sector || (mask & dirty_mask) > 0)) {
         // Check to see if we'd write to an erased page. In that case we
-        // can write directly.
-        if (page_erased(address)) {
+        // can write directly, unless an older copy is in the scratch sector.
+        if (current_sector != this_sector && page_erased(address)) {
             return write_flash(address, data, FILESYSTEM_BLOCK_SIZE);
         }
-        if (current_sector != NO_SECTOR_LOADED) {
-            supervisor_flash_flush();
-        }
-        if (flash_cache_table == NULL && !allocate_ram_cache()) {
+        entry = claim_ram_cache(this_sector);
+        if (entry == NULL) {
+            // No ram, so cache the sector in the scratch sector instead.
+            if (current_sector != NO_SECTOR_LOADED) {
+                supervisor_flash_flush();
+            }
             erase_sector(flash_device->total_size - SPI_FLASH_ERASE_SIZE);
             wait_for_flash_ready();
+            current_sector = this_sector;
+            dirty_mask = 0;
         }
-        current_sector = this_sector;
-        dirty_mask = 0;
     }
-    dirty_mask |= mask;
     // Copy the block to the appropriate cache.
-    if (flash_cache_table != NULL) {
+    if (entry != NULL) {
         for (int i = 0; i < PAGES_PER_BLOCK; i++) {
-            memcpy(flash_cache_table[block_index * PAGES_PER_BLOCK + i],
+            memcpy(entry->table[block_index * PAGES_PER_BLOCK + i],
                 data + i * SPI_FLASH_PAGE_SIZE,
                 SPI_FLASH_PAGE_SIZE);
         }
+        entry->loaded_mask |= mask;
+        entry->dirty_mask |= mask;
         return true;
     } else {
+        dirty_mask |= mask;
         uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE + block_index * FILESYSTEM_BLOCK_SIZE;
         return write_flash(scratch_address, data, FILESYSTEM_BLOCK_SIZE);
     }
 }
 
+// Count the blocks, starting at block, that can be read straight from their
+// own place in flash because no newer copy is held in ram or the scratch sector.
+static uint32_t external_flash_uncached_run(uint32_t block, uint32_t num_blocks) {
+    uint32_t run = 0;
+    while (run < num_blocks) {
+        int32_t address = convert_block_to_flash_addr(block + run);
+        if (address == -1) {
+            break;
+        }
+        uint32_t this_sector = address & (~(SPI_FLASH_ERASE_SIZE - 1));
+        uint32_t mask = 1 << ((address / FILESYSTEM_BLOCK_SIZE) % BLOCKS_PER_SECTOR);
+        // Only looking, so leave the eviction order alone.
+        flash_cache_entry_t *entry = peek_ram_cache(this_sector);
+        if (entry != NULL && (mask & entry->loaded_mask) > 0) {
+            break;
+        }
+        if (current_sector == this_sector && (mask & dirty_mask) > 0) {
+            break;
+        }
+        run++;
+    }
+    return run;
+}
+
+// Consecutive blocks are read with one flash command where possible, so that
+// large sequential reads, such as a host copying files off over USB, don't pay
+// the command overhead for every block.
 mp_uint_t supervisor_flash_read_blocks(uint8_t *dest, uint32_t block_num, uint32_t num_blocks) {
-    for (size_t i = 0; i < num_blocks; i++) {
-        if (!external_flash_read_block(dest + i * FILESYSTEM_BLOCK_SIZE, block_num + i)) {
-            return 1; // error
+    #if CIRCUITPY_EXTERNAL_FLASH_FTL
+    if (ftl_active) {
+        return ftl_read_blocks(dest, block_num, num_blocks) ? 0 : 1;
+    }
+    #endif
+    while (num_blocks > 0) {
+        uint32_t run = external_flash_uncached_run(block_num, num_blocks);
+        if (run > 0) {
+            if (!read_flash(convert_block_to_flash_addr(block_num), dest, run * FILESYSTEM_BLOCK_SIZE)) {
+                return 1; // error
+            }
+        } else {
+            if (!external_flash_read_block(dest, block_num)) {
+                return 1; // error
+            }
+            run = 1;
         }
+        dest += run * FILESYSTEM_BLOCK_SIZE;
+        block_num += run;
+        num_blocks -= run;
     }
     return 0; // success
 }
 
 mp_uint_t supervisor_flash_write_blocks(const uint8_t *src, uint32_t block_num, uint32_t num_blocks) {
+    #if CIRCUITPY_EXTERNAL_FLASH_FTL
+    if (ftl_active) {
+        for (size_t i = 0; i < num_blocks; i++) {
+            if (!ftl_write_block(src + i * FILESYSTEM_BLOCK_SIZE, block_num + i)) {
+                return 1; // error
+            }
+        }
+        return 0; // success
+    }
+    #endif
     for (size_t i = 0; i < num_blocks; i++) {
         if (!external_flash_write_block(src + i * FILESYSTEM_BLOCK_SIZE, block_num + i)) {
             return 1; // error
@@ -26,6 +26,12 @@
 
 void supervisor_external_flash_flush(void);
 
+#if CIRCUITPY_EXTERNAL_FLASH_FTL
+// Whether writes go through the flash translation layer. It isn't used on
+// flash that is too small for it or can't erase sectors.
+bool supervisor_external_flash_ftl_active(void);
+#endif
+
 // Configure anything that needs to get set up before the external flash
 // is init'ed. For example, if GPIO needs to be configured to enable the
 // flash chip, as is the case on some boards.
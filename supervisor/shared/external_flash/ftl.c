@@ -0,0 +1,492 @@
+// This file is part of the CircuitPython project: https://circuitpython.org
+//
+// SPDX-FileCopyrightText: Copyright (c) 2025 Adafruit Industries LLC
+//
+// SPDX-License-Identifier: MIT
+#include "supervisor/shared/external_flash/ftl.h"
+
+#include <string.h>
+
+#include "py/mpconfig.h"
+#include "py/misc.h"
+
+// Set in circuitpy_mpconfig.h. The unix port's simulated flash uses the default.
+#ifndef CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS
+#define CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS (8)
+#endif
+
+// Flash translation layer. Instead of erasing a filesystem block's sector in
+// place on every write, blocks are appended to a log of pre-erased sectors and
+// a table in ram maps each logical block to its newest copy. Sectors full of
+// stale copies are garbage collected: their live blocks are copied to the head
+// of the log and then they're erased.
+//
+// The first block of each sector holds a header and a tag per data block
+// recording which logical block it contains. A block's data is programmed
+// before its tag and the tag can't be half programmed without failing its
+// check, so an interrupted write leaves the previous copy in place. Sectors
+// are numbered as they're opened, so the newest copy of a block is the one in
+// the highest numbered sector, latest in that sector. A garbage collected
+// sector's live blocks are always copied somewhere newer before it's erased.
+
+#define FTL_MAGIC (0x314c5446) // "FTL1"
+#define FTL_BLOCKS_PER_SECTOR (FTL_ERASE_SIZE / FTL_BLOCK_SIZE)
+#define FTL_SLOTS_PER_SECTOR (FTL_BLOCKS_PER_SECTOR - 1)
+#define FTL_NO_SLOT (0xffff)
+#define FTL_NO_SECTOR (0xffffffff)
+// A new log sector is only opened for a filesystem write while at least this
+// many are free, so garbage collection always has somewhere to copy to.
+#define FTL_MIN_FREE_SECTORS (2)
+// Garbage collection done from ftl_background() tops up the
+// free sectors to this many, and erases at most this many sectors each time.
+#define FTL_BACKGROUND_FREE_SECTORS (4)
+#define FTL_BACKGROUND_ERASES (2)
+// Once a sector has been erased this many times fewer than the most worn one,
+// it's collected even though its data is still live, so that data which never
+// changes doesn't keep its sectors out of use.
+#define FTL_WEAR_LEVEL_SPREAD (64)
+
+typedef struct {
+    uint32_t erase_count;
+    uint32_t erase_check;
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t seq_check;
+    uint32_t tags[FTL_SLOTS_PER_SECTOR];
+} ftl_header_t;
+
+enum {
+    FTL_SECTOR_FREE, // Erased, with its erase count written.
+    FTL_SECTOR_DIRTY, // Free, but may need erasing first.
+    FTL_SECTOR_UNCHECKED, // Has its erase count, but may not be blank after it.
+    FTL_SECTOR_USED,
+};
+
+typedef struct {
+    uint32_t erase_count;
+    uint32_t seq;
+    uint8_t state;
+    uint8_t valid; // Number of blocks holding the newest copy of their data.
+} ftl_sector_t;
+
+// Physical slot (sector * FTL_BLOCKS_PER_SECTOR + index) of each logical block.
+static uint16_t *ftl_map;
+static ftl_sector_t *ftl_sectors;
+static uint32_t ftl_sector_count;
+static uint32_t ftl_block_count;
+static uint32_t ftl_free_count;
+static uint32_t ftl_seq;
+static uint32_t ftl_head;
+static uint32_t ftl_head_next;
+
+static uint32_t ftl_sector_address(uint32_t sector) {
+    return sector * FTL_ERASE_SIZE;
+}
+
+static uint32_t ftl_tag_address(uint32_t slot) {
+    return ftl_sector_address(slot / FTL_BLOCKS_PER_SECTOR) + offsetof(ftl_header_t, tags) +
+           (slot % FTL_BLOCKS_PER_SECTOR - 1) * sizeof(uint32_t);
+}
+
+static uint32_t ftl_make_tag(uint32_t block) {
+    return block | ((~block & 0xffff) << 16);
+}
+
+// Returns the logical block in the tag, or FTL_NO_SLOT if it isn't valid.
+static uint32_t ftl_tag_block(uint32_t tag) {
+    uint32_t block = tag & 0xffff;
+    if (tag != ftl_make_tag(block) || block >= ftl_block_count) {
+        return FTL_NO_SLOT;
+    }
+    return block;
+}
+
+// Program a few bytes, which must already be erased.
+static bool ftl_program(uint32_t address, const void *data, uint32_t length) {
+    return ftl_flash_program(address, data, length);
+}
+
+// Program a block's data a page at a time. All ones is what erasing left, so
+// it's skipped.
+static bool ftl_program_block(uint32_t address, const uint8_t *data) {
+    bool all_ones = true;
+    for (uint32_t i = 0; i < FTL_BLOCK_SIZE; i++) {
+        if (data[i] != 0xff) {
+            all_ones = false;
+            break;
+        }
+    }
+    if (all_ones) {
+        return true;
+    }
+    for (uint32_t offset = 0; offset < FTL_BLOCK_SIZE; offset += FTL_PAGE_SIZE) {
+        if (!ftl_program(address + offset, data + offset, FTL_PAGE_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copy a block page by page, to keep the buffer small.
+static bool ftl_copy_block(uint32_t src_address, uint32_t dest_address) {
+    uint8_t buffer[FTL_PAGE_SIZE];
+    for (uint32_t offset = 0; offset < FTL_BLOCK_SIZE; offset += FTL_PAGE_SIZE) {
+        if (!ftl_flash_read(src_address + offset, buffer, FTL_PAGE_SIZE) ||
+            !ftl_program(dest_address + offset, buffer, FTL_PAGE_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Record the erase count of a newly erased sector, which makes it free. The
+// magic goes last so that it's only there with a complete erase count.
+static bool ftl_write_erase_count(uint32_t sector) {
+    ftl_sector_t *s = &ftl_sectors[sector];
+    uint32_t address = ftl_sector_address(sector);
+    uint32_t count[2] = { s->erase_count, ~s->erase_count };
+    uint32_t magic = FTL_MAGIC;
+    if (!ftl_program(address + offsetof(ftl_header_t, erase_count), count, sizeof(count)) ||
+        !ftl_program(address + offsetof(ftl_header_t, magic), &magic, sizeof(magic))) {
+        return false;
+    }
+    s->state = FTL_SECTOR_FREE;
+    return true;
+}
+
+static bool ftl_erase(uint32_t sector) {
+    ftl_sector_t *s = &ftl_sectors[sector];
+    uint32_t address = ftl_sector_address(sector);
+    if (!ftl_flash_erase(address)) {
+        return false;
+    }
+    s->erase_count++;
+    s->valid = 0;
+    return ftl_write_erase_count(sector);
+}
+
+// Whether flash of unknown state is erased.
+static bool ftl_blank(uint32_t address, uint32_t size) {
+    uint8_t buffer[FTL_PAGE_SIZE];
+    for (uint32_t offset = 0; offset < size; offset += sizeof(buffer)) {
+        uint32_t length = MIN(sizeof(buffer), size - offset);
+        if (!ftl_flash_read(address + offset, buffer, length)) {
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            if (buffer[i] != 0xff) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Make a dirty sector free, without erasing it if it's blank already.
+static bool ftl_clean(uint32_t sector) {
+    ftl_sector_t *s = &ftl_sectors[sector];
+    if (s->state == FTL_SECTOR_UNCHECKED) {
+        s->state = ftl_blank(ftl_sector_address(sector) + offsetof(ftl_header_t, seq), FTL_ERASE_SIZE - offsetof(ftl_header_t, seq)) ? FTL_SECTOR_FREE : FTL_SECTOR_DIRTY;
+    }
+    if (s->state == FTL_SECTOR_DIRTY && ftl_blank(ftl_sector_address(sector), FTL_ERASE_SIZE) && !ftl_write_erase_count(sector)) {
+        return false;
+    }
+    return s->state == FTL_SECTOR_FREE || ftl_erase(sector);
+}
+
+// Start a new log sector, using the least worn free one.
+static bool ftl_open_head(void) {
+    uint32_t best = FTL_NO_SECTOR;
+    for (uint32_t i = 0; i < ftl_sector_count; i++) {
+        ftl_sector_t *s = &ftl_sectors[i];
+        if (s->state != FTL_SECTOR_USED &&
+            (best == FTL_NO_SECTOR || s->erase_count < ftl_sectors[best].erase_count)) {
+            best = i;
+        }
+    }
+    if (best == FTL_NO_SECTOR || !ftl_clean(best)) {
+        return false;
+    }
+    uint32_t seq[2] = { ftl_seq + 1, ~(ftl_seq + 1) };
+    if (!ftl_program(ftl_sector_address(best) + offsetof(ftl_header_t, seq), seq, sizeof(seq))) {
+        return false;
+    }
+    ftl_seq++;
+    ftl_sectors[best].state = FTL_SECTOR_USED;
+    ftl_sectors[best].seq = ftl_seq;
+    ftl_free_count--;
+    ftl_head = best;
+    ftl_head_next = 1;
+    return true;
+}
+
+// Append a copy of a logical block to the log, from ram or, when data is NULL,
+// from the flash at src_address.
+static bool ftl_append(uint32_t block, const uint8_t *data, uint32_t src_address) {
+    if (ftl_head == FTL_NO_SECTOR && !ftl_open_head()) {
+        return false;
+    }
+    uint32_t slot = ftl_head * FTL_BLOCKS_PER_SECTOR + ftl_head_next;
+    uint32_t address = slot * FTL_BLOCK_SIZE;
+    // Whatever happens, this slot has been used up.
+    if (++ftl_head_next == FTL_BLOCKS_PER_SECTOR) {
+        ftl_head = FTL_NO_SECTOR;
+    }
+    bool ok = data != NULL ? ftl_program_block(address, data) : ftl_copy_block(src_address, address);
+    uint32_t tag = ftl_make_tag(block);
+    if (!ok || !ftl_program(ftl_tag_address(slot), &tag, sizeof(tag))) {
+        return false;
+    }
+    uint16_t old = ftl_map[block];
+    if (old != FTL_NO_SLOT) {
+        ftl_sectors[old / FTL_BLOCKS_PER_SECTOR].valid--;
+    }
+    ftl_map[block] = slot;
+    ftl_sectors[slot / FTL_BLOCKS_PER_SECTOR].valid++;
+    return true;
+}
+
+// Copy a sector's live blocks to the head of the log, and erase it.
+static bool ftl_collect_sector(uint32_t victim) {
+    uint32_t tags[FTL_SLOTS_PER_SECTOR];
+    if (!ftl_flash_read(ftl_sector_address(victim) + offsetof(ftl_header_t, tags), (uint8_t *)tags, sizeof(tags))) {
+        return false;
+    }
+    for (uint32_t i = 1; i < FTL_BLOCKS_PER_SECTOR && ftl_sectors[victim].valid > 0; i++) {
+        uint32_t slot = victim * FTL_BLOCKS_PER_SECTOR + i;
+        uint32_t block = ftl_tag_block(tags[i - 1]);
+        if (block != FTL_NO_SLOT && ftl_map[block] == slot &&
+            !ftl_append(block, NULL, slot * FTL_BLOCK_SIZE)) {
+            return false;
+        }
+    }
+    if (!ftl_erase(victim)) {
+        return false;
+    }
+    ftl_free_count++;
+    return true;
+}
+
+// Collect the sector with the least live data, preferring less worn ones.
+static bool ftl_collect(void) {
+    // After a reset part way through a collection there may be no free sectors
+    // left, only room in the head.
+    uint32_t room = ftl_free_count * FTL_SLOTS_PER_SECTOR;
+    if (ftl_head != FTL_NO_SECTOR) {
+        room += FTL_BLOCKS_PER_SECTOR - ftl_head_next;
+    }
+    uint32_t victim = FTL_NO_SECTOR;
+    for (uint32_t i = 0; i < ftl_sector_count; i++) {
+        ftl_sector_t *s = &ftl_sectors[i];
+        if (s->state != FTL_SECTOR_USED || i == ftl_head) {
+            continue;
+        }
+        if (victim == FTL_NO_SECTOR || s->valid < ftl_sectors[victim].valid ||
+            (s->valid == ftl_sectors[victim].valid && s->erase_count < ftl_sectors[victim].erase_count)) {
+            victim = i;
+        }
+    }
+    if (victim == FTL_NO_SECTOR || ftl_sectors[victim].valid == FTL_SLOTS_PER_SECTOR ||
+        ftl_sectors[victim].valid > room) {
+        // Nothing to gain, or nowhere to put it.
+        return false;
+    }
+    return ftl_collect_sector(victim);
+}
+
+// Data that never changes keeps its sectors out of the rotation. Once one of
+// them is far less worn than the most worn sector, move its data so that the
+// sector gets reused.
+static void ftl_level_wear(void) {
+    uint32_t coldest = FTL_NO_SECTOR;
+    uint32_t most_worn = 0;
+    for (uint32_t i = 0; i < ftl_sector_count; i++) {
+        ftl_sector_t *s = &ftl_sectors[i];
+        most_worn = MAX(most_worn, s->erase_count);
+        if (s->state == FTL_SECTOR_USED && i != ftl_head &&
+            (coldest == FTL_NO_SECTOR || s->erase_count < ftl_sectors[coldest].erase_count)) {
+            coldest = i;
+        }
+    }
+    // Moving a full sector may need a new head.
+    if (coldest != FTL_NO_SECTOR && ftl_sectors[coldest].erase_count + FTL_WEAR_LEVEL_SPREAD < most_worn &&
+        ftl_free_count >= FTL_MIN_FREE_SECTORS) {
+        ftl_collect_sector(coldest);
+    }
+}
+
+// Collect sectors until at least free_sectors are free, doing at most
+// max_collections.
+static bool ftl_reserve(uint32_t free_sectors, uint32_t max_collections) {
+    while (ftl_free_count < free_sectors) {
+        if (max_collections-- == 0 || !ftl_collect()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Carry on appending to the newest sector, so that its unused slots aren't
+// lost. Garbage collection relies on this after a reset: it may have used the
+// last free sector for the head before it was interrupted.
+static void ftl_resume_head(void) {
+    uint32_t newest = FTL_NO_SECTOR;
+    for (uint32_t i = 0; i < ftl_sector_count; i++) {
+        if (ftl_sectors[i].state == FTL_SECTOR_USED && ftl_sectors[i].seq == ftl_seq) {
+            newest = i;
+        }
+    }
+    uint32_t tags[FTL_SLOTS_PER_SECTOR];
+    if (newest == FTL_NO_SECTOR ||
+        !ftl_flash_read(ftl_sector_address(newest) + offsetof(ftl_header_t, tags), (uint8_t *)tags, sizeof(tags))) {
+        return;
+    }
+    uint32_t next = 1;
+    for (uint32_t i = 1; i < FTL_BLOCKS_PER_SECTOR; i++) {
+        if (tags[i - 1] != 0xffffffff) {
+            next = i + 1;
+        }
+    }
+    // Skip any slot that was being written without its tag.
+    while (next < FTL_BLOCKS_PER_SECTOR && !ftl_blank((newest * FTL_BLOCKS_PER_SECTOR + next) * FTL_BLOCK_SIZE, FTL_BLOCK_SIZE)) {
+        next++;
+    }
+    if (next < FTL_BLOCKS_PER_SECTOR) {
+        ftl_head = newest;
+        ftl_head_next = next;
+    }
+}
+
+size_t ftl_ram_size(uint32_t flash_size) {
+    // Physical slots must fit in the 16 bit map entries.
+    uint32_t sector_count = MIN(flash_size / FTL_ERASE_SIZE, FTL_NO_SLOT / FTL_BLOCKS_PER_SECTOR);
+    if (sector_count <= CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS + FTL_MIN_FREE_SECTORS) {
+        return 0;
+    }
+    uint32_t block_count = (sector_count - CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS) * FTL_SLOTS_PER_SECTOR;
+    return sector_count * sizeof(ftl_sector_t) + block_count * sizeof(uint16_t);
+}
+
+void ftl_init(uint32_t flash_size, void *ram) {
+    ftl_sector_count = MIN(flash_size / FTL_ERASE_SIZE, FTL_NO_SLOT / FTL_BLOCKS_PER_SECTOR);
+    ftl_block_count = (ftl_sector_count - CIRCUITPY_EXTERNAL_FLASH_FTL_SPARE_SECTORS) * FTL_SLOTS_PER_SECTOR;
+    ftl_sectors = ram;
+    ftl_map = (uint16_t *)(ftl_sectors + ftl_sector_count);
+    memset(ftl_map, 0xff, ftl_block_count * sizeof(uint16_t));
+    ftl_free_count = 0;
+    ftl_seq = 0;
+    ftl_head = FTL_NO_SECTOR;
+
+    for (uint32_t sector = 0; sector < ftl_sector_count; sector++) {
+        ftl_sector_t *s = &ftl_sectors[sector];
+        ftl_header_t header;
+        s->valid = 0;
+        if (!ftl_flash_read(ftl_sector_address(sector), (uint8_t *)&header, sizeof(header)) ||
+            header.magic != FTL_MAGIC) {
+            // Never used by the FTL, or its erase was interrupted.
+            s->erase_count = 0;
+            s->state = FTL_SECTOR_DIRTY;
+            ftl_free_count++;
+            continue;
+        }
+        // Part of an interrupted erase may have survived.
+        s->erase_count = header.erase_count == ~header.erase_check ? header.erase_count : 0;
+        if (header.seq != ~header.seq_check) {
+            // Either never opened, or opening it was interrupted before any
+            // data was written. Whether the rest is blank is checked before
+            // the sector is used, to keep mounting quick.
+            s->state = header.seq == 0xffffffff && header.seq_check == 0xffffffff ?
+                FTL_SECTOR_UNCHECKED : FTL_SECTOR_DIRTY;
+            ftl_free_count++;
+            continue;
+        }
+        s->state = FTL_SECTOR_USED;
+        s->seq = header.seq;
+        if ((int32_t)(header.seq - ftl_seq) > 0) {
+            ftl_seq = header.seq;
+        }
+        for (uint32_t i = 1; i < FTL_BLOCKS_PER_SECTOR; i++) {
+            uint32_t block = ftl_tag_block(header.tags[i - 1]);
+            if (block == FTL_NO_SLOT) {
+                continue;
+            }
+            uint32_t slot = sector * FTL_BLOCKS_PER_SECTOR + i;
+            uint16_t current = ftl_map[block];
+            // Slots within a sector are written in order.
+            if (current == FTL_NO_SLOT ||
+                (int32_t)(s->seq - ftl_sectors[current / FTL_BLOCKS_PER_SECTOR].seq) >= 0) {
+                ftl_map[block] = slot;
+            }
+        }
+    }
+    for (uint32_t block = 0; block < ftl_block_count; block++) {
+        if (ftl_map[block] != FTL_NO_SLOT) {
+            ftl_sectors[ftl_map[block] / FTL_BLOCKS_PER_SECTOR].valid++;
+        }
+    }
+    ftl_resume_head();
+}
+
+uint32_t ftl_get_block_count(void) {
+    return ftl_block_count;
+}
+
+// Count the blocks, starting at block, whose slots follow one another in flash.
+static uint32_t ftl_contiguous_run(uint32_t block, uint32_t num_blocks) {
+    if (ftl_map[block] == FTL_NO_SLOT) {
+        return 0;
+    }
+    uint32_t run = 1;
+    while (run < num_blocks && block + run < ftl_block_count &&
+           ftl_map[block + run] == ftl_map[block] + run) {
+        run++;
+    }
+    return run;
+}
+
+// Consecutive blocks are read with one flash read where possible.
+bool ftl_read_blocks(uint8_t *dest, uint32_t block, uint32_t num_blocks) {
+    while (num_blocks > 0) {
+        if (block >= ftl_block_count) {
+            return false;
+        }
+        uint32_t run = ftl_contiguous_run(block, num_blocks);
+        if (run > 0) {
+            if (!ftl_flash_read(ftl_map[block] * FTL_BLOCK_SIZE, dest, run * FTL_BLOCK_SIZE)) {
+                return false;
+            }
+        } else {
+            // Never written.
+            memset(dest, 0xff, FTL_BLOCK_SIZE);
+            run = 1;
+        }
+        dest += run * FTL_BLOCK_SIZE;
+        block += run;
+        num_blocks -= run;
+    }
+    return true;
+}
+
+bool ftl_write_block(const uint8_t *data, uint32_t block) {
+    if (block >= ftl_block_count) {
+        return false;
+    }
+    // Filling the head is fine while a free sector remains for collection.
+    uint32_t free_sectors = ftl_head == FTL_NO_SECTOR ? FTL_MIN_FREE_SECTORS : 1;
+    if (ftl_free_count < free_sectors && !ftl_reserve(free_sectors, ftl_sector_count)) {
+        return false;
+    }
+    return ftl_append(block, data, 0);
+}
+
+void ftl_background(void) {
+    ftl_reserve(FTL_BACKGROUND_FREE_SECTORS, FTL_BACKGROUND_ERASES);
+    ftl_level_wear();
+    uint32_t erases = FTL_BACKGROUND_ERASES;
+    for (uint32_t i = 0; i < ftl_sector_count && erases > 0; i++) {
+        if (ftl_sectors[i].state == FTL_SECTOR_DIRTY || ftl_sectors[i].state == FTL_SECTOR_UNCHECKED) {
+            ftl_clean(i);
+            erases--;
+        }
+    }
+}
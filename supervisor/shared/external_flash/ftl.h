@@ -0,0 +1,47 @@
+// This file is part of the CircuitPython project: https://circuitpython.org
+//
+// SPDX-FileCopyrightText: Copyright (c) 2025 Adafruit Industries LLC
+//
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-structured flash translation layer for NOR flash with 4 KiB erase
+// sectors, 256 byte pages and 512 byte filesystem blocks. See ftl.c.
+//
+// There is one translation layer, working on the flash reached through the
+// functions below. They are provided by its user: the external flash driver,
+// or the unix port's simulated flash.
+
+#define FTL_BLOCK_SIZE (512)
+#define FTL_ERASE_SIZE (4096)
+#define FTL_PAGE_SIZE (256)
+
+// Read length bytes from address.
+bool ftl_flash_read(uint32_t address, uint8_t *data, uint32_t length);
+// Program length bytes at address, which must be erased. They don't cross a
+// page.
+bool ftl_flash_program(uint32_t address, const uint8_t *data, uint32_t length);
+// Erase the sector starting at address.
+bool ftl_flash_erase(uint32_t address);
+
+// Bytes of ram the translation layer needs for flash_size bytes of flash, or 0
+// if the flash is too small for it.
+size_t ftl_ram_size(uint32_t flash_size);
+
+// Find the newest copy of each block on the flash. ram must hold
+// ftl_ram_size(flash_size) bytes and is used until the next ftl_init().
+void ftl_init(uint32_t flash_size, void *ram);
+
+// Number of filesystem blocks, fewer than fit in the flash as some sectors are
+// kept spare for garbage collection.
+uint32_t ftl_get_block_count(void);
+
+bool ftl_read_blocks(uint8_t *dest, uint32_t block, uint32_t num_blocks);
+bool ftl_write_block(const uint8_t *data, uint32_t block);
+
+// Collect and erase sectors ahead of time, so that later writes don't wait.
+void ftl_background(void);
@@ -19,6 +19,23 @@
 #include "shared-module/sdcardio/__init__.h"
 #endif
 
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+#include "extmod/vfs_lfs.h"
+#include "shared/timeutils/timeutils.h"
+#if CIRCUITPY_RTC
+#include "shared-bindings/rtc/RTC.h"
+#endif
+
+#include "supervisor/shared/external_flash/external_flash.h"
+
+#if CIRCUITPY_SAVES_PARTITION_SIZE > 0
+#error "CIRCUITPY_FILESYSTEM_LITTLEFS does not support a saves partition"
+#endif
+#if !CIRCUITPY_EXTERNAL_FLASH_FTL
+#error "CIRCUITPY_FILESYSTEM_LITTLEFS requires CIRCUITPY_EXTERNAL_FLASH_FTL"
+#endif
+#endif
+
 static mp_vfs_mount_t _circuitpy_vfs;
 static fs_user_mount_t _circuitpy_usermount;
 
@@ -78,6 +95,145 @@ static void make_file_with_contents(FATFS *fatfs, const char *filename, const by
     make_empty_file(fatfs, filename)
 #endif
 
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+// The flash block device fakes an MBR in sector 0, so littlefs starts after it.
+#define LFS_FIRST_SECTOR (1)
+#define LFS_SECTORS_PER_BLOCK (CIRCUITPY_LITTLEFS_BLOCK_SIZE / FILESYSTEM_BLOCK_SIZE)
+
+// littlefs reads and programs whole sectors through the flash translation
+// layer. It writes each sector out of place, straight to flash and in order,
+// so a program can't disturb data littlefs has already committed and erasing
+// a block has nothing to do. The buffers are static because the filesystem
+// stays mounted between VMs.
+static uint8_t _lfs_read_buffer[FILESYSTEM_BLOCK_SIZE] __attribute__((aligned(4)));
+static uint8_t _lfs_prog_buffer[FILESYSTEM_BLOCK_SIZE] __attribute__((aligned(4)));
+static uint8_t _lfs_lookahead_buffer[CIRCUITPY_LITTLEFS_LOOKAHEAD_SIZE] __attribute__((aligned(8)));
+static uint8_t _lfs_file_buffer[FILESYSTEM_BLOCK_SIZE] __attribute__((aligned(4)));
+static mp_obj_t _circuitpy_lfs = MP_OBJ_NULL;
+
+static uint32_t lfs_sector(lfs2_block_t block, lfs2_off_t off) {
+    return LFS_FIRST_SECTOR + block * LFS_SECTORS_PER_BLOCK + off / FILESYSTEM_BLOCK_SIZE;
+}
+
+static int lfs_read(const struct lfs2_config *c, lfs2_block_t block, lfs2_off_t off, void *buffer, lfs2_size_t size) {
+    if (mp_vfs_blockdev_read(c->context, lfs_sector(block, off), size / FILESYSTEM_BLOCK_SIZE, buffer) != 0) {
+        return LFS2_ERR_IO;
+    }
+    return 0;
+}
+
+static int lfs_prog(const struct lfs2_config *c, lfs2_block_t block, lfs2_off_t off, const void *buffer, lfs2_size_t size) {
+    if (mp_vfs_blockdev_write(c->context, lfs_sector(block, off), size / FILESYSTEM_BLOCK_SIZE, buffer) != 0) {
+        return LFS2_ERR_IO;
+    }
+    return 0;
+}
+
+static int lfs_erase(const struct lfs2_config *c, lfs2_block_t block) {
+    return 0;
+}
+
+static int lfs_sync(const struct lfs2_config *c) {
+    supervisor_flash_flush();
+    return 0;
+}
+
+lfs2_t *filesystem_circuitpy_lfs(void) {
+    if (!filesystem_present() || _circuitpy_lfs == MP_OBJ_NULL) {
+        return NULL;
+    }
+    return mp_vfs_lfs2_get_lfs(_circuitpy_lfs);
+}
+
+int filesystem_lfs_open(lfs2_file_t *file, const char *path, int flags) {
+    static const struct lfs2_file_config file_config = { .buffer = _lfs_file_buffer };
+    lfs2_t *lfs = _circuitpy_lfs == MP_OBJ_NULL ? NULL : mp_vfs_lfs2_get_lfs(_circuitpy_lfs);
+    if (lfs == NULL) {
+        return LFS2_ERR_NOENT;
+    }
+    return lfs2_file_opencfg(lfs, file, path, flags, &file_config);
+}
+
+static void lfs_make_file(const char *path, const char *contents) {
+    lfs2_t *lfs = mp_vfs_lfs2_get_lfs(_circuitpy_lfs);
+    lfs2_file_t file;
+    if (filesystem_lfs_open(&file, path, LFS2_O_WRONLY | LFS2_O_CREAT | LFS2_O_TRUNC) < 0) {
+        return;
+    }
+    lfs2_file_write(lfs, &file, contents, strlen(contents));
+    lfs2_file_close(lfs, &file);
+}
+
+// Mounts CIRCUITPY, formatting it when there is no filesystem and that's
+// allowed, or when asked to. Returns the VFS object or MP_OBJ_NULL.
+static mp_obj_t circuitpy_lfs_mount(fs_user_mount_t *circuitpy, bool create_allowed, bool force_create) {
+    // Without the translation layer, writes go through the sector cache, which
+    // rewrites whole erase sectors and could lose earlier commits.
+    if (!supervisor_external_flash_ftl_active()) {
+        return MP_OBJ_NULL;
+    }
+    lfs2_size_t block_count = supervisor_flash_get_block_count() / LFS_SECTORS_PER_BLOCK;
+    const struct lfs2_config config = {
+        .context = &circuitpy->blockdev,
+        .read = lfs_read,
+        .prog = lfs_prog,
+        .erase = lfs_erase,
+        .sync = lfs_sync,
+        .read_size = FILESYSTEM_BLOCK_SIZE,
+        .prog_size = FILESYSTEM_BLOCK_SIZE,
+        .block_size = CIRCUITPY_LITTLEFS_BLOCK_SIZE,
+        .block_count = block_count,
+        .block_cycles = 100,
+        .cache_size = FILESYSTEM_BLOCK_SIZE,
+        // Cover the whole device when the buffer allows, so the allocator
+        // doesn't have to rescan the filesystem for free blocks.
+        .lookahead_size = MIN(sizeof(_lfs_lookahead_buffer), (block_count + 63) / 64 * 8),
+        .read_buffer = _lfs_read_buffer,
+        .prog_buffer = _lfs_prog_buffer,
+        .lookahead_buffer = _lfs_lookahead_buffer,
+    };
+
+    _circuitpy_lfs = MP_OBJ_NULL;
+    int ret = LFS2_ERR_CORRUPT;
+    if (!force_create) {
+        ret = mp_vfs_lfs2_mount_static(&circuitpy->blockdev, &config, false, &_circuitpy_lfs);
+    }
+    if ((ret == LFS2_ERR_CORRUPT && create_allowed) || force_create) {
+        ret = mp_vfs_lfs2_mount_static(&circuitpy->blockdev, &config, true, &_circuitpy_lfs);
+        if (ret != 0) {
+            return MP_OBJ_NULL;
+        }
+        lfs2_t *lfs = mp_vfs_lfs2_get_lfs(_circuitpy_lfs);
+        #if CIRCUITPY_SDCARDIO || CIRCUITPY_SDIOIO
+        lfs2_mkdir(lfs, "/sd");
+        lfs_make_file("/sd/placeholder.txt",
+            "SD cards mounted at /sd will hide this file from Python.\n");
+        #endif
+        #if CIRCUITPY_OS_GETENV
+        lfs_make_file("/settings.toml", "");
+        #endif
+        lfs_make_file("/code.py", "print(\"Hello World!\")\n");
+        lfs2_mkdir(lfs, "/lib");
+    }
+    if (ret != 0) {
+        return MP_OBJ_NULL;
+    }
+    return _circuitpy_lfs;
+}
+
+// littlefs stamps files with mp_hal_time_ns(), which ports don't otherwise provide.
+uint64_t mp_hal_time_ns(void) {
+    #if CIRCUITPY_RTC
+    timeutils_struct_time_t tm;
+    common_hal_rtc_get_time(&tm);
+    return timeutils_seconds_since_epoch(tm.tm_year, tm.tm_mon, tm.tm_mday,
+        tm.tm_hour, tm.tm_min, tm.tm_sec) * 1000000000ULL;
+    #else
+    return 0;
+    #endif
+}
+#endif
+
 // we don't make this function static because it needs a lot of stack and we
 // want it to be executed without using stack within main() function
 bool filesystem_init(bool create_allowed, bool force_create) {
@@ -103,6 +259,12 @@ bool filesystem_init(bool create_allowed, bool force_create) {
     mp_vfs_mount_t *circuitpy_vfs = &_circuitpy_vfs;
     circuitpy_vfs->len = 0;
 
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    mp_obj_t circuitpy_obj = circuitpy_lfs_mount(circuitpy, create_allowed, force_create);
+    if (circuitpy_obj == MP_OBJ_NULL) {
+        return false;
+    }
+    #else
     // try to mount the flash
     FRESULT res = f_mount(&circuitpy->fatfs);
     if ((res == FR_NO_FILESYSTEM && create_allowed) || force_create) {
@@ -190,10 +352,12 @@ bool filesystem_init(bool create_allowed, bool force_create) {
     } else if (res != FR_OK) {
         return false;
     }
+    mp_obj_t circuitpy_obj = MP_OBJ_FROM_PTR(circuitpy);
+    #endif
 
     circuitpy_vfs->str = "/";
     circuitpy_vfs->len = 1;
-    circuitpy_vfs->obj = MP_OBJ_FROM_PTR(circuitpy);
+    circuitpy_vfs->obj = circuitpy_obj;
     circuitpy_vfs->next = NULL;
 
     MP_STATE_VM(vfs_mount_table) = circuitpy_vfs;
@@ -280,6 +444,10 @@ fs_user_mount_t *filesystem_circuitpy(void) {
     return &_circuitpy_usermount;
 }
 
+bool filesystem_littlefs(fs_user_mount_t *fs_mount) {
+    return CIRCUITPY_FILESYSTEM_LITTLEFS && fs_mount == &_circuitpy_usermount;
+}
+
 fs_user_mount_t *filesystem_for_path(const char *path_in, const char **path_under_mount) {
     mp_vfs_mount_t *vfs = mp_vfs_lookup_path(path_in, path_under_mount);
     if (vfs == MP_VFS_NONE) {
@@ -287,7 +455,9 @@ fs_user_mount_t *filesystem_for_path(const char *path_in, const char **path_unde
     }
     fs_user_mount_t *fs_mount;
     *path_under_mount = path_in;
-    if (vfs == MP_VFS_ROOT) {
+    // On littlefs the mount table holds the littlefs object rather than the
+    // fs_user_mount_t.
+    if (vfs == MP_VFS_ROOT || vfs == &_circuitpy_vfs) {
         fs_mount = filesystem_circuitpy();
     } else {
         fs_mount = MP_OBJ_TO_PTR(vfs->obj);
@@ -303,7 +473,8 @@ fs_user_mount_t *filesystem_for_path(const char *path_in, const char **path_unde
 }
 
 bool filesystem_native_fatfs(fs_user_mount_t *fs_mount) {
-    return fs_mount->base.type == &mp_fat_vfs_type && (fs_mount->blockdev.flags & MP_BLOCKDEV_FLAG_NATIVE) != 0;
+    return fs_mount->base.type == &mp_fat_vfs_type && (fs_mount->blockdev.flags & MP_BLOCKDEV_FLAG_NATIVE) != 0 &&
+           !filesystem_littlefs(fs_mount);
 }
 
 bool filesystem_lock(fs_user_mount_t *fs_mount) {
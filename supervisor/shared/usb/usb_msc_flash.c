@@ -272,7 +272,10 @@ int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buff
         return -1;
     }
 
-    disk_read(vfs, buffer, lba, block_count);
+    // Runs of consecutive blocks are read from flash with a single command.
+    if (disk_read(vfs, buffer, lba, block_count) != RES_OK) {
+        return -1;
+    }
 
     return block_count * MSC_FLASH_BLOCK_SIZE;
 }
@@ -290,9 +293,13 @@ int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *
     if (vfs == NULL) {
         return -1;
     }
-    disk_write(vfs, buffer, lba, block_count);
+    // The flash cache holds the blocks and writes them back in the
+    // background, so the host isn't kept waiting on an erase for every block.
+    if (disk_write(vfs, buffer, lba, block_count) != RES_OK) {
+        return -1;
+    }
     // Since by getting here we assume the mount is read-only to
-    // MicroPython let's update the cached FatFs sector if it's the one
+    // MicroPython let's update the cached FatFs sector if it's one
     // we just wrote.
     #if FF_MAX_SS != FF_MIN_SS
     if (vfs->fatfs.ssize == MSC_FLASH_BLOCK_SIZE) {
@@ -300,7 +307,8 @@ int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *
     // The compiler can optimize this away.
     if (FF_MAX_SS == FILESYSTEM_BLOCK_SIZE) {
         #endif
-        if (lba == vfs->fatfs.winsect && lba > 0) {
+        if (vfs->fatfs.winsect > 0 && vfs->fatfs.winsect >= lba &&
+            vfs->fatfs.winsect < lba + block_count) {
             memcpy(vfs->fatfs.win,
                 buffer + MSC_FLASH_BLOCK_SIZE * (vfs->fatfs.winsect - lba),
                 MSC_FLASH_BLOCK_SIZE);
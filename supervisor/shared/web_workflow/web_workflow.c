@@ -652,10 +652,10 @@ static void _reply_redirect(socketpool_socket_obj_t *socket, _request *request,
 }
 #endif
 
-static void _reply_directory_json(socketpool_socket_obj_t *socket, _request *request, fs_user_mount_t *fs_mount, FF_DIR *dir, const char *request_path, const char *path) {
-    FILINFO file_info;
-    char *fn = file_info.fname;
-    FRESULT res = f_readdir(dir, &file_info);
+static void _reply_directory_json(socketpool_socket_obj_t *socket, _request *request, fs_user_mount_t *fs_mount, supervisor_workflow_dir_t *dir, const char *request_path, const char *path) {
+    supervisor_workflow_entry_t file_info;
+    char *fn = file_info.name;
+    FRESULT res = supervisor_workflow_readdir(dir, &file_info);
     if (res != FR_OK) {
         _reply_missing(socket, request);
         return;
@@ -667,17 +667,10 @@ static void _reply_directory_json(socketpool_socket_obj_t *socket, _request *req
     mp_print_t _socket_print = {socket, _print_chunk};
 
     // Send mount info.
-    DWORD free_clusters = 0;
-    FATFS *fatfs = &fs_mount->fatfs;
-    f_getfree(fatfs, &free_clusters);
-    size_t ssize;
-    #if FF_MAX_SS != FF_MIN_SS
-    ssize = fatfs->ssize;
-    #else
-    ssize = FF_MIN_SS;
-    #endif
-    uint32_t cluster_size = fatfs->csize * ssize;
-    uint32_t total_clusters = fatfs->n_fatent - 2;
+    uint32_t free_clusters = 0;
+    uint32_t total_clusters = 0;
+    uint32_t cluster_size = 0;
+    supervisor_workflow_getfree(fs_mount, &free_clusters, &total_clusters, &cluster_size);
 
     const char *writable = "false";
     // Test to see if we can grab the write lock. USB will grab the underlying
@@ -702,9 +695,9 @@ static void _reply_directory_json(socketpool_socket_obj_t *socket, _request *req
             _send_chunk(socket, ",");
         }
         _send_chunks(socket,
-            "{\"name\": \"", file_info.fname, "\",",
+            "{\"name\": \"", file_info.name, "\",",
             "\"directory\": ", NULL);
-        if ((file_info.fattrib & AM_DIR) != 0) {
+        if (file_info.directory) {
             _send_chunk(socket, "true");
         } else {
             _send_chunk(socket, "false");
@@ -713,31 +706,22 @@ static void _reply_directory_json(socketpool_socket_obj_t *socket, _request *req
         // LittleFS.
         _send_chunk(socket, ", ");
 
-        uint32_t truncated_time = timeutils_mktime(1980 + (file_info.fdate >> 9),
-            (file_info.fdate >> 5) & 0xf,
-            file_info.fdate & 0x1f,
-            file_info.ftime >> 11,
-            (file_info.ftime >> 5) & 0x3f,
-            (file_info.ftime & 0x1f) * 2);
+        uint32_t truncated_time = file_info.mtime;
 
         // Manually append zeros to make the time nanoseconds. Support for printing 64 bit numbers
         // varies across chipsets.
         mp_printf(&_socket_print, "\"modified_ns\": %lu000000000, ", truncated_time);
-        size_t file_size = 0;
-        if ((file_info.fattrib & AM_DIR) == 0) {
-            file_size = file_info.fsize;
-        }
-        mp_printf(&_socket_print, "\"file_size\": %d }", file_size);
+        mp_printf(&_socket_print, "\"file_size\": %d }", file_info.size);
 
         first = false;
-        res = f_readdir(dir, &file_info);
+        res = supervisor_workflow_readdir(dir, &file_info);
     }
     _send_chunk(socket, "]}");
     _send_chunk(socket, "");
 }
 
-static void _reply_with_file(socketpool_socket_obj_t *socket, _request *request, const char *filename, FIL *active_file) {
-    uint32_t total_length = f_size(active_file);
+static void _reply_with_file(socketpool_socket_obj_t *socket, _request *request, const char *filename, supervisor_workflow_file_t *active_file) {
+    uint32_t total_length = supervisor_workflow_size(active_file);
 
     _send_str(socket, "HTTP/1.1 200 OK\r\n");
     mp_print_t _socket_print = {socket, _print_raw};
@@ -761,8 +745,8 @@ static void _reply_with_file(socketpool_socket_obj_t *socket, _request *request,
     int nodelay_ok = -1;
     while (total_read < total_length) {
         uint8_t data_buffer[64];
-        size_t quantity_read;
-        f_read(active_file, data_buffer, 64, &quantity_read);
+        UINT quantity_read;
+        supervisor_workflow_read(active_file, data_buffer, 64, &quantity_read);
         total_read += quantity_read;
         // When getting near the end of the file, disable Nagle's combining algorithm so that
         // data is sent immediately.
@@ -887,23 +871,17 @@ static void _reply_with_diskinfo_json(socketpool_socket_obj_t *socket, _request
         if (i > 0) {
             _send_chunk(socket, ",");
         }
-        fs_user_mount_t *fs = MP_OBJ_TO_PTR(vfs->obj);
-        // Skip non-fat and non-native block file systems.
-        if (fs->base.type != &mp_fat_vfs_type || (fs->blockdev.flags & MP_BLOCKDEV_FLAG_NATIVE) == 0) {
+        const char *mount_path;
+        fs_user_mount_t *fs = supervisor_workflow_mount_for_path(vfs->str, &mount_path);
+        // Skip file systems the workflows can't use.
+        if (fs == NULL) {
             vfs = vfs->next;
             continue;
         }
-        DWORD free_clusters = 0;
-        FATFS *fatfs = &fs->fatfs;
-        f_getfree(fatfs, &free_clusters);
-        size_t ssize;
-        #if FF_MAX_SS != FF_MIN_SS
-        ssize = fatfs->ssize;
-        #else
-        ssize = FF_MIN_SS;
-        #endif
-        size_t block_size = fatfs->csize * ssize;
-        size_t total_size = fatfs->n_fatent - 2;
+        uint32_t free_clusters = 0;
+        uint32_t total_size = 0;
+        uint32_t block_size = 0;
+        supervisor_workflow_getfree(fs, &free_clusters, &total_size, &block_size);
 
         const char *writable = "false";
         if (filesystem_lock(fs)) {
@@ -957,7 +935,7 @@ static void _discard_incoming(socketpool_socket_obj_t *socket, size_t amount) {
 }
 
 static void _write_file_and_reply(socketpool_socket_obj_t *socket, _request *request, fs_user_mount_t *fs_mount, const TCHAR *path) {
-    FIL active_file;
+    supervisor_workflow_file_t active_file;
 
     if (!filesystem_lock(fs_mount)) {
         _discard_incoming(socket, request->content_length);
@@ -970,15 +948,14 @@ static void _write_file_and_reply(socketpool_socket_obj_t *socket, _request *req
         override_fattime(fattime);
     }
 
-    FATFS *fs = &fs_mount->fatfs;
-    FRESULT result = f_open(fs, &active_file, path, FA_WRITE);
+    FRESULT result = supervisor_workflow_open(fs_mount, &active_file, path, FA_WRITE);
     bool new_file = false;
     size_t old_length = 0;
     if (result == FR_NO_FILE) {
         new_file = true;
-        result = f_open(fs, &active_file, path, FA_WRITE | FA_OPEN_ALWAYS);
+        result = supervisor_workflow_open(fs_mount, &active_file, path, FA_WRITE | FA_OPEN_ALWAYS);
     } else {
-        old_length = f_size(&active_file);
+        old_length = supervisor_workflow_size(&active_file);
     }
 
     if (result == FR_NO_PATH) {
@@ -997,17 +974,16 @@ static void _write_file_and_reply(socketpool_socket_obj_t *socket, _request *req
     }
 
     // Change the file size to start.
-    f_lseek(&active_file, request->content_length);
-    if (f_tell(&active_file) < request->content_length) {
+    if (supervisor_workflow_reserve(&active_file, request->content_length) != FR_OK) {
         if (!new_file) {
             // Truncate the file back to the old length.
-            f_lseek(&active_file, old_length);
-            f_truncate(&active_file);
+            supervisor_workflow_lseek(&active_file, old_length);
+            supervisor_workflow_truncate(&active_file);
         }
-        f_close(&active_file);
+        supervisor_workflow_close(&active_file);
 
         if (new_file) {
-            f_unlink(fs, path);
+            supervisor_workflow_unlink(fs_mount, path);
         }
         override_fattime(0);
         filesystem_unlock(fs_mount);
@@ -1022,8 +998,8 @@ static void _write_file_and_reply(socketpool_socket_obj_t *socket, _request *req
     } else if (request->expect) {
         _reply_continue(socket, request);
     }
-    f_truncate(&active_file);
-    f_rewind(&active_file);
+    supervisor_workflow_truncate(&active_file);
+    supervisor_workflow_lseek(&active_file, 0);
 
     size_t total_read = 0;
     bool error = false;
@@ -1040,14 +1016,14 @@ static void _write_file_and_reply(socketpool_socket_obj_t *socket, _request *req
         }
         total_read += len;
         UINT actual;
-        f_write(&active_file, bytes, len, &actual);
+        supervisor_workflow_write(&active_file, bytes, len, &actual);
         if (actual < (UINT)len) {
             error = true;
             break;
         }
     }
 
-    f_close(&active_file);
+    supervisor_workflow_close(&active_file);
     filesystem_unlock(fs_mount);
 
     override_fattime(0);
@@ -1249,37 +1225,19 @@ static bool _reply(socketpool_socket_obj_t *socket, _request *request) {
 
             // These responses don't use helpers because they stream data in and
             // out. So, share the mount lookup code.
-            const char *path_out = NULL;
-            mp_vfs_mount_t *vfs = mp_vfs_lookup_path(path, &path_out);
-            if (vfs == MP_VFS_NONE) {
+            const char *mount_path;
+            fs_user_mount_t *fs_mount = supervisor_workflow_mount_for_path(path, &mount_path);
+            if (fs_mount == NULL) {
                 _reply_missing(socket, request);
                 return false;
             }
-            fs_user_mount_t *fs_mount;
-            if (vfs == MP_VFS_ROOT) {
-                fs_mount = filesystem_circuitpy();
-            } else {
-                fs_mount = MP_OBJ_TO_PTR(vfs->obj);
-                // Skip non-fat and non-native block file systems.
-                if (!filesystem_native_fatfs(fs_mount)) {
-                    _reply_missing(socket, request);
-                    return false;
-                }
-                // Check if the vfs name is one character long: it must be "/" in that case.
-                // If so don't remove the mount point name. We must use an absolute path
-                // because otherwise the path will be adjusted by os.getcwd() when it's looked up.
-                if (strlen(vfs->str) != 1) {
-                    // Remove the mount point directory name, such as "/sd".
-                    path += strlen(vfs->str);
-                }
-                pathlen = strlen(path);
-
-            }
-            FATFS *fs = &fs_mount->fatfs;
+            // Remove the mount point directory name, such as "/sd".
+            path += mount_path - path;
+            pathlen = strlen(path);
             if (directory) {
                 if (strcasecmp(request->method, "GET") == 0) {
-                    FF_DIR dir;
-                    FRESULT res = f_opendir(fs, &dir, path);
+                    supervisor_workflow_dir_t dir;
+                    FRESULT res = supervisor_workflow_opendir(fs_mount, &dir, path);
                     // Put the / back for replies.
                     if (pathlen > 1) {
                         path[pathlen - 1] = '/';
@@ -1296,12 +1254,12 @@ static bool _reply(socketpool_socket_obj_t *socket, _request *request) {
                         _reply_missing(socket, request);
                     }
 
-                    f_closedir(&dir);
+                    supervisor_workflow_closedir(&dir);
                 }
             } else { // Dealing with a file.
                 if (strcasecmp(request->method, "GET") == 0) {
-                    FIL active_file;
-                    FRESULT result = f_open(fs, &active_file, path, FA_READ);
+                    supervisor_workflow_file_t active_file;
+                    FRESULT result = supervisor_workflow_open(fs_mount, &active_file, path, FA_READ);
 
                     if (result != FR_OK) {
                         _reply_missing(socket, request);
@@ -1309,7 +1267,7 @@ static bool _reply(socketpool_socket_obj_t *socket, _request *request) {
                         _reply_with_file(socket, request, path, &active_file);
                     }
 
-                    f_close(&active_file);
+                    supervisor_workflow_close(&active_file);
                 } else if (strcasecmp(request->method, "PUT") == 0) {
                     _write_file_and_reply(socket, request, fs_mount, path);
                     return true;
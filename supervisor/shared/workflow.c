@@ -5,9 +5,12 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdbool.h>
+#include <string.h>
+
 #include "py/mpconfig.h"
 #include "py/mpstate.h"
 #include "py/stackctrl.h"
+#include "shared/timeutils/timeutils.h"
 #include "supervisor/background_callback.h"
 #include "supervisor/fatfs.h"
 #include "supervisor/filesystem.h"
@@ -116,28 +119,406 @@ void supervisor_workflow_start(void) {
     #endif
 }
 
+#if CIRCUITPY_FILESYSTEM_LITTLEFS
+// The attribute the littlefs VFS keeps modification times in: 64-bit little
+// endian nanoseconds since 1970.
+#define LFS_ATTR_MTIME (1)
+
+static FRESULT lfs_result(int err) {
+    switch (err) {
+        case LFS2_ERR_OK:
+            return FR_OK;
+        case LFS2_ERR_NOENT:
+            return FR_NO_FILE;
+        case LFS2_ERR_EXIST:
+            return FR_EXIST;
+        case LFS2_ERR_NOTDIR:
+            return FR_NO_PATH;
+        case LFS2_ERR_ISDIR:
+        case LFS2_ERR_NOTEMPTY:
+        case LFS2_ERR_NOSPC:
+            return FR_DENIED;
+        case LFS2_ERR_NAMETOOLONG:
+            return FR_INVALID_NAME;
+        default:
+            return err > 0 ? FR_OK : FR_DISK_ERR;
+    }
+}
+
+// Stamp littlefs with the time FatFs would have used, including any override.
+static void lfs_mtime_now(uint8_t mtime[8]) {
+    DWORD fattime = get_fattime();
+    uint64_t ns = timeutils_nanoseconds_since_epoch_to_nanoseconds_since_1970(
+        timeutils_mktime(1980 + (fattime >> 25),
+            (fattime >> 21) & 0xf,
+            (fattime >> 16) & 0x1f,
+            (fattime >> 11) & 0x1f,
+            (fattime >> 5) & 0x3f,
+            (fattime & 0x1f) * 2) * 1000000000ULL);
+    for (size_t i = 0; i < 8; i++) {
+        mtime[i] = ns;
+        ns >>= 8;
+    }
+}
+
+static uint64_t lfs_mtime(const char *dir_path, const char *name) {
+    size_t dir_len = strlen(dir_path);
+    size_t name_len = strlen(name);
+    char path[dir_len + 1 + name_len + 1];
+    memcpy(path, dir_path, dir_len);
+    if (dir_len == 0 || path[dir_len - 1] != '/') {
+        path[dir_len++] = '/';
+    }
+    memcpy(path + dir_len, name, name_len + 1);
+
+    uint8_t mtime[8];
+    if (lfs2_getattr(filesystem_circuitpy_lfs(), path, LFS_ATTR_MTIME, mtime, sizeof(mtime)) != sizeof(mtime)) {
+        return 0;
+    }
+    uint64_t ns = 0;
+    for (size_t i = sizeof(mtime); i > 0; i--) {
+        ns = ns << 8 | mtime[i - 1];
+    }
+    return timeutils_seconds_since_epoch_from_nanoseconds_since_1970(ns);
+}
+#endif
+
+bool supervisor_workflow_mount_supported(fs_user_mount_t *mount) {
+    return filesystem_native_fatfs(mount) || filesystem_littlefs(mount);
+}
+
+fs_user_mount_t *supervisor_workflow_mount_for_path(const char *full_path, const char **mount_path) {
+    fs_user_mount_t *mount = filesystem_for_path(full_path, mount_path);
+    if (mount == NULL || !supervisor_workflow_mount_supported(mount)) {
+        return NULL;
+    }
+    return mount;
+}
+
+FRESULT supervisor_workflow_getfree(fs_user_mount_t *mount, uint32_t *free_blocks, uint32_t *total_blocks, uint32_t *block_size) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        lfs2_t *lfs = filesystem_circuitpy_lfs();
+        lfs2_ssize_t used = lfs2_fs_size(lfs);
+        if (used < 0) {
+            return lfs_result(used);
+        }
+        *total_blocks = lfs->cfg->block_count;
+        *free_blocks = *total_blocks - MIN((uint32_t)used, *total_blocks);
+        *block_size = lfs->cfg->block_size;
+        return FR_OK;
+    }
+    #endif
+    DWORD free_clusters = 0;
+    FATFS *fatfs = &mount->fatfs;
+    FRESULT res = f_getfree(fatfs, &free_clusters);
+    size_t ssize;
+    #if FF_MAX_SS != FF_MIN_SS
+    ssize = fatfs->ssize;
+    #else
+    ssize = FF_MIN_SS;
+    #endif
+    *free_blocks = free_clusters;
+    *total_blocks = fatfs->n_fatent - 2;
+    *block_size = fatfs->csize * ssize;
+    return res;
+}
+
+// FatFs refuses to stat the root, and so the workflows never remove it.
+static FRESULT workflow_stat(fs_user_mount_t *mount, const char *path, bool *directory) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        if (path[0] == '\0' || strcmp(path, "/") == 0) {
+            return FR_INVALID_NAME;
+        }
+        struct lfs2_info info;
+        int err = lfs2_stat(filesystem_circuitpy_lfs(), path, &info);
+        *directory = err == LFS2_ERR_OK && info.type == LFS2_TYPE_DIR;
+        return lfs_result(err);
+    }
+    #endif
+    FILINFO file;
+    FRESULT result = f_stat(&mount->fatfs, path, &file);
+    *directory = result == FR_OK && (file.fattrib & AM_DIR) != 0;
+    return result;
+}
+
+static FRESULT workflow_rename(fs_user_mount_t *mount, const char *old_path, const char *new_path) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        // littlefs replaces the destination but FatFs doesn't.
+        bool directory;
+        if (workflow_stat(mount, new_path, &directory) == FR_OK) {
+            return FR_EXIST;
+        }
+        return lfs_result(lfs2_rename(filesystem_circuitpy_lfs(), old_path, new_path));
+    }
+    #endif
+    return f_rename(&mount->fatfs, old_path, new_path);
+}
+
+static FRESULT workflow_mkdir(fs_user_mount_t *mount, const char *path) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        lfs2_t *lfs = filesystem_circuitpy_lfs();
+        int err = lfs2_mkdir(lfs, path);
+        if (err == LFS2_ERR_OK) {
+            uint8_t mtime[8];
+            lfs_mtime_now(mtime);
+            lfs2_setattr(lfs, path, LFS_ATTR_MTIME, mtime, sizeof(mtime));
+        }
+        return lfs_result(err);
+    }
+    #endif
+    return f_mkdir(&mount->fatfs, path);
+}
+
+FRESULT supervisor_workflow_unlink(fs_user_mount_t *mount, const char *path) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        return lfs_result(lfs2_remove(filesystem_circuitpy_lfs(), path));
+    }
+    #endif
+    return f_unlink(&mount->fatfs, path);
+}
+
+FRESULT supervisor_workflow_open(fs_user_mount_t *mount, supervisor_workflow_file_t *file, const char *path, BYTE mode) {
+    file->mount = NULL;
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        memset(&file->lfs.config, 0, sizeof(file->lfs.config));
+        file->lfs.config.buffer = file->lfs.buffer;
+        int flags = LFS2_O_RDONLY;
+        if ((mode & FA_WRITE) != 0) {
+            flags = LFS2_O_WRONLY;
+            if ((mode & FA_OPEN_ALWAYS) != 0) {
+                flags |= LFS2_O_CREAT;
+            }
+            lfs_mtime_now(file->lfs.mtime);
+            file->lfs.attr.type = LFS_ATTR_MTIME;
+            file->lfs.attr.buffer = file->lfs.mtime;
+            file->lfs.attr.size = sizeof(file->lfs.mtime);
+            file->lfs.config.attrs = &file->lfs.attr;
+            file->lfs.config.attr_count = 1;
+        }
+        int err = lfs2_file_opencfg(filesystem_circuitpy_lfs(), &file->lfs.file, path, flags, &file->lfs.config);
+        if (err == LFS2_ERR_NOENT && (flags & LFS2_O_CREAT) != 0) {
+            // Only a missing directory stops a file being created.
+            return FR_NO_PATH;
+        }
+        if (err == LFS2_ERR_OK) {
+            file->mount = mount;
+        }
+        return lfs_result(err);
+    }
+    #endif
+    FRESULT result = f_open(&mount->fatfs, &file->fat, path, mode);
+    if (result == FR_OK) {
+        file->mount = mount;
+    }
+    return result;
+}
+
+FRESULT supervisor_workflow_read(supervisor_workflow_file_t *file, void *buf, UINT len, UINT *read) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        lfs2_ssize_t result = lfs2_file_read(filesystem_circuitpy_lfs(), &file->lfs.file, buf, len);
+        *read = MAX(result, 0);
+        return lfs_result(result);
+    }
+    #endif
+    return f_read(&file->fat, buf, len, read);
+}
+
+FRESULT supervisor_workflow_write(supervisor_workflow_file_t *file, const void *buf, UINT len, UINT *written) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        lfs2_ssize_t result = lfs2_file_write(filesystem_circuitpy_lfs(), &file->lfs.file, buf, len);
+        *written = MAX(result, 0);
+        return lfs_result(result);
+    }
+    #endif
+    return f_write(&file->fat, buf, len, written);
+}
+
+FRESULT supervisor_workflow_lseek(supervisor_workflow_file_t *file, FSIZE_t offset) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        return lfs_result(lfs2_file_seek(filesystem_circuitpy_lfs(), &file->lfs.file, offset, LFS2_SEEK_SET));
+    }
+    #endif
+    return f_lseek(&file->fat, offset);
+}
+
+FSIZE_t supervisor_workflow_tell(supervisor_workflow_file_t *file) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        return MAX(lfs2_file_tell(filesystem_circuitpy_lfs(), &file->lfs.file), 0);
+    }
+    #endif
+    return f_tell(&file->fat);
+}
+
+FSIZE_t supervisor_workflow_size(supervisor_workflow_file_t *file) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        return MAX(lfs2_file_size(filesystem_circuitpy_lfs(), &file->lfs.file), 0);
+    }
+    #endif
+    return f_size(&file->fat);
+}
+
+FRESULT supervisor_workflow_reserve(supervisor_workflow_file_t *file, FSIZE_t size) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        // littlefs only allocates as it writes, so compare with what's free.
+        // New data doesn't reuse the blocks it replaces until it's committed.
+        uint32_t free_blocks, total_blocks, block_size;
+        FRESULT result = supervisor_workflow_getfree(file->mount, &free_blocks, &total_blocks, &block_size);
+        if (result != FR_OK) {
+            return result;
+        }
+        if ((size + block_size - 1) / block_size > free_blocks) {
+            return FR_DENIED;
+        }
+        return supervisor_workflow_lseek(file, MIN(size, supervisor_workflow_size(file)));
+    }
+    #endif
+    FRESULT result = f_lseek(&file->fat, size);
+    if (result == FR_OK && f_tell(&file->fat) < size) {
+        result = FR_DENIED;
+    }
+    return result;
+}
+
+FRESULT supervisor_workflow_truncate(supervisor_workflow_file_t *file) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(file->mount)) {
+        lfs2_t *lfs = filesystem_circuitpy_lfs();
+        lfs2_soff_t position = lfs2_file_tell(lfs, &file->lfs.file);
+        if (position < 0) {
+            return lfs_result(position);
+        }
+        return lfs_result(lfs2_file_truncate(lfs, &file->lfs.file, position));
+    }
+    #endif
+    return f_truncate(&file->fat);
+}
+
+FRESULT supervisor_workflow_close(supervisor_workflow_file_t *file) {
+    fs_user_mount_t *mount = file->mount;
+    if (mount == NULL) {
+        return FR_OK;
+    }
+    file->mount = NULL;
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        return lfs_result(lfs2_file_close(filesystem_circuitpy_lfs(), &file->lfs.file));
+    }
+    #endif
+    return f_close(&file->fat);
+}
+
+FRESULT supervisor_workflow_opendir(fs_user_mount_t *mount, supervisor_workflow_dir_t *dir, const char *path) {
+    dir->mount = NULL;
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        int err = lfs2_dir_open(filesystem_circuitpy_lfs(), &dir->lfs.dir, path);
+        if (err == LFS2_ERR_OK) {
+            dir->mount = mount;
+            dir->lfs.path = path;
+        }
+        return lfs_result(err);
+    }
+    #endif
+    FRESULT result = f_opendir(&mount->fatfs, &dir->fat, path);
+    if (result == FR_OK) {
+        dir->mount = mount;
+    }
+    return result;
+}
+
+FRESULT supervisor_workflow_readdir(supervisor_workflow_dir_t *dir, supervisor_workflow_entry_t *entry) {
+    entry->name[0] = '\0';
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(dir->mount)) {
+        struct lfs2_info info;
+        int found;
+        do {
+            found = lfs2_dir_read(filesystem_circuitpy_lfs(), &dir->lfs.dir, &info);
+        } while (found > 0 && (strcmp(info.name, ".") == 0 || strcmp(info.name, "..") == 0));
+        if (found <= 0) {
+            return lfs_result(found);
+        }
+        strncpy(entry->name, info.name, sizeof(entry->name) - 1);
+        entry->name[sizeof(entry->name) - 1] = '\0';
+        entry->directory = info.type == LFS2_TYPE_DIR;
+        entry->size = entry->directory ? 0 : info.size;
+        entry->mtime = lfs_mtime(dir->lfs.path, info.name);
+        return FR_OK;
+    }
+    #endif
+    FILINFO file_info;
+    FRESULT result = f_readdir(&dir->fat, &file_info);
+    if (result != FR_OK || file_info.fname[0] == '\0') {
+        return result;
+    }
+    strcpy(entry->name, file_info.fname);
+    entry->directory = (file_info.fattrib & AM_DIR) != 0;
+    entry->size = entry->directory ? 0 : file_info.fsize;
+    entry->mtime = timeutils_mktime(1980 + (file_info.fdate >> 9),
+        (file_info.fdate >> 5) & 0xf,
+        file_info.fdate & 0x1f,
+        file_info.ftime >> 11,
+        (file_info.ftime >> 5) & 0x3f,
+        (file_info.ftime & 0x1f) * 2);
+    return FR_OK;
+}
+
+FRESULT supervisor_workflow_rewinddir(supervisor_workflow_dir_t *dir) {
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(dir->mount)) {
+        return lfs_result(lfs2_dir_rewind(filesystem_circuitpy_lfs(), &dir->lfs.dir));
+    }
+    #endif
+    return f_readdir(&dir->fat, NULL);
+}
+
+FRESULT supervisor_workflow_closedir(supervisor_workflow_dir_t *dir) {
+    fs_user_mount_t *mount = dir->mount;
+    if (mount == NULL) {
+        return FR_OK;
+    }
+    dir->mount = NULL;
+    #if CIRCUITPY_FILESYSTEM_LITTLEFS
+    if (filesystem_littlefs(mount)) {
+        return lfs_result(lfs2_dir_close(filesystem_circuitpy_lfs(), &dir->lfs.dir));
+    }
+    #endif
+    return f_closedir(&dir->fat);
+}
+
 FRESULT supervisor_workflow_move(const char *old_path, const char *new_path) {
     const char *old_mount_path;
     const char *new_mount_path;
-    fs_user_mount_t *active_mount = filesystem_for_path(old_path, &old_mount_path);
-    fs_user_mount_t *new_mount = filesystem_for_path(new_path, &new_mount_path);
-    if (active_mount == NULL || new_mount == NULL || active_mount != new_mount || !filesystem_native_fatfs(active_mount)) {
+    fs_user_mount_t *active_mount = supervisor_workflow_mount_for_path(old_path, &old_mount_path);
+    fs_user_mount_t *new_mount = supervisor_workflow_mount_for_path(new_path, &new_mount_path);
+    if (active_mount == NULL || new_mount == NULL || active_mount != new_mount) {
         return FR_NO_PATH;
     }
     if (!filesystem_lock(active_mount)) {
         return FR_WRITE_PROTECTED;
     }
-    FATFS *fs = &active_mount->fatfs;
 
-    FRESULT result = f_rename(fs, old_mount_path, new_mount_path);
+    FRESULT result = workflow_rename(active_mount, old_mount_path, new_mount_path);
     filesystem_unlock(active_mount);
     return result;
 }
 
 FRESULT supervisor_workflow_mkdir(DWORD fattime, const char *full_path) {
     const char *mount_path;
-    fs_user_mount_t *active_mount = filesystem_for_path(full_path, &mount_path);
-    if (active_mount == NULL || !filesystem_native_fatfs(active_mount)) {
+    fs_user_mount_t *active_mount = supervisor_workflow_mount_for_path(full_path, &mount_path);
+    if (active_mount == NULL) {
         return FR_NO_PATH;
     }
 
@@ -148,9 +529,8 @@ FRESULT supervisor_workflow_mkdir(DWORD fattime, const char *full_path) {
 
     // Check to see if the directory exists already. We don't care about writing
     // it if it already exists.
-    FATFS *fs = &active_mount->fatfs;
-    FILINFO file;
-    FRESULT result = f_stat(fs, mount_path, &file);
+    bool directory;
+    FRESULT result = workflow_stat(active_mount, mount_path, &directory);
     if (result == FR_OK) {
         return FR_EXIST;
     }
@@ -160,7 +540,7 @@ FRESULT supervisor_workflow_mkdir(DWORD fattime, const char *full_path) {
     }
 
     override_fattime(fattime);
-    result = f_mkdir(fs, mount_path);
+    result = workflow_mkdir(active_mount, mount_path);
     override_fattime(0);
     filesystem_unlock(active_mount);
     return result;
@@ -190,64 +570,62 @@ FRESULT supervisor_workflow_mkdir_parents(DWORD fattime, char *path) {
     return result;
 }
 
-static FRESULT supervisor_workflow_delete_directory_contents(FATFS *fs, const TCHAR *path) {
-    FF_DIR dir;
-    FILINFO file_info;
+static FRESULT supervisor_workflow_delete_directory_contents(fs_user_mount_t *mount, const TCHAR *path) {
+    supervisor_workflow_dir_t dir;
+    supervisor_workflow_entry_t entry;
     // Check the stack since we're putting paths on it.
     if (mp_stack_usage() >= MP_STATE_THREAD(stack_limit)) {
         return FR_INT_ERR;
     }
     FRESULT res = FR_OK;
     while (res == FR_OK) {
-        res = f_opendir(fs, &dir, path);
+        res = supervisor_workflow_opendir(mount, &dir, path);
         if (res != FR_OK) {
             break;
         }
-        res = f_readdir(&dir, &file_info);
+        res = supervisor_workflow_readdir(&dir, &entry);
         // We close and reopen the directory every time since we're deleting
         // entries and it may invalidate the directory handle.
-        f_closedir(&dir);
-        if (res != FR_OK || file_info.fname[0] == '\0') {
+        supervisor_workflow_closedir(&dir);
+        if (res != FR_OK || entry.name[0] == '\0') {
             break;
         }
         size_t pathlen = strlen(path);
-        size_t fnlen = strlen(file_info.fname);
+        size_t fnlen = strlen(entry.name);
         TCHAR full_path[pathlen + 1 + fnlen];
         memcpy(full_path, path, pathlen);
         full_path[pathlen] = '/';
         size_t full_pathlen = pathlen + 1 + fnlen;
-        memcpy(full_path + pathlen + 1, file_info.fname, fnlen);
+        memcpy(full_path + pathlen + 1, entry.name, fnlen);
         full_path[full_pathlen] = '\0';
-        if ((file_info.fattrib & AM_DIR) != 0) {
-            res = supervisor_workflow_delete_directory_contents(fs, full_path);
+        if (entry.directory) {
+            res = supervisor_workflow_delete_directory_contents(mount, full_path);
         }
         if (res != FR_OK) {
             break;
         }
-        res = f_unlink(fs, full_path);
+        res = supervisor_workflow_unlink(mount, full_path);
     }
-    f_closedir(&dir);
     return res;
 }
 
 FRESULT supervisor_workflow_delete_recursive(const char *full_path) {
     const char *mount_path;
-    fs_user_mount_t *active_mount = filesystem_for_path(full_path, &mount_path);
-    if (active_mount == NULL || !filesystem_native_fatfs(active_mount)) {
+    fs_user_mount_t *active_mount = supervisor_workflow_mount_for_path(full_path, &mount_path);
+    if (active_mount == NULL) {
         return FR_NO_PATH;
     }
     if (!filesystem_lock(active_mount)) {
         return FR_WRITE_PROTECTED;
     }
-    FATFS *fs = &active_mount->fatfs;
-    FILINFO file;
-    FRESULT result = f_stat(fs, mount_path, &file);
+    bool directory;
+    FRESULT result = workflow_stat(active_mount, mount_path, &directory);
     if (result == FR_OK) {
-        if ((file.fattrib & AM_DIR) != 0) {
-            result = supervisor_workflow_delete_directory_contents(fs, mount_path);
+        if (directory) {
+            result = supervisor_workflow_delete_directory_contents(active_mount, mount_path);
         }
         if (result == FR_OK) {
-            result = f_unlink(fs, mount_path);
+            result = supervisor_workflow_unlink(active_mount, mount_path);
         }
     }
     filesystem_unlock(active_mount);
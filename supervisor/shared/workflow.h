@@ -7,6 +7,7 @@
 #pragma once
 
 #include "lib/oofatfs/ff.h"
+#include "supervisor/filesystem.h"
 
 extern bool supervisor_workflow_connecting(void);
 
@@ -15,3 +16,72 @@ FRESULT supervisor_workflow_move(const char *old_path, const char *new_path);
 FRESULT supervisor_workflow_mkdir(DWORD fattime, const char *full_path);
 FRESULT supervisor_workflow_mkdir_parents(DWORD fattime, char *path);
 FRESULT supervisor_workflow_delete_recursive(const char *full_path);
+
+// Files and directories opened by the workflows. They live on a native FAT
+// mount or, with CIRCUITPY_FILESYSTEM_LITTLEFS, on CIRCUITPY itself. Results
+// are FatFs codes either way, and new files and directories get their time
+// from get_fattime() so override_fattime() works for both.
+typedef struct {
+    fs_user_mount_t *mount;
+    union {
+        FIL fat;
+        #if CIRCUITPY_FILESYSTEM_LITTLEFS
+        struct {
+            lfs2_file_t file;
+            struct lfs2_file_config config;
+            struct lfs2_attr attr;
+            uint8_t mtime[8];
+            uint8_t buffer[FILESYSTEM_BLOCK_SIZE];
+        } lfs;
+        #endif
+    };
+} supervisor_workflow_file_t;
+
+typedef struct {
+    fs_user_mount_t *mount;
+    union {
+        FF_DIR fat;
+        #if CIRCUITPY_FILESYSTEM_LITTLEFS
+        struct {
+            lfs2_dir_t dir;
+            // Used to look up modification times, so it must outlive the
+            // open directory.
+            const char *path;
+        } lfs;
+        #endif
+    };
+} supervisor_workflow_dir_t;
+
+typedef struct {
+    // Empty after the last entry.
+    char name[FF_LFN_BUF + 1];
+    bool directory;
+    uint32_t size;
+    // Seconds since 1970.
+    uint64_t mtime;
+} supervisor_workflow_entry_t;
+
+// Returns the mount holding full_path if the workflows can use it, or NULL.
+fs_user_mount_t *supervisor_workflow_mount_for_path(const char *full_path, const char **mount_path);
+bool supervisor_workflow_mount_supported(fs_user_mount_t *mount);
+FRESULT supervisor_workflow_getfree(fs_user_mount_t *mount, uint32_t *free_blocks, uint32_t *total_blocks, uint32_t *block_size);
+FRESULT supervisor_workflow_unlink(fs_user_mount_t *mount, const char *path);
+
+// mode is FA_READ, FA_WRITE or FA_WRITE | FA_OPEN_ALWAYS.
+FRESULT supervisor_workflow_open(fs_user_mount_t *mount, supervisor_workflow_file_t *file, const char *path, BYTE mode);
+FRESULT supervisor_workflow_read(supervisor_workflow_file_t *file, void *buf, UINT len, UINT *read);
+FRESULT supervisor_workflow_write(supervisor_workflow_file_t *file, const void *buf, UINT len, UINT *written);
+FRESULT supervisor_workflow_lseek(supervisor_workflow_file_t *file, FSIZE_t offset);
+FSIZE_t supervisor_workflow_tell(supervisor_workflow_file_t *file);
+FSIZE_t supervisor_workflow_size(supervisor_workflow_file_t *file);
+// Checks that the file can grow to size bytes, returning FR_DENIED if not. The
+// position is left at size or at the end of the file, whichever is first.
+FRESULT supervisor_workflow_reserve(supervisor_workflow_file_t *file, FSIZE_t size);
+FRESULT supervisor_workflow_truncate(supervisor_workflow_file_t *file);
+// Safe to call on a file that isn't open.
+FRESULT supervisor_workflow_close(supervisor_workflow_file_t *file);
+
+FRESULT supervisor_workflow_opendir(fs_user_mount_t *mount, supervisor_workflow_dir_t *dir, const char *path);
+FRESULT supervisor_workflow_readdir(supervisor_workflow_dir_t *dir, supervisor_workflow_entry_t *entry);
+FRESULT supervisor_workflow_rewinddir(supervisor_workflow_dir_t *dir);
+FRESULT supervisor_workflow_closedir(supervisor_workflow_dir_t *dir);
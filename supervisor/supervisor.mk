@@ -86,6 +86,9 @@ else
   ifeq ($(QSPI_FLASH_FILESYSTEM),1)
     SRC_SUPERVISOR += supervisor/qspi_flash.c supervisor/shared/external_flash/qspi_flash.c
   endif
+  ifeq ($(CIRCUITPY_EXTERNAL_FLASH_FTL),1)
+    SRC_SUPERVISOR += supervisor/shared/external_flash/ftl.c
+  endif
 
 OBJ_EXTRA_ORDER_DEPS += $(HEADER_BUILD)/devices.h
 SRC_QSTR += $(HEADER_BUILD)/devices.h
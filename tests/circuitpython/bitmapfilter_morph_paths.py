@@ -0,0 +1,84 @@
+from displayio import Bitmap
+import bitmapfilter
+
+
+def make_bitmap(w, h, seed):
+    b = Bitmap(w, h, 65536)
+    for i in range(w * h):
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+        b[i] = seed >> 8 & 0xFFFF
+    return b
+
+
+def make_mask(w, h):
+    b = Bitmap(w, h, 2)
+    for y in range(h):
+        for x in range(w):
+            b[x, y] = (x + 2 * y) % 3 == 0
+    return b
+
+
+def clamp(v, hi):
+    return 0 if v < 0 else hi if v > hi else v
+
+
+def swap(p):
+    return (p >> 8) | (p & 0xFF) << 8
+
+
+# A direct evaluation of the kernel, which morph is checked against whichever
+# of its code paths it picks.
+def reference(b, krn, mul, add, mask):
+    w, h = b.width, b.height
+    n = int(len(krn) ** 0.5)
+    ks = n // 2
+    m_int = int(65536 * mul + 0.5)
+    b_int = int(65536 * 63 * add + 0.5)
+    out = []
+    for y in range(h):
+        for x in range(w):
+            if mask and mask[x, y]:
+                out.append(b[x, y])
+                continue
+            r = g = bl = 0
+            for j in range(n):
+                for k in range(n):
+                    p = swap(b[clamp(x + k - ks, w - 1), clamp(y + j - ks, h - 1)])
+                    wt = krn[j * n + k]
+                    r += wt * (p >> 11)
+                    g += wt * (p >> 5 & 63)
+                    bl += wt * (p & 31)
+            r = clamp((r * m_int + b_int) >> 16, 31)
+            g = clamp((g * m_int + b_int * 2) >> 16, 63)
+            bl = clamp((bl * m_int + b_int) >> 16, 31)
+            out.append(swap(r << 11 | g << 5 | bl))
+    return out
+
+
+def outer(col, row):
+    return [c * r for c in col for r in row]
+
+
+kernels = {
+    "box3": (1,) * 9,
+    "box5x2": (2,) * 25,
+    "gauss3": outer((1, 2, 1), (1, 2, 1)),
+    "gauss7": outer((1, 6, 15, 20, 15, 6, 1), (1, 6, 15, 20, 15, 6, 1)),
+    "sobel": outer((1, 2, 1), (-1, 0, 1)),
+    "negcol": outer((-1, 3, -1), (2, 1, 2)),
+    "asym": outer((1, 0, 2), (3, 1, 2)),
+    "laplace": (0, -1, 0, -1, 4, -1, 0, -1, 0),
+    "one": (3,),
+}
+
+for w, h in ((9, 8), (2, 3), (1, 1)):
+    for name, krn in kernels.items():
+        for mask in (None, make_mask(w, h)):
+            s = sum(krn)
+            mul = 1 / s if s else 1 / 4
+            add = 0.5 if s == 0 else 0
+            b = make_bitmap(w, h, len(krn) + w)
+            expected = reference(b, krn, mul, add, mask)
+            bitmapfilter.morph(b, krn, mul=mul, add=add, mask=mask)
+            bad = sum(1 for i in range(w * h) if b[i] != expected[i])
+            print(w, h, name, mask is not None, bad)
@@ -0,0 +1,71 @@
+from displayio import Bitmap, Palette
+import bitmapfilter
+
+
+def make_bitmap(w, h, seed):
+    b = Bitmap(w, h, 65536)
+    for i in range(w * h):
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+        b[i] = seed >> 8 & 0xFFFF
+    return b
+
+
+def make_mask(w, h):
+    b = Bitmap(w, h, 2)
+    for y in range(h):
+        for x in range(w):
+            b[x, y] = (x * 3 + y) % 5 == 0
+    return b
+
+
+def same(a, b):
+    return all(a[i] == b[i] for i in range(a.width * a.height))
+
+
+blur = (1, 2, 1, 2, 4, 2, 1, 2, 1)
+sharpen = (-1, -1, -1, -1, 9, -1, -1, -1, -1)
+box5 = (1,) * 25
+palette = Palette(256)
+for i in range(256):
+    palette[i] = i * 0x10203 & 0xFFFFFF
+sepia = bitmapfilter.ChannelMixer(0.393, 0.769, 0.189, 0.349, 0.686, 0.168, 0.272, 0.534, 0.131)
+gamma = (lambda x: x * x, lambda x: x, lambda x: 1 - x)
+
+chains = (
+    ((bitmapfilter.mix, sepia), (bitmapfilter.solarize, 0.4)),
+    ((bitmapfilter.morph, blur),),
+    ((bitmapfilter.morph, box5, None, 0.1),),
+    ((bitmapfilter.lookup, gamma), (bitmapfilter.morph, blur), (bitmapfilter.false_color, palette)),
+    ((bitmapfilter.morph, blur), (bitmapfilter.morph, box5), (bitmapfilter.morph, sharpen)),
+    (
+        (bitmapfilter.solarize,),
+        (bitmapfilter.morph, sharpen, None, 0.125, {"threshold": True, "offset": -4}),
+        (bitmapfilter.mix, bitmapfilter.ChannelScale(0.5, 1, 1)),
+    ),
+    (),
+)
+
+for w, h in ((13, 11), (3, 2), (1, 7)):
+    for use_mask in (False, True):
+        mask = make_mask(w, h) if use_mask else None
+        for n, chain in enumerate(chains):
+            expected = make_bitmap(w, h, n)
+            for step in chain:
+                kwargs = step[-1] if isinstance(step[-1], dict) else {}
+                posargs = step[1 : len(step) - (1 if kwargs else 0)]
+                step[0](expected, *posargs, mask=mask, **kwargs)
+            b = make_bitmap(w, h, n)
+            print(w, h, use_mask, n, same(bitmapfilter.pipeline(b, chain, mask=mask), expected))
+
+b = make_bitmap(4, 4, 0)
+for steps in (
+    ((bitmapfilter.blend,),),
+    ((),),
+    ((bitmapfilter.solarize, 0.5, make_mask(4, 4)),),
+    (1,),
+    ((bitmapfilter.solarize,) + (0.5,) * 1000,),
+):
+    try:
+        bitmapfilter.pipeline(b, steps)
+    except (TypeError, ValueError) as e:
+        print(type(e).__name__)
@@ -0,0 +1,86 @@
+# Check bitmaptools.blit against a pixel by pixel copy, across the depths,
+# alignments, skip indices and overlapping copies that pick different paths.
+import displayio
+import bitmaptools
+
+seed = 1
+
+
+def rand(n):
+    global seed
+    seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+    return (seed >> 8) % n
+
+
+def make(w, h, depth):
+    bmp = displayio.Bitmap(w, h, 1 << depth)
+    for j in range(h):
+        for i in range(w):
+            bmp[i, j] = rand(min(1 << depth, 5))
+    return bmp
+
+
+def copy(bmp):
+    out = displayio.Bitmap(bmp.width, bmp.height, 1 << bmp.bits_per_value)
+    for j in range(bmp.height):
+        for i in range(bmp.width):
+            out[i, j] = bmp[i, j]
+    return out
+
+
+def reference(dest, src, x, y, x1, y1, x2, y2, skip_source, skip_dest):
+    src = copy(src)
+    for j in range(y2 - y1):
+        for i in range(x2 - x1):
+            if x + i >= dest.width or y + j >= dest.height:
+                continue
+            value = src[x1 + i, y1 + j]
+            if value == skip_source or dest[x + i, y + j] == skip_dest:
+                continue
+            dest[x + i, y + j] = value
+
+
+def same(a, b):
+    return all(a[i, j] == b[i, j] for j in range(a.height) for i in range(a.width))
+
+
+failures = 0
+cases = 0
+for depth, src_depth in ((1, 1), (2, 2), (4, 4), (8, 8), (16, 16), (8, 4), (16, 1)):
+    for trial in range(60):
+        w = 1 + rand(70)
+        h = 1 + rand(6)
+        src = make(w, h, src_depth)
+        dest = make(1 + rand(70), 1 + rand(6), depth)
+        if trial % 5 == 0 and depth == src_depth:
+            src = dest  # copy within one bitmap
+        x1 = rand(src.width)
+        y1 = rand(src.height)
+        x2 = x1 + 1 + rand(src.width - x1)
+        y2 = y1 + 1 + rand(src.height - y1)
+        x = rand(dest.width)
+        if trial % 3 == 0 and x1 % 32 < dest.width:
+            # Start at the same bit within a word as the source.
+            x = x1 % 32
+        y = rand(dest.height)
+        skip_source = rand(3) if trial % 3 == 1 else None
+        skip_dest = rand(3) if trial % 4 == 2 else None
+        expected = copy(dest)
+        reference(expected, src, x, y, x1, y1, x2, y2, skip_source, skip_dest)
+        bitmaptools.blit(
+            dest,
+            src,
+            x,
+            y,
+            x1=x1,
+            y1=y1,
+            x2=x2,
+            y2=y2,
+            skip_source_index=skip_source,
+            skip_dest_index=skip_dest,
+        )
+        cases += 1
+        if not same(dest, expected):
+            failures += 1
+            print("mismatch", depth, src_depth, w, h, x, y, x1, y1, x2, y2, skip_source, skip_dest)
+print(cases, "cases", failures, "failures")
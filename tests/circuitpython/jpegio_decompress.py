@@ -130,3 +130,80 @@ test(content, scale=3, x=12, y=16, x1=8, y1=12, x2=16, y2=16)
 
 print("color key")
 test(content, scale=0, skip_source_index=0x4529, fill=0)
+
+
+def test_rows(jpeg_input, scale, **crop):
+    w, h = decoder.open(jpeg_input)
+    w >>= scale
+    h >>= scale
+    full = Bitmap(w, h, 65535)
+    decoder.decode(full, scale=scale)
+
+    x1 = crop.get("x1", 0)
+    y1 = crop.get("y1", 0)
+    x2 = crop.get("x2", w)
+    y2 = crop.get("y2", h)
+    refb = Bitmap(max(1, x2 - x1), max(1, y2 - y1), 65535)
+    bitmaptools.blit(refb, full, 0, 0, x1=x1, y1=y1, x2=x2, y2=y2)
+
+    b = Bitmap(refb.width, refb.height, 65535)
+    bands = []
+
+    def callback(band, y):
+        bands.append((band.width, band.height, y))
+        bitmaptools.blit(b, band, 0, y)
+
+    if isinstance(jpeg_input, io.BytesIO):
+        jpeg_input.seek(0)
+    decoder.open(jpeg_input)
+    decoder.decode_rows(callback, scale=scale, **crop)
+    print(len(bands), bands[:2], bands[-1:], f"{memoryview(refb) == memoryview(b)=}")
+
+
+print("decode_rows")
+test_rows(content, scale=0)
+test_rows(content, scale=1)
+test_rows(content, scale=2)
+test_rows(content, scale=3)
+test_rows(content, scale=0, x1=17, y1=5, x2=101, y2=77)
+test_rows(content, scale=1, x1=64, x2=65)
+test_rows(content, scale=3, y1=29)
+test_rows(io.BytesIO(content), scale=2, x1=3, y1=7, x2=40, y2=41)
+test_rows(content, scale=0, x1=10, x2=10)
+
+
+def fail(band, y):
+    raise ValueError(y)
+
+
+decoder.open(content)
+try:
+    decoder.decode_rows(fail)
+except ValueError as e:
+    print("ValueError", e)
+try:
+    decoder.decode_rows(fail)
+except RuntimeError as e:
+    print("RuntimeError", e)
+
+
+# The decoder can't be used again from inside a decode_rows() callback.
+def reenter(band, y):
+    for name, call in (
+        ("open", lambda: decoder.open(content)),
+        ("decode", lambda: decoder.decode(Bitmap(240, 240, 65535))),
+        ("decode_rows", lambda: decoder.decode_rows(reenter)),
+    ):
+        try:
+            call()
+        except RuntimeError as e:
+            print(name, "RuntimeError", e)
+    raise ValueError(y)
+
+
+decoder.open(content)
+try:
+    decoder.decode_rows(reenter)
+except ValueError as e:
+    print("ValueError", e)
+print(decoder.open(content))
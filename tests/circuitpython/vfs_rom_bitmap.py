@@ -0,0 +1,89 @@
+# Test zero-copy Bitmaps backed by files in a ROMFS image.
+
+try:
+    import os, sys
+
+    os.VfsRom
+    import displayio
+
+    # Build the images with the same packer as CIRCUITPY's ROMFS.
+    sys.path.append("../../tools")
+    from romfs_pack import RomfsPacker
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+def make_romfs(files):
+    packer = RomfsPacker()
+    tree = b"".join(packer.file_record(name, contents) for name, contents in files)
+    return packer.finalise(tree)
+
+
+# An 8x2 bitmap with 8 bits per value.
+src = displayio.Bitmap(8, 2, 256)
+for i in range(16):
+    src[i] = i * 3
+image = bytearray(make_romfs((("odd", b"x"), ("sprite.bin", bytes(src)), ("wave", b"\x01\x00\xff\xff"))))
+
+os.mount(os.VfsRom(image), "/rom")
+print(sorted(os.listdir("/rom")))
+
+with open("/rom/sprite.bin", "rb") as f:
+    bmp = displayio.Bitmap(8, 2, 256, buffer=f)
+print(bmp.width, bmp.height, bmp.bits_per_value)
+print([bmp[i] for i in range(16)])
+
+# ROM data makes a read-only bitmap.
+try:
+    bmp[0] = 1
+except RuntimeError:
+    print("read-only")
+
+# The bitmap reads the image in place rather than a copy.
+image[image.find(bytes(src)) + 5] = 99
+print(bmp[5], bmp.width)
+
+# Waveform data can be reinterpreted without copying too.
+with open("/rom/wave", "rb") as f:
+    print(list(memoryview(f).cast("h")))
+
+os.umount("/rom")
+
+# A writable buffer gives a writable bitmap sharing its storage.
+storage = bytearray(8)
+bmp = displayio.Bitmap(4, 2, 16, buffer=storage)
+bmp[1, 1] = 7
+print(storage != bytearray(8), bmp[1, 1])
+
+try:
+    displayio.Bitmap(8, 2, 256, buffer=bytearray(15))
+except ValueError:
+    print("ValueError short")
+
+try:
+    displayio.Bitmap(4, 1, 256, buffer=memoryview(bytearray(12))[1:9])
+except ValueError:
+    print("ValueError aligned")
+
+# Filters and drawing functions that write the data directly refuse too, and
+# leave the buffer alone.
+import bitmapfilter, bitmaptools
+
+data = bytes(32)
+ro = displayio.Bitmap(4, 4, 65536, buffer=data)
+rw = displayio.Bitmap(4, 4, 65536)
+for name, fun in (
+    ("lookup", lambda: bitmapfilter.lookup(ro, lambda x: 1.0)),
+    ("morph", lambda: bitmapfilter.morph(ro, (0, 0, 0, 0, 1, 0, 0, 0, 0))),
+    ("blend", lambda: bitmapfilter.blend(ro, rw, rw, bitmapfilter.blend_precompute(lambda a, b: a))),
+    ("rotozoom", lambda: bitmaptools.rotozoom(ro, rw)),
+    ("dither", lambda: bitmaptools.dither(ro, rw, displayio.Colorspace.RGB565)),
+    ("alphablend", lambda: bitmaptools.alphablend(ro, rw, rw, displayio.Colorspace.RGB565)),
+    ("fill_region", lambda: bitmaptools.fill_region(ro, 0, 0, 2, 2, 1)),
+):
+    try:
+        fun()
+    except RuntimeError:
+        print(name, "read-only")
+print(data == bytes(32))
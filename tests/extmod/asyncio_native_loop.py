@@ -0,0 +1,182 @@
+# Test the native _asyncio.IOQueue and run_until_complete with a minimal core.
+
+try:
+    import io, time
+    from _asyncio import Task, TaskQueue, IOQueue, run_until_complete
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+# Module globals act as the asyncio core context.
+class CancelledError(BaseException):
+    pass
+
+
+class Loop:
+    @staticmethod
+    def call_exception_handler(context):
+        print("handler", repr(context["exception"]))
+
+
+_exc_context = {}
+_task_queue = TaskQueue()
+_io_queue = IOQueue()
+cur_task = None
+
+
+class SingletonGenerator:
+    def __iter__(self):
+        return self
+
+    def __await__(self):
+        return self
+
+    def __next__(self):
+        if self.exc is None:
+            self.exc = StopIteration
+            return None
+        raise self.exc
+
+
+def yield_now():
+    # Reschedule the current task to run again now.
+    _task_queue.push(cur_task)
+    g = SingletonGenerator()
+    g.exc = None
+    return g
+
+
+def sleep_ms(ms):
+    # ph_key uses 29-bit ticks.
+    _task_queue.push(cur_task, (time.ticks_ms() + ms) & ((1 << 29) - 1))
+    g = SingletonGenerator()
+    g.exc = None
+    return g
+
+
+def create_task(coro):
+    t = Task(coro, globals())
+    _task_queue.push(t)
+    return t
+
+
+# A stream whose readiness is controlled by the test.
+class Pipe(io.IOBase):
+    def __init__(self):
+        self.data = []
+
+    def ioctl(self, req, arg):
+        if req == 3:  # MP_STREAM_POLL
+            ret = 0
+            if arg & 1 and self.data:
+                ret |= 1
+            if arg & 4:
+                ret |= 4
+            return ret
+        return -22  # EINVAL, so it has no file descriptor
+
+
+class Awaitable:
+    def __init__(self, gen):
+        self.gen = gen
+
+    def __await__(self):
+        return self.gen
+
+
+def _read(p):
+    while not p.data:
+        yield _io_queue.queue_read(p)
+    return p.data.pop(0)
+
+
+def read(p):
+    return Awaitable(_read(p))
+
+
+def _write(p, x):
+    yield _io_queue.queue_write(p)
+    p.data.append(x)
+
+
+def write(p, x):
+    return Awaitable(_write(p, x))
+
+
+def _wait_ready(s, idx, woken):
+    yield _io_queue.queue_write(s) if idx else _io_queue.queue_read(s)
+    woken.append(idx)
+
+
+async def producer(p, n):
+    for i in range(n):
+        await write(p, i)
+        await yield_now()
+        await yield_now()
+
+
+async def consumer(name, p, n):
+    total = 0
+    for _ in range(n):
+        total += await read(p)
+    print(name, "got", total)
+    return total
+
+
+async def fail():
+    raise ValueError("detached")
+
+
+async def main():
+    p = Pipe()
+    c = create_task(consumer("c", p, 10))
+    create_task(producer(p, 10))
+    create_task(fail())
+    print("main result", await c)
+    print("waiting", len(_io_queue), bool(_io_queue))
+
+    # A cancelled reader is removed from the IOQueue.
+    t = create_task(_read(Pipe()))
+    await yield_now()
+    print("waiting", len(_io_queue))
+    t.cancel()
+    await yield_now()
+    print("waiting", len(_io_queue), t.done())
+
+    # A stream with a file descriptor, waited on for reading and writing at once.
+    woken = []
+    with open(__file__, "rb") as f:
+        create_task(_wait_ready(f, 0, woken))
+        create_task(_wait_ready(f, 1, woken))
+        await sleep_ms(20)
+    print("file ready", sorted(woken), len(_io_queue))
+
+    # Sleeping with no IO waiters.
+    t0 = time.ticks_ms()
+    await sleep_ms(20)
+    print("slept", time.ticks_diff(time.ticks_ms(), t0) >= 20)
+    return "done"
+
+
+print(run_until_complete(create_task(main())))
+
+# The loop returns once nothing is left to run.
+print(run_until_complete())
+print(cur_task)
+
+
+# The main task's exception propagates.
+async def main_fail():
+    raise KeyError("main")
+
+
+try:
+    run_until_complete(create_task(main_fail()))
+except KeyError as er:
+    print("KeyError", er)
+
+try:
+    IOQueue().queue_read(1)
+except (OSError, TypeError):
+    print("not a stream")
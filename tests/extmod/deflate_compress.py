@@ -152,3 +152,16 @@ for wbits in range(5, 10):
 # at the start of the bytes.
 compressed = compress(b"1234567890abcdefghijklmnopqrstuvwxyz123123", deflate.RAW)
 print(len(compressed), compressed)
+
+# Compression levels: 0 is a brute force search of the window, 1-9 use hash
+# chains with increasing search effort.
+compress_error(unpacked, deflate.RAW, 8, False, -1)
+compress_error(unpacked, deflate.RAW, 8, False, 10)
+log = "".join("%d INFO sensor[%d] temp=%d\n" % (i * 37, i % 5, 200 + i * 7 % 13) for i in range(100))
+log = log.encode()
+sizes = []
+for level in range(10):
+    result = compress(log, deflate.RAW, 10, False, level)
+    sizes.append(len(result))
+    print(level, decompress(result, deflate.RAW, 10) == log)
+print(sizes[9] <= sizes[1] < len(log) // 2)
@@ -0,0 +1,42 @@
+# Test search, split and sub on patterns that begin with literal characters,
+# including ones where a later construct changes what the literals require.
+
+try:
+    import re
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+subject = "x" * 40 + "OK +CSQ: 21,99\r\nERROR\r\n" + "y" * 5
+patterns = (
+    "OK",
+    r"\+CSQ: (\d+),(\d+)",
+    "ERROR\r\n",
+    "ab+c",
+    "a(bc)+d",
+    "abc?",
+    "bc|ab",
+    "(a|b)c",
+    "xO",
+    "y+$",
+    "^x",
+    "ZZ",
+)
+for p in patterns:
+    for s in (subject, "abbbc abcbcd bc ac zzz", "", "a"):
+        m = re.search(p, s)
+        print(repr(p), m and m.group(0))
+
+print(re.compile("xO").search(subject, 10) is not None)
+print(re.compile(b"OK").search(b"aaOKaOK").group(0))
+print(re.compile("ab").split("xabyabz"))
+print(re.compile(", ").split("a, b, c, d", 2))
+
+try:
+    re.sub
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+print(re.sub("ab", "-", "xabyabzab"))
+print(re.sub(r"OK(\d)", r"<\1>", "OK1 OK2 OK OK3", 2))
@@ -0,0 +1,127 @@
+# Test select.poll with a mix of file-descriptor and ioctl-only objects,
+# including changes to the set while results are being iterated.
+
+try:
+    import io, select, sys
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    io.IOBase
+    select.poll
+    sys.stdout.fileno
+    zero = open("/dev/zero", "rb")
+    rnd = None
+except (AttributeError, OSError):
+    print("SKIP")
+    raise SystemExit
+
+
+# A stream whose readiness is controlled by the test.
+class Stream(io.IOBase):
+    def __init__(self, name):
+        self.name = name
+        self.ready = 0
+
+    def ioctl(self, req, arg):
+        if req == 3:  # MP_STREAM_POLL
+            return self.ready & arg
+        return -1
+
+
+def name(o):
+    if o is sys.stdout:
+        return "stdout"
+    if o is zero:
+        return "zero"
+    if o is rnd:
+        return "rnd"
+    return o.name
+
+
+def show(res):
+    print(sorted((name(o), ev) for o, ev in res))
+
+
+s1 = Stream("s1")
+s2 = Stream("s2")
+
+# stdout is always writable, /dev/zero always readable.
+p = select.poll()
+p.register(s1, select.POLLIN)
+p.register(s2, select.POLLIN | select.POLLOUT)
+p.register(sys.stdout, 0)
+p.register(zero, 0)
+
+# Nothing ready.
+show(p.poll(0))
+
+# Only ioctl objects ready.
+s1.ready = select.POLLIN
+s2.ready = select.POLLOUT
+show(p.poll(0))
+
+# File descriptors become ready; results from the previous poll are not repeated.
+s1.ready = s2.ready = 0
+p.modify(sys.stdout, select.POLLOUT)
+show(p.poll(0))
+p.modify(zero, select.POLLIN)
+show(p.poll(1000))
+p.modify(sys.stdout, 0)
+show(p.poll(0))
+p.modify(zero, 0)
+show(p.poll(0))
+
+# Unregister the other objects while iterating the results of ipoll.
+p.modify(sys.stdout, select.POLLOUT)
+p.modify(zero, select.POLLIN)
+s1.ready = s2.ready = select.POLLIN
+n = 0
+for o, ev in p.ipoll(0):
+    if n == 0:
+        for other in (s1, s2, sys.stdout, zero):
+            if other is not o:
+                p.unregister(other)
+    n += 1
+print("ipoll count", n)
+
+# Register everything again.
+p.register(s1, select.POLLIN)
+p.register(s2, select.POLLIN)
+p.register(sys.stdout, select.POLLOUT)
+p.register(zero, select.POLLIN)
+show(p.poll(0))
+
+# One-shot mode disables an object until it is modified.
+show(p.ipoll(0, 1))
+show(p.poll(0))
+p.modify(sys.stdout, select.POLLOUT)
+show(p.poll(0))
+
+# Many objects, of which a few are ready.
+p = select.poll()
+streams = [Stream("m%d" % i) for i in range(100)]
+for st in streams:
+    p.register(st, select.POLLIN)
+p.register(sys.stdout, select.POLLOUT)
+streams[7].ready = streams[93].ready = select.POLLIN
+show(p.poll(0))
+p.unregister(sys.stdout)
+show(p.poll(0))
+
+# An object closed while registered, whose fd number is then reused by another
+# object: modifying or unregistering the closed one must leave the new one be.
+p = select.poll()
+rnd = open("/dev/random", "rb")
+closed = rnd
+p.register(closed, select.POLLIN)
+closed.close()
+rnd = open("/dev/random", "rb")
+p.register(rnd, select.POLLIN)
+p.modify(closed, 0)
+p.unregister(closed)
+show(p.poll(0))
+rnd.close()
+
+zero.close()
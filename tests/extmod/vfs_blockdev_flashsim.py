@@ -0,0 +1,92 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test the unix port's simulated flash block device.
+try:
+    import flashsim
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+def stats(dev):
+    s = dev.stats()
+    return sorted(s.items())
+
+
+# NOR flash with erase sectors as blocks, used through the extended protocol.
+dev = flashsim.BlockDevice(8, block_size=4096, erase_size=4096, page_size=256)
+print(dev.ioctl(4, 0), dev.ioctl(5, 0))
+buf = bytearray(4)
+dev.readblocks(1, buf, 10)
+print(buf)
+
+# Programming can only clear bits.
+dev.writeblocks(1, b"\x0f\x3c", 10)
+dev.writeblocks(1, b"\xf0\x3c", 10)
+dev.readblocks(1, buf, 10)
+print(buf, dev.stats()["overwrites"])
+
+# Erasing brings it back.
+print(dev.ioctl(6, 1))
+dev.readblocks(1, buf, 10)
+print(buf, dev.wear(), dev.wear(1))
+
+# Writes across a page boundary are charged for both pages.
+dev.reset_stats()
+dev.writeblocks(2, b"ab", 255)
+print(stats(dev))
+
+# Out of range.
+try:
+    dev.readblocks(8, buf)
+except OSError as er:
+    print("OSError")
+
+# 512 byte blocks on 4096 byte sectors: plain writes go through a write-back
+# cache of whole sectors, which is written out on sync or eviction. The rest
+# of a sector is only read in then, so writing all of it reads nothing.
+dev = flashsim.BlockDevice(64, erase_size=4096, cache_sectors=2, command_us=1, read_us=10, program_us=100, erase_us=1000)
+block = bytearray(512)
+for i in range(8):
+    block[0] = i
+    dev.writeblocks(i, block)
+print(stats(dev), dev.wear())
+dev.ioctl(3, 0)
+print(stats(dev), dev.wear())
+
+# A block smaller than a sector can't be erased on its own.
+print(dev.ioctl(6, 1))
+
+# Reads are served from the cache when they can be.
+dev.reset_stats()
+dev.readblocks(3, block)
+print(block[0], stats(dev))
+dev.readblocks(9, block)
+print(stats(dev))
+
+# A third sector evicts the least recently used of the two cached.
+dev.reset_stats()
+dev.writeblocks(8, block)
+dev.writeblocks(16, block)
+dev.writeblocks(24, block)
+print(stats(dev), dev.wear(1), dev.wear(2), dev.wear(3))
+dev.ioctl(3, 0)
+print(dev.wear())
+
+# Without a cache every block write rewrites its sector.
+dev = flashsim.BlockDevice(16, erase_size=4096, cache_sectors=0)
+dev.writeblocks(0, bytearray(1024))
+print(stats(dev))
+
+# An SD card needs no erasing and overwrites in place.
+dev = flashsim.BlockDevice(16, erase_size=0, page_size=512, command_us=100, read_us=50, program_us=250)
+dev.readblocks(0, block)
+print(block[:4])
+dev.writeblocks(0, b"\xff" * 512)
+dev.writeblocks(0, b"\x00" * 512)
+dev.readblocks(0, block)
+print(block[:4], stats(dev), dev.wear())
+
+try:
+    flashsim.BlockDevice(10, erase_size=4096)
+except ValueError:
+    print("ValueError")
@@ -0,0 +1,121 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test the external flash translation layer (supervisor/shared/external_flash/ftl.c)
+# on the unix port's simulated flash, including losing power part way through
+# a program or erase.
+try:
+    import flashsim, random
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# 32 erase sectors, 8 of them kept spare.
+dev = flashsim.BlockDevice(32 * 8, cache_sectors=0)
+
+# The translation layer needs the driver's geometry, uncached.
+for bad in (
+    flashsim.BlockDevice(32 * 8),
+    flashsim.BlockDevice(32 * 8, cache_sectors=0, erase_size=8192),
+    flashsim.BlockDevice(8 * 8, cache_sectors=0),
+):
+    try:
+        flashsim.FTL(bad)
+    except ValueError:
+        print("ValueError")
+
+ftl = flashsim.FTL(dev)
+n = ftl.ioctl(4, 0)
+print(n, ftl.ioctl(5, 0))
+
+# Blank flash reads as erased, and blocks survive a remount.
+buf = bytearray(512)
+ftl.readblocks(0, buf)
+print(buf == b"\xff" * 512)
+ftl.writeblocks(0, b"a" * 512 + b"b" * 512)
+ftl.mount()
+buf2 = bytearray(1024)
+ftl.readblocks(0, buf2)
+print(buf2 == b"a" * 512 + b"b" * 512)
+
+# Out of range.
+for block in (-1, n):
+    try:
+        ftl.readblocks(block, buf)
+    except OSError as er:
+        print("OSError", er.errno)
+
+# Rewriting a block programs into the log instead of erasing its sector.
+dev.reset_stats()
+for i in range(20):
+    ftl.writeblocks(5, bytes([i]) * 512)
+print(dev.stats()["erases"], dev.stats()["overwrites"])
+
+# Losing power during each step of a write leaves either the old or the new
+# data, and the other blocks alone.
+for ops in range(8):
+    ftl.cut_power(ops)
+    try:
+        ftl.writeblocks(1, bytes([ops]) * 512)
+        done = True
+    except OSError:
+        done = False
+    powered = ftl.powered()
+    ftl.mount()
+    ftl.readblocks(0, buf2)
+    new = buf2[512:] == bytes([ops]) * 512
+    print(ops, done, powered, new, buf2[:512] == b"a" * 512)
+    if not new:
+        ftl.writeblocks(1, bytes([ops]) * 512)
+
+
+# Random writes to a hot set of blocks and a few cold ones, with the power
+# cut at random points, garbage collection included.
+def soak(seed, iterations):
+    random.seed(seed)
+    model = [None] * n
+    for b in range(n):
+        ftl.readblocks(b, buf)
+        model[b] = bytes(buf)
+    lost = 0
+    cuts = 0
+    for it in range(iterations):
+        op = random.randrange(100)
+        b = random.randrange(n) if random.randrange(20) == 0 else random.randrange(16)
+        data = None
+        if random.randrange(100) == 0:
+            ftl.cut_power(random.randrange(40))
+        try:
+            if op < 50:
+                data = bytes([random.getrandbits(8), it & 0xFF]) * 256
+                ftl.writeblocks(b, data)
+                model[b] = data
+            elif op < 95:
+                ftl.readblocks(b, buf)
+                if buf != model[b]:
+                    lost += 1
+            elif ftl.ioctl(3, 0):
+                raise OSError
+        except OSError:
+            cuts += 1
+            ftl.mount()
+            for x in range(n):
+                ftl.readblocks(x, buf)
+                if buf == model[x]:
+                    continue
+                if data is not None and x == b and buf == data:
+                    model[x] = data
+                else:
+                    lost += 1
+                    model[x] = bytes(buf)
+    ftl.mount()
+    for x in range(n):
+        ftl.readblocks(x, buf)
+        if buf != model[x]:
+            lost += 1
+    return lost, cuts > 0
+
+
+print(soak(1, 3000))
+print(soak(2, 3000))
+
+# All sectors take their turn.
+print(dev.wear()[0] > 0)
@@ -0,0 +1,106 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Replay USB mass storage traces against the simulated flash, as the MSC
+# callbacks would, to compare how many flash operations they turn into. The
+# sector cache is flashsim's model of the external flash driver's: blocks are
+# loaded lazily, and reading past a cached sector doesn't make it recently used.
+try:
+    import flashsim, os
+
+    os.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+BLOCK_COUNT = 1024
+
+
+# A sparse ram disk that records every command it is given, like a host's
+# view of the drive.
+class RecordingDev:
+    def __init__(self):
+        self.blocks = {}
+        self.trace = []
+
+    def block(self, n):
+        return self.blocks.get(n, bytes(512))
+
+    def readblocks(self, n, buf):
+        self.trace.append(("r", n, len(buf) // 512))
+        for i in range(len(buf) // 512):
+            buf[i * 512 : (i + 1) * 512] = self.block(n + i)
+
+    def writeblocks(self, n, buf):
+        self.trace.append(("w", n, len(buf) // 512))
+        for i in range(len(buf) // 512):
+            self.blocks[n + i] = bytes(buf[i * 512 : (i + 1) * 512])
+
+    def ioctl(self, op, arg):
+        if op == 4:  # MP_BLOCKDEV_IOCTL_BLOCK_COUNT
+            return BLOCK_COUNT
+        if op == 5:  # MP_BLOCKDEV_IOCTL_BLOCK_SIZE
+            return 512
+
+
+# Build a trace: format, then copy a 128KB library and a few small files on.
+host = RecordingDev()
+os.VfsFat.mkfs(host)
+image = dict(host.blocks)
+host.trace = []
+fs = os.VfsFat(host)
+fs.mount(False, False)
+fs.mkdir("/lib")
+chunk = bytes(i & 0xFF for i in range(4096))
+with fs.open("/lib/bundle.mpy", "wb") as f:
+    for i in range(32):
+        f.write(chunk)
+for i in range(8):
+    with fs.open("/lib/mod%d.py" % i, "w") as f:
+        f.write("x = %d\n" % i * 20)
+fs.umount()
+
+trace = host.trace
+
+# Then read the whole drive back the way a host does, with large READ10s.
+for lba in range(0, BLOCK_COUNT, 128):
+    trace.append(("r", lba, 128))
+print("trace", len(trace), [sum(c for op, lba, c in trace if op == rw) for rw in "rw"])
+
+
+# TinyUSB hands the data over one endpoint buffer at a time, and each buffer
+# becomes a single readblocks or writeblocks call.
+def replay(dev, trace, bufsize):
+    per_call = bufsize // 512
+    buf = bytearray(bufsize)
+    for op, lba, count in trace:
+        while count > 0:
+            n = min(count, per_call)
+            mv = memoryview(buf)[: n * 512]
+            if op == "r":
+                dev.readblocks(lba, mv)
+            else:
+                for i in range(n):
+                    mv[i * 512 : (i + 1) * 512] = host.block(lba + i)
+                dev.writeblocks(lba, mv)
+            lba += n
+            count -= n
+    dev.ioctl(3, 0)  # MP_BLOCKDEV_IOCTL_SYNC
+
+
+for cache in (1, 4):
+    for bufsize in (512, 4096):
+        dev = flashsim.BlockDevice(
+            BLOCK_COUNT, cache_sectors=cache, command_us=10, read_us=50, program_us=400, erase_us=45000
+        )
+        for n in image:
+            dev.writeblocks(n, image[n])
+        dev.ioctl(3, 0)
+        dev.reset_stats()
+        replay(dev, trace, bufsize)
+        s = dev.stats()
+        print(cache, bufsize, s["commands"], s["erases"], s["programs"], s["elapsed_us"])
+
+        # The replayed image is what the host wrote.
+        vfs = os.VfsFat(dev)
+        with vfs.open("/lib/bundle.mpy", "rb") as f:
+            ok = all(f.read(4096) == chunk for i in range(32))
+        print(ok, vfs.open("/lib/mod7.py", "r").read(5), len(list(vfs.ilistdir("/lib"))))
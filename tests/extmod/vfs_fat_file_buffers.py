@@ -0,0 +1,112 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test VfsFat.file_buffers, which gives each open file its own sector buffer.
+import os
+
+try:
+    os.VfsFat.file_buffers
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.reads = 0
+
+    def readblocks(self, n, buf):
+        self.reads += 1
+        buf[:] = self.data[n * self.SEC_SIZE : n * self.SEC_SIZE + len(buf)]
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE : n * self.SEC_SIZE + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # MP_BLOCKDEV_IOCTL_BLOCK_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # MP_BLOCKDEV_IOCTL_BLOCK_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(64)
+    os.VfsFat.mkfs(bdev)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+fs = os.VfsFat(bdev)
+os.mount(fs, "/ramdisk")
+os.chdir("/ramdisk")
+print(fs.file_buffers)
+
+data_a = bytes(range(256)) * 8
+data_b = bytes(range(255, -1, -1)) * 8
+with open("a", "wb") as f:
+    f.write(data_a)
+with open("b", "wb") as f:
+    f.write(data_b)
+
+
+# Read both files in small interleaved chunks, and count the sector reads.
+def interleaved_read():
+    out_a = bytearray()
+    out_b = bytearray()
+    with open("a", "rb") as fa, open("b", "rb") as fb:
+        bdev.reads = 0
+        while True:
+            x = fa.read(16)
+            y = fb.read(16)
+            if not x:
+                break
+            out_a.extend(x)
+            out_b.extend(y)
+    return out_a == data_a and out_b == data_b, bdev.reads
+
+
+ok, shared_reads = interleaved_read()
+print(ok)
+fs.file_buffers = True
+print(fs.file_buffers)
+ok, private_reads = interleaved_read()
+print(ok, private_reads, private_reads < shared_reads)
+
+# Interleaved writes, partial sector updates and appends with private buffers.
+with open("a", "r+b") as fa, open("b", "ab") as fb:
+    for i in range(64):
+        fa.seek(i * 31)
+        fa.write(b"A%02d" % i)
+        fb.write(b"B%02d" % i)
+    # Reading back through the file's own buffer sees unflushed data.
+    fa.seek(31)
+    print(fa.read(3))
+
+expect_a = bytearray(data_a)
+expect_b = bytearray(data_b)
+for i in range(64):
+    p = i * 31
+    expect_a[p : p + 3] = b"A%02d" % i
+    expect_b.extend(b"B%02d" % i)
+with open("a", "rb") as f:
+    d = f.read()
+print(len(d), d == expect_a)
+with open("b", "rb") as f:
+    d = f.read()
+print(len(d), d == expect_b)
+
+# Appending to a file whose last sector is in the shared window.
+fs.file_buffers = False
+with open("c", "wb") as f:
+    f.write(b"x" * 700)
+fs.file_buffers = True
+with open("c", "ab") as f:
+    f.write(b"y" * 10)
+with open("c", "rb") as f:
+    d = f.read()
+print(len(d), d[695:])
+
+fs.file_buffers = False
+print(fs.file_buffers)
+os.umount("/ramdisk")
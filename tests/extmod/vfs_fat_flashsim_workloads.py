@@ -0,0 +1,109 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Storage workloads on FAT over simulated flash and SD. The device counts
+# operations and charges typical latencies to a virtual clock, so the
+# figures here are deterministic and changes to FAT and the VFS show up as
+# changes to them. The flash driver's sector cache is modelled by flashsim,
+# not run, so changes to the driver itself don't.
+try:
+    import flashsim, os
+
+    os.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# 2MB of QSPI NOR: 4k erase sectors, 256 byte pages.
+NOR = {
+    "erase_size": 4096,
+    "page_size": 256,
+    "command_us": 2,
+    "read_us": 10,
+    "program_us": 400,
+    "erase_us": 45000,
+}
+# An SD card on SPI, which erases internally.
+SD = {
+    "erase_size": 0,
+    "page_size": 512,
+    "command_us": 100,
+    "read_us": 200,
+    "program_us": 800,
+}
+
+
+def report(name, dev):
+    s = dev.stats()
+    print(
+        "{:8} erases {:4} programs {:5} reads {:5} overwrites {} ms {}".format(
+            name, s["erases"], s["programs"], s["reads"], s["overwrites"], s["elapsed_us"] // 1000
+        )
+    )
+    dev.reset_stats()
+
+
+def log_small(n):
+    # Append a short line and flush it, as a data logger would.
+    with open("/fs/log.txt", "a") as f:
+        for i in range(n):
+            f.write("{:05d},{:05d}\n".format(i, i * 7 % 1000))
+            f.flush()
+
+
+def bulk_copy(size):
+    chunk = bytearray(512)
+    with open("/fs/src.bin", "wb") as f:
+        for i in range(size // len(chunk)):
+            chunk[0] = i & 0xFF
+            f.write(chunk)
+    with open("/fs/src.bin", "rb") as src, open("/fs/dst.bin", "wb") as dst:
+        while True:
+            n = src.readinto(chunk)
+            if not n:
+                break
+            dst.write(chunk[:n])
+
+
+def dir_listing(n):
+    os.mkdir("/fs/dir")
+    for i in range(n):
+        with open("/fs/dir/file{:03d}.txt".format(i), "w") as f:
+            f.write("x")
+    return n
+
+
+def list_dir():
+    total = 0
+    for name, *_ in os.ilistdir("/fs/dir"):
+        total += os.stat("/fs/dir/" + name)[6]
+    return total
+
+
+def run(name, blocks, **config):
+    print(name)
+    dev = flashsim.BlockDevice(blocks, **config)
+    os.VfsFat.mkfs(dev)
+    report("mkfs", dev)
+    os.mount(os.VfsFat(dev), "/fs")
+
+    log_small(200)
+    dev.ioctl(3, 0)
+    report("log", dev)
+
+    bulk_copy(64 * 1024)
+    dev.ioctl(3, 0)
+    report("copy", dev)
+
+    dir_listing(40)
+    dev.ioctl(3, 0)
+    report("mkfiles", dev)
+
+    print(list_dir())
+    report("listdir", dev)
+
+    os.umount("/fs")
+    print("wear", dev.wear())
+
+
+run("nor", 4096, cache_sectors=1, **NOR)
+run("nor cache 4", 4096, cache_sectors=4, **NOR)
+run("sd", 4096, **SD)
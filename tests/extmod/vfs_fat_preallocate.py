@@ -0,0 +1,134 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test reserving contiguous space for FAT files with preallocate().
+try:
+    import errno, os
+
+    os.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMBlockDevice:
+    ERASE_BLOCK_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.ERASE_BLOCK_SIZE)
+
+    def readblocks(self, block, buf):
+        addr = block * self.ERASE_BLOCK_SIZE
+        buf[:] = self.data[addr : addr + len(buf)]
+
+    def writeblocks(self, block, buf):
+        addr = block * self.ERASE_BLOCK_SIZE
+        self.data[addr : addr + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # block count
+            return len(self.data) // self.ERASE_BLOCK_SIZE
+        if op == 5:  # block size
+            return self.ERASE_BLOCK_SIZE
+
+
+try:
+    bdev = RAMBlockDevice(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+os.VfsFat.mkfs(bdev)
+vfs = os.VfsFat(bdev)
+f = vfs.open("/probe", "w")
+if not hasattr(f, "preallocate"):
+    f.close()
+    print("SKIP")
+    raise SystemExit
+f.close()
+vfs.remove("/probe")
+
+free = vfs.statvfs("/")[3]
+print("free", free)
+
+# Fragment the free space, so that a contiguous run has to be searched for.
+for i in range(6):
+    with vfs.open("/f%d" % i, "wb") as f:
+        f.write(b"x" * 1000)
+for i in range(0, 6, 2):
+    vfs.remove("/f%d" % i)
+print("free", vfs.statvfs("/")[3])
+
+# The reservation is taken at once, but the size follows the writes.
+with vfs.open("/log.bin", "wb") as f:
+    f.preallocate(20000)
+    print("reserved", vfs.statvfs("/")[3])
+    for i in range(100):
+        f.write(bytes([i]) * 100)
+    print(f.tell(), vfs.stat("/log.bin")[6])
+    f.flush()
+    print(vfs.stat("/log.bin")[6])
+    f.seek(50)
+    f.write(b"hello")
+    f.seek(0, 2)
+    print(f.tell())
+# Unused space is given back on close.
+print(vfs.stat("/log.bin")[6], "free", vfs.statvfs("/")[3])
+# A fresh mount counts the free clusters from the FAT itself.
+vfs = os.VfsFat(bdev)
+print("free", vfs.statvfs("/")[3])
+with vfs.open("/log.bin", "rb") as f:
+    data = f.read()
+print(len(data), data[45:60], all(data[i * 100 + 99] == i for i in range(100)))
+
+# Writing past the reservation carries on as usual.
+with vfs.open("/big.bin", "wb") as f:
+    f.preallocate(1000)
+    for i in range(5):
+        f.write(bytes([65 + i]) * 600)
+print(vfs.stat("/big.bin")[6])
+with vfs.open("/big.bin", "rb") as f:
+    data = f.read()
+print(all(data[i * 600 : i * 600 + 600] == bytes([65 + i]) * 600 for i in range(5)))
+
+# Seeking past what has been written moves into the reservation.
+with vfs.open("/gap.bin", "wb") as f:
+    f.preallocate(20000)
+    f.write(b"a" * 100)
+    f.seek(5000)
+    print(f.tell())
+    f.write(b"b")
+    print(f.tell())
+print(vfs.stat("/gap.bin")[6])
+with vfs.open("/gap.bin", "rb") as f:
+    data = f.read()
+print(data[:100] == b"a" * 100, data[5000:])
+vfs.remove("/gap.bin")
+
+# And past the reservation too.
+with vfs.open("/gap.bin", "wb") as f:
+    f.preallocate(5000)
+    f.write(b"a" * 100)
+    f.seek(6000)
+    f.write(b"c")
+print(vfs.stat("/gap.bin")[6])
+vfs.remove("/gap.bin")
+
+# Nothing written, nothing kept.
+with vfs.open("/empty.bin", "wb") as f:
+    f.preallocate(5000)
+print(vfs.stat("/empty.bin")[6])
+vfs.remove("/log.bin")
+vfs.remove("/big.bin")
+vfs.remove("/empty.bin")
+print("free", vfs.statvfs("/")[3], os.VfsFat(bdev).statvfs("/")[3])
+
+# Only empty, writable files can be preallocated, and only into space that exists.
+with vfs.open("/f1", "ab") as f:
+    try:
+        f.preallocate(100)
+    except OSError as er:
+        print("OSError", er.errno == errno.EINVAL)
+with vfs.open("/huge.bin", "wb") as f:
+    try:
+        f.preallocate(1000000)
+    except OSError as er:
+        print("OSError", er.errno == errno.ENOSPC)
@@ -0,0 +1,91 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test read-ahead buffering of FAT files, requested with open(..., buffering=N).
+try:
+    import os
+
+    os.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMBlockDevice:
+    ERASE_BLOCK_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.ERASE_BLOCK_SIZE)
+
+    def readblocks(self, block, buf):
+        addr = block * self.ERASE_BLOCK_SIZE
+        buf[:] = self.data[addr : addr + len(buf)]
+
+    def writeblocks(self, block, buf):
+        addr = block * self.ERASE_BLOCK_SIZE
+        self.data[addr : addr + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # block count
+            return len(self.data) // self.ERASE_BLOCK_SIZE
+        if op == 5:  # block size
+            return self.ERASE_BLOCK_SIZE
+
+
+try:
+    bdev = RAMBlockDevice(80)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+os.VfsFat.mkfs(bdev)
+vfs = os.VfsFat(bdev)
+os.mount(vfs, "/ramdisk")
+
+data = bytes(range(256)) * 40
+with open("/ramdisk/data.bin", "wb") as f:
+    f.write(data)
+with open("/ramdisk/lines.txt", "w") as f:
+    for i in range(300):
+        f.write("line %d\n" % i)
+
+# Small reads come out of the buffer, and add up to the file.
+with open("/ramdisk/data.bin", "rb", buffering=2048) as f:
+    chunks = []
+    while True:
+        chunk = f.read(37)
+        if not chunk:
+            break
+        chunks.append(chunk)
+    print(b"".join(chunks) == data, f.tell())
+
+# tell and seek account for what has been read ahead.
+with open("/ramdisk/data.bin", "rb", buffering=1024) as f:
+    print(f.read(10) == data[:10], f.tell())
+    f.seek(500)
+    print(f.read(4) == data[500:504], f.tell())
+    f.seek(-100, 1)
+    print(f.read(4) == data[404:408], f.tell())
+    f.seek(9000)
+    print(f.read(4) == data[9000:9004], f.tell())
+    f.seek(-6, 2)
+    print(f.read(100) == data[-6:], f.tell())
+    # Reads bigger than the buffer go straight to the file.
+    f.seek(10)
+    print(f.read(3000) == data[10:3010], f.tell())
+
+# Text files and readline.
+with open("/ramdisk/lines.txt", "r", buffering=512) as f:
+    lines = f.readlines()
+    print(len(lines), lines[0], lines[-1])
+
+# Writing lands where the reader is, not where the buffer got to.
+with open("/ramdisk/data.bin", "r+b", buffering=1024) as f:
+    f.read(100)
+    f.write(b"hello")
+    print(f.tell())
+    f.seek(95)
+    print(f.read(15))
+with open("/ramdisk/data.bin", "rb") as f:
+    f.seek(100)
+    print(f.read(5))
+
+os.umount("/ramdisk")
@@ -0,0 +1,101 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# Test that VfsFat answers repeated stats without rereading the disk, and that
+# writes invalidate what it remembers.
+try:
+    import errno, os
+
+    os.VfsFat
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMBlockDevice:
+    ERASE_BLOCK_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.ERASE_BLOCK_SIZE)
+        self.reads = 0
+
+    def readblocks(self, block, buf):
+        self.reads += 1
+        addr = block * self.ERASE_BLOCK_SIZE
+        for i in range(len(buf)):
+            buf[i] = self.data[addr + i]
+
+    def writeblocks(self, block, buf):
+        addr = block * self.ERASE_BLOCK_SIZE
+        for i in range(len(buf)):
+            self.data[addr + i] = buf[i]
+
+    def ioctl(self, op, arg):
+        if op == 4:  # block count
+            return len(self.data) // self.ERASE_BLOCK_SIZE
+        if op == 5:  # block size
+            return self.ERASE_BLOCK_SIZE
+
+
+try:
+    bdev = RAMBlockDevice(50)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+os.VfsFat.mkfs(bdev)
+vfs = os.VfsFat(bdev)
+vfs.mkdir("/lib")
+for i in range(20):
+    with vfs.open("/lib/module_with_long_name_%d.py" % i, "w") as f:
+        f.write("x" * i)
+
+
+def stat(path):
+    before = bdev.reads
+    try:
+        result = vfs.stat(path)[6]
+    except OSError as er:
+        result = errno.errorcode[er.errno]
+    return result, bdev.reads - before
+
+
+# The second stat of a path, found or not, comes from the cache.
+for path in ("/lib/module_with_long_name_19.py", "/lib/missing.mpy", "/lib"):
+    print(path, stat(path)[1] > 0, stat(path))
+
+# Listing a directory primes the cache for its most recent entries.
+vfs.chdir("/")
+print(len(list(vfs.ilistdir("/lib"))))
+print([stat("/lib/module_with_long_name_%d.py" % i) for i in (0, 19)])
+print(len(list(vfs.ilistdir("lib"))))
+print(stat("lib/module_with_long_name_5.py"))
+
+# Writes invalidate the cache.
+with vfs.open("/lib/missing.mpy", "w") as f:
+    f.write("abc")
+print(stat("/lib/missing.mpy"))
+with vfs.open("/lib/missing.mpy", "a") as f:
+    f.write("def")
+print(stat("/lib/missing.mpy"))
+vfs.remove("/lib/missing.mpy")
+print(stat("/lib/missing.mpy")[0])
+
+# So do creating, renaming and removing, even before anything is written.
+print(stat("/x")[0])
+f = vfs.open("/x", "w")
+print(stat("/x")[0], [e[0] for e in vfs.ilistdir("/") if e[0] == "x"])
+f.close()
+print(stat("/y")[0])
+vfs.rename("/x", "/y")
+print(stat("/x")[0], stat("/y")[0])
+vfs.remove("/y")
+print(stat("/y")[0])
+print(stat("/d")[0])
+vfs.mkdir("/d")
+print(stat("/d")[0])
+vfs.rmdir("/d")
+print(stat("/d")[0])
+
+# Relative paths are forgotten when the directory changes.
+print(stat("module_with_long_name_2.py")[0])
+vfs.chdir("/lib")
+print(stat("module_with_long_name_2.py")[0])
@@ -0,0 +1,190 @@
+# CIRCUITPY-CHANGE: micropython does not have this file
+# littlefs and FAT side by side on CIRCUITPY's storage: the cost of small
+# flushed appends, of mounting, and what survives losing power part way
+# through rewriting a file. littlefs is only offered on top of the external
+# flash translation layer, which writes each 512 byte sector out of place, so a
+# sector lands whole or not at all and never disturbs its neighbours. Both run
+# on flashsim.FTL, the translation layer itself on simulated NOR flash. The
+# flash charges typical latencies to a virtual clock, so the figures are
+# deterministic.
+try:
+    import flashsim, os
+
+    os.VfsFat
+    os.VfsLfs2
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# 1MB of QSPI NOR behind the translation layer: 256 byte pages, 4k sectors.
+NOR = {
+    "cache_sectors": 0,
+    "command_us": 2,
+    "read_us": 10,
+    "program_us": 400,
+    "erase_us": 45000,
+}
+SIZE = 1024 * 1024
+SECTOR = 512
+
+
+def report(name, dev):
+    s = dev.stats()
+    print(
+        "{:8} programs {:5} reads {:5} ms {}".format(
+            name, s["programs"], s["reads"], s["elapsed_us"] // 1000
+        )
+    )
+    dev.reset_stats()
+
+
+# Presents the sectors in blocks of block_size, as CIRCUITPY does for
+# littlefs, and hands each sector of a write to the device separately.
+# Erasing has nothing to do.
+class Sectors:
+    def __init__(self, dev, block_size):
+        self.dev = dev
+        self.block_size = block_size
+
+    def readblocks(self, block, buf, offset=0):
+        self.dev.readblocks((block * self.block_size + offset) // SECTOR, buf)
+
+    def writeblocks(self, block, buf, offset=0):
+        addr = block * self.block_size + offset
+        buf = memoryview(buf)
+        for i in range(0, len(buf), SECTOR):
+            self.dev.writeblocks((addr + i) // SECTOR, buf[i : i + SECTOR])
+
+    def ioctl(self, op, arg):
+        if op == 4:
+            return self.dev.ioctl(4, 0) * SECTOR // self.block_size
+        if op == 5:
+            return self.block_size
+        if op == 6:
+            return 0
+        return self.dev.ioctl(op, arg)
+
+
+# CIRCUITPY's littlefs reads and programs 512 byte sectors of 4k blocks.
+def fat_vfs(dev):
+    return os.VfsFat(Sectors(dev, SECTOR))
+
+
+def lfs_vfs(dev):
+    return os.VfsLfs2(Sectors(dev, 4096), readsize=SECTOR, progsize=SECTOR)
+
+
+# Returns the flash, for its statistics, and the translation layer on it.
+def make_fat():
+    flash = flashsim.BlockDevice(SIZE // SECTOR, **NOR)
+    dev = flashsim.FTL(flash)
+    os.VfsFat.mkfs(Sectors(dev, SECTOR))
+    return flash, dev
+
+
+def make_lfs():
+    flash = flashsim.BlockDevice(SIZE // SECTOR, **NOR)
+    dev = flashsim.FTL(flash)
+    os.VfsLfs2.mkfs(Sectors(dev, 4096), readsize=SECTOR, progsize=SECTOR)
+    return flash, dev
+
+
+FILESYSTEMS = (("fat", make_fat, fat_vfs), ("lfs", make_lfs, lfs_vfs))
+
+
+def log_small(n):
+    # Append a short line and flush it, as a data logger would.
+    with open("/fs/log.txt", "a") as f:
+        for i in range(n):
+            f.write("{:05d},{:05d}\n".format(i, i * 7 % 1000))
+            f.flush()
+
+
+def populate(n):
+    os.mkdir("/fs/lib")
+    for i in range(n):
+        with open("/fs/lib/mod{:02d}.py".format(i), "w") as f:
+            f.write("x = {}\n".format(i) * (i + 1))
+
+
+for name, make, vfs in FILESYSTEMS:
+    print(name)
+    flash, dev = make()
+    flash.reset_stats()
+    os.mount(vfs(dev), "/fs")
+    log_small(200)
+    report("log", flash)
+    populate(20)
+    os.umount("/fs")
+    dev.mount()
+    flash.reset_stats()
+
+    os.mount(vfs(dev), "/fs")
+    print(len(os.listdir("/fs/lib")), os.stat("/fs/log.txt")[6])
+    report("mount", flash)
+    os.umount("/fs")
+
+
+OLD = "old " * 300
+NEW = "new " * 300
+
+
+# Cut the power part way through a program or erase, after ops of them.
+# Returns the file, which FAT keeps open if closing it failed.
+def rewrite(vfs, dev, ops):
+    os.mount(vfs(dev), "/fs")
+    dev.cut_power(ops)
+    f = None
+    try:
+        f = open("/fs/data.txt", "w")
+        f.write(NEW)
+        f.close()
+    except OSError:
+        pass
+    try:
+        os.umount("/fs")
+    except OSError:
+        pass
+    # Power up again.
+    dev.mount()
+    return f
+
+
+def check(vfs, dev):
+    try:
+        os.mount(vfs(dev), "/fs")
+    except OSError:
+        return "unmountable"
+    try:
+        with open("/fs/data.txt") as f:
+            data = f.read()
+    except OSError:
+        data = None
+    os.umount("/fs")
+    if data == OLD:
+        return "old"
+    if data == NEW:
+        return "new"
+    if data is None:
+        return "missing"
+    return "torn"
+
+
+for name, make, vfs in FILESYSTEMS:
+    outcomes = {}
+    for ops in range(0, 48, 3):
+        flash, dev = make()
+        os.mount(vfs(dev), "/fs")
+        with open("/fs/data.txt", "w") as f:
+            f.write(OLD)
+        os.umount("/fs")
+        f = rewrite(vfs, dev, ops)
+        outcome = check(vfs, dev)
+        # Finish with the file rather than leave it to the finaliser.
+        try:
+            if f:
+                f.close()
+        except OSError:
+            pass
+        outcomes[outcome] = outcomes.get(outcome, 0) + 1
+    print(name, sorted(outcomes.items()))
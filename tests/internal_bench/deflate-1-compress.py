@@ -0,0 +1,40 @@
+# Compressing device log and sensor data with deflate.DeflateIO
+# Each run compresses the same data once at every level in LEVELS: 0 is a
+# brute force search of the window, 1-9 use hash chains.
+import bench
+import deflate
+import io
+
+LEVELS = (0, 1, 6, 9)
+
+
+def make_data(n):
+    buf = bytearray()
+    seed = 1
+    t = 0
+    temp = 2150
+    while len(buf) < n:
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+        t += seed % 500
+        temp += (seed >> 8) % 5 - 2
+        line = "%d.%03d INFO sensor[%d] temp=%d status=%s\n" % (
+            t // 1000,
+            t % 1000,
+            seed % 8,
+            temp,
+            "ok" if seed & 3 else "warn",
+        )
+        buf += line.encode()
+        buf += temp.to_bytes(2, "little") * 4
+    return buf
+
+
+def test(num):
+    data = make_data(8192)
+    for i in range(num // 2000000):
+        for level in LEVELS:
+            with deflate.DeflateIO(io.BytesIO(), deflate.RAW, 12, False, level) as g:
+                g.write(data)
+
+
+bench.run(test)
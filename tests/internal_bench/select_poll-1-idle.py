@@ -0,0 +1,24 @@
+# Poll a ready file descriptor alongside 0, 9 and 99 idle ones
+# With epoll the cost per poll doesn't depend on the number of idle objects
+import bench
+import select
+import sys
+
+COUNTS = (1, 10, 100)
+
+
+def test(num):
+    for count in COUNTS:
+        p = select.poll()
+        p.register(sys.stdout, select.POLLOUT)
+        # Extra descriptors for stdout, registered but not waiting for anything.
+        files = [open("/dev/stdout", "wb") for i in range(count - 1)]
+        for f in files:
+            p.register(f, 0)
+        for i in range(num // 2000):
+            p.poll(0)
+        for f in files:
+            f.close()
+
+
+bench.run(test)
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: 2025 Adafruit Industries LLC
+#
+# SPDX-License-Identifier: MIT
+
+# Pack a directory into a ROMFS image that os.VfsRom can mount.
+#
+# File contents are stored once each, ahead of the directory tree, and aligned
+# so that memoryview(open(path, "rb")) on the device can be used directly as
+# Bitmap, synthio waveform or font data without copying it into RAM. The image
+# itself should be placed at an address aligned to at least 8 bytes.
+#
+# RomfsPacker only needs what MicroPython also provides, so tests can import
+# this file to build their images.
+
+import os
+import sys
+
+ROMFS_HEADER = b"\xd2\xcd\x31"
+
+ROMFS_RECORD_KIND_PADDING = 1
+ROMFS_RECORD_KIND_DATA_VERBATIM = 2
+ROMFS_RECORD_KIND_DATA_POINTER = 3
+ROMFS_RECORD_KIND_DIRECTORY = 4
+ROMFS_RECORD_KIND_FILE = 5
+
+# The filesystem record's length is padded to this many bytes so the payload
+# always starts 8 bytes into the image.
+HEADER_LEN_BYTES = 5
+PAYLOAD_START = len(ROMFS_HEADER) + HEADER_LEN_BYTES
+
+
+def encode_uint(value):
+    encoded = [value & 0x7F]
+    value >>= 7
+    while value != 0:
+        encoded.insert(0, 0x80 | (value & 0x7F))
+        value >>= 7
+    return bytes(encoded)
+
+
+def pack_record(kind, payload):
+    return encode_uint(kind) + encode_uint(len(payload)) + payload
+
+
+class RomfsPacker:
+    def __init__(self, align=4):
+        self._align = align
+        self._data = bytearray()
+        self._offsets = {}
+
+    def add_data(self, data):
+        """Store data aligned in the image and return its payload offset.
+        Identical contents are stored once."""
+        data = bytes(data)
+        if data in self._offsets:
+            return self._offsets[data]
+        encoded_len = encode_uint(len(data))
+        # Padding a varuint with leading 0x80 bytes does not change its value,
+        # so the record's own length field provides the alignment.
+        used = PAYLOAD_START + len(self._data) + 1 + len(encoded_len)
+        pad = -used % self._align
+        self._data.extend(encode_uint(ROMFS_RECORD_KIND_DATA_VERBATIM))
+        self._data.extend(b"\x80" * pad + encoded_len)
+        offset = len(self._data)
+        self._data.extend(data)
+        self._offsets[data] = offset
+        return offset
+
+    def file_record(self, name, data):
+        offset = self.add_data(data)
+        pointer = encode_uint(len(data)) + encode_uint(offset)
+        name = name.encode("utf-8")
+        payload = encode_uint(len(name)) + name
+        payload += pack_record(ROMFS_RECORD_KIND_DATA_POINTER, pointer)
+        return pack_record(ROMFS_RECORD_KIND_FILE, payload)
+
+    def dir_record(self, name, records):
+        name = name.encode("utf-8")
+        payload = encode_uint(len(name)) + name + records
+        return pack_record(ROMFS_RECORD_KIND_DIRECTORY, payload)
+
+    def finalise(self, tree):
+        payload = bytes(self._data) + tree
+        # The whole image must have an even size, and a padding record is at
+        # least two bytes long.
+        if (PAYLOAD_START + len(payload)) % 2:
+            payload += pack_record(ROMFS_RECORD_KIND_PADDING, b"\x00")
+        encoded_len = encode_uint(len(payload))
+        if len(encoded_len) > HEADER_LEN_BYTES:
+            raise ValueError("image too large")
+        encoded_len = b"\x80" * (HEADER_LEN_BYTES - len(encoded_len)) + encoded_len
+        return ROMFS_HEADER + encoded_len + payload
+
+
+def pack_dir(packer, path):
+    records = bytearray()
+    for name in sorted(os.listdir(path)):
+        if name.startswith("."):
+            continue
+        full = os.path.join(path, name)
+        if os.path.isdir(full):
+            records.extend(packer.dir_record(name, pack_dir(packer, full)))
+        else:
+            with open(full, "rb") as f:
+                records.extend(packer.file_record(name, f.read()))
+    return bytes(records)
+
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Pack a directory into a ROMFS image.")
+    parser.add_argument("source", help="directory to pack")
+    parser.add_argument("output", help="image file to write")
+    parser.add_argument(
+        "--align",
+        type=int,
+        default=4,
+        help="alignment of file data in bytes (a power of 2, default 4)",
+    )
+    args = parser.parse_args()
+
+    if args.align < 1 or args.align & (args.align - 1):
+        parser.error("--align must be a power of 2")
+    if not os.path.isdir(args.source):
+        parser.error("{} is not a directory".format(args.source))
+
+    packer = RomfsPacker(args.align)
+    image = packer.finalise(pack_dir(packer, args.source))
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("{}: {} bytes".format(args.output, len(image)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()